@@ -0,0 +1,127 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/auto_schedule/database/tuning_record_database.h"
+
+#include <glog/logging.h>
+#include <google/protobuf/util/json_util.h>
+#include <llvm/Support/Host.h>
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+#include "paddle/common/enforce.h"
+#include "paddle/common/flags.h"
+
+PD_DECLARE_string(cinn_tuning_record_file);
+
+namespace cinn {
+namespace auto_schedule {
+
+TuningRecordDatabase::TuningRecordDatabase(const std::string& path)
+    : path_(path) {
+  std::ifstream is(path_);
+  if (!is.good()) {
+    VLOG(3) << "No tuning records in " << path_;
+    return;
+  }
+  size_t num_lines = 0;
+  for (std::string line; std::getline(is, line);) {
+    if (line.empty()) continue;
+    ++num_lines;
+    proto::TuningRecord record;
+    auto status = google::protobuf::util::JsonStringToMessage(line, &record);
+    // A line cut by a crashed tuner is skipped, the others stay usable.
+    if (!status.ok()) {
+      LOG(WARNING) << "Skip invalid tuning record in " << path_ << ": "
+                   << status.ToString();
+      continue;
+    }
+    Update(record);
+  }
+  VLOG(3) << "Loaded " << best_records_.size() << " tasks from " << num_lines
+          << " tuning records in " << path_;
+}
+
+TuningRecordDatabase* TuningRecordDatabase::Global() {
+  if (FLAGS_cinn_tuning_record_file.empty()) return nullptr;
+  static std::mutex mutex;
+  // Keyed by path, a database stays valid after the flag changes.
+  static std::unordered_map<std::string, std::unique_ptr<TuningRecordDatabase>>
+      databases;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& database = databases[FLAGS_cinn_tuning_record_file];
+  if (!database) {
+    database =
+        std::make_unique<TuningRecordDatabase>(FLAGS_cinn_tuning_record_file);
+  }
+  return database.get();
+}
+
+// The schedules are measured on the local cpu, so the host cpu is part of
+// the key.
+std::string TuningRecordDatabase::MakeTaskKey(
+    const common::Target& target, const std::string& group_fingerprint) {
+  std::ostringstream os;
+  os << "target: " << target << "\n"
+     << "host cpu: " << llvm::sys::getHostCPUName().str() << "\n"
+     << group_fingerprint;
+  return os.str();
+}
+
+std::optional<proto::TuningRecord> TuningRecordDatabase::GetBest(
+    const std::string& task_key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = best_records_.find(task_key);
+  if (it == best_records_.end()) return std::nullopt;
+  return it->second;
+}
+
+bool TuningRecordDatabase::Commit(const proto::TuningRecord& record) {
+  std::string json_string;
+  auto status =
+      google::protobuf::util::MessageToJsonString(record, &json_string);
+  PADDLE_ENFORCE_EQ(
+      status.ok(),
+      true,
+      ::common::errors::InvalidArgument(
+          "Failed to serialize the tuning record to JSON, error: %s",
+          status.ToString()));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!Update(record)) return false;
+  std::ofstream os(path_, std::ofstream::app);
+  PADDLE_ENFORCE_EQ(os.good(),
+                    true,
+                    ::common::errors::InvalidArgument(
+                        "Cannot open the file to write: %s", path_));
+  os << json_string << std::endl;
+  VLOG(3) << "Commit tuning record of cost " << record.execution_cost()
+          << " to " << path_;
+  return true;
+}
+
+bool TuningRecordDatabase::Update(const proto::TuningRecord& record) {
+  auto it = best_records_.find(record.task_key());
+  if (it != best_records_.end() &&
+      it->second.execution_cost() <= record.execution_cost()) {
+    return false;
+  }
+  best_records_[record.task_key()] = record;
+  return true;
+}
+
+}  // namespace auto_schedule
+}  // namespace cinn
@@ -0,0 +1,65 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "paddle/cinn/auto_schedule/auto_schedule.pb.h"
+#include "paddle/cinn/common/target.h"
+
+namespace cinn {
+namespace auto_schedule {
+
+/**
+ * The tuned schedules of the CPU kernels of fusion groups.
+ *
+ * A record is a proto::TuningRecord, its task_key is made from the target, the
+ * host cpu and the fingerprint of the fusion group, and its trace is the
+ * ScheduleDesc applied to the lowered kernel of the group. The records are
+ * appended to a file as json lines, and only the one with the lowest
+ * execution_cost of each task is kept when the file is loaded.
+ */
+class TuningRecordDatabase {
+ public:
+  // Loads the records in path if it exists, Commit appends to it.
+  explicit TuningRecordDatabase(const std::string& path);
+
+  // The database of FLAGS_cinn_tuning_record_file, nullptr if it is empty.
+  static TuningRecordDatabase* Global();
+
+  static std::string MakeTaskKey(const common::Target& target,
+                                 const std::string& group_fingerprint);
+
+  std::optional<proto::TuningRecord> GetBest(const std::string& task_key) const;
+
+  // Keeps the record and appends it to the file if it runs faster than the
+  // best one of its task. Returns whether it is the new best.
+  bool Commit(const proto::TuningRecord& record);
+
+  const std::string& path() const { return path_; }
+
+ private:
+  bool Update(const proto::TuningRecord& record);
+
+  const std::string path_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, proto::TuningRecord> best_records_;
+};
+
+}  // namespace auto_schedule
+}  // namespace cinn
@@ -23,6 +23,7 @@
 #include "paddle/cinn/hlir/framework/graph_compiler_util.h"
 #include "paddle/cinn/ir/ir_printer.h"
 #include "paddle/cinn/runtime/backend_api.h"
+#include "paddle/cinn/utils/compile_stage_timer.h"
 #ifdef CINN_WITH_CUDA
 #include "paddle/cinn/backends/codegen_cuda_dev.h"
 #include "paddle/cinn/backends/nvrtc/nvrtc_util.h"
@@ -252,6 +253,7 @@ void Compiler::AppendBroadcastSwitchModule(const ir::Module& module) {
 }
 
 void Compiler::EndCompile() {
+  utils::CompileStageTimer timer(utils::CompileStage::kLink);
   RegisterDeviceModuleSymbol();
   engine_->AddSelfModule();
 }
@@ -405,6 +407,7 @@ void Compiler::CompileCudaModule(const Module& module,
     std::string file_path = FLAGS_cinn_debug_custom_code_path;
     source_code = GetFileContent(file_path);
   } else if (code.empty()) {
+    utils::CompileStageTimer timer(utils::CompileStage::kCodeGen);
     CodeGenCudaDev codegen(target_);
     source_code = codegen.Compile(device_module);
   } else {
@@ -443,6 +446,7 @@ void Compiler::CompileHipModule(const Module& module, const std::string& code) {
     std::string file_path = FLAGS_cinn_debug_custom_code_path;
     source_code = GetFileContent(file_path);
   } else if (code.empty()) {
+    utils::CompileStageTimer timer(utils::CompileStage::kCodeGen);
     hip::CodeGenHipDevice codegen(target_);
     source_code = codegen.Compile(device_module);
   } else {
@@ -474,6 +478,26 @@ void Compiler::ExportObject(const std::string& path) {
   engine_->ExportObject(path);
 }
 
+std::string Compiler::GetHostObject() const {
+  PADDLE_ENFORCE_EQ(
+      std::holds_alternative<common::X86Arch>(target_.arch),
+      true,
+      ::common::errors::Unimplemented(
+          "Only the host object of X86 target can be saved, but got %s.",
+          target_.arch_str()));
+  return engine_->GetSelfModuleObject();
+}
+
+bool Compiler::LoadHostObject(const std::string& object) {
+  PADDLE_ENFORCE_EQ(
+      std::holds_alternative<common::X86Arch>(target_.arch),
+      true,
+      ::common::errors::Unimplemented(
+          "Only the host object of X86 target can be loaded, but got %s.",
+          target_.arch_str()));
+  return engine_->AddObject(object);
+}
+
 void* Compiler::Lookup(absl::string_view fn_name) {
   PADDLE_ENFORCE_NOT_NULL(
       engine_, ::common::errors::InvalidArgument("Sorry, engine_ is nullptr"));
@@ -116,6 +116,15 @@ class Compiler final {
 
   void ExportObject(const std::string& path);
 
+  /**
+   * The host object code compiled for X86, which is available after the
+   * first Lookup. Loading it by LoadHostObject in another Compiler replaces
+   * Build and EndCompile, it returns false if the object can not be parsed.
+   */
+  std::string GetHostObject() const;
+
+  bool LoadHostObject(const std::string& object);
+
   std::string GetSourceCode(const ir::Module& module);
 
   void BuildDefault(const ir::Module& module);
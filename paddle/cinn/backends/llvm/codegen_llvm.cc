@@ -712,6 +712,11 @@ llvm::Value *CodeGenLLVM::Visit(const ir::_Dim_ *) {
 llvm::Value *CodeGenLLVM::Visit(const ir::Call *op) {
   if (op->name == runtime::intrinsic::debug_log_repr) {
     return EmitCall_debug_info(op);
+  } else if (op->name == runtime::intrinsic::vector_reduce_add ||
+             op->name == runtime::intrinsic::vector_reduce_mul ||
+             op->name == runtime::intrinsic::vector_reduce_max ||
+             op->name == runtime::intrinsic::vector_reduce_min) {
+    return EmitCall_vector_reduce(op);
   } else if (op->is_extern_call()) {
     auto emitter_id = ExternFuncID{backend_llvm_host, op->name.c_str()};
     const auto &fn_name =
@@ -843,6 +848,17 @@ llvm::Value *CodeGenLLVM::Visit(const ir::Load *op) {
     // meta, 0));
     return load_inst;
   } else {  // vector load
+    // All the lanes read the same element, load it once and broadcast it.
+    Expr broadcast_index = detail::StridedRampBase(op->index(), 0);
+    if (auto *broadcast = op->index().As<ir::Broadcast>()) {
+      broadcast_index = broadcast->value;
+    }
+    if (broadcast_index.defined()) {
+      Expr broadcast_load = ir::Broadcast::Make(
+          ir::Load::Make(op->tensor, {broadcast_index}), op->type().lanes());
+      return Visit(&broadcast_load);
+    }
+
     Expr dense_strided_ramp = detail::StridedRampBase(op->index(), 1);
     llvm::Value *buffer = Visit(&op->tensor);
     if (dense_strided_ramp.defined()) {
@@ -1191,6 +1207,61 @@ llvm::Value *CodeGenLLVM::EmitCall_debug_info(const ir::Call *op) {
   return Call(callee, args, "call debug_info");
 }
 
+llvm::Value *CodeGenLLVM::EmitCall_vector_reduce(const ir::Call *op) {
+  PADDLE_ENFORCE_EQ(op->read_args.size(),
+                    1UL,
+                    ::common::errors::InvalidArgument(
+                        "The vector reduction %s takes one vector argument, "
+                        "but received %d.",
+                        op->name,
+                        op->read_args.size()));
+  const Type type = op->read_args[0].type();
+  PADDLE_ENFORCE_GT(type.lanes(),
+                    1,
+                    ::common::errors::InvalidArgument(
+                        "The argument of %s should be a vector.", op->name));
+  llvm::Value *src = Visit(&op->read_args[0]);
+
+  if (type.is_float()) {
+    // The lanes hold partial results of a reduction CINN already reorders,
+    // allow LLVM to reduce them as a tree instead of in order.
+    llvm::FastMathFlags fmf;
+    fmf.setAllowReassoc();
+    llvm::Type *elem_type = CinnTypeToLLVMType(type.ElementOf(), m_);
+    llvm::CallInst *reduce = nullptr;
+    if (op->name == runtime::intrinsic::vector_reduce_add) {
+      reduce = b_->CreateFAddReduce(
+          llvm::ConstantFP::getNegativeZero(elem_type), src);
+    } else if (op->name == runtime::intrinsic::vector_reduce_mul) {
+      reduce = b_->CreateFMulReduce(llvm::ConstantFP::get(elem_type, 1.0), src);
+    } else if (op->name == runtime::intrinsic::vector_reduce_max) {
+#if LLVM_VERSION_MAJOR >= 12
+      reduce = b_->CreateFPMaxReduce(src);
+#else
+      reduce = b_->CreateFPMaxReduce(src, /*NoNaN*/ false);
+#endif
+    } else {
+#if LLVM_VERSION_MAJOR >= 12
+      reduce = b_->CreateFPMinReduce(src);
+#else
+      reduce = b_->CreateFPMinReduce(src, /*NoNaN*/ false);
+#endif
+    }
+    reduce->setFastMathFlags(fmf);
+    return reduce;
+  }
+
+  const bool is_signed = type.is_int();
+  if (op->name == runtime::intrinsic::vector_reduce_add) {
+    return b_->CreateAddReduce(src);
+  } else if (op->name == runtime::intrinsic::vector_reduce_mul) {
+    return b_->CreateMulReduce(src);
+  } else if (op->name == runtime::intrinsic::vector_reduce_max) {
+    return b_->CreateIntMaxReduce(src, is_signed);
+  }
+  return b_->CreateIntMinReduce(src, is_signed);
+}
+
 llvm::Value *CodeGenLLVM::GetVar(const std::string &name, bool lazy) {
   auto symbol = symbol_table_->Lookup(name);
   if (!lazy) {
@@ -226,6 +226,7 @@ class CodeGenLLVM : public LLVMIRVisitor, public IrBuilderMixin<CodeGenLLVM> {
   llvm::Value *EmitCall_buffer_malloc(const ir::Call *op);
   llvm::Value *EmitCall_get_address(const ir::Call *op);
   llvm::Value *EmitCall_debug_info(const ir::Call *op);
+  llvm::Value *EmitCall_vector_reduce(const ir::Call *op);
   // @}
 
   llvm::Value *EmitBinaryOp(llvm::Value *lhs,
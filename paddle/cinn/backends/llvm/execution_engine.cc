@@ -63,6 +63,7 @@
 #include "paddle/cinn/backends/llvm/runtime_symbol_registry.h"
 #include "paddle/cinn/ir/ir_printer.h"
 #include "paddle/cinn/runtime/intrinsic.h"
+#include "paddle/cinn/utils/compile_stage_timer.h"
 #include "paddle/cinn/utils/profiler.h"
 
 namespace cinn::backends {
@@ -107,6 +108,12 @@ std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(
   return llvm::MemoryBuffer::getMemBuffer(it->second->getMemBufferRef());
 }
 
+const llvm::MemoryBuffer *NaiveObjectCache::Find(
+    llvm::StringRef module_id) const {
+  auto it = cached_objects_.find(module_id);
+  return it == cached_objects_.end() ? nullptr : it->second.get();
+}
+
 /*static*/ std::unique_ptr<ExecutionEngine> ExecutionEngine::Create(
     const ExecutionOptions &config) {
   VLOG(1) << "===================== Create CINN ExecutionEngine begin "
@@ -173,6 +180,7 @@ template <typename CodeGenT>
 void ExecutionEngine::Link(const ir::Module &module) {
   utils::RecordEvent("ExecutionEngine Link", utils::EventType::kOrdinary);
 
+  utils::CompileStageTimer codegen_timer(utils::CompileStage::kCodeGen);
   auto ir_emitter = std::make_unique<CodeGenT>(m.get(), b.get());
   VLOG(3) << "ir_emitter->Compile(module) Begin";
   ir_emitter->Compile(module);
@@ -184,6 +192,7 @@ void ExecutionEngine::Link(const ir::Module &module) {
   auto machine = std::move(llvm::cantFail(
       llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost())
           .createTargetMachine()));
+  utils::CompileStageTimer opt_timer(utils::CompileStage::kLLVMOpt);
   LLVMModuleOptimizer optimize(machine.get(), 3, {}, true);
   optimize(m.get());
   PADDLE_ENFORCE_EQ(
@@ -244,9 +253,35 @@ void ExecutionEngine::RegisterModuleRuntimeSymbols(
 }
 
 bool ExecutionEngine::AddSelfModule() {
+  self_module_id_ = m->getModuleIdentifier();
   return AddModule(std::move(m), std::move(ctx));
 }
 
+bool ExecutionEngine::AddObject(absl::string_view object) {
+  utils::RecordEvent("ExecutionEngine AddObject", utils::EventType::kOrdinary);
+  std::lock_guard<std::mutex> lock(mu_);
+  llvm::Error error = jit_->addObjectFile(
+      llvm::MemoryBuffer::getMemBufferCopy(AsStringRef(object)));
+  if (error) {
+    LOG(WARNING) << "Failed to add the object: "
+                 << llvm::toString(std::move(error));
+    return false;
+  }
+  return true;
+}
+
+std::string ExecutionEngine::GetSelfModuleObject() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  const llvm::MemoryBuffer *object = cache_->Find(self_module_id_);
+  PADDLE_ENFORCE_NOT_NULL(
+      object,
+      ::common::errors::PreconditionNotMet(
+          "The module %s is not compiled yet, please lookup its symbols "
+          "before getting the object.",
+          self_module_id_));
+  return object->getBuffer().str();
+}
+
 void ExecutionEngine::ExportObject(const std::string &path) {
   FILE *of = fopen(path.c_str(), "w");
   fwrite(buffer_.data(), 1, buffer_.size(), of);
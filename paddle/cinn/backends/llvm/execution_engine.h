@@ -56,6 +56,9 @@ class NaiveObjectCache : public llvm::ObjectCache {
                             llvm::MemoryBufferRef) override;
   std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *) override;
 
+  // The object compiled from the module, or nullptr if not compiled yet.
+  const llvm::MemoryBuffer *Find(llvm::StringRef module_id) const;
+
  private:
   llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> cached_objects_;
 };
@@ -87,6 +90,14 @@ class ExecutionEngine {
 
   bool AddSelfModule();
 
+  // Adds an object compiled by another engine, see GetSelfModuleObject.
+  // Returns false if the object can not be parsed.
+  bool AddObject(absl::string_view object);
+
+  // The object code of the module added by AddSelfModule. The jit compiles
+  // the module at the first lookup of its symbols, so call it after Lookup.
+  std::string GetSelfModuleObject() const;
+
  protected:
   explicit ExecutionEngine(bool enable_object_cache)
       : cache_(std::make_unique<NaiveObjectCache>()),
@@ -107,6 +118,7 @@ class ExecutionEngine {
   std::unique_ptr<llvm::orc::LLJIT> jit_;
   std::unique_ptr<NaiveObjectCache> cache_;
   RuntimeSymbols module_symbols_;
+  std::string self_module_id_;
 
   std::unique_ptr<llvm::LLVMContext> ctx;
   std::unique_ptr<llvm::Module> m;
@@ -256,6 +256,8 @@ class AddBroadcastToElementwisePass : public pir::PatternRewritePass {
   bool CanApplyOn(pir::Operation* op) const override {
     return op->num_regions() > 0 && op->isa<cinn::dialect::GroupOp>();
   }
+
+  bool IsRegionLocal() const override { return true; }
 };
 
 class DeleteUselessBroadcastPass : public pir::PatternRewritePass {
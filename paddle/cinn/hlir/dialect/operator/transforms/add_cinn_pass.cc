@@ -67,6 +67,7 @@ COMMON_DECLARE_bool(disable_dyshape_in_train);
 COMMON_DECLARE_bool(enable_cinn_accuracy_check);
 COMMON_DECLARE_bool(enable_fuse_parallel_matmul_pass);
 COMMON_DECLARE_bool(enable_fusion_fallback);
+COMMON_DECLARE_int32(cinn_group_op_pass_num_threads);
 COMMON_DECLARE_bool(logging_pir_py_code_dump_symbolic_dims);
 PD_DECLARE_bool(group_schedule_tiling_first);
 
@@ -181,9 +182,15 @@ void ApplyBuildGroupOpPass(
 void ApplyGroupOpPass(::pir::Program* program,
                       const std::function<std::shared_ptr<pir::PassManager>()>&
                           CreatePassManager) {
-  std::shared_ptr<pir::PassManager> pass_manager = CreatePassManager();
-  pass_manager->AddPass(
+  // The group ops are independent of each other in the passes that are
+  // region local, which run on them in parallel.
+  std::shared_ptr<pir::PassManager> local_pass_manager = CreatePassManager();
+  local_pass_manager->AddPass(
       cinn::dialect::ir::CreateAddBroadcastToElementwisePass());
+  local_pass_manager->EnableParallel(FLAGS_cinn_group_op_pass_num_threads);
+  local_pass_manager->Run(program);
+
+  std::shared_ptr<pir::PassManager> pass_manager = CreatePassManager();
   if (HasDynamicShape(*program)) {
     pass_manager->AddPass(cinn::dialect::ir::CreateInsertBroadcastPass());
     pass_manager->AddPass(cinn::dialect::ir::CreateSimplifyDimExprPass());
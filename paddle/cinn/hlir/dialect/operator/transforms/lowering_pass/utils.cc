@@ -22,12 +22,14 @@
 #include "paddle/cinn/hlir/dialect/runtime/ir/jit_kernel_op.h"
 #include "paddle/cinn/hlir/dialect/runtime/ir/runtime_dialect.h"
 #include "paddle/cinn/hlir/framework/pir/compilation_cache.h"
+#include "paddle/cinn/hlir/framework/pir/shape_specialization.h"
 #include "paddle/cinn/hlir/framework/pir/utils.h"
 #include "paddle/cinn/hlir/framework/pir_compiler.h"
 #include "paddle/cinn/runtime/flags.h"
 
 PD_DECLARE_bool(cinn_enable_map_expr);
 PD_DECLARE_bool(enable_cinn_compile_cache);
+PD_DECLARE_int64(cinn_shape_specialize_threshold);
 
 namespace cinn::dialect::ir::details {
 
@@ -35,6 +37,7 @@ using cinn::hlir::framework::CompilationCache;
 using cinn::hlir::framework::PirCompiler;
 using cinn::hlir::framework::pir::CINNKernelInfo;
 using cinn::hlir::framework::pir::CompatibleInfo;
+using cinn::hlir::framework::pir::ShapeSpecializationCache;
 
 std::vector<pir::Value> GetBlockOutsideInput(
     const std::vector<pir::Operation*>& op_list) {
@@ -71,11 +74,14 @@ std::unordered_map<std::string, ::pir::Attribute> GetJitKernelAttr(
       return pir_compiler.Build({group})[0];
     };
 
-    if (FLAGS_enable_cinn_compile_cache) {
-      return CreateFromCache();
-    } else {
-      return CreateFromNewCompile();
+    CINNKernelInfo kernel_info = FLAGS_enable_cinn_compile_cache
+                                     ? CreateFromCache()
+                                     : CreateFromNewCompile();
+    if (FLAGS_cinn_shape_specialize_threshold > 0) {
+      kernel_info.shape_specialization = ShapeSpecializationCache::Create(
+          cinn::common::DefaultDeviceTarget(), group, kernel_info);
     }
+    return kernel_info;
   };
   std::unordered_map<std::string, ::pir::Attribute> attrs{
       {cinn::dialect::JitKernelOp::kAttrName,
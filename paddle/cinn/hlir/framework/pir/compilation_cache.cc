@@ -60,6 +60,7 @@ pir::CINNKernelInfo BackendResource::GenerateKernelInfo() const {
 }  // namespace pir
 
 bool CompilationCache::Has(const CacheKey& key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   const bool has_existed = cache_.find(key) != cache_.end();
   VLOG(6) << "Check IsExisted in CompilationCache: " << has_existed << " - "
           << key;
@@ -68,11 +69,14 @@ bool CompilationCache::Has(const CacheKey& key) const {
 
 const CompilationCache::CacheValue& CompilationCache::Get(
     const CacheKey& key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = cache_.find(key);
   PADDLE_ENFORCE_EQ(
-      Has(key),
+      it != cache_.end(),
       true,
       ::common::errors::NotFound("%s is not in CompliatonCache.", key));
-  return cache_.at(key);
+  // The references to the elements of unordered_map are stable.
+  return it->second;
 }
 
 pir::CINNKernelInfo CompilationCache::GetKernelInfo(const CacheKey& key) const {
@@ -81,15 +85,22 @@ pir::CINNKernelInfo CompilationCache::GetKernelInfo(const CacheKey& key) const {
 
 void CompilationCache::Insert(const CacheKey& key, const CacheValue& value) {
   VLOG(6) << "Insert CompilationCache for: " << key;
-  PADDLE_ENFORCE_EQ(Has(key),
-                    false,
-                    ::common::errors::PreconditionNotMet(
-                        "%s is already in CompliatonCache while calling "
-                        "CompilationCache::Insert().",
-                        key));
-  cache_.insert({key, value});
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Another thread may have compiled the same group meanwhile, keep the first
+  // one since its kernel infos may be in use already.
+  if (!cache_.insert({key, value}).second) {
+    VLOG(6) << key << " is already inserted by another thread.";
+  }
 }
 
-void CompilationCache::Clear() { cache_.clear(); }
+void CompilationCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_.clear();
+}
+
+size_t CompilationCache::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cache_.size();
+}
 
 }  // namespace cinn::hlir::framework
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include "paddle/cinn/backends/compiler.h"
 #include "paddle/cinn/common/macros.h"
@@ -57,6 +58,7 @@ class BackendResource final {
   }
   pir::CINNKernelInfo GenerateKernelInfo() const;
   const std::string& GetHostFuncName() const { return host_fn_name_; }
+  const std::string& GetInferFuncName() const { return infer_fn_name_; }
 
  private:
   std::string host_fn_name_;
@@ -106,8 +108,10 @@ class CompilationCache {
   using CacheKey = pir::FusionInfo;
   using CacheValue = std::shared_ptr<pir::CompilationResult>;
 
+  // Shared by all the threads, so a group compiled by one thread is reused
+  // by the others.
   static CompilationCache& Instance() {
-    thread_local static CompilationCache instance;
+    static CompilationCache instance;
     return instance;
   }
 
@@ -115,7 +119,7 @@ class CompilationCache {
   const CacheValue& Get(const CacheKey& key) const;
   void Insert(const CacheKey& key, const CacheValue& value);
   void Clear();
-  size_t Size() const { return cache_.size(); }
+  size_t Size() const;
 
   pir::CINNKernelInfo GetKernelInfo(const CacheKey& key) const;
 
@@ -123,6 +127,7 @@ class CompilationCache {
   CompilationCache() = default;
   CINN_DISALLOW_COPY_AND_ASSIGN(CompilationCache);
 
+  mutable std::mutex mutex_;
   std::unordered_map<CacheKey, CacheValue> cache_;
 };
 
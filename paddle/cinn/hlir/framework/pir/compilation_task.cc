@@ -22,6 +22,7 @@
 #include "paddle/cinn/hlir/framework/op_lowering.h"
 #include "paddle/cinn/hlir/framework/pir/op_lowering_group.h"
 #include "paddle/cinn/hlir/framework/pir/utils.h"
+#include "paddle/cinn/utils/compile_stage_timer.h"
 #include "paddle/common/enforce.h"
 namespace cinn {
 namespace hlir {
@@ -153,6 +154,7 @@ std::shared_ptr<pir::CompilationResult> CompilationTask::operator()() {
 }
 
 void CompilationTask::Lowering() {
+  utils::CompileStageTimer timer(utils::CompileStage::kLowering);
   VLOG(5) << "Begin to lowering group: " << *context_->group_;
   auto op_lowerer = CreateOpLowerer<pir::OpLoweringGroupPtr>(context_->target_);
   context_->SetLoweredFuncs(op_lowerer.BucketLower(context_->group_));
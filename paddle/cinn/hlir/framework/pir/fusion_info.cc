@@ -13,6 +13,9 @@
 // limitations under the License.
 
 #include "paddle/cinn/hlir/framework/pir/fusion_info.h"
+
+#include <sstream>
+
 #include "paddle/common/enforce.h"
 #include "paddle/common/flags.h"
 #include "paddle/pir/include/core/ir_printer.h"
@@ -36,8 +39,17 @@ std::ostream& operator<<(std::ostream& os, const AttributeInfo& attr_info) {
   return os;
 }
 
+void AttributeInfo::PrintFingerprint(std::ostream& os) const {
+  os << name_ << "=";
+  ::pir::IrPrinter(os).PrintAttribute(attr_);
+}
+
 std::size_t ValueInfo::hash() const { return type_.hash(); }
 
+void ValueInfo::PrintFingerprint(std::ostream& os) const {
+  ::pir::IrPrinter(os).PrintType(type_);
+}
+
 std::ostream& operator<<(std::ostream& os, const ValueInfo& value_info) {
   os << "ValueInfo - " << value_info.hash();
   if (VLOG_IS_ON(7)) {
@@ -81,6 +93,25 @@ std::size_t OperationInfo::hash() const {
   return seed;
 }
 
+void OperationInfo::PrintFingerprint(std::ostream& os) const {
+  os << name_ << "(";
+  for (const auto& info : input_infos_) {
+    info.PrintFingerprint(os);
+    os << ", ";
+  }
+  os << ") -> (";
+  for (const auto& info : output_infos_) {
+    info.PrintFingerprint(os);
+    os << ", ";
+  }
+  os << ") {";
+  for (const auto& info : attr_infos_) {
+    info.PrintFingerprint(os);
+    os << ", ";
+  }
+  os << "}";
+}
+
 std::ostream& operator<<(std::ostream& os, const OperationInfo& op_info) {
   os << op_info.name_ << " - " << op_info.hash();
   if (VLOG_IS_ON(7)) {
@@ -106,6 +137,11 @@ std::size_t OpDepInfo::hash() const {
   return seed;
 }
 
+// The upstream op is printed as a whole by the FusionInfo, its index is enough.
+void OpDepInfo::PrintFingerprint(std::ostream& os) const {
+  os << upstream_index_;
+}
+
 std::size_t FusionOpInfo::hash() const {
   std::size_t seed = op_info_.hash();
   for (const auto& [value_index, op_info_hash] : inner_deps_) {
@@ -115,6 +151,17 @@ std::size_t FusionOpInfo::hash() const {
   return seed;
 }
 
+void FusionOpInfo::PrintFingerprint(std::ostream& os) const {
+  op_info_.PrintFingerprint(os);
+  os << " deps {";
+  for (const auto& [value_index, dep_info] : inner_deps_) {
+    os << value_index << ":";
+    dep_info.PrintFingerprint(os);
+    os << ", ";
+  }
+  os << "}";
+}
+
 std::ostream& operator<<(std::ostream& os, const FusionOpInfo& info) {
   os << info.op_info_ << ", inner_deps:{";
   for (const auto& [value_index, op_info_hash] : info.inner_deps_) {
@@ -203,6 +250,19 @@ std::size_t FusionInfo::hash() const {
   return seed;
 }
 
+std::string FusionInfo::Fingerprint() const {
+  std::ostringstream os;
+  os << "input_dim_exprs: {";
+  for (const auto& dim_expr : input_dim_exprs_) os << " " << dim_expr;
+  os << " }\n";
+  for (const auto& op_info : op_infos_) {
+    op_info.PrintFingerprint(os);
+    os << "\n";
+  }
+  if (!FLAGS_enable_cinn_compile_cache) os << "fn_name: " << unique_fn_name_;
+  return os.str();
+}
+
 std::ostream& operator<<(std::ostream& os, const FusionInfo& fusion_info) {
   os << "FusionInfo - " << fusion_info.hash();
   if (VLOG_IS_ON(5)) {
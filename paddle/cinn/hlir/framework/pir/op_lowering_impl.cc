@@ -17,6 +17,7 @@
 #include <string>
 
 #include "paddle/cinn/adt/map_expr_ctx.h"
+#include "paddle/cinn/auto_schedule/database/tuning_record_database.h"
 #include "paddle/cinn/ast_gen_ius/tensor_group.h"
 #include "paddle/cinn/backends/codegen_device_util.h"
 #include "paddle/cinn/common/dim_expr_converter.h"
@@ -24,6 +25,7 @@
 #include "paddle/cinn/hlir/dialect/operator/ir/manual_op.h"
 #include "paddle/cinn/hlir/dialect/operator/transforms/group_merge/op_with_group_merge_util.h"
 #include "paddle/cinn/hlir/framework/compile_error.h"
+#include "paddle/cinn/hlir/framework/pir/fusion_info.h"
 #include "paddle/cinn/hlir/framework/pir/op_lowering_util.h"
 #include "paddle/cinn/hlir/framework/pir/trivial_op_impl.h"
 #include "paddle/cinn/hlir/framework/pir/utils.h"
@@ -31,6 +33,7 @@
 #include "paddle/cinn/ir/dim.h"
 #include "paddle/cinn/ir/group_schedule/base_group_scheduler.h"
 #include "paddle/cinn/ir/group_schedule/config/group_tile_config.h"
+#include "paddle/cinn/ir/group_schedule/cpu_schedule.h"
 #include "paddle/cinn/ir/ir_analyzer/ir_analyzer.h"
 #include "paddle/cinn/ir/schedule/ir_schedule.h"
 #include "paddle/cinn/lang/placeholder.h"
@@ -41,6 +44,7 @@
 #include "paddle/cinn/optim/rearrange_load_instruction.h"
 #include "paddle/cinn/optim/schedule_block_dce.h"
 #include "paddle/cinn/optim/transform_gpu_forloop.h"
+#include "paddle/cinn/utils/compile_stage_timer.h"
 #include "paddle/common/ddim.h"
 #include "paddle/common/enforce.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
@@ -85,6 +89,22 @@ std::optional<std::vector<ir::Expr>> GetTensorValueFromShapeOrData(
   return result;
 }
 
+// The cpu kernels are scheduled while tuning or if there are tuned records.
+bool NeedCpuSchedule() {
+  return ir::CpuScheduleTuningScope::Current() ||
+         auto_schedule::TuningRecordDatabase::Global();
+}
+
+// The task key of a cpu kernel of the group, the kernels of the buckets are
+// tuned one by one and named by their index.
+std::string CpuKernelTaskKey(const OpLoweringGroupPtr& group,
+                             const std::string& kernel) {
+  std::string fingerprint = FusionInfo(*group).Fingerprint();
+  if (!kernel.empty()) fingerprint += "\n" + kernel;
+  return auto_schedule::TuningRecordDatabase::MakeTaskKey(
+      common::DefaultHostTarget(), fingerprint);
+}
+
 }  // namespace details
 
 OpLowererImpl::OpLowererImpl(const Target& target) : target_(target) {
@@ -96,6 +116,9 @@ BucketLoweredFuncsWrapper OpLowererImpl::BucketLower(
   VLOG(4) << "BucketLower Group : \n" << *group;
   // 1.Do compute, lower and schedule for each op.
   const auto& ops = group->ops();
+  // LowerX86 resets the target, so check it first.
+  const bool is_host_target =
+      std::holds_alternative<common::X86Arch>(target_.arch);
   auto X86Expr = LowerX86(group, ops, false);
   VLOG(3) << "After x86 lower, ir is: \n" << X86Expr;
 
@@ -159,7 +182,10 @@ BucketLoweredFuncsWrapper OpLowererImpl::BucketLower(
                                fusion_group_info);
 
   VLOG(4) << "Start apply group_scheduler->Schedule()";
-  group_scheduler->Schedule();
+  {
+    utils::CompileStageTimer timer(utils::CompileStage::kSchedule);
+    group_scheduler->Schedule();
+  }
   VLOG(4) << "End   apply group_scheduler->Schedule()";
 
   cond2func_bodies = group_scheduler->GetIRs();
@@ -168,6 +194,17 @@ BucketLoweredFuncsWrapper OpLowererImpl::BucketLower(
   priorities = group_scheduler->GetPriorities();
   VLOG(4) << "End group_scheduler->GetPriorities";
 
+  // On the host target the bucket kernels run on the cpu themselves, so each
+  // of them is scheduled by its own record as well.
+  if (is_host_target && details::NeedCpuSchedule()) {
+    for (size_t i = 0; i < cond2func_bodies.size(); ++i) {
+      cond2func_bodies[i].second = ir::ScheduleCpuKernel(
+          details::CpuKernelTaskKey(group, "bucket_" + std::to_string(i)),
+          group->FuncName(),
+          cond2func_bodies[i].second);
+    }
+  }
+
   // The last func is stored as a kernel on x86
   cond2func_bodies.emplace_back(ir::Expr(true), X86Expr);
 
@@ -753,6 +790,7 @@ ir::Expr OpLowererImpl::LowerX86(const OpLoweringGroupPtr& group,
   // for some op, it will output more tmp value and regard as
   // XX_0, XX_1, so we log them in tmp_tensor_info;
 
+  const bool tune_cpu_kernel = details::NeedCpuSchedule();
   auto need_lower_x86 = [&]() -> bool {
     for (auto* op : ops) {
       for (size_t i = 0; i < op->num_operands(); ++i) {
@@ -768,7 +806,9 @@ ir::Expr OpLowererImpl::LowerX86(const OpLoweringGroupPtr& group,
         if (::common::contain_unknown_dim(dims)) {
           return false;
         }
-        // 2. size < 4 not need lower x86
+        // 2. size < 4 not need lower x86, unless the cpu kernels are tuned,
+        // which is done for groups of any size.
+        if (tune_cpu_kernel) continue;
         int64_t sym_shape_size = 1;
         for (int i = 0; i < dims.size(); ++i) {
           sym_shape_size *= dims[i];
@@ -806,6 +846,11 @@ ir::Expr OpLowererImpl::LowerX86(const OpLoweringGroupPtr& group,
       mod_expr, -1, false, cinn::utils::ErrorMessageLevel::kGeneral, true);
   ir_sch.MergeExprs();
   auto X86Expr = ir::ir_utils::IRCopy(ir_sch.GetModule().GetExprs().at(0));
+  if (tune_cpu_kernel) {
+    X86Expr = ir::ScheduleCpuKernel(details::CpuKernelTaskKey(group, ""),
+                                    group->FuncName(),
+                                    X86Expr);
+  }
   return X86Expr;
 }
 
@@ -0,0 +1,277 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/hlir/framework/pir/persistent_compilation_cache.h"
+
+#include <absl/strings/string_view.h>
+#include <fcntl.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/Host.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "paddle/cinn/auto_schedule/database/tuning_record_database.h"
+#include "paddle/cinn/backends/llvm/cinn_runtime_llvm_ir.h"
+#include "paddle/common/enforce.h"
+#include "paddle/common/flags.h"
+
+PD_DECLARE_string(cinn_compilation_cache_dir);
+
+namespace cinn::hlir::framework::pir {
+
+namespace {
+
+constexpr char kEntryMagic[8] = {'C', 'I', 'N', 'N', 'P', 'C', 'C', 'E'};
+// Bump it whenever the layout of the entry changes.
+constexpr uint32_t kEntryVersion = 2;
+
+uint64_t Fnv1aHash(absl::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// The object code is only valid for the same compiler and host cpu.
+std::string MakeKey(const Target& target, const FusionInfo& fusion_info) {
+  std::ostringstream os;
+  os << "target: " << target << "\n"
+     << "llvm: " << LLVM_VERSION_STRING << "\n"
+     << "host cpu: " << llvm::sys::getHostCPUName().str() << "\n"
+     << "runtime: " << Fnv1aHash(backends::kRuntimeLlvmIr) << "\n"
+     << fusion_info.Fingerprint();
+  // The cpu kernel of the group is scheduled by its tuned record.
+  if (auto* database = auto_schedule::TuningRecordDatabase::Global()) {
+    const auto record =
+        database->GetBest(auto_schedule::TuningRecordDatabase::MakeTaskKey(
+            common::DefaultHostTarget(), fusion_info.Fingerprint()));
+    if (record.has_value()) {
+      os << "\ncpu schedule: " << record->trace().ShortDebugString();
+    }
+  }
+  return os.str();
+}
+
+void MakeDirs(const std::string& dir) {
+  for (size_t pos = dir.find('/', 1); pos != std::string::npos;
+       pos = dir.find('/', pos + 1)) {
+    mkdir(dir.substr(0, pos).c_str(), 0755);
+  }
+  mkdir(dir.c_str(), 0755);
+}
+
+class EntryWriter {
+ public:
+  template <typename T>
+  void Write(const T& value) {
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+  void Write(const std::string& value) {
+    Write(static_cast<uint64_t>(value.size()));
+    buffer_.append(value);
+  }
+  const std::string& buffer() const { return buffer_; }
+
+ private:
+  std::string buffer_;
+};
+
+// Reads the entry with bounds checking, a truncated or damaged entry is
+// treated as a miss.
+class EntryReader {
+ public:
+  explicit EntryReader(const std::string& buffer) : buffer_(buffer) {}
+
+  template <typename T>
+  bool Read(T* value) {
+    if (pos_ + sizeof(T) > buffer_.size()) return false;
+    std::memcpy(value, buffer_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+  bool Read(std::string* value) {
+    uint64_t size = 0;
+    if (!Read(&size) || size > buffer_.size() - pos_) return false;
+    value->assign(buffer_.data() + pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+ private:
+  const std::string& buffer_;
+  size_t pos_{0};
+};
+
+}  // namespace
+
+bool PersistentCacheEntry::IsEnabled(const Target& target) {
+  return !FLAGS_cinn_compilation_cache_dir.empty() &&
+         std::holds_alternative<common::X86Arch>(target.arch);
+}
+
+PersistentCacheEntry::PersistentCacheEntry(const Target& target,
+                                           const FusionInfo& fusion_info)
+    : target_(target), key_(MakeKey(target, fusion_info)) {
+  const std::string& dir = FLAGS_cinn_compilation_cache_dir;
+  MakeDirs(dir);
+  std::ostringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << Fnv1aHash(key_);
+  path_ = dir + "/" + name.str() + ".cinn";
+
+  lock_fd_ = open((path_ + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+  if (lock_fd_ < 0 || flock(lock_fd_, LOCK_EX) != 0) {
+    LOG(WARNING) << "Failed to lock " << path_
+                 << ".lock: " << std::strerror(errno)
+                 << ", the group may be compiled by other processes as well.";
+  }
+}
+
+PersistentCacheEntry::~PersistentCacheEntry() {
+  if (lock_fd_ >= 0) {
+    flock(lock_fd_, LOCK_UN);
+    close(lock_fd_);
+  }
+}
+
+std::shared_ptr<CompilationResult> PersistentCacheEntry::Load() const {
+  std::ifstream fin(path_, std::ios::binary);
+  if (!fin) return nullptr;
+  std::string buffer((std::istreambuf_iterator<char>(fin)),
+                     std::istreambuf_iterator<char>());
+
+  EntryReader reader(buffer);
+  char magic[sizeof(kEntryMagic)];
+  uint32_t version = 0;
+  std::string key, host_fn_name, infer_fn_name, object;
+  uint64_t symbol_arg_num = 0, object_hash = 0;
+  std::map<int, CINNKernelInfo::SymbolArgBindInfo> symbol_args_map;
+  bool valid = reader.Read(&magic) &&
+               std::memcmp(magic, kEntryMagic, sizeof(magic)) == 0 &&
+               reader.Read(&version) && version == kEntryVersion &&
+               reader.Read(&key) && key == key_ && reader.Read(&host_fn_name) &&
+               reader.Read(&infer_fn_name) && reader.Read(&symbol_arg_num);
+  for (uint64_t i = 0; valid && i < symbol_arg_num; ++i) {
+    int32_t arg_idx = 0, kind = 0, first = 0, second = 0;
+    valid = reader.Read(&arg_idx) && reader.Read(&kind) &&
+            reader.Read(&first) && reader.Read(&second) &&
+            (kind == 0 || kind == 1);
+    if (kind == 0) {
+      symbol_args_map[arg_idx] = CINNKernelInfo::ArgDimIdx{first, second};
+    } else {
+      symbol_args_map[arg_idx] = CINNKernelInfo::ArgValueIdx{first, second};
+    }
+  }
+  uint64_t temp_space_num = 0;
+  valid = valid && reader.Read(&temp_space_num);
+  std::vector<int64_t> temp_space_sizes;
+  for (uint64_t i = 0; valid && i < temp_space_num; ++i) {
+    int64_t size = 0;
+    valid = reader.Read(&size);
+    temp_space_sizes.push_back(size);
+  }
+  // The object code is checked before it is handed to the jit linker.
+  valid = valid && reader.Read(&object) && reader.Read(&object_hash) &&
+          object_hash == Fnv1aHash(object);
+  if (!valid) {
+    LOG(WARNING) << "Ignore the invalid compilation cache " << path_;
+    return nullptr;
+  }
+
+  auto backend_resource = std::make_shared<BackendResource>(target_,
+                                                            host_fn_name,
+                                                            infer_fn_name,
+                                                            symbol_args_map,
+                                                            temp_space_sizes);
+  if (!backend_resource->GetBackendCompiler()->LoadHostObject(object)) {
+    LOG(WARNING) << "Ignore the compilation cache " << path_
+                 << ", its object code can not be loaded";
+    return nullptr;
+  }
+  auto compilation_result = std::make_shared<CompilationResult>(target_);
+  compilation_result->SetBackendResource(backend_resource);
+  VLOG(4) << "Load " << host_fn_name << " from compilation cache " << path_;
+  return compilation_result;
+}
+
+void PersistentCacheEntry::Save(const CompilationResult& result) const {
+  const auto& backend_resource = result.GetBackendResource();
+  PADDLE_ENFORCE_NOT_NULL(backend_resource,
+                          ::common::errors::PreconditionNotMet(
+                              "Found backend_resource_ is nullptr, please "
+                              "call SetBackendResource first."));
+  EntryWriter writer;
+  writer.Write(kEntryMagic);
+  writer.Write(kEntryVersion);
+  writer.Write(key_);
+  writer.Write(backend_resource->GetHostFuncName());
+  writer.Write(backend_resource->GetInferFuncName());
+  writer.Write(
+      static_cast<uint64_t>(backend_resource->GetSymbolArgsMap().size()));
+  for (const auto& [arg_idx, bind_info] :
+       backend_resource->GetSymbolArgsMap()) {
+    writer.Write(static_cast<int32_t>(arg_idx));
+    if (const auto* dim_idx =
+            std::get_if<CINNKernelInfo::ArgDimIdx>(&bind_info)) {
+      writer.Write(static_cast<int32_t>(0));
+      writer.Write(static_cast<int32_t>(dim_idx->arg_idx));
+      writer.Write(static_cast<int32_t>(dim_idx->dim_idx));
+    } else {
+      const auto& value_idx = std::get<CINNKernelInfo::ArgValueIdx>(bind_info);
+      writer.Write(static_cast<int32_t>(1));
+      writer.Write(static_cast<int32_t>(value_idx.arg_idx));
+      writer.Write(static_cast<int32_t>(value_idx.value_idx));
+    }
+  }
+  const auto& temp_space_sizes = backend_resource->GetTempSpaceSizes();
+  writer.Write(static_cast<uint64_t>(temp_space_sizes.size()));
+  for (int64_t size : temp_space_sizes) {
+    writer.Write(size);
+  }
+  const std::string object =
+      backend_resource->GetBackendCompiler()->GetHostObject();
+  writer.Write(object);
+  writer.Write(Fnv1aHash(object));
+
+  // Readers without the lock never see a partially written entry.
+  const std::string tmp_path = path_ + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream fout(tmp_path, std::ios::binary);
+    fout.write(writer.buffer().data(), writer.buffer().size());
+    if (!fout) {
+      LOG(WARNING) << "Failed to write the compilation cache " << tmp_path;
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+    LOG(WARNING) << "Failed to save the compilation cache " << path_ << ": "
+                 << std::strerror(errno);
+    std::remove(tmp_path.c_str());
+    return;
+  }
+  VLOG(4) << "Save " << backend_resource->GetHostFuncName()
+          << " to compilation cache " << path_;
+}
+
+}  // namespace cinn::hlir::framework::pir
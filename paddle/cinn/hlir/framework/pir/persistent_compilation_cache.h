@@ -0,0 +1,67 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "paddle/cinn/common/macros.h"
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/hlir/framework/pir/compilation_cache.h"
+#include "paddle/cinn/hlir/framework/pir/fusion_info.h"
+
+namespace cinn::hlir::framework::pir {
+
+/*
+ * An entry of the compilation cache under FLAGS_cinn_compilation_cache_dir,
+ * which keeps the host object code, symbol_args_map and temp_space_sizes of
+ * a compiled fusion group for other processes.
+ *
+ * The entry is keyed by the fingerprint of the FusionInfo, the target and
+ * the version of the compiler. While the entry is alive it holds an exclusive
+ * file lock on the key, so the processes compiling the same group wait for
+ * the first one and load its result instead of compiling again:
+ *
+ *   PersistentCacheEntry entry(target, fusion_info);
+ *   auto result = entry.Load();
+ *   if (!result) {
+ *     result = Compile(...);
+ *     entry.Save(*result);
+ *   }
+ */
+class PersistentCacheEntry final {
+ public:
+  // Whether FLAGS_cinn_compilation_cache_dir is set and the target is X86.
+  static bool IsEnabled(const Target& target);
+
+  PersistentCacheEntry(const Target& target, const FusionInfo& fusion_info);
+  ~PersistentCacheEntry();
+
+  // Returns nullptr if the entry is not saved yet or is invalid.
+  std::shared_ptr<CompilationResult> Load() const;
+
+  // The result must be looked up by GetKernelInfo before saved.
+  void Save(const CompilationResult& result) const;
+
+ private:
+  CINN_DISALLOW_COPY_AND_ASSIGN(PersistentCacheEntry);
+
+  Target target_;
+  std::string key_;
+  std::string path_;
+  int lock_fd_{-1};
+};
+
+}  // namespace cinn::hlir::framework::pir
@@ -0,0 +1,424 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/hlir/framework/pir/shape_specialization.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include "paddle/cinn/hlir/dialect/operator/transforms/lowering_pass/utils.h"
+#include "paddle/cinn/hlir/framework/pir_compiler.h"
+#include "paddle/cinn/runtime/arch_device.h"
+#include "paddle/common/enforce.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/scope_guard.h"
+#include "paddle/pir/include/core/builtin_type.h"
+#include "paddle/pir/include/core/ir_mapping.h"
+#include "paddle/pir/include/core/utils.h"
+#include "paddle/pir/include/dialect/shape/utils/dim_expr_util.h"
+#include "paddle/pir/include/dialect/shape/utils/shape_analysis.h"
+
+PD_DECLARE_int64(cinn_shape_specialize_threshold);
+PD_DECLARE_int64(cinn_shape_specialize_max_kernels);
+
+namespace cinn::hlir::framework::pir {
+
+namespace {
+
+// Bounds the memory of profiling groups whose shapes rarely repeat.
+constexpr size_t kMaxProfiledSymbolArgs = 1024;
+
+// Compiles the static kernels one by one in a thread, so that they do not
+// compete with the executor for the cpus.
+class BackgroundCompiler final {
+ public:
+  static BackgroundCompiler& Instance() {
+    static BackgroundCompiler instance;
+    return instance;
+  }
+
+  ~BackgroundCompiler() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+  }
+
+  void Submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+      if (!thread_.joinable()) {
+        thread_ = std::thread([this] { Loop(); });
+      }
+    }
+    cv_.notify_one();
+  }
+
+ private:
+  BackgroundCompiler() = default;
+  CINN_DISALLOW_COPY_AND_ASSIGN(BackgroundCompiler);
+
+  void Loop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (stop_) return;
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stop_{false};
+  std::thread thread_;
+};
+
+template <typename DoEachT>
+void VisitEachDimExpr(const symbol::ShapeOrDataDimExprs& shape_or_data,
+                      const DoEachT& DoEach) {
+  const auto& VisitTensor =
+      [&](const symbol::TensorShapeOrDataDimExprs& tensor) {
+        for (const auto& dim_expr : tensor.shape()) DoEach(dim_expr);
+        if (!tensor.data().has_value()) return;
+        for (const auto& dim_expr : tensor.data().value()) DoEach(dim_expr);
+      };
+  if (shape_or_data.isa<symbol::TensorShapeOrDataDimExprs>()) {
+    VisitTensor(shape_or_data.dyn_cast<symbol::TensorShapeOrDataDimExprs>());
+  } else if (shape_or_data.isa<symbol::TensorListShapeOrDataDimExprs>()) {
+    for (const auto& tensor :
+         shape_or_data.dyn_cast<symbol::TensorListShapeOrDataDimExprs>()) {
+      VisitTensor(tensor);
+    }
+  }
+}
+
+bool OnlyDependsOn(const symbol::ShapeOrDataDimExprs& shape_or_data,
+                   const std::unordered_set<std::string>& symbols) {
+  bool result = true;
+  VisitEachDimExpr(shape_or_data, [&](const symbol::DimExpr& dim_expr) {
+    for (const auto& name : symbol::CollectDimExprSymbols(dim_expr)) {
+      result = result && symbols.count(name) > 0;
+    }
+  });
+  return result;
+}
+
+// Returns the dense tensor type of the static shape, or type itself if the
+// shape is not static.
+::pir::Type GetStaticType(::pir::Type type,
+                          const symbol::ShapeOrDataDimExprs& shape_or_data) {
+  auto dense_type = type.dyn_cast<::pir::DenseTensorType>();
+  if (!dense_type || !shape_or_data.isa<symbol::TensorShapeOrDataDimExprs>()) {
+    return type;
+  }
+  std::vector<int64_t> dims;
+  for (const auto& dim_expr : shape_or_data.shape()) {
+    if (!dim_expr.isa<int64_t>()) return type;
+    dims.push_back(dim_expr.dyn_cast<int64_t>());
+  }
+  return ::pir::DenseTensorType::get(::pir::IrContext::Instance(),
+                                     dense_type.dtype(),
+                                     ::common::make_ddim(dims),
+                                     dense_type.data_layout(),
+                                     dense_type.lod(),
+                                     dense_type.offset());
+}
+
+// Clones the ops of group into the block of program, with the inputs replaced
+// by the arguments of the block. The values of the clone get the types and
+// the shapes returned by GetShape for the original values.
+std::shared_ptr<OpLoweringGroup> CloneGroupInto(
+    const OpLoweringGroup& group,
+    const std::string& fn_name,
+    const std::function<symbol::ShapeOrDataDimExprs(::pir::Value)>& GetShape,
+    ::pir::Program* program) {
+  auto& shape_analysis =
+      ::pir::ShapeAnalysisManager::Instance().Get(program);
+  shape_analysis.InitInferContext();
+  std::unordered_map<::pir::Value, symbol::ShapeOrDataDimExprs> value_exprs;
+  const auto& SetValue = [&](::pir::Value origin, ::pir::Value value) {
+    const auto& shape_or_data = GetShape(origin);
+    value.set_type(GetStaticType(origin.type(), shape_or_data));
+    shape_analysis.SetShapeOrDataForValue(value, shape_or_data);
+    value_exprs.emplace(value, shape_or_data);
+  };
+
+  ::pir::IrMapping mapping;
+  for (auto input :
+       cinn::dialect::ir::details::GetBlockOutsideInput(group.ops())) {
+    if (!input) continue;
+    auto arg = program->block()->AddArg(input.type());
+    SetValue(input, arg);
+    mapping.Add(input, arg);
+  }
+  std::vector<::pir::Operation*> ops;
+  for (auto* op : group.ops()) {
+    auto* new_op = op->Clone(mapping, ::pir::CloneOptions(true, true, false));
+    program->block()->push_back(new_op);
+    for (uint32_t i = 0; i < op->num_results(); ++i) {
+      SetValue(op->result(i), new_op->result(i));
+    }
+    ops.push_back(new_op);
+  }
+
+  auto new_group =
+      std::make_shared<OpLoweringGroup>(ops, fn_name, group.fusion_tracker_ptr);
+  for (auto value : group.output_values()) {
+    new_group->mut_output_values().push_back(mapping.Lookup(value));
+  }
+  for (auto* op : group.output_ops()) {
+    new_group->mut_output_ops().insert(mapping.Lookup(op));
+  }
+  for (const auto& [op, schedule_info] : group.alignment_schedule_info()) {
+    new_group->mut_alignment_schedule_info()[mapping.Lookup(op)] =
+        schedule_info;
+  }
+  new_group->set_loop_ranges(group.loop_ranges());
+  new_group->set_loop_ranges_expr(group.loop_ranges_expr());
+  new_group->set_reduce_axis(group.reduce_axis());
+  new_group->set_op_pattern_kind(group.op_pattern_kind());
+  new_group->set_value_to_shape_or_data_exprs(value_exprs);
+  return new_group;
+}
+
+}  // namespace
+
+size_t ShapeSpecializationCache::SymbolArgsHash::operator()(
+    const std::vector<int64_t>& symbol_args) const {
+  size_t seed = symbol_args.size();
+  for (int64_t arg : symbol_args) {
+    seed = ::pir::detail::hash_combine(seed, std::hash<int64_t>()(arg));
+  }
+  return seed;
+}
+
+std::shared_ptr<ShapeSpecializationCache> ShapeSpecializationCache::Create(
+    const Target& target,
+    const std::shared_ptr<OpLoweringGroup>& group,
+    const CINNKernelInfo& kernel_info) {
+  if (kernel_info.symbol_args_map.empty()) return nullptr;
+  const auto& inputs =
+      cinn::dialect::ir::details::GetBlockOutsideInput(group->ops());
+  std::vector<symbol::DimExpr> symbols;
+  std::unordered_set<std::string> symbol_names;
+  for (const auto& [_, binding_info] : kernel_info.symbol_args_map) {
+    const auto* dim_idx =
+        std::get_if<CINNKernelInfo::ArgDimIdx>(&binding_info);
+    if (dim_idx == nullptr || dim_idx->arg_idx < 0 ||
+        static_cast<size_t>(dim_idx->arg_idx) >= inputs.size() ||
+        !group->HasShapeOrDataExprs(inputs[dim_idx->arg_idx])) {
+      return nullptr;
+    }
+    const auto& shape_or_data =
+        group->GetShapeOrDataExprs(inputs[dim_idx->arg_idx]);
+    if (!shape_or_data.isa<symbol::TensorShapeOrDataDimExprs>() ||
+        dim_idx->dim_idx < 0 ||
+        static_cast<size_t>(dim_idx->dim_idx) >=
+            shape_or_data.shape().size()) {
+      return nullptr;
+    }
+    const auto& dim_expr = shape_or_data.shape()[dim_idx->dim_idx];
+    if (!dim_expr.isa<std::string>()) return nullptr;
+    symbols.push_back(dim_expr);
+    symbol_names.insert(dim_expr.dyn_cast<std::string>());
+  }
+
+  bool is_specializable = true;
+  const auto& CheckValue = [&](::pir::Value value) {
+    if (!value) return;
+    is_specializable =
+        is_specializable && group->HasShapeOrDataExprs(value) &&
+        OnlyDependsOn(group->GetShapeOrDataExprs(value), symbol_names);
+  };
+  group->WalkOps([&](::pir::Operation* op) {
+    for (uint32_t i = 0; i < op->num_operands(); ++i) {
+      CheckValue(op->operand_source(i));
+    }
+    for (uint32_t i = 0; i < op->num_results(); ++i) {
+      CheckValue(op->result(i));
+    }
+  });
+  if (!is_specializable) {
+    VLOG(4) << "Group " << group->FuncName()
+            << " has shapes not bound by its symbol args, skip specializing.";
+    return nullptr;
+  }
+  std::shared_ptr<ShapeSpecializationCache> cache(
+      new ShapeSpecializationCache(target,
+                                   group->FuncName(),
+                                   kernel_info.temp_space_sizes.size(),
+                                   symbols));
+  cache->group_ = CloneGroupInto(
+      *group,
+      cache->fn_name_,
+      [&](::pir::Value value) {
+        return group->GetShapeOrDataExprs(value);
+      },
+      &cache->program_);
+  auto* cache_ptr = cache.get();
+  cache->compile_ = [cache_ptr](const std::vector<int64_t>& symbol_args) {
+    return cache_ptr->Compile(symbol_args);
+  };
+  return cache;
+}
+
+std::shared_ptr<ShapeSpecializationCache> ShapeSpecializationCache::Create(
+    const Target& target,
+    const std::string& fn_name,
+    size_t num_temp_spaces,
+    const CompileFunc& compile) {
+  std::shared_ptr<ShapeSpecializationCache> cache(
+      new ShapeSpecializationCache(target, fn_name, num_temp_spaces, {}));
+  cache->compile_ = compile;
+  return cache;
+}
+
+ShapeSpecializationCache::ShapeSpecializationCache(
+    const Target& target,
+    const std::string& fn_name,
+    size_t num_temp_spaces,
+    const std::vector<symbol::DimExpr>& symbols)
+    : target_(target),
+      fn_name_(fn_name),
+      num_temp_spaces_(num_temp_spaces),
+      symbols_(symbols),
+      program_(::pir::IrContext::Instance()) {}
+
+ShapeSpecializationCache::~ShapeSpecializationCache() {
+  ::pir::ShapeAnalysisManager::Instance().Erase(&program_);
+}
+
+const CINNKernelInfo* ShapeSpecializationCache::Lookup(
+    const std::vector<int64_t>& symbol_args) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = entries_.find(symbol_args);
+  if (iter == entries_.end()) {
+    if (entries_.size() >= kMaxProfiledSymbolArgs) return nullptr;
+    iter = entries_.emplace(symbol_args, Entry{}).first;
+  }
+  Entry& entry = iter->second;
+  if (entry.state == State::kReady) return &entry.kernel_info;
+  if (entry.state != State::kProfiling ||
+      ++entry.num_runs < FLAGS_cinn_shape_specialize_threshold ||
+      num_kernels_ >= FLAGS_cinn_shape_specialize_max_kernels) {
+    return nullptr;
+  }
+  entry.state = State::kCompiling;
+  ++num_kernels_;
+  ++num_compiling_;
+  // The device of the executor thread, to compile the kernel for.
+  const auto device_id = runtime::GetArchDevice(target_);
+  BackgroundCompiler::Instance().Submit(
+      [self = shared_from_this(), symbol_args, device_id] {
+        self->CompileInBackground(symbol_args, device_id);
+      });
+  return nullptr;
+}
+
+void ShapeSpecializationCache::CompileInBackground(
+    const std::vector<int64_t>& symbol_args,
+    const std::optional<int>& device_id) {
+  runtime::SetArchDevice(target_, device_id);
+  CINNKernelInfo kernel_info;
+  State state = State::kReady;
+  try {
+    kernel_info = compile_(symbol_args);
+    // The instruction allocates the temporary spaces of the generic kernel.
+    if (kernel_info.temp_space_sizes.size() != num_temp_spaces_) {
+      state = State::kFailed;
+    }
+    for (int64_t size : kernel_info.temp_space_sizes) {
+      if (size < 0) state = State::kFailed;
+    }
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Failed to compile the static kernel of " << fn_name_
+                 << ", keep running the dynamic shape kernel: " << e.what();
+    state = State::kFailed;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_.at(symbol_args);
+    entry.kernel_info = kernel_info;
+    entry.state = state;
+    --num_compiling_;
+  }
+  cv_.notify_all();
+}
+
+void ShapeSpecializationCache::WaitForCompiles() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return num_compiling_ == 0; });
+}
+
+CINNKernelInfo ShapeSpecializationCache::Compile(
+    const std::vector<int64_t>& symbol_args) {
+  PADDLE_ENFORCE_EQ(symbol_args.size(),
+                    symbols_.size(),
+                    ::common::errors::InvalidArgument(
+                        "The group %s has %d symbol args, but received %d.",
+                        fn_name_,
+                        symbols_.size(),
+                        symbol_args.size()));
+  std::unordered_map<symbol::DimExpr, symbol::DimExpr> bindings;
+  std::ostringstream suffix;
+  for (size_t i = 0; i < symbols_.size(); ++i) {
+    bindings.emplace(symbols_[i], symbol::DimExpr(symbol_args[i]));
+    suffix << "_" << symbol_args[i];
+  }
+  VLOG(3) << "Compile the static kernel of " << fn_name_ << " for symbol args"
+          << suffix.str();
+
+  ::pir::Program program(::pir::IrContext::Instance());
+  DEFINE_PADDLE_SCOPE_GUARD(
+      [&] { ::pir::ShapeAnalysisManager::Instance().Erase(&program); });
+  auto group = CloneGroupInto(
+      *group_,
+      fn_name_ + "_static" + suffix.str(),
+      [&](::pir::Value value) {
+        return symbol::SubstituteShapeOrData(group_->GetShapeOrDataExprs(value),
+                                             bindings);
+      },
+      &program);
+  std::vector<symbol::DimExpr> loop_ranges_expr;
+  std::vector<int64_t> loop_ranges;
+  for (const auto& dim_expr : group->loop_ranges_expr()) {
+    loop_ranges_expr.push_back(symbol::SimplifyDimExpr(
+        symbol::SubstituteDimExpr(dim_expr, bindings)));
+    loop_ranges.push_back(loop_ranges_expr.back().isa<int64_t>()
+                              ? loop_ranges_expr.back().dyn_cast<int64_t>()
+                              : -1);
+  }
+  if (!loop_ranges_expr.empty()) {
+    group->set_loop_ranges_expr(loop_ranges_expr);
+    group->set_loop_ranges(loop_ranges);
+  }
+
+  PirCompiler pir_compiler(target_);
+  return pir_compiler.Build({group})[0];
+}
+
+}  // namespace cinn::hlir::framework::pir
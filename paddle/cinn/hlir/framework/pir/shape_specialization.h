@@ -0,0 +1,121 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/cinn/common/macros.h"
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/hlir/framework/pir/op_lowering_group.h"
+#include "paddle/cinn/hlir/framework/pir/utils.h"
+#include "paddle/pir/include/core/program.h"
+
+namespace cinn::hlir::framework::pir {
+
+/**
+ * Profile guided static kernels of a dynamic shape group.
+ *
+ * The generic kernel of a dynamic shape group takes the symbols of the shapes
+ * as its symbol args. The cache counts the runs of each value of the symbol
+ * args, and once a value has run FLAGS_cinn_shape_specialize_threshold times,
+ * compiles the group with the symbols bound to it in a background thread.
+ * Later runs with the same value use the static kernel, the others keep using
+ * the generic one.
+ *
+ * The ops of the group are cloned into a program owned by the cache, since the
+ * fusion op is erased after lowering.
+ */
+class ShapeSpecializationCache final
+    : public std::enable_shared_from_this<ShapeSpecializationCache> {
+ public:
+  using CompileFunc =
+      std::function<CINNKernelInfo(const std::vector<int64_t>& symbol_args)>;
+
+  // Returns nullptr if some symbol arg of kernel_info is not a symbol dim of
+  // the inputs, e.g. taken from the data of a tensor, or some shape in the
+  // group does not only depend on the symbol args.
+  static std::shared_ptr<ShapeSpecializationCache> Create(
+      const Target& target,
+      const std::shared_ptr<OpLoweringGroup>& group,
+      const CINNKernelInfo& kernel_info);
+
+  // Compiles the static kernels with compile instead of a group, used by the
+  // tests of the profiling.
+  static std::shared_ptr<ShapeSpecializationCache> Create(
+      const Target& target,
+      const std::string& fn_name,
+      size_t num_temp_spaces,
+      const CompileFunc& compile);
+
+  // Counts a run with symbol_args, in the order of
+  // CINNKernelInfo::symbol_args_map, and returns the static kernel compiled
+  // for it, or nullptr if it is not compiled yet.
+  const CINNKernelInfo* Lookup(const std::vector<int64_t>& symbol_args);
+
+  // Blocks until the static kernels being compiled are ready or failed.
+  void WaitForCompiles();
+
+  ~ShapeSpecializationCache();
+
+ private:
+  ShapeSpecializationCache(const Target& target,
+                           const std::string& fn_name,
+                           size_t num_temp_spaces,
+                           const std::vector<symbol::DimExpr>& symbols);
+  CINN_DISALLOW_COPY_AND_ASSIGN(ShapeSpecializationCache);
+
+  CINNKernelInfo Compile(const std::vector<int64_t>& symbol_args);
+  void CompileInBackground(const std::vector<int64_t>& symbol_args,
+                           const std::optional<int>& device_id);
+
+  struct SymbolArgsHash {
+    size_t operator()(const std::vector<int64_t>& symbol_args) const;
+  };
+
+  enum class State { kProfiling, kCompiling, kReady, kFailed };
+  struct Entry {
+    int64_t num_runs{0};
+    State state{State::kProfiling};
+    CINNKernelInfo kernel_info;
+  };
+
+  const Target target_;
+  const std::string fn_name_;
+  const size_t num_temp_spaces_;
+  // The symbols bound by the symbol args.
+  const std::vector<symbol::DimExpr> symbols_;
+
+  // The group cloned into program_, the inputs are the block arguments.
+  ::pir::Program program_;
+  std::shared_ptr<OpLoweringGroup> group_;
+  // Compile of the group, or the one given to Create.
+  CompileFunc compile_;
+
+  std::mutex mutex_;
+  // Notified when a compile finishes.
+  std::condition_variable cv_;
+  std::unordered_map<std::vector<int64_t>, Entry, SymbolArgsHash> entries_;
+  int64_t num_kernels_{0};
+  int64_t num_compiling_{0};
+};
+
+}  // namespace cinn::hlir::framework::pir
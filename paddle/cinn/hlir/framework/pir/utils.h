@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -29,6 +30,8 @@ namespace hlir {
 namespace framework {
 
 namespace pir {
+class ShapeSpecializationCache;
+
 struct CINNKernelInfo {
   std::string fn_name;
   void* fn_ptr;
@@ -71,6 +74,10 @@ struct CINNKernelInfo {
   // These spaces are allocated before the kernel is launched, appended to the
   // kernel's argument list, and released when the kernel completes.
   std::vector<int64_t> temp_space_sizes;
+
+  // The static kernels of a dynamic shape kernel, null if disabled by
+  // FLAGS_cinn_shape_specialize_threshold or the kernel is static.
+  std::shared_ptr<ShapeSpecializationCache> shape_specialization;
 };
 
 struct CompatibleInfo {
@@ -15,16 +15,24 @@
 #include "paddle/cinn/hlir/framework/pir_compiler.h"
 #include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
 
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
 #include "paddle/cinn/hlir/dialect/operator/transforms/lowering_pass/utils.h"
 #include "paddle/cinn/hlir/framework/pir/broadcast_with_cf.h"
+#include "paddle/cinn/hlir/framework/pir/persistent_compilation_cache.h"
 #include "paddle/cinn/hlir/framework/pir/utils.h"
 #include "paddle/cinn/runtime/arch_device.h"
+#include "paddle/cinn/utils/compile_stage_timer.h"
 #include "paddle/cinn/utils/multi_threading.h"
+#include "paddle/cinn/utils/timer.h"
 #include "paddle/common/enforce.h"
 #include "paddle/common/flags.h"
 
 PD_DECLARE_bool(enable_cinn_compile_cache);
 PD_DECLARE_int64(cinn_compile_thread_num);
+PD_DECLARE_bool(cinn_report_compile_time);
 
 namespace cinn::hlir::framework {
 class CompilationContextMapper {
@@ -36,6 +44,9 @@ class CompilationContextMapper {
   std::vector<GroupCompilationContext>& UniqueCompilationContexts() {
     return group_compilation_contexts_;
   }
+  const pir::FusionInfo& UniqueFusionInfo(size_t index) const {
+    return fusion_infos_[mapper_index_[index]];
+  }
   std::vector<std::shared_ptr<pir::CompilationResult>>&
   MutableCompilationResult() {
     return compilation_results_;
@@ -66,6 +77,47 @@ static size_t GetThreadNum(size_t task_size) {
   return thread_size;
 }
 
+// The number of threads left to each of the thread_size compiling threads,
+// so that the nested lowering does not oversubscribe the cpus.
+static size_t GetNestedThreadNum(size_t thread_size) {
+  const size_t hardware_threads =
+      std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  return std::max<size_t>(
+      hardware_threads / std::min(std::max<size_t>(thread_size, 1),
+                                  hardware_threads),
+      1);
+}
+
+static void ReportCompileTime(
+    const std::vector<GroupCompilationContext>& contexts,
+    const std::vector<utils::CompileStageTimes>& stage_times,
+    size_t group_num,
+    size_t thread_size,
+    float wall_ms) {
+  if (!FLAGS_cinn_report_compile_time && !VLOG_IS_ON(3)) return;
+  utils::CompileStageTimes sum;
+  size_t slowest = 0;
+  for (size_t i = 0; i < stage_times.size(); ++i) {
+    VLOG(4) << "Compile " << contexts[i].GetGroup()->FuncName() << ", "
+            << stage_times[i].ToString();
+    sum += stage_times[i];
+    if (stage_times[i].Total() > stage_times[slowest].Total()) slowest = i;
+  }
+  std::ostringstream os;
+  os << "Compiled " << stage_times.size() << " unique groups of " << group_num
+     << " in " << wall_ms << " ms with " << thread_size
+     << " threads, sum of stages: " << sum.ToString();
+  if (!stage_times.empty()) {
+    os << ", slowest group " << contexts[slowest].GetGroup()->FuncName()
+       << ": " << stage_times[slowest].Total() << " ms";
+  }
+  if (FLAGS_cinn_report_compile_time) {
+    LOG(INFO) << os.str();
+  } else {
+    VLOG(3) << os.str();
+  }
+}
+
 std::vector<pir::CINNKernelInfo> PirCompiler::Build(
     const std::vector<pir::OpLoweringGroupPtr>& groups) {
   CompilationContextMapper ctx_mapper(target_, groups);
@@ -82,13 +134,28 @@ std::vector<pir::CINNKernelInfo> PirCompiler::Build(
     // https://developer.nvidia.com/blog/cuda-pro-tip-always-set-current-device-avoid-multithreading-bugs/
     // for details.
     const auto device_id = runtime::GetArchDevice(target_);
+    const size_t nested_thread_size = GetNestedThreadNum(thread_size);
+    std::vector<utils::CompileStageTimes> stage_times(task_size);
+    utils::Timer timer;
+    timer.Start();
+    // Results are written by index, so they keep the order of the groups
+    // whichever thread compiles them.
     auto worker_fn = [&](int index) {
       runtime::SetArchDevice(target_, device_id);
-      compilation_results[index] = Compile(&group_compilation_contexts[index]);
+      utils::ScopedCompileStageTimes collect(&stage_times[index]);
+      compilation_results[index] =
+          CompileWithPersistentCache(ctx_mapper.UniqueFusionInfo(index),
+                                     &group_compilation_contexts[index],
+                                     nested_thread_size);
     };
     utils::parallel_run(worker_fn,
                         utils::SequenceDispatcher(0, task_size),
                         /*thread_num=*/thread_size);
+    ReportCompileTime(group_compilation_contexts,
+                      stage_times,
+                      groups.size(),
+                      thread_size,
+                      timer.Stop());
   }
   VLOG(5) << "Finished compiling " << task_size << " Cinn Kernel info.";
   ctx_mapper.SetFinalize(true);
@@ -97,7 +164,7 @@ std::vector<pir::CINNKernelInfo> PirCompiler::Build(
 }
 
 std::shared_ptr<pir::CompilationResult> PirCompiler::Compile(
-    GroupCompilationContext* ctx) {
+    GroupCompilationContext* ctx, size_t max_thread_size) {
   std::shared_ptr<pir::CompilationResult> compile_result;
   CompilationTask task(ctx);
 
@@ -114,14 +181,25 @@ std::shared_ptr<pir::CompilationResult> PirCompiler::Compile(
 
     const auto& ParallelLowering = [&]() {
       const size_t task_size = switch_group_ctxs.size();
+      // The lowering threads report to the times of the calling thread.
+      utils::CompileStageTimes* stage_times =
+          utils::ScopedCompileStageTimes::Current();
+      std::vector<utils::CompileStageTimes> lowering_times(task_size);
       auto worker_fn = [&](int index) {
+        utils::ScopedCompileStageTimes collect(&lowering_times[index]);
         CompilationTask lowering_task(&switch_group_ctxs[index]);
         lowering_task.Lowering();
       };
-      const size_t thread_size = GetThreadNum(task_size);
+      const size_t thread_size =
+          std::min(GetThreadNum(task_size), max_thread_size);
       utils::parallel_run(worker_fn,
                           utils::SequenceDispatcher(0, task_size),
                           /*thread_num=*/thread_size);
+      if (stage_times != nullptr) {
+        for (const auto& times : lowering_times) {
+          *stage_times += times;
+        }
+      }
     };
 
     ParallelLowering();
@@ -135,7 +213,27 @@ std::shared_ptr<pir::CompilationResult> PirCompiler::Compile(
   }
 
   // Triggering llvm compilation in thread
-  compile_result->GetKernelInfo();
+  {
+    utils::CompileStageTimer timer(utils::CompileStage::kLink);
+    compile_result->GetKernelInfo();
+  }
+  return compile_result;
+}
+
+std::shared_ptr<pir::CompilationResult> PirCompiler::CompileWithPersistentCache(
+    const pir::FusionInfo& fusion_info,
+    GroupCompilationContext* ctx,
+    size_t max_thread_size) {
+  if (!FLAGS_enable_cinn_compile_cache ||
+      !pir::PersistentCacheEntry::IsEnabled(target_)) {
+    return Compile(ctx, max_thread_size);
+  }
+  pir::PersistentCacheEntry entry(target_, fusion_info);
+  if (auto compile_result = entry.Load()) {
+    return compile_result;
+  }
+  auto compile_result = Compile(ctx, max_thread_size);
+  entry.Save(*compile_result);
   return compile_result;
 }
 
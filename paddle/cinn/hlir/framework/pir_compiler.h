@@ -30,7 +30,17 @@ class PirCompiler final {
  private:
   CINN_DISALLOW_COPY_AND_ASSIGN(PirCompiler);
 
-  std::shared_ptr<pir::CompilationResult> Compile(GroupCompilationContext* ctx);
+  // max_thread_size bounds the threads lowering the broadcast branches of
+  // the group.
+  std::shared_ptr<pir::CompilationResult> Compile(GroupCompilationContext* ctx,
+                                                  size_t max_thread_size);
+
+  // Compile with FLAGS_cinn_compilation_cache_dir, which loads the result
+  // compiled by previous processes instead if any.
+  std::shared_ptr<pir::CompilationResult> CompileWithPersistentCache(
+      const pir::FusionInfo& fusion_info,
+      GroupCompilationContext* ctx,
+      size_t max_thread_size);
 
   Target target_;
 };
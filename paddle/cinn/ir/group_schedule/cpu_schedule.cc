@@ -0,0 +1,213 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/ir/group_schedule/cpu_schedule.h"
+
+#include <glog/logging.h>
+
+#include <optional>
+#include <sstream>
+
+#include "paddle/cinn/auto_schedule/database/tuning_record_database.h"
+#include "paddle/cinn/ir/ir_analyzer/ir_analyzer.h"
+#include "paddle/cinn/ir/utils/ir_copy.h"
+#include "paddle/common/enforce.h"
+
+namespace cinn {
+namespace ir {
+
+std::string CpuScheduleParams::ToString() const {
+  std::ostringstream os;
+  os << "vectorize_factor: " << vectorize_factor
+     << ", parallel: " << (parallel ? "true" : "false");
+  return os.str();
+}
+
+std::vector<CpuScheduleParams> CpuScheduleCandidates() {
+  std::vector<CpuScheduleParams> candidates;
+  for (int factor : {1, 2, 4, 8, 16}) {
+    for (bool parallel : {false, true}) {
+      if (factor == 1 && !parallel) continue;
+      CpuScheduleParams params;
+      params.vectorize_factor = factor;
+      params.parallel = parallel;
+      candidates.push_back(params);
+    }
+  }
+  return candidates;
+}
+
+namespace {
+
+// Whether the loop only contains the block, e.g. the loop of the init block
+// of a reduction also contains the reduction loops.
+bool OnlyContainsBlock(const Expr& loop) {
+  return analyzer::GetChildBlocks(loop).size() == 1;
+}
+
+void VectorizeInnermostLoop(const std::string& block_name,
+                            int factor,
+                            IRSchedule* ir_sch) {
+  std::vector<Expr> loops = ir_sch->GetLoops(block_name);
+  if (loops.empty()) return;
+  const Expr& loop = loops.back();
+  const ir::Expr& extent = loop.As<ir::For>()->extent;
+  if (!extent.is_constant() || !OnlyContainsBlock(loop)) return;
+  const int64_t extent_value = extent.as_int64();
+  if (extent_value < factor || extent_value % factor != 0) return;
+  if (extent_value == factor) {
+    ir_sch->Vectorize(loop, factor);
+    return;
+  }
+  std::vector<Expr> splits = ir_sch->Split(loop, {-1, factor});
+  ir_sch->Vectorize(splits.back(), factor);
+}
+
+// Whether the reduction block accumulates with an add, mul, max or min, the
+// ones the vectorizer turns into a horizontal reduction of the lanes.
+bool IsVectorizableReduction(const Expr& block) {
+  const Expr& body = block.As<ScheduleBlockRealize>()
+                         ->schedule_block.As<ScheduleBlock>()
+                         ->body;
+  const Expr* store = body.As<Store>() ? &body : nullptr;
+  if (const auto* body_block = body.As<Block>()) {
+    if (body_block->stmts.size() == 1) store = &body_block->stmts[0];
+  }
+  if (!store || !store->As<Store>()) return false;
+  const Expr& value = store->As<Store>()->value;
+  return value.As<Add>() || value.As<Mul>() || value.As<Max>() ||
+         value.As<Min>();
+}
+
+void ParallelOutermostLoop(const std::string& block_name,
+                           int vectorize_factor,
+                           IRSchedule* ir_sch) {
+  std::vector<Expr> loops = ir_sch->GetLoops(block_name);
+  if (loops.empty() || !OnlyContainsBlock(loops.front())) return;
+  // Leave the vectorized loop to the vectorizer.
+  if (loops.size() == 1 && vectorize_factor > 1) return;
+  ir_sch->Parallel(loops.front());
+}
+
+}  // namespace
+
+void ApplyCpuSchedule(const CpuScheduleParams& params, IRSchedule* ir_sch) {
+  std::vector<std::string> block_names;
+  std::vector<std::string> reduce_block_names;
+  for (const Expr& block : ir_sch->GetAllBlocks()) {
+    if (!analyzer::IsReductionSBlock(block)) {
+      block_names.push_back(analyzer::GetBlockName(block));
+    } else if (IsVectorizableReduction(block)) {
+      reduce_block_names.push_back(analyzer::GetBlockName(block));
+    }
+  }
+  // The lowering puts the reduce loops inside the spatial ones.
+  if (params.vectorize_factor > 1) {
+    for (const std::string& block_name : reduce_block_names) {
+      VectorizeInnermostLoop(block_name, params.vectorize_factor, ir_sch);
+    }
+  }
+  for (const std::string& block_name : block_names) {
+    if (params.vectorize_factor > 1) {
+      VectorizeInnermostLoop(block_name, params.vectorize_factor, ir_sch);
+    }
+    if (params.parallel) {
+      ParallelOutermostLoop(block_name, params.vectorize_factor, ir_sch);
+    }
+  }
+}
+
+namespace {
+
+std::mutex& TuningScopeMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+CpuScheduleTuningScope*& CurrentTuningScope() {
+  static CpuScheduleTuningScope* scope = nullptr;
+  return scope;
+}
+
+}  // namespace
+
+CpuScheduleTuningScope::CpuScheduleTuningScope(const CpuScheduleParams& params)
+    : params_(params) {
+  std::lock_guard<std::mutex> lock(TuningScopeMutex());
+  PADDLE_ENFORCE_EQ(CurrentTuningScope(),
+                    nullptr,
+                    ::common::errors::PreconditionNotMet(
+                        "Another CpuScheduleTuningScope is alive."));
+  CurrentTuningScope() = this;
+}
+
+CpuScheduleTuningScope::~CpuScheduleTuningScope() {
+  std::lock_guard<std::mutex> lock(TuningScopeMutex());
+  CurrentTuningScope() = nullptr;
+}
+
+CpuScheduleTuningScope* CpuScheduleTuningScope::Current() {
+  std::lock_guard<std::mutex> lock(TuningScopeMutex());
+  return CurrentTuningScope();
+}
+
+void CpuScheduleTuningScope::AddTrace(const std::string& task_key,
+                                      const std::string& kernel_name,
+                                      const ScheduleDesc& trace) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  traces_[task_key] = CpuKernelTrace{kernel_name, trace.ToProto()};
+}
+
+std::unordered_map<std::string, CpuKernelTrace>
+CpuScheduleTuningScope::traces() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return traces_;
+}
+
+Expr ScheduleCpuKernel(const std::string& task_key,
+                       const std::string& kernel_name,
+                       const Expr& func_body) {
+  CpuScheduleTuningScope* scope = CpuScheduleTuningScope::Current();
+  std::optional<auto_schedule::proto::TuningRecord> record;
+  if (!scope) {
+    auto* database = auto_schedule::TuningRecordDatabase::Global();
+    if (database) record = database->GetBest(task_key);
+    if (!record.has_value()) return func_body;
+  }
+
+  // The trace is recorded on the merged body, so the steps replay on any
+  // lowering of the same group.
+  ModuleExpr mod_expr({ir_utils::IRCopy(func_body)});
+  IRSchedule ir_sch(
+      mod_expr, -1, false, cinn::utils::ErrorMessageLevel::kGeneral, true);
+  try {
+    if (scope) {
+      ApplyCpuSchedule(scope->params(), &ir_sch);
+      scope->AddTrace(task_key, kernel_name, ir_sch.GetTraceDesc());
+    } else {
+      ScheduleDesc::ReplayWithProto(record->trace(), &ir_sch);
+    }
+  } catch (const ::common::enforce::EnforceNotMet& e) {
+    // A stale record must not break the compilation, the kernel just stays
+    // unscheduled.
+    LOG(WARNING) << "Failed to schedule the cpu kernel, keep it unscheduled: "
+                 << e.what();
+    return func_body;
+  }
+  VLOG(4) << "Scheduled cpu kernel:\n" << ir_sch.GetModule().GetExprs().at(0);
+  return ir_sch.GetModule().GetExprs().at(0);
+}
+
+}  // namespace ir
+}  // namespace cinn
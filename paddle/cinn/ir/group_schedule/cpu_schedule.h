@@ -0,0 +1,93 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/cinn/common/macros.h"
+#include "paddle/cinn/ir/schedule/ir_schedule.h"
+
+namespace cinn {
+namespace ir {
+
+// The parameters of the schedule of the CPU kernel of a fusion group.
+struct CpuScheduleParams {
+  // Lanes of the innermost loop of the elementwise blocks and of the
+  // reductions the vectorizer reduces horizontally, 1 means no
+  // vectorization.
+  int vectorize_factor{1};
+  // Whether to run the outermost loop of the elementwise blocks in parallel.
+  bool parallel{false};
+
+  std::string ToString() const;
+};
+
+// The candidates measured by search::CpuScheduleTuner.
+std::vector<CpuScheduleParams> CpuScheduleCandidates();
+
+// Parallelizes and vectorizes the loops of the elementwise blocks, and
+// vectorizes the innermost reduce loop of the sum, product, max and min
+// reduction blocks. A loop is only vectorized if its extent is a constant
+// multiple of the factor.
+void ApplyCpuSchedule(const CpuScheduleParams& params, IRSchedule* ir_sch);
+
+// The trace applied to the CPU kernel of a fusion group.
+struct CpuKernelTrace {
+  // The function name of the kernel, which labels its execution time.
+  std::string kernel_name;
+  proto::ScheduleDesc trace;
+};
+
+/**
+ * While a scope is alive, the CPU kernels are scheduled with its params
+ * instead of the tuned records, and the traces applied to the fusion groups
+ * are collected by their task keys. Only one scope can be alive at a time.
+ */
+class CpuScheduleTuningScope {
+ public:
+  explicit CpuScheduleTuningScope(const CpuScheduleParams& params);
+  ~CpuScheduleTuningScope();
+  CINN_DISALLOW_COPY_AND_ASSIGN(CpuScheduleTuningScope);
+
+  static CpuScheduleTuningScope* Current();
+
+  const CpuScheduleParams& params() const { return params_; }
+
+  void AddTrace(const std::string& task_key,
+                const std::string& kernel_name,
+                const ScheduleDesc& trace);
+  std::unordered_map<std::string, CpuKernelTrace> traces() const;
+
+ private:
+  const CpuScheduleParams params_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, CpuKernelTrace> traces_;
+};
+
+// Schedules the merged CPU kernel kernel_name of the fusion group of
+// task_key, see auto_schedule::TuningRecordDatabase::MakeTaskKey. In a
+// CpuScheduleTuningScope it applies the params of the scope, otherwise it
+// replays the best trace of the task in
+// auto_schedule::TuningRecordDatabase::Global(), if any. Returns func_body
+// itself if nothing is applied.
+Expr ScheduleCpuKernel(const std::string& task_key,
+                       const std::string& kernel_name,
+                       const Expr& func_body);
+
+}  // namespace ir
+}  // namespace cinn
@@ -0,0 +1,166 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/ir/group_schedule/search/cpu_schedule_tuner.h"
+
+#include <glog/logging.h>
+
+#include <limits>
+
+#include "paddle/cinn/ir/group_schedule/cpu_schedule.h"
+#include "paddle/cinn/ir/group_schedule/search/measurer.h"
+#include "paddle/common/enforce.h"
+#include "paddle/common/flags.h"
+#include "paddle/common/performance_statistician.h"
+#include "paddle/phi/common/place.h"
+
+PD_DECLARE_bool(enable_cinn_compile_cache);
+PD_DECLARE_bool(cinn_measure_kernel_time);
+
+namespace cinn {
+namespace ir {
+namespace search {
+
+namespace {
+
+// Every candidate must be lowered again instead of hitting the kernels
+// compiled for the previous one, and the CPU kernels are measured one by one.
+class TuningFlagsGuard {
+ public:
+  TuningFlagsGuard()
+      : compile_cache_(FLAGS_enable_cinn_compile_cache),
+        measure_kernel_time_(FLAGS_cinn_measure_kernel_time) {
+    FLAGS_enable_cinn_compile_cache = false;
+    FLAGS_cinn_measure_kernel_time = true;
+  }
+  ~TuningFlagsGuard() {
+    FLAGS_enable_cinn_compile_cache = compile_cache_;
+    FLAGS_cinn_measure_kernel_time = measure_kernel_time_;
+  }
+
+ private:
+  const bool compile_cache_;
+  const bool measure_kernel_time_;
+};
+
+struct TaskCost {
+  double baseline_cost = std::numeric_limits<double>::max();
+  double best_cost = std::numeric_limits<double>::max();
+  proto::ScheduleDesc best_trace;
+};
+
+}  // namespace
+
+CpuScheduleTuner::CpuScheduleTuner(
+    ::pir::Program* program,
+    auto_schedule::TuningRecordDatabase* database,
+    int repeat)
+    : program_(program), database_(database), repeat_(repeat) {
+  PADDLE_ENFORCE_NOT_NULL(
+      database_,
+      ::common::errors::InvalidArgument(
+          "The tuning record database of CpuScheduleTuner is nullptr."));
+  PADDLE_ENFORCE_GT(repeat_,
+                    0,
+                    ::common::errors::InvalidArgument(
+                        "The repeat of CpuScheduleTuner should be positive, "
+                        "but got %d.",
+                        repeat_));
+}
+
+int CpuScheduleTuner::Tune(
+    const std::unordered_map<std::string, std::vector<int64_t>>&
+        input_name_and_shape) {
+  TuningFlagsGuard guard;
+
+  // The default params leave the kernels unscheduled, which is the baseline.
+  std::vector<CpuScheduleParams> candidates{CpuScheduleParams()};
+  for (const auto& params : CpuScheduleCandidates()) {
+    candidates.push_back(params);
+  }
+
+  std::unordered_map<std::string, TaskCost> task_costs;
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const CpuScheduleParams& params = candidates[i];
+    CpuScheduleTuningScope scope(params);
+    MeasureResult result;
+    try {
+      Measurer measurer(program_, phi::CPUPlace());
+      measurer.Compile();
+      measurer.Run(input_name_and_shape, repeat_);
+      result = measurer.Result();
+    } catch (const ::common::enforce::EnforceNotMet& e) {
+      LOG(WARNING) << "Skip cpu schedule {" << params.ToString()
+                   << "}: " << e.what();
+      ::common::PerformanceStatistician::Instance().Reset();
+      continue;
+    }
+    for (const auto& [task_key, kernel_trace] : scope.traces()) {
+      auto it =
+          result.avg_cpu_kernel_execute_times.find(kernel_trace.kernel_name);
+      if (it == result.avg_cpu_kernel_execute_times.end()) {
+        VLOG(3) << "Cpu kernel " << kernel_trace.kernel_name
+                << " is not measured.";
+        continue;
+      }
+      const double cost = it->second.count();
+      VLOG(3) << "Cpu schedule {" << params.ToString() << "} of kernel "
+              << kernel_trace.kernel_name << " costs " << cost << " us";
+      TaskCost& task_cost = task_costs[task_key];
+      if (i == 0) task_cost.baseline_cost = cost;
+      if (cost < task_cost.best_cost) {
+        task_cost.best_cost = cost;
+        task_cost.best_trace = kernel_trace.trace;
+      }
+    }
+  }
+
+  int num_committed = 0;
+  for (const auto& [task_key, task_cost] : task_costs) {
+    if (task_cost.best_trace.steps_size() == 0 ||
+        task_cost.best_cost >= task_cost.baseline_cost) {
+      VLOG(3) << "No cpu schedule beats the unscheduled kernel of task:\n"
+              << task_key;
+      continue;
+    }
+    auto_schedule::proto::TuningRecord record;
+    record.set_task_key(task_key);
+    record.set_execution_cost(task_cost.best_cost);
+    *record.mutable_trace() = task_cost.best_trace;
+    if (database_->Commit(record)) ++num_committed;
+  }
+  return num_committed;
+}
+
+int TuneCpuSchedules(const std::vector<CpuTuningTask>& tasks, int repeat) {
+  auto* database = auto_schedule::TuningRecordDatabase::Global();
+  PADDLE_ENFORCE_NOT_NULL(
+      database,
+      ::common::errors::PreconditionNotMet(
+          "Set FLAGS_cinn_tuning_record_file to the file of the records "
+          "before tuning the cpu schedules."));
+  int num_committed = 0;
+  for (const CpuTuningTask& task : tasks) {
+    const int num = CpuScheduleTuner(task.program, database, repeat)
+                        .Tune(task.input_name_and_shape);
+    LOG(INFO) << "Committed " << num << " cpu schedule records to "
+              << database->path();
+    num_committed += num;
+  }
+  return num_committed;
+}
+
+}  // namespace search
+}  // namespace ir
+}  // namespace cinn
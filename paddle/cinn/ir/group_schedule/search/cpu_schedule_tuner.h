@@ -0,0 +1,66 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/cinn/auto_schedule/database/tuning_record_database.h"
+#include "paddle/pir/include/core/program.h"
+
+namespace cinn {
+namespace ir {
+namespace search {
+
+/**
+ * Tunes the schedules of the CPU kernels of the fusion groups in a program.
+ *
+ * Each of CpuScheduleCandidates() is applied to all the groups of the program,
+ * which is compiled and run on the CPU place. The kernel of each group is
+ * measured by itself, and the trace of its fastest candidate is committed to
+ * the database if it beats the unscheduled kernel.
+ */
+class CpuScheduleTuner {
+ public:
+  CpuScheduleTuner(::pir::Program* program,
+                   auto_schedule::TuningRecordDatabase* database,
+                   int repeat = 10);
+
+  // Returns the number of the committed records.
+  int Tune(const std::unordered_map<std::string, std::vector<int64_t>>&
+               input_name_and_shape);
+
+ private:
+  ::pir::Program* program_;
+  auto_schedule::TuningRecordDatabase* database_;
+  int repeat_;
+};
+
+// A program to tune and the shapes of its inputs.
+struct CpuTuningTask {
+  ::pir::Program* program;
+  std::unordered_map<std::string, std::vector<int64_t>> input_name_and_shape;
+};
+
+// The offline tuning driver: tunes the programs of tasks one by one on the
+// local cpu and commits the records to
+// auto_schedule::TuningRecordDatabase::Global(), which the compilation reads.
+// Returns the number of the committed records.
+int TuneCpuSchedules(const std::vector<CpuTuningTask>& tasks, int repeat = 10);
+
+}  // namespace search
+}  // namespace ir
+}  // namespace cinn
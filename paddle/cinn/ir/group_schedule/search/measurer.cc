@@ -47,7 +47,8 @@ std::shared_ptr<pir::PassManager> CreatePassManager() {
   return pass_manager;
 }
 
-Measurer::Measurer(::pir::Program* program) : program_(program) {
+Measurer::Measurer(::pir::Program* program, const phi::Place& place)
+    : program_(program), place_(place) {
   std::stringstream ss;
   ss << *program_;
   compile_label_ = "Compile Program\n" + ss.str();
@@ -132,6 +133,17 @@ MeasureResult Measurer::Result() const {
   result.avg_total_execute_time = avg_total_execute_time;
   result.avg_kernel_execute_time = avg_kernel_execute_time;
 
+  // CinnJitInstruction labels a CPU kernel with its function name after the
+  // kernel execution label.
+  const std::string prefix = FLAGS_cinn_kernel_execution_label + "\n";
+  for (const std::string& label : ps.Labels()) {
+    if (label.compare(0, prefix.size(), prefix) != 0) continue;
+    auto durations =
+        ::common::PerformanceReporter::ExtractDuration(ps.Record(label));
+    result.avg_cpu_kernel_execute_times[label.substr(prefix.size())] =
+        ::common::PerformanceReporter::TrimMean(durations);
+  }
+
   ps.Reset();
   return result;
 }
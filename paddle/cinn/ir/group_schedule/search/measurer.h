@@ -18,6 +18,7 @@
 #include <map>
 #include <random>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "paddle/common/performance_statistician.h"
@@ -34,12 +35,16 @@ struct MeasureResult {
   ::common::TimeDuration compile_time;
   ::common::TimeDuration avg_kernel_execute_time;
   ::common::TimeDuration avg_total_execute_time;
+  // The CPU kernels run on the CPU place, by their function names.
+  std::unordered_map<std::string, ::common::TimeDuration>
+      avg_cpu_kernel_execute_times;
   std::string err_msg;
 };
 
 class Measurer {
  public:
-  explicit Measurer(::pir::Program* program);
+  explicit Measurer(::pir::Program* program,
+                    const phi::Place& place = phi::GPUPlace(0));
 
   void Compile();
 
@@ -53,7 +58,7 @@ class Measurer {
   std::string compile_label_;
   std::string execute_label_;
   ::pir::Program* program_;
-  phi::Place place_ = phi::GPUPlace(0);
+  phi::Place place_;
   std::unique_ptr<pir::Program> kernel_program_;
   std::unique_ptr<paddle::framework::Scope> exe_scope_ =
       std::make_unique<paddle::framework::Scope>();
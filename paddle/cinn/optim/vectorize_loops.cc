@@ -27,11 +27,13 @@
 #include "paddle/cinn/common/ir_util.h"
 #include "paddle/cinn/ir/ir_printer.h"
 #include "paddle/cinn/ir/op/ir_operators.h"
+#include "paddle/cinn/ir/utils/ir_compare.h"
 #include "paddle/cinn/ir/utils/ir_copy.h"
 #include "paddle/cinn/ir/utils/ir_nodes_collector.h"
 #include "paddle/cinn/ir/utils/ir_replace.h"
 #include "paddle/cinn/optim/ir_simplify.h"
 #include "paddle/cinn/optim/unroll_loops.h"
+#include "paddle/cinn/runtime/intrinsic.h"
 #include "paddle/cinn/utils/functional.h"
 
 namespace cinn {
@@ -507,7 +509,24 @@ class Vectorizer : public IRMutator<Expr *> {
     *expr = Load::Make(node->tensor, new_indices);
   }
 
+  void Visit(const ScheduleBlockRealize *op, Expr *expr) override {
+    // The body reads the var through the iter vars of the block, replace
+    // those bound to the var with their values so that the body is
+    // vectorized in it, e.g. a reduction keeps its accumulator invariant.
+    auto *node = expr->As<ScheduleBlockRealize>();
+    auto *block = node->schedule_block.As<ScheduleBlock>();
+    for (int i = 0; i < node->iter_values.size(); ++i) {
+      if (i < block->iter_vars.size() && DependsOnVar(node->iter_values[i])) {
+        cinn::ir::ir_utils::IrReplaceVarBroadcast(
+            &block->body, block->iter_vars[i], node->iter_values[i]);
+      }
+    }
+    IRMutator<Expr *>::Visit(op, expr);
+  }
+
   void Visit(const Store *op, Expr *expr) override {
+    if (VectorizeReduceStore(expr)) return;
+
     auto *node = expr->As<Store>();
     auto value0 = node->value;
     Visit(&node->value);
@@ -601,6 +620,79 @@ class Vectorizer : public IRMutator<Expr *> {
     ir::IRMutator<>::Visit(op, expr);
   }
 
+  //! Rewrites a store accumulating into a location invariant in the var, e.g.
+  //! `C[j] = C[j] + A[j, i]`, to `C[j] = C[j] + vector_reduce_add(A[j, ramp])`,
+  //! which the LLVM backend emits as a horizontal reduction of the lanes.
+  //! Returns false if the store is not such a reduction.
+  bool VectorizeReduceStore(Expr *expr) {
+    auto *node = expr->As<Store>();
+    for (auto &idx : node->indices) {
+      if (DependsOnVar(idx)) return false;
+    }
+    return VectorizeReduceValue<Add>(node,
+                                     runtime::intrinsic::vector_reduce_add) ||
+           VectorizeReduceValue<Mul>(node,
+                                     runtime::intrinsic::vector_reduce_mul) ||
+           VectorizeReduceValue<Max>(node,
+                                     runtime::intrinsic::vector_reduce_max) ||
+           VectorizeReduceValue<Min>(node,
+                                     runtime::intrinsic::vector_reduce_min);
+  }
+
+  template <typename T>
+  bool VectorizeReduceValue(Store *store, const char *reduce_repr) {
+    auto *op = store->value.As<T>();
+    if (!op) return false;
+    Expr acc = op->a();
+    Expr operand = op->b();
+    if (!IsLoadOf(acc, *store)) std::swap(acc, operand);
+    if (!IsLoadOf(acc, *store) || IsLoadOf(operand, *store)) return false;
+
+    Type type = operand.type();
+    if (!type.is_float() && !type.is_int() && !type.is_uint()) return false;
+
+    // Vectorize a copy, the operand shares its nodes with the store.
+    Expr vec_operand =
+        ir::ir_utils::IRCopy(operand, /* copy_buffer_node = */ false);
+    Visit(&vec_operand);
+    if (vec_operand.type().lanes() == 1) return false;
+
+    Expr reduced = Call::Make(type.ElementOf(),
+                              reduce_repr,
+                              {vec_operand},
+                              {},
+                              CallType::Intrinsic);
+    store->value = T::Make(acc, reduced);
+    return true;
+  }
+
+  bool IsLoadOf(const Expr &e, const Store &store) const {
+    auto *load = e.As<Load>();
+    if (!load || !load->tensor.as_tensor() || !store.tensor.as_tensor()) {
+      return false;
+    }
+    if (load->tensor.as_tensor()->name != store.tensor.as_tensor()->name ||
+        load->indices.size() != store.indices.size()) {
+      return false;
+    }
+    for (int i = 0; i < load->indices.size(); ++i) {
+      if (!ir::ir_utils::IRCompare(load->indices[i], store.indices[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool DependsOnVar(const Expr &e) const {
+    return !ir::ir_utils::CollectIRNodesWithoutTensor(
+                e,
+                [&](const Expr *x) {
+                  return x->as_var() && x->as_var()->name == var->name;
+                },
+                /* uniq_target = */ true)
+                .empty();
+  }
+
   void Scalarize(Expr *expr) {
     Var idx(var->name + "_s", Int(32));
     std::map<const ir::_Var_ *, Expr> var_map;
@@ -790,6 +882,9 @@ struct VectorizeLoops_ : public IRMutator<Expr *> {
       vectorizable_ = true;
       IRMutator<>::Visit(&node->body, &node->body);
 
+      // The CPU targets vectorize the iterations in whole vectors and run the
+      // remainder in a tail after them.
+      bool with_tail = false;
       target.arch.Match(
           [&](common::NVGPUArch) {
             if (!forloop->extent.As<IntImm>() ||
@@ -811,7 +906,7 @@ struct VectorizeLoops_ : public IRMutator<Expr *> {
           },
           [&](std::variant<common::UnknownArch,
                            common::X86Arch,
-                           common::ARMArch>) {});
+                           common::ARMArch>) { with_tail = true; });
 
       if (extent_min || extent_max || !vectorizable_) {
         // not vectorize if has tail blocks, for llvm to optimize
@@ -821,7 +916,24 @@ struct VectorizeLoops_ : public IRMutator<Expr *> {
       }
 
       const int factor = forloop->vectorize_info().factor;
-      auto _new_forloop = SplitForLoop(node, factor);
+      Expr tail;
+      if (with_tail) {
+        auto *extent_int = node->extent.As<IntImm>();
+        if (extent_int && extent_int->value <= 0) {
+          // No iteration to vectorize, keep the loop as it is.
+          node->reset_vectorize_info();
+          var_intervals.erase(loop_var_name);
+          return;
+        }
+        tail = MakeTailForLoop(node, factor);
+        if (extent_int && extent_int->value < factor) {
+          // The tail covers all the iterations.
+          *expr = tail;
+          var_intervals.erase(loop_var_name);
+          return;
+        }
+      }
+      auto _new_forloop = SplitForLoop(node, factor, with_tail);
       if (!_new_forloop.defined()) {
         IRMutator<>::Visit(&node->body, &node->body);
         var_intervals.erase(forloop->loop_var->name);
@@ -898,6 +1010,9 @@ struct VectorizeLoops_ : public IRMutator<Expr *> {
       } else {
         node->body = new_forloop->body;
       }
+      if (tail.defined()) {
+        *expr = Block::Make({*expr, tail});
+      }
     } else {
       IRMutator::Visit(forloop, expr);
     }
@@ -992,9 +1107,55 @@ struct VectorizeLoops_ : public IRMutator<Expr *> {
     return false;
   }
 
-  //! Split the forloop with size \p factor.
+  //! Build the iterations of \p forloop left after the vector loop of \p
+  //! factor lanes, from extent / factor * factor to extent. A constant
+  //! remainder is vectorized to a narrower vector, which LLVM legalizes to
+  //! partial vector ops, a dynamic one runs in a serial loop.
+  //! @return The tail, undefined if the extent is a multiple of factor.
+  Expr MakeTailForLoop(const For *forloop, int factor) {
+    PADDLE_ENFORCE_EQ(is_zero(forloop->min),
+                      true,
+                      ::common::errors::InvalidArgument(
+                          "The tail of a vectorized loop is computed from "
+                          "its extent, the minimum of the loop should be "
+                          "zero, but received %s.",
+                          forloop->min));
+    Expr tail_min = cinn::common::AutoSimplify(
+        Div::Make(forloop->extent, make_const(factor)) * make_const(factor));
+    Expr body = ir::ir_utils::IRCopy(forloop->body,
+                                     /* copy_buffer_node = */ false);
+    Var tail_var(cinn::common::UniqName(forloop->loop_var->name + "_tail"),
+                 forloop->loop_var->type());
+
+    auto *extent_int = forloop->extent.As<IntImm>();
+    if (!extent_int) {
+      cinn::ir::ir_utils::IrReplaceVarBroadcast(
+          &body, forloop->loop_var, Expr(tail_var));
+      return For::Make(tail_var,
+                       tail_min,
+                       forloop->extent,
+                       ForType::Serial,
+                       DeviceAPI::UNK,
+                       body);
+    }
+
+    const int remainder = extent_int->value % factor;
+    if (remainder == 0) return Expr();
+    if (remainder == 1) {
+      cinn::ir::ir_utils::IrReplaceVarBroadcast(
+          &body, forloop->loop_var, tail_min);
+      return body;
+    }
+    cinn::ir::ir_utils::IrReplaceVarBroadcast(
+        &body, forloop->loop_var, tail_min + Expr(tail_var));
+    Vectorizer(tail_var, remainder, var_intervals).Visit(&body);
+    return body;
+  }
+
+  //! Split the forloop with size \p factor. If \p with_tail, the iterations
+  //! after the last whole vector are left to the tail.
   //! @return The new forloop.
-  Expr SplitForLoop(For *forloop, int factor) {
+  Expr SplitForLoop(For *forloop, int factor, bool with_tail = false) {
     PADDLE_ENFORCE_GT(factor,
                       1,
                       ::common::errors::InvalidArgument(
@@ -1015,8 +1176,9 @@ struct VectorizeLoops_ : public IRMutator<Expr *> {
       if (extent_ptr->value == 0) return Expr();
       int extent_int = forloop->extent.as_int32();
       int extent_trunc = extent_int / factor;
-      int extent_times =
-          extent_int % factor == 0 ? extent_trunc : extent_trunc + 1;
+      int extent_times = extent_int % factor == 0 || with_tail
+                             ? extent_trunc
+                             : extent_trunc + 1;
       times = cinn::common::make_const(forloop->extent->type(), extent_times);
     } else {
       times = cinn::common::AutoSimplify(
@@ -0,0 +1,347 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/optim/vectorize_loops.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/cinn/backends/compiler.h"
+#include "paddle/cinn/cinn.h"
+#include "paddle/cinn/ir/group_schedule/cpu_schedule.h"
+#include "paddle/cinn/ir/ir.h"
+#include "paddle/cinn/ir/ir_printer.h"
+#include "paddle/cinn/ir/schedule/ir_schedule.h"
+#include "paddle/cinn/lang/lower.h"
+#include "paddle/cinn/runtime/cinn_runtime.h"
+#include "paddle/cinn/runtime/intrinsic.h"
+#include "paddle/cinn/utils/string.h"
+
+namespace cinn {
+namespace optim {
+
+namespace {
+
+// A loop over var from 0 to extent, vectorized with factor lanes.
+Expr MakeVectorizedFor(const Var& var, Expr extent, int factor, Expr body) {
+  return ir::For::Make(var,
+                       Expr(0),
+                       extent,
+                       ir::ForType::Vectorized,
+                       ir::DeviceAPI::UNK,
+                       ir::Block::Make({body}),
+                       ir::VectorizeInfo(0, factor));
+}
+
+int CountOf(const std::string& str, const std::string& sub) {
+  int count = 0;
+  for (size_t pos = str.find(sub); pos != std::string::npos;
+       pos = str.find(sub, pos + sub.size())) {
+    ++count;
+  }
+  return count;
+}
+
+// Lowers args, replaces the body of the function with body and compiles it
+// for the host.
+void* CompileForHost(const std::string& fn_name,
+                     const std::vector<ir::Tensor>& args,
+                     Expr body,
+                     backends::Compiler* compiler) {
+  Target target = cinn::common::DefaultHostTarget();
+  ast_gen_ius::TensorGroup tensor_group(args);
+  auto func = lang::LowerToAst(fn_name, args, &tensor_group, target);
+  func->body = ir::Block::Make({body});
+  ir::Module::Builder builder(fn_name + "_module", target);
+  builder.AddFunction(func);
+  compiler->Build(builder.Build());
+  compiler->EndCompile();
+  return compiler->Lookup(fn_name);
+}
+
+cinn_buffer_t* NewHostBuffer(const std::vector<float>& data) {
+  auto* buffer = cinn_buffer_t::new_(
+      cinn_x86_device, cinn_float32_t(), {static_cast<int>(data.size())});
+  cinn_buffer_malloc(nullptr, buffer);
+  std::copy(data.begin(), data.end(), reinterpret_cast<float*>(buffer->memory));
+  return buffer;
+}
+
+std::vector<float> ReadAndFree(cinn_buffer_t* buffer) {
+  auto* data = reinterpret_cast<float*>(buffer->memory);
+  std::vector<float> out(data, data + buffer->num_elements());
+  cinn_buffer_free(nullptr, buffer);
+  cinn_buffer_t::delete_(buffer);
+  return out;
+}
+
+// Runs fn on buffers and returns their contents.
+std::vector<std::vector<float>> Run(
+    void* fn, const std::vector<cinn_buffer_t*>& buffers) {
+  std::vector<cinn_pod_value_t> args;
+  for (auto* buffer : buffers) {
+    args.emplace_back(buffer);
+  }
+  auto* host_fn = reinterpret_cast<void (*)(void*, int32_t)>(fn);
+  host_fn(args.data(), static_cast<int32_t>(args.size()));
+  std::vector<std::vector<float>> outs;
+  for (auto* buffer : buffers) {
+    outs.push_back(ReadAndFree(buffer));
+  }
+  return outs;
+}
+
+}  // namespace
+
+TEST(VectorizeLoops, ReduceToIntrinsic) {
+  Placeholder<float> A("A", {Expr(4), Expr(16)});
+  Placeholder<float> B("B", {Expr(4)});
+  Var i("i");
+  Var j("j");
+  Expr store = ir::Store::Make(B, B(i) + A(i, j), {Expr(i)});
+  Expr expr = ir::For::Make(i,
+                            Expr(0),
+                            Expr(4),
+                            ir::ForType::Serial,
+                            ir::DeviceAPI::UNK,
+                            ir::Block::Make({MakeVectorizedFor(
+                                j, Expr(16), 8, store)}));
+
+  VectorizeLoops(&expr, cinn::common::DefaultHostTarget());
+  std::string ir = utils::GetStreamCnt(expr);
+  VLOG(6) << "After VectorizeLoops: " << ir;
+
+  // The accumulation is reduced horizontally into the scalar accumulator.
+  EXPECT_EQ(CountOf(ir, runtime::intrinsic::vector_reduce_add), 1) << ir;
+}
+
+TEST(VectorizeLoops, ConstantTail) {
+  Placeholder<float> A("A", {Expr(19)});
+  Placeholder<float> B("B", {Expr(19)});
+  Var i("i");
+  Expr expr = MakeVectorizedFor(
+      i, Expr(19), 8, ir::Store::Make(B, A(i) * Expr(2.f), {Expr(i)}));
+
+  VectorizeLoops(&expr, cinn::common::DefaultHostTarget());
+  std::string ir = utils::GetStreamCnt(expr);
+  VLOG(6) << "After VectorizeLoops: " << ir;
+
+  // Two whole vectors of 8 lanes and a tail of 3 lanes.
+  EXPECT_EQ(CountOf(ir, ",1,8)"), 2) << ir;
+  EXPECT_EQ(CountOf(ir, ",1,3)"), 2) << ir;
+  EXPECT_EQ(CountOf(ir, "_tail"), 0) << ir;
+}
+
+TEST(VectorizeLoops, DynamicTail) {
+  Var n("n", Int(32));
+  Placeholder<float> A("A", {Expr(n)});
+  Placeholder<float> B("B", {Expr(n)});
+  Var i("i");
+  Expr expr = MakeVectorizedFor(
+      i, Expr(n), 8, ir::Store::Make(B, A(i) * Expr(2.f), {Expr(i)}));
+
+  VectorizeLoops(&expr, cinn::common::DefaultHostTarget());
+  std::string ir = utils::GetStreamCnt(expr);
+  VLOG(6) << "After VectorizeLoops: " << ir;
+
+  // The whole vectors, then a serial loop over the remainder.
+  EXPECT_EQ(CountOf(ir, ",1,8)"), 2) << ir;
+  EXPECT_GT(CountOf(ir, "i_tail"), 0) << ir;
+}
+
+TEST(VectorizeLoops, ZeroExtent) {
+  Placeholder<float> A("A", {Expr(8)});
+  Placeholder<float> B("B", {Expr(8)});
+  Var i("i");
+  Expr expr = MakeVectorizedFor(
+      i, Expr(0), 8, ir::Store::Make(B, A(i), {Expr(i)}));
+
+  VectorizeLoops(&expr, cinn::common::DefaultHostTarget());
+  VLOG(6) << "After VectorizeLoops: " << expr;
+
+  // The loop is kept, not replaced with an undefined tail.
+  ASSERT_TRUE(expr.defined());
+  auto* loop = expr.As<ir::For>();
+  ASSERT_NE(loop, nullptr);
+  EXPECT_FALSE(loop->is_vectorized());
+  EXPECT_EQ(CountOf(utils::GetStreamCnt(expr), "Ramp("), 0);
+}
+
+TEST(VectorizeLoops, RunExtentNotMultipleOfFactor) {
+  Placeholder<float> A("A", {Expr(19)});
+  ir::Tensor B = Compute(
+      {Expr(19)}, [&](Var i) { return A(i) * Expr(2.f); }, "B");
+  Var i("i");
+  auto compiler =
+      backends::Compiler::Create(cinn::common::DefaultHostTarget());
+  void* fn = CompileForHost(
+      "vectorize_tail",
+      {A, B},
+      MakeVectorizedFor(
+          i, Expr(19), 8, ir::Store::Make(B, A(i) * Expr(2.f), {Expr(i)})),
+      compiler.get());
+  ASSERT_NE(fn, nullptr);
+
+  // B has 5 more elements than the loop writes, they should stay untouched.
+  std::vector<float> a(19);
+  for (int k = 0; k < 19; ++k) a[k] = static_cast<float>(k);
+  auto outs = Run(
+      fn, {NewHostBuffer(a), NewHostBuffer(std::vector<float>(24, -1.f))});
+  for (int k = 0; k < 19; ++k) EXPECT_EQ(outs[1][k], 2.f * k) << k;
+  for (int k = 19; k < 24; ++k) EXPECT_EQ(outs[1][k], -1.f) << k;
+}
+
+TEST(VectorizeLoops, RunReduceWithTail) {
+  Placeholder<float> A("A", {Expr(4), Expr(19)});
+  ir::Tensor B = Compute(
+      {Expr(4)}, [&](Var i) { return A(i, Expr(0)); }, "B");
+  Var i("i");
+  Var j("j");
+  Expr body = ir::For::Make(
+      i,
+      Expr(0),
+      Expr(4),
+      ir::ForType::Serial,
+      ir::DeviceAPI::UNK,
+      ir::Block::Make({ir::Store::Make(B, Expr(0.f), {Expr(i)}),
+                       MakeVectorizedFor(
+                           j,
+                           Expr(19),
+                           8,
+                           ir::Store::Make(B, B(i) + A(i, j), {Expr(i)}))}));
+  auto compiler =
+      backends::Compiler::Create(cinn::common::DefaultHostTarget());
+  void* fn = CompileForHost("vectorize_reduce", {A, B}, body, compiler.get());
+  ASSERT_NE(fn, nullptr);
+
+  std::vector<float> a(4 * 19);
+  std::vector<float> expected(4, 0.f);
+  for (int k = 0; k < 4 * 19; ++k) {
+    a[k] = 0.25f * (k % 7) - 0.5f;
+    expected[k / 19] += a[k];
+  }
+  auto outs = Run(
+      fn, {NewHostBuffer(a), NewHostBuffer(std::vector<float>(4, -1.f))});
+  for (int k = 0; k < 4; ++k) EXPECT_NEAR(outs[1][k], expected[k], 1e-5) << k;
+}
+
+TEST(VectorizeLoops, RunSplatLoad) {
+  Placeholder<float> A("A", {Expr(8)});
+  ir::Tensor B = Compute(
+      {Expr(16)}, [&](Var i) { return A(Expr(0)); }, "B");
+  // All the lanes read one element, by a broadcast index and by a ramp of
+  // stride 0.
+  Expr body = ir::Block::Make(
+      {ir::Store::Make(B,
+                       ir::Load::Make(A, {ir::Broadcast::Make(Expr(3), 8)}),
+                       {ir::Ramp::Make(Expr(0), Expr(1), 8)}),
+       ir::Store::Make(B,
+                       ir::Load::Make(A, {ir::Ramp::Make(Expr(5), Expr(0), 8)}),
+                       {ir::Ramp::Make(Expr(8), Expr(1), 8)})});
+  auto compiler =
+      backends::Compiler::Create(cinn::common::DefaultHostTarget());
+  void* fn = CompileForHost("splat_load", {A, B}, body, compiler.get());
+  ASSERT_NE(fn, nullptr);
+
+  std::vector<float> a = {0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f};
+  auto outs = Run(
+      fn, {NewHostBuffer(a), NewHostBuffer(std::vector<float>(16, -1.f))});
+  for (int k = 0; k < 8; ++k) EXPECT_EQ(outs[1][k], 3.f) << k;
+  for (int k = 8; k < 16; ++k) EXPECT_EQ(outs[1][k], 5.f) << k;
+}
+
+TEST(VectorizeLoops, SoftmaxGroupOnHost) {
+  constexpr int kRows = 16;
+  constexpr int kCols = 256;
+  Placeholder<float> X("X", {Expr(kRows), Expr(kCols)});
+  Var max_k(kCols, "max_k");
+  ir::Tensor row_max = Compute(
+      {Expr(kRows)},
+      [&](Var i) { return lang::ReduceMax(X(i, max_k), {max_k}); },
+      "row_max");
+  ir::Tensor row_exp = Compute(
+      {Expr(kRows), Expr(kCols)},
+      [&](Var i, Var j) { return lang::Exp(X(i, j) - row_max(i)); },
+      "row_exp");
+  Var sum_k(kCols, "sum_k");
+  ir::Tensor row_sum = Compute(
+      {Expr(kRows)},
+      [&](Var i) { return lang::ReduceSum(row_exp(i, sum_k), {sum_k}); },
+      "row_sum");
+  ir::Tensor out = Compute(
+      {Expr(kRows), Expr(kCols)},
+      [&](Var i, Var j) { return row_exp(i, j) / row_sum(i); },
+      "softmax_out");
+
+  // Lower and merge the group as OpLowererImpl::LowerX86 does, then
+  // schedule it as the CPU kernel of a fused group with 8 lanes.
+  Target target = cinn::common::DefaultHostTarget();
+  ast_gen_ius::TensorGroup tensor_group({X, out});
+  auto func = lang::LowerToAst("softmax", {X, out}, &tensor_group, target);
+  ir::ModuleExpr mod_expr({func->body});
+  ir::IRSchedule ir_sch(
+      mod_expr, -1, false, cinn::utils::ErrorMessageLevel::kGeneral, true);
+  ir_sch.MergeExprs();
+  {
+    ir::CpuScheduleParams params;
+    params.vectorize_factor = 8;
+    ir::CpuScheduleTuningScope scope(params);
+    func->body = ir::ScheduleCpuKernel(
+        "softmax", "softmax", ir_sch.GetModule().GetExprs().at(0));
+  }
+
+  ir::Module::Builder builder("softmax_module", target);
+  builder.AddFunction(func);
+  ir::Module module = builder.Build();
+  std::string ir = utils::GetStreamCnt(module.functions().at(0));
+  VLOG(6) << "Softmax group: " << ir;
+
+  // Both reductions of the rows are reduced horizontally.
+  EXPECT_GT(CountOf(ir, runtime::intrinsic::vector_reduce_max), 0) << ir;
+  EXPECT_GT(CountOf(ir, runtime::intrinsic::vector_reduce_add), 0) << ir;
+
+  auto compiler = backends::Compiler::Create(target);
+  compiler->Build(module);
+  compiler->EndCompile();
+  void* fn = compiler->Lookup("softmax");
+  ASSERT_NE(fn, nullptr);
+
+  std::vector<float> x(kRows * kCols);
+  for (int k = 0; k < kRows * kCols; ++k) x[k] = 0.01f * (k % 97) - 0.3f;
+  auto outs = Run(fn,
+                  {NewHostBuffer(x),
+                   NewHostBuffer(std::vector<float>(kRows * kCols, -1.f))});
+  for (int row = 0; row < kRows; ++row) {
+    const float* x_row = x.data() + row * kCols;
+    float max_value = *std::max_element(x_row, x_row + kCols);
+    float sum = 0.f;
+    for (int col = 0; col < kCols; ++col) {
+      sum += std::exp(x_row[col] - max_value);
+    }
+    for (int col = 0; col < kCols; ++col) {
+      EXPECT_NEAR(outs[1][row * kCols + col],
+                  std::exp(x_row[col] - max_value) / sum,
+                  1e-6)
+          << row << ", " << col;
+    }
+  }
+}
+
+}  // namespace optim
+}  // namespace cinn
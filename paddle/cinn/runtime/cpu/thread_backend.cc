@@ -24,8 +24,12 @@
 #include "paddle/cinn/backends/extern_func_jit_register.h"
 #include "paddle/cinn/backends/llvm/runtime_symbol_registry.h"
 #include "paddle/cinn/common/cas.h"
+#include "paddle/cinn/runtime/cpu/thread_pool.h"
 #include "paddle/cinn/runtime/intrinsic.h"
 #include "paddle/common/enforce.h"
+#include "paddle/common/flags.h"
+
+PD_DECLARE_string(cinn_host_parallel_backend);
 
 int max_concurrency() {
   int max_concurrency = 1;
@@ -49,6 +53,17 @@ int cinn_backend_parallel_launch(FCINNParallelLambda flambda,
                                  int num_task) {
   int num_workers = max_concurrency();
   if (num_task == 0) num_task = num_workers;
+  if (FLAGS_cinn_host_parallel_backend == "thread_pool") {
+    cinn::runtime::cpu::ParallelLaunchPool::Global().Launch(
+        flambda, datas, num_task);
+    return 0;
+  }
+  PADDLE_ENFORCE_EQ(FLAGS_cinn_host_parallel_backend,
+                    "openmp",
+                    ::common::errors::InvalidArgument(
+                        "Unknown host parallel backend %s, it should be "
+                        "'thread_pool' or 'openmp'.",
+                        FLAGS_cinn_host_parallel_backend));
 #ifdef CINN_USE_OPENMP
   omp_set_num_threads(num_task);
 #pragma omp parallel num_threads(num_task)
@@ -0,0 +1,203 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/runtime/cpu/thread_pool.h"
+
+#include <glog/logging.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+
+#include "paddle/common/flags.h"
+
+PD_DECLARE_bool(cinn_thread_pool_bind_cpu);
+
+namespace cinn::runtime::cpu {
+
+namespace {
+
+// The pauses to spin for before sleeping. Its time depends on the cpu, the
+// latency of a pause ranges from a few to over a hundred cycles.
+constexpr int kSpinCount = 1 << 14;
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Set in the workers, so that nested launches run serially.
+thread_local bool is_pool_worker = false;
+
+void RunSerially(FCINNParallelLambda flambda, void* datas, int num_task) {
+  for (int task_id = 0; task_id < num_task; ++task_id) {
+    (*flambda)(task_id, num_task, datas);
+  }
+}
+
+// Binds the calling thread to the index-th cpu the process may run on.
+void BindCpu(int index) {
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+  const int num_allowed = CPU_COUNT(&allowed);
+  if (num_allowed == 0) return;
+  index %= num_allowed;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &allowed)) continue;
+    if (index-- == 0) {
+      cpu_set_t target;
+      CPU_ZERO(&target);
+      CPU_SET(cpu, &target);
+      if (pthread_setaffinity_np(pthread_self(), sizeof(target), &target) !=
+          0) {
+        VLOG(3) << "Failed to bind the CINN worker to cpu " << cpu;
+      }
+      return;
+    }
+  }
+#endif
+}
+
+}  // namespace
+
+ParallelLaunchPool& ParallelLaunchPool::Global() {
+  static ParallelLaunchPool pool(max_concurrency(),
+                                 FLAGS_cinn_thread_pool_bind_cpu);
+  return pool;
+}
+
+ParallelLaunchPool::ParallelLaunchPool(int num_threads, bool bind_cpu)
+    : num_threads_(std::max(num_threads, 1)) {
+  slots_.reserve(num_threads_ - 1);
+  for (int worker_id = 1; worker_id < num_threads_; ++worker_id) {
+    slots_.emplace_back(std::make_unique<WorkerSlot>());
+  }
+  workers_.reserve(num_threads_ - 1);
+  for (int worker_id = 1; worker_id < num_threads_; ++worker_id) {
+    workers_.emplace_back([this, worker_id, bind_cpu] {
+      is_pool_worker = true;
+      if (bind_cpu) BindCpu(worker_id);
+      WorkerLoop(worker_id);
+    });
+  }
+  VLOG(3) << "Create CINN parallel launch pool with " << num_threads_
+          << " threads";
+}
+
+ParallelLaunchPool::~ParallelLaunchPool() {
+  stop_ = true;
+  ++generation_;
+  for (auto& slot : slots_) {
+    std::lock_guard<std::mutex> lock(slot->mutex);
+    slot->generation.store(generation_, std::memory_order_seq_cst);
+    slot->cv.notify_one();
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ParallelLaunchPool::RunChunk(int worker_id) const {
+  const int64_t begin =
+      static_cast<int64_t>(num_task_) * worker_id / num_active_;
+  const int64_t end =
+      static_cast<int64_t>(num_task_) * (worker_id + 1) / num_active_;
+  for (int64_t task_id = begin; task_id < end; ++task_id) {
+    (*flambda_)(static_cast<int>(task_id), num_task_, datas_);
+  }
+}
+
+void ParallelLaunchPool::Post(WorkerSlot* slot, uint64_t generation) {
+  // Either the worker sees the generation before it sleeps, or this sees it
+  // sleeping and wakes it, since both sides use sequentially consistent
+  // accesses. The mutex makes the notification wait for the worker to sleep.
+  slot->generation.store(generation, std::memory_order_seq_cst);
+  if (slot->sleeping.load(std::memory_order_seq_cst)) {
+    std::lock_guard<std::mutex> lock(slot->mutex);
+    slot->cv.notify_one();
+  }
+}
+
+void ParallelLaunchPool::WorkerLoop(int worker_id) {
+  WorkerSlot* slot = slots_[worker_id - 1].get();
+  uint64_t seen = 0;
+  while (true) {
+    uint64_t generation = slot->generation.load(std::memory_order_acquire);
+    for (int spin = 0; generation == seen && spin < kSpinCount; ++spin) {
+      CpuRelax();
+      generation = slot->generation.load(std::memory_order_acquire);
+    }
+    if (generation == seen) {
+      std::unique_lock<std::mutex> lock(slot->mutex);
+      slot->sleeping.store(true, std::memory_order_seq_cst);
+      slot->cv.wait(lock, [&] {
+        return slot->generation.load(std::memory_order_seq_cst) != seen;
+      });
+      slot->sleeping.store(false, std::memory_order_relaxed);
+      generation = slot->generation.load(std::memory_order_acquire);
+    }
+    seen = generation;
+    if (stop_) return;
+    RunChunk(worker_id);
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+  }
+}
+
+void ParallelLaunchPool::Launch(FCINNParallelLambda flambda,
+                                void* datas,
+                                int num_task) {
+  if (num_task <= 0) return;
+  if (num_task == 1 || num_threads_ == 1 || is_pool_worker) {
+    RunSerially(flambda, datas, num_task);
+    return;
+  }
+  std::unique_lock<std::mutex> launch_lock(launch_mutex_, std::try_to_lock);
+  if (!launch_lock.owns_lock()) {
+    RunSerially(flambda, datas, num_task);
+    return;
+  }
+
+  flambda_ = flambda;
+  datas_ = datas;
+  num_task_ = num_task;
+  num_active_ = std::min(num_task, num_threads_);
+  // Only the workers with a chunk are posted the launch, the others keep
+  // waiting and never read the fields above.
+  pending_.store(num_active_ - 1, std::memory_order_relaxed);
+  ++generation_;
+  for (int worker_id = 1; worker_id < num_active_; ++worker_id) {
+    Post(slots_[worker_id - 1].get(), generation_);
+  }
+
+  is_pool_worker = true;
+  RunChunk(0);
+  is_pool_worker = false;
+  // Yields after spinning, the workers may share the cpus with the caller.
+  for (int spin = 0; pending_.load(std::memory_order_acquire) != 0; ++spin) {
+    if (spin < kSpinCount) {
+      CpuRelax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+}  // namespace cinn::runtime::cpu
@@ -0,0 +1,93 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "paddle/cinn/common/macros.h"
+#include "paddle/cinn/runtime/cpu/thread_backend.h"
+
+namespace cinn::runtime::cpu {
+
+/**
+ * A persistent pool running the parallel lambdas of the host kernels.
+ *
+ * The calling thread works as worker 0 and the num_threads - 1 workers are
+ * created once. If bind_cpu is set (FLAGS_cinn_thread_pool_bind_cpu, off by
+ * default) they are bound to the cpus of the process one by one. Between
+ * launches the workers spin for a while before sleeping, so the back to back
+ * launches of small kernels do not pay for waking them up. The tasks of a
+ * launch are split into contiguous chunks, one per worker, and only the
+ * workers with a chunk are woken.
+ *
+ * Only one launch runs on the pool at a time. Nested launches from a worker,
+ * and launches from other threads while the pool is busy, run their tasks
+ * in the calling thread.
+ */
+class ParallelLaunchPool final {
+ public:
+  // The pool of max_concurrency() threads.
+  static ParallelLaunchPool& Global();
+
+  ParallelLaunchPool(int num_threads, bool bind_cpu);
+  ~ParallelLaunchPool();
+
+  int num_threads() const { return num_threads_; }
+
+  // Runs flambda(task_id, num_task, datas) for task_id in [0, num_task).
+  void Launch(FCINNParallelLambda flambda, void* datas, int num_task);
+
+ private:
+  CINN_DISALLOW_COPY_AND_ASSIGN(ParallelLaunchPool);
+
+  // The launches posted to a worker, on its own cache line.
+  struct alignas(64) WorkerSlot {
+    // The generation of the last launch the worker has a chunk of.
+    std::atomic<uint64_t> generation{0};
+    std::atomic<bool> sleeping{false};
+    std::mutex mutex;
+    std::condition_variable cv;
+  };
+
+  void WorkerLoop(int worker_id);
+  void RunChunk(int worker_id) const;
+  void Post(WorkerSlot* slot, uint64_t generation);
+
+  const int num_threads_;
+  std::vector<std::thread> workers_;
+  // slots_[worker_id - 1] is the slot of the worker worker_id.
+  std::vector<std::unique_ptr<WorkerSlot>> slots_;
+
+  // The launch being run, published by the generation of the slots.
+  FCINNParallelLambda flambda_{nullptr};
+  void* datas_{nullptr};
+  int num_task_{0};
+  int num_active_{0};
+  bool stop_{false};
+
+  // Guarded by launch_mutex_.
+  uint64_t generation_{0};
+  // The number of woken workers which have not finished the current launch.
+  std::atomic<int> pending_{0};
+
+  std::mutex launch_mutex_;
+};
+
+}  // namespace cinn::runtime::cpu
@@ -0,0 +1,180 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/runtime/cpu/thread_pool.h"
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#ifdef CINN_USE_OPENMP
+#include <omp.h>
+#endif  // CINN_USE_OPENMP
+
+namespace cinn::runtime::cpu {
+
+namespace {
+
+struct CountData {
+  std::vector<std::atomic<int>>* counts;
+  int expected_num_task;
+  std::atomic<bool>* num_task_mismatch;
+};
+
+int CountTask(int task_id, int num_task, void* datas) {
+  auto* data = static_cast<CountData*>(datas);
+  if (num_task != data->expected_num_task) {
+    data->num_task_mismatch->store(true);
+  }
+  (*data->counts)[task_id].fetch_add(1);
+  return 0;
+}
+
+void CheckEachTaskRunOnce(ParallelLaunchPool* pool, int num_task) {
+  std::vector<std::atomic<int>> counts(num_task);
+  std::atomic<bool> num_task_mismatch{false};
+  CountData data{&counts, num_task, &num_task_mismatch};
+  pool->Launch(&CountTask, &data, num_task);
+  EXPECT_FALSE(num_task_mismatch.load());
+  for (int i = 0; i < num_task; ++i) {
+    EXPECT_EQ(counts[i].load(), 1) << "task " << i << " of " << num_task;
+  }
+}
+
+struct NestedData {
+  ParallelLaunchPool* pool;
+  std::atomic<int>* sum;
+};
+
+int AddOne(int task_id, int num_task, void* datas) {
+  static_cast<std::atomic<int>*>(datas)->fetch_add(1);
+  return 0;
+}
+
+int LaunchInner(int task_id, int num_task, void* datas) {
+  auto* data = static_cast<NestedData*>(datas);
+  data->pool->Launch(&AddOne, data->sum, 8);
+  return 0;
+}
+
+struct ScaleData {
+  const float* x;
+  float* y;
+  int64_t numel;
+};
+
+int Scale(int task_id, int num_task, void* datas) {
+  auto* data = static_cast<ScaleData*>(datas);
+  int64_t begin = data->numel * task_id / num_task;
+  int64_t end = data->numel * (task_id + 1) / num_task;
+  for (int64_t i = begin; i < end; ++i) {
+    data->y[i] = data->x[i] * 2.f + 1.f;
+  }
+  return 0;
+}
+
+}  // namespace
+
+TEST(ParallelLaunchPool, each_task_run_once) {
+  ParallelLaunchPool pool(4, /*bind_cpu=*/false);
+  for (int num_task : {1, 2, 3, 4, 5, 7, 64, 1000}) {
+    CheckEachTaskRunOnce(&pool, num_task);
+  }
+  // Back to back launches reuse the workers.
+  for (int i = 0; i < 1000; ++i) {
+    CheckEachTaskRunOnce(&pool, 1 + i % 9);
+  }
+}
+
+TEST(ParallelLaunchPool, single_thread) {
+  ParallelLaunchPool pool(1, /*bind_cpu=*/false);
+  CheckEachTaskRunOnce(&pool, 17);
+}
+
+TEST(ParallelLaunchPool, empty_launch) {
+  ParallelLaunchPool pool(4, /*bind_cpu=*/false);
+  std::atomic<int> sum{0};
+  pool.Launch(&AddOne, &sum, 0);
+  EXPECT_EQ(sum.load(), 0);
+}
+
+TEST(ParallelLaunchPool, nested_launch) {
+  ParallelLaunchPool pool(4, /*bind_cpu=*/false);
+  std::atomic<int> sum{0};
+  NestedData data{&pool, &sum};
+  pool.Launch(&LaunchInner, &data, 6);
+  EXPECT_EQ(sum.load(), 6 * 8);
+}
+
+TEST(ParallelLaunchPool, concurrent_launch) {
+  ParallelLaunchPool pool(4, /*bind_cpu=*/false);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&pool] {
+      for (int i = 0; i < 200; ++i) {
+        CheckEachTaskRunOnce(&pool, 1 + i % 13);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(ParallelLaunchPool, global) {
+  auto& pool = ParallelLaunchPool::Global();
+  EXPECT_EQ(pool.num_threads(), max_concurrency());
+  CheckEachTaskRunOnce(&pool, 2 * pool.num_threads() + 1);
+}
+
+// Compares the launch overhead of the pool with OpenMP on a chain of small
+// elementwise kernels, like the host kernels of a fused subgraph.
+TEST(ParallelLaunchPool, benchmark) {
+  constexpr int64_t kNumel = 1 << 14;
+  constexpr int kNumKernel = 16;
+  constexpr int kRepeat = 200;
+  std::vector<float> x(kNumel, 1.f), y(kNumel);
+  ScaleData data{x.data(), y.data(), kNumel};
+  auto& pool = ParallelLaunchPool::Global();
+  const int num_task = pool.num_threads();
+
+  auto run = [&](auto&& launch) {
+    launch();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRepeat * kNumKernel; ++i) {
+      launch();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() /
+           kRepeat;
+  };
+  double pool_us = run([&] { pool.Launch(&Scale, &data, num_task); });
+  EXPECT_EQ(y[kNumel - 1], 3.f);
+  LOG(INFO) << "Run " << kNumKernel << " kernels of " << kNumel
+            << " elements with " << num_task << " threads, thread pool: "
+            << pool_us << " us";
+#ifdef CINN_USE_OPENMP
+  double omp_us = run([&] {
+#pragma omp parallel num_threads(num_task)
+    Scale(omp_get_thread_num(), num_task, &data);
+  });
+  LOG(INFO) << "OpenMP: " << omp_us << " us";
+#endif
+}
+
+}  // namespace cinn::runtime::cpu
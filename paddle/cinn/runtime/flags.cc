@@ -58,6 +58,45 @@ PD_DEFINE_string(cinn_tile_config_filename_label,
                  StringFromEnv("FLAGS_cinn_tile_config_filename_label", ""),
                  "Label used to name file of tile config database");
 
+PD_DEFINE_string(cinn_compilation_cache_dir,
+                 StringFromEnv("FLAGS_cinn_compilation_cache_dir", ""),
+                 "Directory of the compilation cache shared across processes, "
+                 "empty means disabled. Only X86 kernels are cached.");
+
+PD_DEFINE_bool(cinn_report_compile_time,
+               BoolFromEnv("FLAGS_cinn_report_compile_time", false),
+               "Whether to log the time of each compile stage of the fusion "
+               "groups compiled by PirCompiler.");
+
+PD_DEFINE_string(cinn_host_parallel_backend,
+                 StringFromEnv("FLAGS_cinn_host_parallel_backend",
+                               "thread_pool"),
+                 "Backend of the parallel launch of host kernels, "
+                 "'thread_pool' or 'openmp'.");
+
+PD_DEFINE_bool(cinn_thread_pool_bind_cpu,
+               BoolFromEnv("FLAGS_cinn_thread_pool_bind_cpu", false),
+               "Whether to bind the workers of the host thread pool to cpus. "
+               "The workers of each process bind from the first allowed cpu, "
+               "enable it only when one process runs on the allowed cpus.");
+
+PD_DEFINE_int64(cinn_shape_specialize_threshold,
+                Int64FromEnv("FLAGS_cinn_shape_specialize_threshold", 0L),
+                "The number of runs of a dynamic shape group with the same "
+                "symbol args, after which a static kernel is compiled for "
+                "them in background. 0 means disabled.");
+
+PD_DEFINE_int64(cinn_shape_specialize_max_kernels,
+                Int64FromEnv("FLAGS_cinn_shape_specialize_max_kernels", 8L),
+                "The max number of static kernels compiled for each dynamic "
+                "shape group.");
+
+PD_DEFINE_string(cinn_tuning_record_file,
+                 StringFromEnv("FLAGS_cinn_tuning_record_file", ""),
+                 "File of the tuned schedules of the CPU kernels, written by "
+                 "search::CpuScheduleTuner and applied when compiling the "
+                 "fusion groups. Empty means disabled.");
+
 PD_DEFINE_string(
     tile_config_policy,
     StringFromEnv("FLAGS_tile_config_policy", "default"),
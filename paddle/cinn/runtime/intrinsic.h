@@ -131,6 +131,15 @@ static const char* cuda_sync_threads = "__syncthreads";
 
 static const char* parallel_launch = "cinn_backend_parallel_launch";
 
+//! Reduce the lanes of a vector to a scalar, emitted by the CPU vectorizer for
+//! the reductions into a location invariant in the vectorized loop.
+// @{
+static const char* vector_reduce_add = "cinn_vector_reduce_add";
+static const char* vector_reduce_mul = "cinn_vector_reduce_mul";
+static const char* vector_reduce_max = "cinn_vector_reduce_max";
+static const char* vector_reduce_min = "cinn_vector_reduce_min";
+// @}
+
 }  // namespace intrinsic
 
 /**
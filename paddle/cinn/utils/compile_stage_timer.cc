@@ -0,0 +1,102 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/utils/compile_stage_timer.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace cinn {
+namespace utils {
+
+namespace {
+thread_local CompileStageTimes* current_times = nullptr;
+thread_local CompileStageTimer* current_timer = nullptr;
+}  // namespace
+
+const char* CompileStageToString(CompileStage stage) {
+  switch (stage) {
+    case CompileStage::kLowering:
+      return "lowering";
+    case CompileStage::kSchedule:
+      return "schedule";
+    case CompileStage::kCodeGen:
+      return "codegen";
+    case CompileStage::kLLVMOpt:
+      return "llvm_opt";
+    case CompileStage::kLink:
+      return "link";
+    default:
+      return "unknown";
+  }
+}
+
+double CompileStageTimes::Total() const {
+  double total = 0.;
+  for (double stage_ms : ms) {
+    total += stage_ms;
+  }
+  return total;
+}
+
+CompileStageTimes& CompileStageTimes::operator+=(
+    const CompileStageTimes& other) {
+  for (size_t i = 0; i < ms.size(); ++i) {
+    ms[i] += other.ms[i];
+  }
+  return *this;
+}
+
+std::string CompileStageTimes::ToString() const {
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  for (size_t i = 0; i < ms.size(); ++i) {
+    os << CompileStageToString(static_cast<CompileStage>(i)) << ": " << ms[i]
+       << " ms, ";
+  }
+  os << "total: " << Total() << " ms";
+  return os.str();
+}
+
+ScopedCompileStageTimes::ScopedCompileStageTimes(CompileStageTimes* times)
+    : prev_(current_times) {
+  current_times = times;
+}
+
+ScopedCompileStageTimes::~ScopedCompileStageTimes() { current_times = prev_; }
+
+CompileStageTimes* ScopedCompileStageTimes::Current() { return current_times; }
+
+CompileStageTimer::CompileStageTimer(CompileStage stage)
+    : stage_(stage),
+      parent_(current_timer),
+      start_(std::chrono::steady_clock::now()) {
+  current_timer = this;
+}
+
+CompileStageTimer::~CompileStageTimer() {
+  const double elapsed_ms = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - start_)
+                                .count();
+  if (current_times != nullptr) {
+    (*current_times)[stage_] += elapsed_ms - nested_ms_;
+  }
+  if (parent_ != nullptr) {
+    parent_->nested_ms_ += elapsed_ms;
+  }
+  current_timer = parent_;
+}
+
+}  // namespace utils
+}  // namespace cinn
@@ -0,0 +1,95 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <chrono>  // NOLINT
+#include <string>
+
+namespace cinn {
+namespace utils {
+
+enum class CompileStage {
+  // Lowering a group into LoweredFuncs, except the scheduling.
+  kLowering = 0,
+  // Applying the group scheduler.
+  kSchedule,
+  // Emitting LLVM IR or device source code.
+  kCodeGen,
+  // Optimizing the LLVM module and emitting the object code.
+  kLLVMOpt,
+  // Compiling the device code, adding the modules to the JIT and looking
+  // up the kernels.
+  kLink,
+  kNumStages
+};
+
+const char* CompileStageToString(CompileStage stage);
+
+// The time in milliseconds spent in each stage.
+struct CompileStageTimes {
+  std::array<double, static_cast<size_t>(CompileStage::kNumStages)> ms{};
+
+  double& operator[](CompileStage stage) {
+    return ms[static_cast<size_t>(stage)];
+  }
+  double operator[](CompileStage stage) const {
+    return ms[static_cast<size_t>(stage)];
+  }
+  double Total() const;
+  CompileStageTimes& operator+=(const CompileStageTimes& other);
+  std::string ToString() const;
+};
+
+/**
+ * Collects the stage times of the current thread into `times` while alive.
+ *
+ *   CompileStageTimes times;
+ *   {
+ *     ScopedCompileStageTimes collect(&times);
+ *     CompilationTask(ctx)();
+ *   }
+ */
+class ScopedCompileStageTimes {
+ public:
+  explicit ScopedCompileStageTimes(CompileStageTimes* times);
+  ~ScopedCompileStageTimes();
+
+  // The times being collected by the current thread, or nullptr.
+  static CompileStageTimes* Current();
+
+ private:
+  CompileStageTimes* prev_;
+};
+
+/**
+ * Adds the time of its scope to `stage` of the times being collected by the
+ * current thread, if any. The time of the nested timers is excluded, so a
+ * stage only counts its own work.
+ */
+class CompileStageTimer {
+ public:
+  explicit CompileStageTimer(CompileStage stage);
+  ~CompileStageTimer();
+
+ private:
+  CompileStage stage_;
+  CompileStageTimer* parent_;
+  std::chrono::steady_clock::time_point start_;
+  double nested_ms_{0.};
+};
+
+}  // namespace utils
+}  // namespace cinn
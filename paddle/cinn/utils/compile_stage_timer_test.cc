@@ -0,0 +1,90 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/utils/compile_stage_timer.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
+namespace cinn {
+namespace utils {
+
+namespace {
+void SleepMs(int ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+}  // namespace
+
+TEST(CompileStageTimer, nested_stages_are_exclusive) {
+  CompileStageTimes times;
+  const auto start = std::chrono::steady_clock::now();
+  {
+    ScopedCompileStageTimes collect(&times);
+    CompileStageTimer lowering(CompileStage::kLowering);
+    SleepMs(10);
+    {
+      CompileStageTimer schedule(CompileStage::kSchedule);
+      SleepMs(30);
+    }
+  }
+  const double span_ms = std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  // The exclusive stage times add up to no more than the enclosing span,
+  // counting the schedule time in lowering too would exceed it by 30ms.
+  EXPECT_LE(times.Total(), span_ms);
+  EXPECT_GE(times[CompileStage::kLowering], 10.);
+  EXPECT_GE(times[CompileStage::kSchedule], 30.);
+  EXPECT_EQ(times[CompileStage::kCodeGen], 0.);
+  EXPECT_DOUBLE_EQ(
+      times.Total(),
+      times[CompileStage::kLowering] + times[CompileStage::kSchedule]);
+}
+
+TEST(CompileStageTimer, not_collected) {
+  CompileStageTimes times;
+  {
+    CompileStageTimer link(CompileStage::kLink);
+  }
+  {
+    ScopedCompileStageTimes collect(&times);
+  }
+  {
+    CompileStageTimer link(CompileStage::kLink);
+  }
+  EXPECT_EQ(times.Total(), 0.);
+}
+
+TEST(CompileStageTimer, per_thread) {
+  CompileStageTimes main_times;
+  CompileStageTimes worker_times;
+  ScopedCompileStageTimes collect(&main_times);
+  std::thread worker([&] {
+    ScopedCompileStageTimes worker_collect(&worker_times);
+    CompileStageTimer codegen(CompileStage::kCodeGen);
+    SleepMs(5);
+  });
+  worker.join();
+  EXPECT_EQ(main_times.Total(), 0.);
+  EXPECT_GE(worker_times[CompileStage::kCodeGen], 5.);
+
+  main_times += worker_times;
+  EXPECT_EQ(main_times[CompileStage::kCodeGen],
+            worker_times[CompileStage::kCodeGen]);
+}
+
+}  // namespace utils
+}  // namespace cinn
@@ -462,8 +462,8 @@ PHI_DEFINE_EXPORTED_double(
  * Allocator related FLAG
  * Name: FLAGS_allocator_strategy
  * Since Version: 1.2
- * Value Range: string, {naive_best_fit, auto_growth, thread_local},
- * default=auto_growth
+ * Value Range: string, {naive_best_fit, auto_growth, auto_growth_slab,
+ * thread_local}, default=auto_growth
  * Example:
  * Note: For selecting allocator policy of PaddlePaddle.
  */
@@ -481,7 +481,9 @@ PHI_DEFINE_EXPORTED_string(
     "size of models may be larger). auto_growth strategy would allocate "
     "GPU memory on demand, which allows users to start several Paddle jobs "
     "on the same GPU card but may lead to more memory fragmentation "
-    "(i.e., maximum batch size of models may be smaller).");
+    "(i.e., maximum batch size of models may be smaller). "
+    "auto_growth_slab is auto_growth with a per-thread size-class cache for "
+    "small CPU allocations.");
 
 /**
  * Memory related FLAG
@@ -744,6 +746,42 @@ PHI_DEFINE_EXPORTED_int32(
     "less FLAGS_max_inplace_grad_add, than it will be use several grad_add"
     "instead of sum. Default is 0.");
 
+/**
+ * Performance related FLAG
+ * Name: eager_backward_num_threads
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_eager_backward_num_threads=8, run the independent grad nodes
+ * of the dygraph backward on CPU in 8 threads.
+ * Note: 0 runs the backward in the calling thread. Only the backward without
+ * create_graph on CPU runs in parallel.
+ */
+PHI_DEFINE_EXPORTED_int32(
+    eager_backward_num_threads,
+    0,
+    "The number of threads to run the independent grad nodes of the "
+    "dygraph backward on CPU, 0 means running them in the calling thread.");
+
+/**
+ * Performance related FLAG
+ * Name: eager_saved_tensor_compression
+ * Since Version: 3.0.0
+ * Value Range: string, {"", "bf16", "int8"}, default=""
+ * Example: FLAGS_eager_saved_tensor_compression="bf16", save the float
+ * activations kept for the dygraph backward in bfloat16.
+ * Note: "int8" saves them in int8 with a scale per channel. With either
+ * policy, the saved tensors whose backward only uses their signs, e.g. the
+ * out of relu and the mask of dropout, are saved as bit masks on CPU, and the
+ * precision sensitive ones, e.g. the out of softmax and the statistics of
+ * layer_norm, are saved as they are. The saved tensors are restored when the
+ * backward runs. Empty saves them as they are.
+ */
+PHI_DEFINE_EXPORTED_string(
+    eager_saved_tensor_compression,
+    "",
+    "The policy to compress the tensors saved for the dygraph backward, "
+    "empty, bf16 or int8.");
+
 /**
  * Tensor.numpy() has a hack, and this flag can close this hack
  * [true]: set 0D Tensor to 1D Numpy
@@ -1221,6 +1259,10 @@ PD_DEFINE_bool(enable_slotrecord_reset_shrink,  // NOLINT
 PD_DEFINE_bool(enable_ins_parser_file,  // NOLINT
                false,
                "enable parser ins file, default false");
+PD_DEFINE_int32(data_feed_parse_thread_num,
+                0,
+                "InMemoryDataFeed parse thread num of each reader, 0 means "
+                "parsing in the reading thread");
 PHI_DEFINE_EXPORTED_bool(
     gpugraph_enable_hbm_table_collision_stat,
     false,
@@ -1369,6 +1411,19 @@ PHI_DEFINE_EXPORTED_bool(enable_fusion_fallback,
                          false,
                          "Whether enable fallback fusion ops in cinn.");
 
+/**
+ * CINN group op passes related FLAG
+ * Name: FLAGS_cinn_group_op_pass_num_threads
+ * Since Version: 3.0 beta
+ * Value Range: int32, default=1
+ * Note: The number of threads running the region local passes on the group
+ * ops, 1 means serial and 0 means the number of cpus.
+ */
+PHI_DEFINE_EXPORTED_int32(cinn_group_op_pass_num_threads,
+                          1,
+                          "The number of threads running the region local "
+                          "passes on the cinn group ops.");
+
 /**
  * Conv Search cache max number related FLAG
  * Name: FLAGS_search_cache_max_number
@@ -1591,6 +1646,21 @@ PHI_DEFINE_EXPORTED_bool(pir_apply_inplace_pass,
                          "Whether to apply inplace pass on lowering "
                          "::pir::Program to Kernel Dialect");
 
+/**
+ * Apply memory planning pass to PIR FLAG
+ * Name: pir_apply_memory_planning_pass
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, will apply memory planning pass after inplace pass, the
+ * static shape intermediate tensors are placed in one preallocated arena and
+ * the executor runs the program in order.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_apply_memory_planning_pass,
+                         false,
+                         "Whether to apply memory planning pass on the "
+                         "::pir::Program of Kernel Dialect");
+
 PHI_DEFINE_EXPORTED_string(
     ir_inplace_kernel_blacklist,
     "",
@@ -0,0 +1,316 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/collective/comm_hook.h"
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+#include "paddle/phi/api/include/api.h"
+#include "paddle/phi/core/enforce.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+phi::DenseTensor *GetDenseTensor(const paddle::Tensor &tensor) {
+  return std::dynamic_pointer_cast<phi::DenseTensor>(tensor.impl()).get();
+}
+
+bool IsFloatingPoint(phi::DataType dtype) {
+  return dtype == phi::DataType::FLOAT32 || dtype == phi::DataType::FLOAT64;
+}
+
+void AllReduceSum(ProcessGroup *process_group, const paddle::Tensor &tensor) {
+  distributed::AllreduceOptions opts;
+  opts.reduce_op = ReduceOp::SUM;
+  std::vector<phi::DenseTensor> in_out{*GetDenseTensor(tensor)};
+  process_group->AllReduce(in_out, in_out, opts)->Synchronize();
+}
+
+void AllGather(ProcessGroup *process_group,
+               const paddle::Tensor &in,
+               paddle::Tensor *out) {
+  std::vector<phi::DenseTensor> in_tensors{*GetDenseTensor(in)};
+  std::vector<phi::DenseTensor> out_tensors{*GetDenseTensor(*out)};
+  process_group->AllGather(in_tensors, out_tensors)->Synchronize();
+}
+
+}  // namespace
+
+CastCommHook::CastCommHook(phi::DataType comm_dtype)
+    : comm_dtype_(comm_dtype) {
+  PADDLE_ENFORCE_EQ(comm_dtype_ == phi::DataType::FLOAT16 ||
+                        comm_dtype_ == phi::DataType::BFLOAT16,
+                    true,
+                    common::errors::InvalidArgument(
+                        "CastCommHook only casts to float16 or bfloat16, but "
+                        "got %s.",
+                        comm_dtype_));
+}
+
+void CastCommHook::Reduce(ProcessGroup *process_group,
+                          size_t group_index UNUSED,
+                          const std::vector<IntArray> &shapes UNUSED,
+                          paddle::Tensor *contents) {
+  const phi::DataType dtype = contents->dtype();
+  if (!IsFloatingPoint(dtype)) {
+    AllReduceSum(process_group, *contents);
+    return;
+  }
+  // The gradients are divided by nranks before the cast, so the sum does not
+  // overflow float16 more than the gradients of a single rank.
+  paddle::Tensor compressed =
+      paddle::experimental::cast(*contents, comm_dtype_);
+  AllReduceSum(process_group, compressed);
+  *contents = paddle::experimental::cast(compressed, dtype);
+}
+
+std::string CastCommHook::Name() const {
+  return "cast_" + phi::DataTypeToString(comm_dtype_);
+}
+
+PowerSGDCommHook::PowerSGDCommHook(int matrix_approximation_rank,
+                                   int start_iter)
+    : matrix_approximation_rank_(matrix_approximation_rank),
+      start_iter_(start_iter) {
+  PADDLE_ENFORCE_GT(matrix_approximation_rank_,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The matrix approximation rank of PowerSGD should be "
+                        "positive, but got %d.",
+                        matrix_approximation_rank_));
+}
+
+void PowerSGDCommHook::Reduce(ProcessGroup *process_group,
+                              size_t group_index,
+                              const std::vector<IntArray> &shapes,
+                              paddle::Tensor *contents) {
+  const phi::DataType dtype = contents->dtype();
+  const phi::Place place = contents->place();
+  const int64_t length = contents->numel();
+
+  // Each gradient is viewed as a matrix of its first dim by the others, and
+  // is compressed only if P and Q are smaller than the matrix.
+  std::vector<int64_t> lengths, rows, cols, ranks;
+  int64_t q_length = 0;
+  for (const auto &shape : shapes) {
+    int64_t numel = 1;
+    for (int64_t dim : shape.GetData()) numel *= dim;
+    lengths.push_back(numel);
+    const int64_t row = shape.size() >= 2 ? shape[0] : 0;
+    const int64_t col = row > 0 ? numel / row : 0;
+    const int64_t rank = std::min<int64_t>(
+        {static_cast<int64_t>(matrix_approximation_rank_), row, col});
+    const bool compressible = row > 0 && (row + col) * rank < numel;
+    rows.push_back(row);
+    cols.push_back(col);
+    ranks.push_back(compressible ? rank : 0);
+    q_length += col * ranks.back();
+  }
+  PADDLE_ENFORCE_EQ(
+      std::accumulate(lengths.begin(), lengths.end(), int64_t{0}),
+      length,
+      common::errors::InvalidArgument(
+          "The shapes of group %d do not add up to its %d gradients.",
+          group_index,
+          length));
+
+  State &state = states_[group_index];
+  // The groups are rebuilt with other sizes.
+  if (state.length != length) {
+    state = State();
+    state.length = length;
+  }
+  const bool compress =
+      IsFloatingPoint(dtype) && state.iter >= start_iter_ && q_length > 0;
+  ++state.iter;
+  if (!compress) {
+    AllReduceSum(process_group, *contents);
+    return;
+  }
+
+  paddle::Tensor flat = *contents;
+  if (state.error.initialized()) {
+    flat = paddle::experimental::add(flat, state.error);
+  }
+  std::vector<paddle::Tensor> grads =
+      paddle::experimental::split(flat, IntArray(lengths), 0);
+  if (!state.q.initialized()) {
+    // The same seed on all ranks gives the same initial Q.
+    state.q = paddle::experimental::gaussian(IntArray({q_length}),
+                                             0.0,
+                                             1.0,
+                                             static_cast<int>(group_index) + 1,
+                                             dtype,
+                                             place);
+  }
+
+  // The gradients left uncompressed are all-reduced together, and so are the
+  // P and the Q of the compressed ones.
+  std::vector<size_t> compressed, uncompressed;
+  std::vector<int64_t> p_lengths, q_lengths;
+  for (size_t i = 0; i < grads.size(); ++i) {
+    if (ranks[i] > 0) {
+      compressed.push_back(i);
+      p_lengths.push_back(rows[i] * ranks[i]);
+      q_lengths.push_back(cols[i] * ranks[i]);
+    } else {
+      uncompressed.push_back(i);
+    }
+  }
+  std::vector<paddle::Tensor> matrices, qs, ps;
+  std::vector<paddle::Tensor> qs_flat =
+      paddle::experimental::split(state.q, IntArray(q_lengths), 0);
+  for (size_t j = 0; j < compressed.size(); ++j) {
+    const size_t i = compressed[j];
+    matrices.push_back(
+        paddle::experimental::reshape(grads[i], IntArray({rows[i], cols[i]})));
+    qs.push_back(paddle::experimental::reshape(
+        qs_flat[j], IntArray({cols[i], ranks[i]})));
+    ps.push_back(paddle::experimental::reshape(
+        paddle::experimental::matmul(matrices[j], qs[j]),
+        IntArray({p_lengths[j]})));
+  }
+  paddle::Tensor p_flat = paddle::experimental::concat(ps, 0);
+  AllReduceSum(process_group, p_flat);
+  ps = paddle::experimental::split(p_flat, IntArray(p_lengths), 0);
+  for (size_t j = 0; j < compressed.size(); ++j) {
+    const size_t i = compressed[j];
+    ps[j] = std::get<0>(paddle::experimental::qr(
+        paddle::experimental::reshape(ps[j], IntArray({rows[i], ranks[i]})),
+        "reduced"));
+    qs_flat[j] = paddle::experimental::reshape(
+        paddle::experimental::matmul(
+            matrices[j], ps[j], /*transpose_x=*/true, /*transpose_y=*/false),
+        IntArray({q_lengths[j]}));
+  }
+  paddle::Tensor q_flat = paddle::experimental::concat(qs_flat, 0);
+  AllReduceSum(process_group, q_flat);
+  // Q of this step warm starts the power iteration of the next step.
+  state.q = q_flat;
+  qs_flat = paddle::experimental::split(q_flat, IntArray(q_lengths), 0);
+
+  std::vector<paddle::Tensor> reduced(grads.size()), errors(grads.size());
+  // Each rank keeps its share of the error, so the errors of all ranks sum up
+  // to the error of the reduced gradients.
+  const double nranks = static_cast<double>(process_group->GetSize());
+  for (size_t j = 0; j < compressed.size(); ++j) {
+    const size_t i = compressed[j];
+    reduced[i] = paddle::experimental::reshape(
+        paddle::experimental::matmul(
+            ps[j],
+            paddle::experimental::reshape(qs_flat[j],
+                                          IntArray({cols[i], ranks[i]})),
+            /*transpose_x=*/false,
+            /*transpose_y=*/true),
+        IntArray({lengths[i]}));
+    errors[i] = paddle::experimental::subtract(
+        grads[i],
+        paddle::experimental::scale(reduced[i], 1.0 / nranks, 0.0, true));
+  }
+  if (!uncompressed.empty()) {
+    std::vector<paddle::Tensor> exact;
+    std::vector<int64_t> exact_lengths;
+    for (size_t i : uncompressed) {
+      exact.push_back(grads[i]);
+      exact_lengths.push_back(lengths[i]);
+    }
+    paddle::Tensor exact_flat = paddle::experimental::concat(exact, 0);
+    AllReduceSum(process_group, exact_flat);
+    exact = paddle::experimental::split(exact_flat, IntArray(exact_lengths), 0);
+    for (size_t j = 0; j < uncompressed.size(); ++j) {
+      const size_t i = uncompressed[j];
+      reduced[i] = exact[j];
+      errors[i] = paddle::experimental::full(
+          IntArray({lengths[i]}), 0.0, dtype, place);
+    }
+  }
+  state.error = paddle::experimental::concat(errors, 0);
+  *contents = paddle::experimental::concat(reduced, 0);
+}
+
+std::string PowerSGDCommHook::Name() const {
+  return "powersgd_rank" + std::to_string(matrix_approximation_rank_);
+}
+
+TopKCommHook::TopKCommHook(double ratio) : ratio_(ratio) {
+  PADDLE_ENFORCE_EQ(ratio_ > 0 && ratio_ <= 1,
+                    true,
+                    common::errors::InvalidArgument(
+                        "The ratio of TopKCommHook should be in (0, 1], but "
+                        "got %f.",
+                        ratio_));
+}
+
+void TopKCommHook::Reduce(ProcessGroup *process_group,
+                          size_t group_index,
+                          const std::vector<IntArray> &shapes UNUSED,
+                          paddle::Tensor *contents) {
+  const phi::DataType dtype = contents->dtype();
+  const phi::Place place = contents->place();
+  const int64_t length = contents->numel();
+  const int64_t k =
+      std::max<int64_t>(static_cast<int64_t>(ratio_ * length), 1);
+  // The values are sent with their indices, it does not pay off for more
+  // than half of the gradients.
+  if (!IsFloatingPoint(dtype) || 2 * k >= length) {
+    AllReduceSum(process_group, *contents);
+    return;
+  }
+
+  paddle::Tensor flat = *contents;
+  auto error = errors_.find(group_index);
+  if (error != errors_.end() && error->second.numel() == length) {
+    flat = paddle::experimental::add(flat, error->second);
+  }
+  paddle::Tensor indices =
+      std::get<1>(paddle::experimental::topk(paddle::experimental::abs(flat),
+                                             k,
+                                             /*axis=*/0,
+                                             /*largest=*/true,
+                                             /*sorted=*/false));
+  paddle::Tensor values = paddle::experimental::gather(flat, indices, 0);
+
+  const int64_t nranks = process_group->GetSize();
+  paddle::Tensor all_indices = paddle::experimental::empty(
+      IntArray({nranks * k}), indices.dtype(), place);
+  paddle::Tensor all_values =
+      paddle::experimental::empty(IntArray({nranks * k}), dtype, place);
+  AllGather(process_group, indices, &all_indices);
+  AllGather(process_group, values, &all_values);
+
+  // The values of the same index from different ranks are summed up.
+  paddle::Tensor reduced = paddle::experimental::scatter(
+      paddle::experimental::full(IntArray({length}), 0.0, dtype, place),
+      all_indices,
+      all_values,
+      /*overwrite=*/false);
+  errors_[group_index] = paddle::experimental::scatter(
+      flat,
+      indices,
+      paddle::experimental::full(IntArray({k}), 0.0, dtype, place),
+      /*overwrite=*/true);
+  *contents = reduced;
+}
+
+std::string TopKCommHook::Name() const {
+  return "topk_" + std::to_string(ratio_);
+}
+
+}  //  namespace distributed
+}  //  namespace paddle
@@ -0,0 +1,127 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/distributed/collective/process_group.h"
+#include "paddle/phi/api/include/tensor.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/common/int_array.h"
+
+namespace paddle {
+namespace distributed {
+
+using IntArray = paddle::experimental::IntArrayBase<paddle::Tensor>;
+
+/**
+ * A communication hook replaces the fused all-reduce of the dense groups of
+ * EagerReducer, e.g. to compress the gradients before sending them.
+ *
+ * Reduce takes the fused gradients of a group, already divided by nranks, with
+ * the shapes of the gradients in the order they are fused, and replaces them
+ * with the reduced ones. It is called for the groups in the
+ * same order on all ranks, one group at a time, so the state of a hook can be
+ * kept by group_index without locking.
+ */
+class CommHook {
+ public:
+  virtual ~CommHook() = default;
+
+  virtual void Reduce(ProcessGroup* process_group,
+                      size_t group_index,
+                      const std::vector<IntArray>& shapes,
+                      paddle::Tensor* contents) = 0;
+
+  virtual std::string Name() const = 0;
+};
+
+// Casts the gradients to float16 or bfloat16 for the all-reduce, which halves
+// the traffic of float32 gradients.
+class CastCommHook : public CommHook {
+ public:
+  explicit CastCommHook(phi::DataType comm_dtype);
+
+  void Reduce(ProcessGroup* process_group,
+              size_t group_index,
+              const std::vector<IntArray>& shapes,
+              paddle::Tensor* contents) override;
+
+  std::string Name() const override;
+
+ private:
+  const phi::DataType comm_dtype_;
+};
+
+/**
+ * PowerSGD, https://arxiv.org/abs/1905.13514. The gradient of each parameter
+ * is viewed as a matrix M of its first dim by the others, and approximated by
+ * P * Q^T of the given rank, so only P and Q are all-reduced. The P and the Q
+ * of all the parameters of a group are all-reduced together. The error of the
+ * approximation is added to the gradients of the next step.
+ *
+ * The first start_iter steps of each group are all-reduced uncompressed,
+ * which is known to help the convergence. The vectors and the matrices too
+ * small to gain from the compression are always all-reduced uncompressed, in
+ * one all-reduce per group.
+ */
+class PowerSGDCommHook : public CommHook {
+ public:
+  PowerSGDCommHook(int matrix_approximation_rank, int start_iter);
+
+  void Reduce(ProcessGroup* process_group,
+              size_t group_index,
+              const std::vector<IntArray>& shapes,
+              paddle::Tensor* contents) override;
+
+  std::string Name() const override;
+
+ private:
+  // The error of the fused gradients and the Q of the compressed ones, in
+  // the order of the parameters.
+  struct State {
+    int64_t length{0};
+    int64_t iter{0};
+    paddle::Tensor error;
+    paddle::Tensor q;
+  };
+
+  const int matrix_approximation_rank_;
+  const int start_iter_;
+  std::unordered_map<size_t, State> states_;
+};
+
+// Sends the ratio of the gradients with the largest magnitudes and their
+// indices, the others are added to the gradients of the next step.
+class TopKCommHook : public CommHook {
+ public:
+  explicit TopKCommHook(double ratio);
+
+  void Reduce(ProcessGroup* process_group,
+              size_t group_index,
+              const std::vector<IntArray>& shapes,
+              paddle::Tensor* contents) override;
+
+  std::string Name() const override;
+
+ private:
+  const double ratio_;
+  std::unordered_map<size_t, paddle::Tensor> errors_;
+};
+
+}  //  namespace distributed
+}  //  namespace paddle
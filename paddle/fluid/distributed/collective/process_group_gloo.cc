@@ -30,10 +30,13 @@
 #include "paddle/fluid/distributed/collective/common.h"
 #include "paddle/fluid/distributed/collective/process_group_gloo.h"
 #include "paddle/phi/core/distributed/comm_context_manager.h"
+#include "paddle/phi/core/distributed/utils.h"
 #include "paddle/phi/core/enforce.h"
 
 namespace paddle::distributed {
 
+using phi::distributed::CheckSizeOnEachRank;
+
 #ifdef _WIN32
 #define GENERATE_FUNC(type, func, ...)       \
   switch (type) {                            \
@@ -467,6 +470,84 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllGather(
   return task;
 }
 
+class AllToAllGlooTask : public ProcessGroupGloo::GlooTask {
+ public:
+  AllToAllGlooTask(int rank,
+                   phi::distributed::GlooCommContext* comm_context,
+                   const phi::DenseTensor& input,
+                   phi::DenseTensor* output,
+                   const std::vector<int64_t>& out_numel_each_rank,
+                   const std::vector<int64_t>& in_numel_each_rank,
+                   uint32_t tag)
+      : ProcessGroupGloo::GlooTask(rank, {input}, CommType::ALLTOALL),
+        _comm_context(comm_context),
+        _input(input),
+        _output(output),
+        _out_numel_each_rank(out_numel_each_rank),
+        _in_numel_each_rank(in_numel_each_rank),
+        _tag(tag) {}
+
+  void Run() override {
+    _comm_context->AllToAll(
+        _output, _input, _out_numel_each_rank, _in_numel_each_rank, _tag);
+  }
+
+ private:
+  phi::distributed::GlooCommContext* _comm_context;
+  phi::DenseTensor _input;
+  phi::DenseTensor* _output;
+  std::vector<int64_t> _out_numel_each_rank;
+  std::vector<int64_t> _in_numel_each_rank;
+  uint32_t _tag;
+};
+
+std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllToAll(
+    phi::DenseTensor* out_tensor,
+    const phi::DenseTensor& in_tensor,
+    const std::vector<int64_t>& out_size_each_rank,
+    const std::vector<int64_t>& in_size_each_rank,
+    bool sync_op) {
+  CheckTensorContiguous(in_tensor);
+  CheckTensorContiguous(*out_tensor);
+
+  const phi::DDim& out_dim = out_tensor->dims();
+  const phi::DDim& in_dim = in_tensor.dims();
+  CheckSizeOnEachRank(out_dim, out_size_each_rank, size_);
+  CheckSizeOnEachRank(in_dim, in_size_each_rank, size_);
+
+  // The sizes are in rows of dim 0, gloo takes the numbers of elements.
+  const auto ToNumel = [](const std::vector<int64_t>& size_each_rank,
+                          int64_t row_size) {
+    std::vector<int64_t> numel_each_rank;
+    numel_each_rank.reserve(size_each_rank.size());
+    for (int64_t size : size_each_rank) {
+      numel_each_rank.push_back(size * row_size);
+    }
+    return numel_each_rank;
+  };
+  // A tensor with no rows sends or receives nothing, its sizes are all 0.
+  const auto RowSize = [](const phi::DenseTensor& tensor) -> int64_t {
+    const int64_t rows = tensor.dims()[0];
+    return rows == 0 ? 0 : tensor.numel() / rows;
+  };
+  const int64_t out_row_size = RowSize(*out_tensor);
+  const int64_t in_row_size = RowSize(in_tensor);
+
+  std::shared_ptr<AllToAllGlooTask> task;
+  auto tag = next_tag();
+  auto comm_context = this->GetCommContext();
+  task = std::make_shared<AllToAllGlooTask>(
+      rank_,
+      comm_context,
+      in_tensor,
+      out_tensor,
+      ToNumel(out_size_each_rank, out_row_size),
+      ToNumel(in_size_each_rank, in_row_size),
+      tag);
+  task->Run();
+  return task;
+}
+
 class ReduceGlooTask : public ProcessGroupGloo::GlooTask {
  public:
   ReduceGlooTask(int rank,
@@ -534,6 +615,51 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Reduce(
   return Reduce(&outputs[0], inputs[0], opts, true);
 }
 
+class ReduceScatterGlooTask : public ProcessGroupGloo::GlooTask {
+ public:
+  ReduceScatterGlooTask(int rank,
+                        phi::distributed::GlooCommContext* comm_context,
+                        const phi::DenseTensor& input,
+                        phi::DenseTensor* output,
+                        ReduceOp reduce_op,
+                        uint32_t tag)
+      : ProcessGroupGloo::GlooTask(rank, {input}, CommType::REDUCE_SCATTER),
+        _comm_context(comm_context),
+        _input(input),
+        _output(output),
+        _reduce_op(reduce_op),
+        _tag(tag) {}
+
+  void Run() override {
+    _comm_context->ReduceScatter(
+        _output, _input, static_cast<int>(_reduce_op), _tag);
+  }
+
+ private:
+  phi::distributed::GlooCommContext* _comm_context;
+  phi::DenseTensor _input;
+  phi::DenseTensor* _output;
+  const ReduceOp _reduce_op;
+  uint32_t _tag;
+};
+
+std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::ReduceScatter(
+    phi::DenseTensor* out_tensor,
+    const phi::DenseTensor& in_tensor,
+    const ReduceScatterOptions& opts,
+    bool sync_op) {
+  CheckTensorContiguous(in_tensor);
+  CheckTensorContiguous(*out_tensor);
+
+  std::shared_ptr<ReduceScatterGlooTask> task;
+  auto tag = next_tag();
+  auto comm_context = this->GetCommContext();
+  task = std::make_shared<ReduceScatterGlooTask>(
+      rank_, comm_context, in_tensor, out_tensor, opts.reduce_op, tag);
+  task->Run();
+  return task;
+}
+
 class ScatterGlooTask : public ProcessGroupGloo::GlooTask {
  public:
   ScatterGlooTask(int rank,
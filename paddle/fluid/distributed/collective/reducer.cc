@@ -25,7 +25,8 @@ namespace paddle {
 namespace distributed {
 
 static bool IsStreamSafeAllocator() {
-  return (FLAGS_allocator_strategy == "auto_growth" &&
+  return ((FLAGS_allocator_strategy == "auto_growth" ||
+           FLAGS_allocator_strategy == "auto_growth_slab") &&
           FLAGS_use_stream_safe_cuda_allocator);
 }
 
@@ -970,7 +971,16 @@ void EagerReducer::MarkGroupReady(size_t group_index) {
   for (; next_group_ < groups_.size() && groups_[next_group_].pending_ == 0;
        ++next_group_) {
     UNUSED auto &group = groups_[next_group_];
-    if (group.is_sparse_) {
+    if (group.is_sparse_ && comm_hook_pool_ && comm_hook_) {
+      // The collectives of the process group are issued in one order on all
+      // ranks only if they all run in the comm hook thread, so the sparse
+      // groups are reduced there too, after the dense groups before them.
+      const int curr_group_index = static_cast<int>(next_group_);
+      group.hook_future =
+          comm_hook_pool_->Run([this, &group, curr_group_index]() {
+            AllReduceSparse(&group, curr_group_index);
+          });
+    } else if (group.is_sparse_) {
       AllReduceSparse(&group, static_cast<int>(next_group_));
     } else {
       FusedAllReduceSchedule(&group, static_cast<int>(next_group_));
@@ -1059,11 +1069,30 @@ void EagerReducer::ProcessUnusedDenseVars() {
   }
 }
 
+void EagerReducer::RegisterCommHook(std::shared_ptr<CommHook> comm_hook) {
+  PADDLE_ENFORCE_EQ(groups_need_finalize_,
+                    false,
+                    common::errors::PreconditionNotMet(
+                        "The comm hook can't be registered during backward."));
+  comm_hook_ = std::move(comm_hook);
+  if (comm_hook_ && phi::is_cpu_place(inner_place_) && !comm_hook_pool_) {
+    comm_hook_pool_ = std::make_unique<phi::ThreadPool>(1);
+  }
+  VLOG(3) << "Register comm hook "
+          << (comm_hook_ ? comm_hook_->Name() : std::string("none"));
+}
+
 void EagerReducer::FinalizeBackward() {
   groups_need_finalize_ = false;
   grad_need_hooks_ = false;
   for (auto &group : groups_) {
-    if (!group.is_sparse_) {
+    if (group.hook_future.valid()) {
+      group.hook_future.get();
+    }
+    if (!group.is_sparse_ && comm_hook_) {
+      auto *default_ctx = phi::DeviceContextPool::Instance().Get(inner_place_);
+      group.SplitTensors(*default_ctx);
+    } else if (!group.is_sparse_) {
       group.task->Synchronize();
       if (!IsStreamSafeAllocator()) {
         auto *default_ctx =
@@ -1098,6 +1127,11 @@ void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
   paddle::experimental::scale_(
       group->dense_contents_, 1.0 / nranks_, 0.0, false);  // NOLINT
 
+  if (comm_hook_) {
+    RunCommHook(group, curr_group_index);
+    return;
+  }
+
   // all_reduce
   std::vector<Tensor> reduce_tensors = {group->dense_contents_};
   std::vector<phi::DenseTensor> in_out;
@@ -1119,6 +1153,27 @@ void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
   }
 }
 
+void EagerReducer::RunCommHook(EagerGroup *group,
+                               const int curr_group_index) {
+  VLOG(3) << "group [" << curr_group_index << "] start "
+          << comm_hook_->Name() << " comm hook.";
+  auto comm_hook = comm_hook_;
+  auto process_group = process_group_;
+  auto run = [comm_hook, process_group, group, curr_group_index]() {
+    comm_hook->Reduce(process_group.get(),
+                      curr_group_index,
+                      group->origin_shapes_,
+                      &group->dense_contents_);
+  };
+  if (comm_hook_pool_) {
+    // The groups are reduced in the order they are ready, which is the same
+    // on all ranks, and the backward goes on meanwhile.
+    group->hook_future = comm_hook_pool_->Run(run);
+  } else {
+    run();
+  }
+}
+
 void EagerReducer::AllReduceSparse(EagerGroup *group,
                                    const int curr_group_index) {
   // div nranks
@@ -14,9 +14,12 @@
 
 #pragma once
 
+#include <future>
 #include <map>
+#include <memory>
 #include <vector>
 
+#include "paddle/fluid/distributed/collective/comm_hook.h"
 #include "paddle/fluid/distributed/collective/process_group.h"
 #include "paddle/fluid/eager/accumulation/accumulation_node.h"
 #include "paddle/fluid/eager/api/utils/hook_utils.h"
@@ -27,6 +30,7 @@
 #include "paddle/phi/api/include/tensor.h"
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_info.h"
+#include "paddle/phi/core/threadpool.h"
 #include "paddle/phi/kernels/funcs/concat_and_split_functor.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 #include "paddle/utils/string/string_helper.h"
@@ -68,6 +72,8 @@ class EagerGroup {
 
   // help to sync
   std::shared_ptr<ProcessGroup::Task> task;
+  // help to sync when the group is reduced in the comm hook thread
+  std::future<void> hook_future;
 
   // context is used to select the stream for concat
   void ConcatTensors(const phi::Place &);
@@ -107,11 +113,13 @@ class EagerReducer {
   void MarkVarReady(const size_t var_index, const bool is_used_var);
   void MarkGroupReady(const size_t group_index);
   void FusedAllReduceSchedule(EagerGroup *group, const int curr_group_index);
+  void RunCommHook(EagerGroup *group, const int curr_group_index);
   void AllReduceSparse(EagerGroup *group, const int curr_group_index);
   void FinalizeBackward();
   void TraverseBackwardGraph(const std::vector<Tensor> &outputs);
   void ProcessUnusedDenseVars();
   bool HasGrad(size_t var_index);
+  void RegisterCommHook(std::shared_ptr<CommHook> comm_hook);
 
  private:
   std::vector<Tensor> tensors_;
@@ -139,6 +147,12 @@ class EagerReducer {
   bool find_unused_vars_once_{true};
   bool groups_need_finalize_{false};
   Tensor global_used_vars_;
+
+  std::shared_ptr<CommHook> comm_hook_;
+  // On CPU, the hooks and the all-reduce of the sparse groups run in this
+  // thread in the order of the groups, so the communication of a group
+  // overlaps the backward of the next groups.
+  std::unique_ptr<phi::ThreadPool> comm_hook_pool_;
 };
 
 }  //  namespace distributed
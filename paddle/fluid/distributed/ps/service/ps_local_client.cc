@@ -21,7 +21,8 @@ int32_t PsLocalClient::Initialize() {
   TableManager::Instance().Initialize();
   for (int i = 0; i < downpour_param.downpour_table_param_size(); ++i) {
     auto* table = CREATE_PSCORE_CLASS(
-        Table, downpour_param.downpour_table_param(i).table_class());
+        Table,
+        TableManager::TableClass(downpour_param.downpour_table_param(i)));
     table->SetShard(0, 1);
     table->Initialize(downpour_param.downpour_table_param(i),
                       _config.fs_client_param());
@@ -79,7 +79,8 @@ int32_t PSServer::Configure(
 
   for (int i = 0; i < downpour_param.downpour_table_param_size(); ++i) {
     auto *table = CREATE_PSCORE_CLASS(
-        Table, downpour_param.downpour_table_param(i).table_class());
+        Table,
+        TableManager::TableClass(downpour_param.downpour_table_param(i)));
 
     if (downpour_param.downpour_table_param(i).table_class() ==
         "BarrierTable") {
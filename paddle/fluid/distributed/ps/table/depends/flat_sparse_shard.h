@@ -0,0 +1,454 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>         // NOLINT
+#include <shared_mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace distributed {
+
+static const int FLAT_SPARSE_SHARD_STRIPE_NUM_BITS = 4;
+static const size_t FLAT_SPARSE_SHARD_STRIPE_NUM =
+    static_cast<size_t>(1) << FLAT_SPARSE_SHARD_STRIPE_NUM_BITS;
+
+// Fixed-stride float storage for feature values. Values are carved out of
+// large contiguous chunks, so neighbouring features share cache lines and
+// pages, and a value never moves once it is allocated.
+class FlatValueArena {
+ public:
+  explicit FlatValueArena(size_t stride, size_t chunk_values = 4096)
+      : _stride(stride), _chunk_values(chunk_values) {}
+  FlatValueArena(const FlatValueArena&) = delete;
+
+  size_t stride() const { return _stride; }
+
+  float* acquire() {
+    if (!_free_values.empty()) {
+      float* x = _free_values.back();
+      _free_values.pop_back();
+      return x;
+    }
+    if (_chunks.empty() || _chunk_used == _chunk_values) {
+      _chunks.emplace_back(new float[_stride * _chunk_values]);
+      _chunk_used = 0;
+    }
+    return _chunks.back().get() + _stride * _chunk_used++;
+  }
+  void release(float* x) { _free_values.push_back(x); }
+
+ private:
+  size_t _stride;
+  size_t _chunk_values;
+  size_t _chunk_used{0};
+  std::vector<std::unique_ptr<float[]>> _chunks;
+  std::vector<float*> _free_values;
+};
+
+// A sparse table shard backed by flat open-addressing tables with linear
+// probing. The shard is split into FLAT_SPARSE_SHARD_STRIPE_NUM stripes, each
+// with its own slot array, value arenas and reader-writer lock, so pulls can
+// read one stripe while a push is updating another one, or the same one in
+// turn.
+//
+// Unlike SparseTableShard, values are not node allocated objects, they are
+// float spans stored inline in per-size arenas. They are accessed through
+// callbacks that run under the stripe lock, a pointer to a value must not be
+// kept after the callback returns.
+template <class KEY>
+class alignas(64) FlatSparseTableShard {
+ public:
+  class ValueRef;
+
+ private:
+  enum SlotState : uint32_t { kEmpty = 0, kFull = 1, kDeleted = 2 };
+
+  struct Slot {
+    KEY key;
+    float* data;
+    uint32_t size;
+    uint32_t state;
+  };
+
+  struct Stripe {
+    mutable std::shared_mutex mutex;
+    std::unique_ptr<Slot[]> slots;
+    // Published separately so that prefetch hints can be computed without the
+    // lock, a stale value only makes the hint useless.
+    std::atomic<Slot*> slots_hint{nullptr};
+    std::atomic<size_t> mask_hint{0};
+    size_t capacity{0};
+    size_t size{0};
+    size_t deleted{0};
+    std::vector<std::unique_ptr<FlatValueArena>> arenas;
+
+    FlatValueArena* arena(size_t stride) {
+      for (auto& arena : arenas) {
+        if (arena->stride() == stride) {
+          return arena.get();
+        }
+      }
+      arenas.emplace_back(new FlatValueArena(stride));
+      return arenas.back().get();
+    }
+  };
+
+ public:
+  // A mutable view of one value, only valid inside the callback it is passed
+  // to.
+  class ValueRef {
+   public:
+    float* data() { return _slot->data; }
+    size_t size() const { return _slot->size; }
+    // Moves the value to the arena of the new size, the common prefix is
+    // preserved and new elements are left uninitialized.
+    void resize(size_t size) {
+      if (size == _slot->size) {
+        return;
+      }
+      float* data = size > 0 ? _stripe->arena(size)->acquire() : nullptr;
+      size_t copy_size = std::min<size_t>(size, _slot->size);
+      if (copy_size > 0) {
+        memcpy(data, _slot->data, copy_size * sizeof(float));
+      }
+      if (_slot->size > 0) {
+        _stripe->arena(_slot->size)->release(_slot->data);
+      }
+      _slot->data = data;
+      _slot->size = static_cast<uint32_t>(size);
+    }
+
+   private:
+    friend class FlatSparseTableShard;
+    ValueRef(Stripe* stripe, Slot* slot) : _stripe(stripe), _slot(slot) {}
+    Stripe* _stripe;
+    Slot* _slot;
+  };
+
+  FlatSparseTableShard() = default;
+  FlatSparseTableShard(const FlatSparseTableShard&) = delete;
+
+  size_t size() const {
+    size_t total = 0;
+    for (auto& stripe : _stripes) {
+      std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+      total += stripe.size;
+    }
+    return total;
+  }
+  bool empty() const { return size() == 0; }
+  size_t bucket_count() const { return FLAT_SPARSE_SHARD_STRIPE_NUM; }
+  void set_max_load_factor(float x) {
+    PADDLE_ENFORCE_EQ(
+        x > 0.0f && x < 1.0f,
+        true,
+        common::errors::InvalidArgument(
+            "The max load factor of an open addressing shard should be in "
+            "(0, 1), but received %f.",
+            x));
+    _max_load_factor = x;
+  }
+
+  void clear() {
+    for (auto& stripe : _stripes) {
+      std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+      stripe.slots.reset();
+      stripe.slots_hint.store(nullptr, std::memory_order_relaxed);
+      stripe.mask_hint.store(0, std::memory_order_relaxed);
+      stripe.capacity = 0;
+      stripe.size = 0;
+      stripe.deleted = 0;
+      stripe.arenas.clear();
+    }
+  }
+
+  // Hint the slot of key into cache, used to overlap the probes of a batch.
+  void prefetch(const KEY& key) const {
+    size_t hash = hash_key(key);
+    const Stripe& stripe = _stripes[compute_stripe(hash)];
+    const Slot* slots = stripe.slots_hint.load(std::memory_order_relaxed);
+    if (slots != nullptr) {
+      __builtin_prefetch(
+          slots + (hash & stripe.mask_hint.load(std::memory_order_relaxed)));
+    }
+  }
+
+  // Calls fn(const float* data, size_t size) under a shared lock if key
+  // exists. Returns whether key was found.
+  template <class FUNC>
+  bool find(const KEY& key, FUNC&& fn) const {
+    size_t hash = hash_key(key);
+    const Stripe& stripe = _stripes[compute_stripe(hash)];
+    std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+    const Slot* slot = find_slot(stripe, key, hash);
+    if (slot == nullptr) {
+      return false;
+    }
+    fn(static_cast<const float*>(slot->data), static_cast<size_t>(slot->size));
+    return true;
+  }
+
+  bool contains(const KEY& key) const {
+    return find(key, [](const float*, size_t) {});
+  }
+
+  // Calls fn(ValueRef& value, bool created) under an exclusive lock. A
+  // missing key is inserted with an uninitialized value of init_size first.
+  template <class FUNC>
+  void upsert(const KEY& key, size_t init_size, FUNC&& fn) {
+    size_t hash = hash_key(key);
+    Stripe& stripe = _stripes[compute_stripe(hash)];
+    std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+    bool created = false;
+    Slot* slot = find_or_insert_slot(&stripe, key, hash, init_size, &created);
+    ValueRef value(&stripe, slot);
+    fn(value, created);
+  }
+
+  // Like upsert, but a missing key is only inserted if create() returns true,
+  // which is decided under the same lock. Returns whether fn was called.
+  template <class CREATE, class FUNC>
+  bool upsert_if(const KEY& key, size_t init_size, CREATE&& create, FUNC&& fn) {
+    size_t hash = hash_key(key);
+    Stripe& stripe = _stripes[compute_stripe(hash)];
+    std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+    bool created = false;
+    Slot* slot = const_cast<Slot*>(find_slot(stripe, key, hash));
+    if (slot == nullptr) {
+      if (!create()) {
+        return false;
+      }
+      slot = find_or_insert_slot(&stripe, key, hash, init_size, &created);
+    }
+    ValueRef value(&stripe, slot);
+    fn(value, created);
+    return true;
+  }
+
+  // Like upsert, but does nothing and returns false if key is missing.
+  template <class FUNC>
+  bool update(const KEY& key, FUNC&& fn) {
+    size_t hash = hash_key(key);
+    Stripe& stripe = _stripes[compute_stripe(hash)];
+    std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+    Slot* slot = const_cast<Slot*>(find_slot(stripe, key, hash));
+    if (slot == nullptr) {
+      return false;
+    }
+    ValueRef value(&stripe, slot);
+    fn(value, false);
+    return true;
+  }
+
+  size_t erase(const KEY& key) {
+    size_t hash = hash_key(key);
+    Stripe& stripe = _stripes[compute_stripe(hash)];
+    std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+    Slot* slot = const_cast<Slot*>(find_slot(stripe, key, hash));
+    if (slot == nullptr) {
+      return 0;
+    }
+    erase_slot(&stripe, slot);
+    return 1;
+  }
+
+  // Calls fn(const KEY& key, ValueRef& value) for every value, one stripe at
+  // a time under its exclusive lock.
+  template <class FUNC>
+  void for_each(FUNC&& fn) {
+    for (auto& stripe : _stripes) {
+      std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+      for (size_t i = 0; i < stripe.capacity; ++i) {
+        Slot* slot = &stripe.slots[i];
+        if (slot->state == kFull) {
+          ValueRef value(&stripe, slot);
+          fn(static_cast<const KEY&>(slot->key), value);
+        }
+      }
+    }
+  }
+
+  // Calls fn(const KEY& key, float* data, size_t size) for every value
+  // without holding any lock. The values of a stripe are copied under its
+  // shared lock first, so fn may be slow, e.g. write them to a file, without
+  // blocking the pushes. Changes to data are not written back.
+  template <class FUNC>
+  void for_each_snapshot(FUNC&& fn) const {
+    std::vector<KEY> keys;
+    std::vector<size_t> offsets;
+    std::vector<float> values;
+    for (auto& stripe : _stripes) {
+      keys.clear();
+      offsets.assign(1, 0);
+      values.clear();
+      {
+        std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+        for (size_t i = 0; i < stripe.capacity; ++i) {
+          const Slot& slot = stripe.slots[i];
+          if (slot.state == kFull) {
+            keys.push_back(slot.key);
+            values.insert(values.end(), slot.data, slot.data + slot.size);
+            offsets.push_back(values.size());
+          }
+        }
+      }
+      for (size_t i = 0; i < keys.size(); ++i) {
+        fn(static_cast<const KEY&>(keys[i]),
+           values.data() + offsets[i],
+           offsets[i + 1] - offsets[i]);
+      }
+    }
+  }
+
+  // Erases every value for which pred(const KEY& key, ValueRef& value)
+  // returns true. Returns the number of erased values.
+  template <class PRED>
+  size_t erase_if(PRED&& pred) {
+    size_t erased = 0;
+    for (auto& stripe : _stripes) {
+      std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+      for (size_t i = 0; i < stripe.capacity; ++i) {
+        Slot* slot = &stripe.slots[i];
+        if (slot->state != kFull) {
+          continue;
+        }
+        ValueRef value(&stripe, slot);
+        if (pred(static_cast<const KEY&>(slot->key), value)) {
+          erase_slot(&stripe, slot);
+          ++erased;
+        }
+      }
+    }
+    return erased;
+  }
+
+ private:
+  static size_t hash_key(const KEY& key) {
+    // std::hash of integers is the identity in libstdc++, which clusters
+    // badly under linear probing. Mix the bits first (murmur3 finalizer).
+    uint64_t h = static_cast<uint64_t>(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+
+  static size_t compute_stripe(size_t hash) {
+    return hash >> (sizeof(size_t) * 8 - FLAT_SPARSE_SHARD_STRIPE_NUM_BITS);
+  }
+
+  static const Slot* find_slot(const Stripe& stripe,
+                               const KEY& key,
+                               size_t hash) {
+    if (stripe.capacity == 0) {
+      return nullptr;
+    }
+    size_t mask = stripe.capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      const Slot& slot = stripe.slots[i];
+      if (slot.state == kEmpty) {
+        return nullptr;
+      }
+      if (slot.state == kFull && slot.key == key) {
+        return &slot;
+      }
+    }
+  }
+
+  Slot* find_or_insert_slot(
+      Stripe* stripe, const KEY& key, size_t hash, size_t size, bool* created) {
+    Slot* slot = const_cast<Slot*>(find_slot(*stripe, key, hash));
+    if (slot != nullptr) {
+      *created = false;
+      return slot;
+    }
+    if (static_cast<float>(stripe->size + stripe->deleted + 1) >
+        _max_load_factor * static_cast<float>(stripe->capacity)) {
+      rehash(stripe);
+    }
+    size_t mask = stripe->capacity - 1;
+    size_t i = hash & mask;
+    while (stripe->slots[i].state == kFull) {
+      i = (i + 1) & mask;
+    }
+    slot = &stripe->slots[i];
+    if (slot->state == kDeleted) {
+      --stripe->deleted;
+    }
+    slot->key = key;
+    slot->data = size > 0 ? stripe->arena(size)->acquire() : nullptr;
+    slot->size = static_cast<uint32_t>(size);
+    slot->state = kFull;
+    ++stripe->size;
+    *created = true;
+    return slot;
+  }
+
+  void erase_slot(Stripe* stripe, Slot* slot) {
+    if (slot->size > 0) {
+      stripe->arena(slot->size)->release(slot->data);
+    }
+    slot->data = nullptr;
+    slot->size = 0;
+    slot->state = kDeleted;
+    --stripe->size;
+    ++stripe->deleted;
+  }
+
+  // Grows the stripe when live values dominate, otherwise only drops the
+  // tombstones. Values stay in their arenas, only slots are moved.
+  void rehash(Stripe* stripe) {
+    size_t capacity = stripe->capacity == 0 ? 64 : stripe->capacity;
+    while (static_cast<float>(stripe->size + 1) >
+           _max_load_factor * static_cast<float>(capacity) / 2) {
+      capacity *= 2;
+    }
+    std::unique_ptr<Slot[]> slots(new Slot[capacity]);
+    memset(slots.get(), 0, capacity * sizeof(Slot));
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < stripe->capacity; ++i) {
+      const Slot& slot = stripe->slots[i];
+      if (slot.state != kFull) {
+        continue;
+      }
+      size_t j = hash_key(slot.key) & mask;
+      while (slots[j].state == kFull) {
+        j = (j + 1) & mask;
+      }
+      slots[j] = slot;
+    }
+    stripe->slots = std::move(slots);
+    stripe->capacity = capacity;
+    stripe->deleted = 0;
+    stripe->slots_hint.store(stripe->slots.get(), std::memory_order_relaxed);
+    stripe->mask_hint.store(mask, std::memory_order_relaxed);
+  }
+
+  Stripe _stripes[FLAT_SPARSE_SHARD_STRIPE_NUM];
+  float _max_load_factor{0.7f};
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,552 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/memory_flat_sparse_table.h"
+
+#include <omp.h>
+
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/common/cost_timer.h"
+#include "paddle/fluid/distributed/common/topk_calculator.h"
+#include "paddle/fluid/framework/io/fs.h"
+#include "paddle/fluid/platform/enforce.h"
+
+PD_DECLARE_bool(pserver_create_value_when_push);
+PD_DECLARE_bool(pserver_enable_create_feasign_randomly);
+PD_DECLARE_int32(pserver_table_save_max_retry);
+
+namespace paddle::distributed {
+
+namespace {
+// How many keys ahead of the current one the slot is prefetched.
+constexpr size_t kPrefetchDistance = 8;
+}  // namespace
+
+int32_t MemoryFlatSparseTable::Initialize() {
+  auto &profiler = CostProfiler::instance();
+  profiler.register_profiler("pserver_sparse_update_all");
+  profiler.register_profiler("pserver_sparse_select_all");
+  PADDLE_ENFORCE_EQ(_config.enable_revert(),
+                    false,
+                    common::errors::Unimplemented(
+                        "Patch model (enable_revert) is not supported by the "
+                        "flat open addressing sparse shard."));
+  InitializeShardNum();
+  _local_flat_shards.reset(new shard_type[_real_local_shard_num]);
+  _shards_task_pool.resize(_task_pool_size);
+  for (auto &shards_task : _shards_task_pool) {
+    shards_task.reset(new ::ThreadPool(1));
+  }
+  _shards_pull_task_pool.resize(_task_pool_size);
+  for (auto &shards_task : _shards_pull_task_pool) {
+    shards_task.reset(new ::ThreadPool(1));
+  }
+  VLOG(0) << "initalize MemoryFlatSparseTable succ";
+  return 0;
+}
+
+std::vector<std::vector<std::pair<uint64_t, int>>>
+MemoryFlatSparseTable::SplitKeys(const uint64_t *keys, size_t num) {
+  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
+      _real_local_shard_num);
+  for (size_t i = 0; i < num; ++i) {
+    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
+    task_keys[shard_id].push_back({keys[i], i});
+  }
+  return task_keys;
+}
+
+void MemoryFlatSparseTable::LoadLocalShard(int shard_id,
+                                           const std::string &file,
+                                           int load_param) {
+  size_t feature_value_size =
+      _value_accessor->GetAccessorInfo().size / sizeof(float);
+  auto &shard = _local_flat_shards[shard_id];
+  std::vector<float> data_buffer(feature_value_size);
+  LoadShardFile(file, load_param, [&](uint64_t key, char *value_str) {
+    size_t parse_size =
+        _value_accessor->ParseFromString(value_str, data_buffer.data());
+    shard.upsert(
+        key, parse_size, [&](shard_type::ValueRef &value, bool created) {
+          value.resize(parse_size);
+          memcpy(value.data(), data_buffer.data(), parse_size * sizeof(float));
+        });
+  });
+}
+
+int32_t MemoryFlatSparseTable::LoadPatch(
+    const std::vector<std::string> &file_list, int load_param) {
+  PADDLE_THROW(common::errors::Unimplemented(
+      "Patch model is not supported by the flat open addressing sparse "
+      "shard."));
+}
+
+int32_t MemoryFlatSparseTable::Save(const std::string &dirname,
+                                    const std::string &param) {
+  return SaveImpl(dirname, param, false);
+}
+
+#if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
+int32_t MemoryFlatSparseTable::Save_v2(const std::string &dirname,
+                                       const std::string &param) {
+  return SaveImpl(dirname, param, true);
+}
+#endif
+
+int32_t MemoryFlatSparseTable::SaveImpl(const std::string &dirname,
+                                        const std::string &param,
+                                        bool save_slot_feature) {
+  if (_real_local_shard_num == 0) {
+    _local_show_threshold = -1;
+    return 0;
+  }
+
+  VLOG(0) << "MemoryFlatSparseTable::save dirname: " << dirname;
+  int save_param =
+      atoi(param.c_str());  // checkpoint:0  xbox delta:1  xbox base:2
+  PADDLE_ENFORCE_NE(save_param,
+                    5,
+                    common::errors::Unimplemented(
+                        "Patch model is not supported by the flat open "
+                        "addressing sparse shard."));
+
+  // cache model
+  int64_t tk_size = LocalSize() * _config.sparse_table_cache_rate();
+  TopkCalculator tk(_real_local_shard_num, tk_size);
+
+  std::string table_path = TableDir(dirname);
+  _afs_client.remove(::paddle::string::format_string(
+      "%s/part-%03d-*", table_path.c_str(), _shard_idx));
+  if (save_slot_feature) {
+    // path to save the feasigns of the filtered slots
+    _afs_client.remove(::paddle::string::format_string(
+        "%s/slot_feature/part-%03d-*", table_path.c_str(), _shard_idx));
+  }
+  size_t file_start_idx = _avg_local_shard_num * _shard_idx;
+
+  int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
+  omp_set_num_threads(thread_num);
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    FsChannelConfig channel_config = {};
+    FsChannelConfig slot_feature_config = {};
+    const char *suffix =
+        _config.compress_in_save() && (save_param == 0 || save_param == 3)
+            ? ".gz"
+            : "";
+    channel_config.path =
+        ::paddle::string::format_string("%s/part-%03d-%05d%s",
+                                        table_path.c_str(),
+                                        _shard_idx,
+                                        file_start_idx + i,
+                                        suffix);
+    slot_feature_config.path =
+        ::paddle::string::format_string("%s/slot_feature/part-%03d-%05d%s",
+                                        table_path.c_str(),
+                                        _shard_idx,
+                                        file_start_idx + i,
+                                        suffix);
+    for (auto *config : {&channel_config, &slot_feature_config}) {
+      config->converter = _value_accessor->Converter(save_param).converter;
+      config->deconverter = _value_accessor->Converter(save_param).deconverter;
+    }
+    bool is_write_failed = false;
+    int feasign_size = 0;
+    int slot_feature_size = 0;
+    int retry_num = 0;
+    int err_no = 0;
+    int slot_feature_err_no = 0;
+    auto &shard = _local_flat_shards[i];
+    do {
+      err_no = 0;
+      slot_feature_err_no = 0;
+      feasign_size = 0;
+      slot_feature_size = 0;
+      is_write_failed = false;
+      auto write_channel =
+          _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
+      std::shared_ptr<FsWriteChannel> slot_feature_channel = nullptr;
+      if (save_slot_feature) {
+        slot_feature_channel = _afs_client.open_w(
+            slot_feature_config, 1024 * 1024 * 40, &slot_feature_err_no);
+      }
+      // The values are formatted and written without holding the stripe
+      // locks, so the pushes to the shard are not blocked by the file system.
+      shard.for_each_snapshot(
+          [&](const uint64_t &key, float *value, size_t size) {
+            if (is_write_failed) {
+              return;
+            }
+            if (_config.enable_sparse_table_cache() &&
+                (save_param == 1 || save_param == 2) &&
+                _value_accessor->Save(value, 4)) {
+              tk.push(i, _value_accessor->GetField(value, "show"));
+            }
+            if (_value_accessor->Save(value, save_param)) {
+              std::string line = ::paddle::string::format_string(
+                  "%lu %s",
+                  key,
+                  _value_accessor->ParseToString(value, size).c_str());
+              if (0 != write_channel->write_line(line)) {
+                ++retry_num;
+                is_write_failed = true;
+                LOG(ERROR) << "MemoryFlatSparseTable save prefix failed, "
+                              "retry it! path:"
+                           << channel_config.path
+                           << " , retry_num=" << retry_num;
+                return;
+              }
+              ++feasign_size;
+              if (slot_feature_channel != nullptr &&
+                  _value_accessor->SaveFilterSlot(value)) {
+                if (0 != slot_feature_channel->write_line(line)) {
+                  ++retry_num;
+                  is_write_failed = true;
+                  LOG(ERROR) << "MemoryFlatSparseTable save slot feature "
+                                "failed, retry it! path:"
+                             << slot_feature_config.path
+                             << " , retry_num=" << retry_num;
+                  return;
+                }
+                ++slot_feature_size;
+              }
+            }
+          });
+      write_channel->close();
+      if (slot_feature_channel != nullptr) {
+        slot_feature_channel->close();
+      }
+      if (err_no == -1 || slot_feature_err_no == -1) {
+        ++retry_num;
+        is_write_failed = true;
+        LOG(ERROR)
+            << "MemoryFlatSparseTable save prefix failed after write, retry "
+            << "it! path:" << channel_config.path
+            << " , retry_num=" << retry_num;
+      }
+      if (is_write_failed) {
+        _afs_client.remove(channel_config.path);
+        if (save_slot_feature) {
+          _afs_client.remove(slot_feature_config.path);
+        }
+      }
+      if (retry_num > FLAGS_pserver_table_save_max_retry) {
+        LOG(ERROR)
+            << "MemoryFlatSparseTable save prefix failed reach max limit!";
+        exit(-1);
+      }
+    } while (is_write_failed);
+    shard.for_each([&](const uint64_t &key, shard_type::ValueRef &value) {
+      _value_accessor->UpdateStatAfterSave(value.data(), save_param);
+    });
+    LOG(INFO) << "MemoryFlatSparseTable save prefix success, path: "
+              << channel_config.path << " feasign_size: " << feasign_size;
+    if (save_slot_feature) {
+      LOG(INFO) << "MemoryFlatSparseTable save slot feature success, path: "
+                << slot_feature_config.path
+                << " feasign_size: " << slot_feature_size;
+    }
+  }
+  _local_show_threshold = tk.top();
+  return 0;
+}
+
+void MemoryFlatSparseTable::WriteCacheEntries(
+    int shard_id,
+    int save_param,
+    double cache_threshold,
+    ::paddle::framework::ChannelWriter<std::pair<uint64_t, std::string>>
+        *writer) {
+  _local_flat_shards[shard_id].for_each_snapshot(
+      [&](const uint64_t &key, float *data, size_t size) {
+        if (_value_accessor->SaveCache(data, save_param, cache_threshold)) {
+          *writer << std::make_pair(key,
+                                    _value_accessor->ParseToString(data, size));
+        }
+      });
+}
+
+int64_t MemoryFlatSparseTable::LocalSize() {
+  int64_t local_size = 0;
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    local_size += _local_flat_shards[i].size();
+  }
+  return local_size;
+}
+
+int64_t MemoryFlatSparseTable::LocalMFSize() {
+  std::vector<int64_t> size_arr(_real_local_shard_num, 0);
+  std::vector<std::future<int>> tasks(_real_local_shard_num);
+  int64_t ret_size = 0;
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    tasks[shard_id] =
+        _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+            [this, shard_id, &size_arr]() -> int {
+              _local_flat_shards[shard_id].for_each(
+                  [&](const uint64_t &key, shard_type::ValueRef &value) {
+                    if (_value_accessor->HasMF(value.size())) {
+                      size_arr[shard_id] += 1;
+                    }
+                  });
+              return 0;
+            });
+  }
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    tasks[i].wait();
+  }
+  for (auto x : size_arr) {
+    ret_size += x;
+  }
+  return ret_size;
+}
+
+std::pair<int64_t, int64_t> MemoryFlatSparseTable::PrintTableStat() {
+  int64_t feasign_size = LocalSize();
+  int64_t mf_size = LocalMFSize();
+  return {feasign_size, mf_size};
+}
+
+int32_t MemoryFlatSparseTable::Pull(TableContext &context) {
+  PADDLE_ENFORCE_EQ(
+      context.value_type,
+      Sparse,
+      common::errors::InvalidArgument(
+          "The 'value_type' in context must be 'Sparse', but received %d.",
+          context.value_type));
+  PADDLE_ENFORCE_EQ(context.use_ptr,
+                    false,
+                    common::errors::Unimplemented(
+                        "Values of the flat open addressing sparse shard are "
+                        "not addressable, pull by pointer is not supported."));
+  float *pull_values = context.pull_context.values;
+  const PullSparseValue &pull_value = context.pull_context.pull_value;
+  return PullSparse(pull_values, pull_value);
+}
+
+int32_t MemoryFlatSparseTable::Push(TableContext &context) {
+  PADDLE_ENFORCE_EQ(
+      context.value_type,
+      Sparse,
+      common::errors::InvalidArgument(
+          "The 'value_type' in context must be 'Sparse', but received %d.",
+          context.value_type));
+  if (!context.use_ptr) {
+    return PushSparse(
+        context.push_context.keys, context.push_context.values, context.num);
+  } else {
+    return PushSparse(context.push_context.keys,
+                      context.push_context.ptr_values,
+                      context.num);
+  }
+}
+
+int32_t MemoryFlatSparseTable::PullSparse(float *pull_values,
+                                          const PullSparseValue &pull_value) {
+  CostTimer timer("pserver_sparse_select_all");
+  std::vector<std::future<int>> tasks(_real_local_shard_num);
+
+  const size_t value_size =
+      _value_accessor->GetAccessorInfo().size / sizeof(float);
+  size_t mf_value_size =
+      _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
+  size_t select_value_size =
+      _value_accessor->GetAccessorInfo().select_size / sizeof(float);
+
+  auto task_keys = SplitKeys(pull_value.feasigns_, pull_value.numel_);
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    tasks[shard_id] =
+        _shards_pull_task_pool[shard_id % _shards_pull_task_pool.size()]
+            ->enqueue([this,
+                       shard_id,
+                       &task_keys,
+                       value_size,
+                       pull_values,
+                       mf_value_size,
+                       select_value_size]() -> int {
+              auto &local_shard = _local_flat_shards[shard_id];
+              float data_buffer[value_size];  // NOLINT
+              float *data_buffer_ptr = data_buffer;
+
+              auto &keys = task_keys[shard_id];
+              for (size_t k = 0; k < keys.size(); ++k) {
+                if (k + kPrefetchDistance < keys.size()) {
+                  local_shard.prefetch(keys[k + kPrefetchDistance].first);
+                }
+                uint64_t key = keys[k].first;
+                size_t data_size = value_size - mf_value_size;
+                bool found = local_shard.find(
+                    key, [&](const float *data, size_t size) {
+                      data_size = size;
+                      memcpy(data_buffer_ptr, data, size * sizeof(float));
+                    });
+                if (!found) {
+                  if (FLAGS_pserver_create_value_when_push) {
+                    memset(data_buffer, 0, sizeof(float) * data_size);
+                  } else {
+                    local_shard.upsert(
+                        key,
+                        data_size,
+                        [&](shard_type::ValueRef &value, bool created) {
+                          if (created) {
+                            _value_accessor->Create(&data_buffer_ptr, 1);
+                            memcpy(value.data(),
+                                   data_buffer_ptr,
+                                   data_size * sizeof(float));
+                          } else {
+                            data_size = value.size();
+                            memcpy(data_buffer_ptr,
+                                   value.data(),
+                                   data_size * sizeof(float));
+                          }
+                        });
+                  }
+                }
+                for (size_t mf_idx = data_size; mf_idx < value_size; ++mf_idx) {
+                  data_buffer[mf_idx] = 0.0;
+                }
+                auto offset = keys[k].second;
+                float *select_data = pull_values + select_value_size * offset;
+                _value_accessor->Select(
+                    &select_data, (const float **)&data_buffer_ptr, 1);
+              }
+              return 0;
+            });
+  }
+
+  for (auto &task : tasks) {
+    task.wait();
+  }
+  return 0;
+}
+
+template <class GET_UPDATE>
+int32_t MemoryFlatSparseTable::PushSparseImpl(const uint64_t *keys,
+                                              size_t num,
+                                              GET_UPDATE get_update) {
+  CostTimer timer("pserver_sparse_update_all");
+  std::vector<std::future<int>> tasks(_real_local_shard_num);
+  auto task_keys = SplitKeys(keys, num);
+
+  const size_t value_col =
+      _value_accessor->GetAccessorInfo().size / sizeof(float);
+  size_t mf_value_col =
+      _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
+
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    tasks[shard_id] = _shards_task_pool[shard_id % _task_pool_size]->enqueue(
+        [this,
+         shard_id,
+         value_col,
+         mf_value_col,
+         &get_update,
+         &task_keys]() -> int {
+          auto &keys = task_keys[shard_id];
+          auto &local_shard = _local_flat_shards[shard_id];
+          float data_buffer[value_col];  // NOLINT
+          float *data_buffer_ptr = data_buffer;
+          for (size_t k = 0; k < keys.size(); ++k) {
+            if (k + kPrefetchDistance < keys.size()) {
+              local_shard.prefetch(keys[k + kPrefetchDistance].first);
+            }
+            uint64_t key = keys[k].first;
+            const float *update_data = get_update(keys[k].second);
+            // Whether to create a missing key is decided under the stripe
+            // lock, so a concurrent push can not create it in between.
+            local_shard.upsert_if(
+                key,
+                value_col - mf_value_col,
+                [&]() {
+                  return !FLAGS_pserver_enable_create_feasign_randomly ||
+                         _value_accessor->CreateValue(1, update_data);
+                },
+                [&](shard_type::ValueRef &feature_value, bool created) {
+                  if (created) {
+                    _value_accessor->Create(&data_buffer_ptr, 1);
+                    memcpy(feature_value.data(),
+                           data_buffer_ptr,
+                           feature_value.size() * sizeof(float));
+                  }
+                  float *value_data = feature_value.data();
+                  size_t value_size = feature_value.size();
+                  if (value_size == value_col) {  // update in place
+                    _value_accessor->Update(&value_data, &update_data, 1);
+                  } else {
+                    // update in the buffer, mf is dropped unless the
+                    // feature is extended.
+                    memcpy(data_buffer_ptr,
+                           value_data,
+                           value_size * sizeof(float));
+                    _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
+                    if (_value_accessor->NeedExtendMF(data_buffer)) {
+                      feature_value.resize(value_col);
+                      value_data = feature_value.data();
+                      _value_accessor->Create(&value_data, 1);
+                    }
+                    memcpy(value_data,
+                           data_buffer_ptr,
+                           value_size * sizeof(float));
+                  }
+                });
+          }
+          return 0;
+        });
+  }
+
+  for (auto &task : tasks) {
+    task.wait();
+  }
+  return 0;
+}
+
+int32_t MemoryFlatSparseTable::PushSparse(const uint64_t *keys,
+                                          const float *values,
+                                          size_t num) {
+  size_t update_value_col =
+      _value_accessor->GetAccessorInfo().update_size / sizeof(float);
+  return PushSparseImpl(keys, num, [values, update_value_col](int idx) {
+    return values + idx * update_value_col;
+  });
+}
+
+int32_t MemoryFlatSparseTable::PushSparse(const uint64_t *keys,
+                                          const float **values,
+                                          size_t num) {
+  return PushSparseImpl(
+      keys, num, [values](int idx) -> const float * { return values[idx]; });
+}
+
+int32_t MemoryFlatSparseTable::Shrink(const std::string &param) {
+  VLOG(0) << "MemoryFlatSparseTable::Shrink";
+  std::atomic<uint32_t> shrink_size_all{0};
+  int thread_num = _real_local_shard_num;
+  omp_set_num_threads(thread_num);
+#pragma omp parallel for schedule(dynamic)
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    shrink_size_all += _local_flat_shards[shard_id].erase_if(
+        [this](const uint64_t &key, shard_type::ValueRef &value) {
+          return _value_accessor->Shrink(value.data());
+        });
+  }
+  VLOG(0) << "MemoryFlatSparseTable::Shrink success, shrink size:"
+          << shrink_size_all;
+  return 0;
+}
+
+void MemoryFlatSparseTable::Clear() {
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    _local_flat_shards[i].clear();
+  }
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,105 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <ThreadPool.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/depends/flat_sparse_shard.h"
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+
+namespace paddle {
+namespace distributed {
+
+// MemorySparseTable with FlatSparseTableShard shards, selected by
+// sparse_shard_type = FLAT_OPEN_ADDRESSING_SHARD in TableParameter.
+//
+// Only the accesses to the shards are overridden, keys are mapped to shards
+// and the models are loaded and cached by the code of MemorySparseTable, so
+// the two tables can read each other's models. Pulls run on their own task
+// pools and only take the stripe locks in shared mode, so they are not queued
+// behind the pushes of the same shard. Patch model (enable_revert) and
+// pointer pulls of the GPU-PS are not supported.
+class MemoryFlatSparseTable : public MemorySparseTable {
+ public:
+  typedef FlatSparseTableShard<uint64_t> shard_type;
+  MemoryFlatSparseTable() {}
+  virtual ~MemoryFlatSparseTable() {}
+
+  int32_t Pull(TableContext& context) override;
+  int32_t Push(TableContext& context) override;
+
+  int32_t Initialize() override;
+
+  int32_t Save(const std::string& path, const std::string& param) override;
+#if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
+  // Also saves the feasigns of the slots filtered by the accessor to
+  // slot_feature/.
+  int32_t Save_v2(const std::string& path, const std::string& param) override;
+#endif
+
+  int64_t LocalSize();
+  int64_t LocalMFSize();
+  std::pair<int64_t, int64_t> PrintTableStat() override;
+
+  int32_t PullSparse(float* values, const PullSparseValue& pull_value);
+  int32_t PushSparse(const uint64_t* keys, const float* values, size_t num);
+  int32_t PushSparse(const uint64_t* keys, const float** values, size_t num);
+
+  int32_t Shrink(const std::string& param) override;
+  void Clear() override;
+
+  void* GetShard(size_t shard_idx) override {
+    return &_local_flat_shards[shard_idx];
+  }
+
+ protected:
+  void LoadLocalShard(int shard_id,
+                      const std::string& file,
+                      int load_param) override;
+  int32_t LoadPatch(const std::vector<std::string>& file_list,
+                    int load_param) override;
+  void WriteCacheEntries(
+      int shard_id,
+      int save_param,
+      double cache_threshold,
+      paddle::framework::ChannelWriter<std::pair<uint64_t, std::string>>*
+          writer) override;
+
+  template <class GET_UPDATE>
+  int32_t PushSparseImpl(const uint64_t* keys,
+                         size_t num,
+                         GET_UPDATE get_update);
+
+  int32_t SaveImpl(const std::string& path,
+                   const std::string& param,
+                   bool save_slot_feature);
+
+  // Split keys by local shard, keeping their position in the request.
+  std::vector<std::vector<std::pair<uint64_t, int>>> SplitKeys(
+      const uint64_t* keys, size_t num);
+
+  // Pushes of one shard are serialized on its push pool (_shards_task_pool),
+  // pulls go to a separate pool and may overlap with them.
+  std::vector<std::shared_ptr<::ThreadPool>> _shards_pull_task_pool;
+  std::unique_ptr<shard_type[]> _local_flat_shards;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -54,7 +54,7 @@ int32_t MemorySparseTable::Initialize() {
   return 0;
 }
 
-int32_t MemorySparseTable::InitializeValue() {
+void MemorySparseTable::InitializeShardNum() {
   _sparse_table_shard_num = static_cast<int>(_config.shard_num());
   _avg_local_shard_num =
       sparse_local_shard_num(_sparse_table_shard_num, _shard_num);
@@ -75,7 +75,10 @@ int32_t MemorySparseTable::InitializeValue() {
           << " _real_local_shard_num: " << _real_local_shard_num
           << " _task_pool_size:" << _task_pool_size
           << " _use_gpu_graph:" << _use_gpu_graph;
+}
 
+int32_t MemorySparseTable::InitializeValue() {
+  InitializeShardNum();
   _local_shards.reset(new shard_type[_real_local_shard_num]);
 
   if (_config.enable_revert()) {
@@ -152,9 +155,6 @@ int32_t MemorySparseTable::Load(const std::string &path,
     return 0;
   }
 
-  size_t feature_value_size =
-      _value_accessor->GetAccessorInfo().size / sizeof(float);
-
 #ifdef PADDLE_WITH_HETERPS
   int thread_num = _real_local_shard_num;
 #else
@@ -164,53 +164,7 @@ int32_t MemorySparseTable::Load(const std::string &path,
   omp_set_num_threads(thread_num);
 #pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < _real_local_shard_num; ++i) {
-    FsChannelConfig channel_config = {};
-    channel_config.path = file_list[file_start_idx + i];
-    VLOG(1) << "MemorySparseTable::load begin load " << channel_config.path
-            << " into local shard " << i;
-    channel_config.converter = _value_accessor->Converter(load_param).converter;
-    channel_config.deconverter =
-        _value_accessor->Converter(load_param).deconverter;
-
-    bool is_read_failed = false;
-    int retry_num = 0;
-    int err_no = 0;
-    do {
-      is_read_failed = false;
-      err_no = 0;
-      std::string line_data;
-      auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
-      char *end = nullptr;
-      auto &shard = _local_shards[i];
-      try {
-        while (read_channel->read_line(line_data) == 0 &&
-               line_data.size() > 1) {
-          uint64_t key = std::strtoul(line_data.data(), &end, 10);
-          auto &value = shard[key];
-          value.resize(feature_value_size);
-          int parse_size =
-              _value_accessor->ParseFromString(++end, value.data());
-          value.resize(parse_size);
-        }
-        read_channel->close();
-        if (err_no == -1) {
-          ++retry_num;
-          is_read_failed = true;
-          LOG(ERROR)
-              << "MemorySparseTable load failed after read, retry it! path:"
-              << channel_config.path << " , retry_num=" << retry_num;
-        }
-      } catch (...) {
-        ++retry_num;
-        is_read_failed = true;
-        LOG(ERROR) << "MemorySparseTable load failed, retry it! path:"
-                   << channel_config.path << " , retry_num=" << retry_num;
-      }
-      if (retry_num > FLAGS_pserver_table_save_max_retry) {
-        LOG(ERROR) << "MemorySparseTable load failed reach max limit!";
-        exit(-1);
-      }
-    } while (is_read_failed);
+    LoadLocalShard(i, file_list[file_start_idx + i], load_param);
   }
   LOG(INFO) << "MemorySparseTable load success, path from "
             << file_list[file_start_idx] << " to "
@@ -218,6 +172,67 @@ int32_t MemorySparseTable::Load(const std::string &path,
   return 0;
 }
 
+void MemorySparseTable::LoadLocalShard(int shard_id,
+                                       const std::string &file,
+                                       int load_param) {
+  size_t feature_value_size =
+      _value_accessor->GetAccessorInfo().size / sizeof(float);
+  auto &shard = _local_shards[shard_id];
+  LoadShardFile(file, load_param, [&](uint64_t key, char *value_str) {
+    auto &value = shard[key];
+    value.resize(feature_value_size);
+    int parse_size = _value_accessor->ParseFromString(value_str, value.data());
+    value.resize(parse_size);
+  });
+}
+
+void MemorySparseTable::LoadShardFile(
+    const std::string &file,
+    int load_param,
+    const std::function<void(uint64_t, char *)> &load_line) {
+  FsChannelConfig channel_config = {};
+  channel_config.path = file;
+  VLOG(1) << "MemorySparseTable::load begin load " << channel_config.path;
+  channel_config.converter = _value_accessor->Converter(load_param).converter;
+  channel_config.deconverter =
+      _value_accessor->Converter(load_param).deconverter;
+
+  bool is_read_failed = false;
+  int retry_num = 0;
+  int err_no = 0;
+  do {
+    is_read_failed = false;
+    err_no = 0;
+    std::string line_data;
+    auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
+    char *end = nullptr;
+    try {
+      while (read_channel->read_line(line_data) == 0 &&
+             line_data.size() > 1) {
+        uint64_t key = std::strtoul(line_data.data(), &end, 10);
+        load_line(key, ++end);
+      }
+      read_channel->close();
+      if (err_no == -1) {
+        ++retry_num;
+        is_read_failed = true;
+        LOG(ERROR)
+            << "MemorySparseTable load failed after read, retry it! path:"
+            << channel_config.path << " , retry_num=" << retry_num;
+      }
+    } catch (...) {
+      ++retry_num;
+      is_read_failed = true;
+      LOG(ERROR) << "MemorySparseTable load failed, retry it! path:"
+                 << channel_config.path << " , retry_num=" << retry_num;
+    }
+    if (retry_num > FLAGS_pserver_table_save_max_retry) {
+      LOG(ERROR) << "MemorySparseTable load failed reach max limit!";
+      exit(-1);
+    }
+  } while (is_read_failed);
+}
+
 int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
                                      int load_param) {
   if (!_config.enable_revert()) {
@@ -781,13 +796,6 @@ int64_t MemorySparseTable::CacheShuffle(
   // TODO(zhaocaibei123): check shuffle_node_num <= server_node_num
   int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
 
-  std::vector<
-      ::paddle::framework::ChannelWriter<std::pair<uint64_t, std::string>>>
-      writers(_real_local_shard_num);
-  std::vector<std::vector<std::pair<uint64_t, std::string>>> datas(
-      _real_local_shard_num);
-
-  int feasign_size = 0;
   std::vector<::paddle::framework::Channel<std::pair<uint64_t, std::string>>>
       tmp_channels;
   for (int i = 0; i < _real_local_shard_num; ++i) {
@@ -799,36 +807,19 @@ int64_t MemorySparseTable::CacheShuffle(
 #pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < _real_local_shard_num; ++i) {
     ::paddle::framework::ChannelWriter<std::pair<uint64_t, std::string>>
-        &writer = writers[i];
-    writer.Reset(tmp_channels[i].get());
-
+        writer(tmp_channels[i].get());
+    // The shards of the tables are read by themselves, so the tables may use
+    // different shard containers.
     for (auto table_ptr : table_ptrs) {
-      auto value_accessor = table_ptr->GetValueAccessor();
-      shard_type *shard_ptr = static_cast<shard_type *>(table_ptr->GetShard(i));
-
-      for (auto it = shard_ptr->begin(); it != shard_ptr->end(); ++it) {
-        if (value_accessor->SaveCache(
-                it.value().data(), save_param, cache_threshold)) {
-          std::string format_value = value_accessor->ParseToString(
-              it.value().data(), it.value().size());
-          std::pair<uint64_t, std::string> pkv(it.key(), format_value.c_str());
-          writer << pkv;
-          ++feasign_size;
-        }
-      }
+      static_cast<MemorySparseTable *>(table_ptr)->WriteCacheEntries(
+          i, save_param, cache_threshold, &writer);
     }
     writer.Flush();
-    writer.channel()->Close();
+    tmp_channels[i]->Close();
   }
-  // LOG(INFO) << "MemorySparseTable cache KV save success to Channel feasign
-  // size: " << feasign_size << " and start sparse cache data shuffle real local
-  // shard num: " << _real_local_shard_num;
   std::vector<std::pair<uint64_t, std::string>> local_datas;
-  for (int idx_shard = 0; idx_shard < _real_local_shard_num; ++idx_shard) {
-    ::paddle::framework::ChannelWriter<std::pair<uint64_t, std::string>>
-        &writer = writers[idx_shard];
-    auto channel = writer.channel();
-    std::vector<std::pair<uint64_t, std::string>> &data = datas[idx_shard];
+  for (const auto &channel : tmp_channels) {
+    std::vector<std::pair<uint64_t, std::string>> data;
     std::vector<::paddle::framework::BinaryArchive> ars(shuffle_node_num);
     while (channel->Read(data)) {
       for (auto &t : data) {
@@ -872,6 +863,24 @@ int64_t MemorySparseTable::CacheShuffle(
   return 0;
 }
 
+void MemorySparseTable::WriteCacheEntries(
+    int shard_id,
+    int save_param,
+    double cache_threshold,
+    ::paddle::framework::ChannelWriter<std::pair<uint64_t, std::string>>
+        *writer) {
+  auto &shard = _local_shards[shard_id];
+  for (auto it = shard.begin(); it != shard.end(); ++it) {
+    if (_value_accessor->SaveCache(
+            it.value().data(), save_param, cache_threshold)) {
+      std::string format_value =
+          _value_accessor->ParseToString(it.value().data(), it.value().size());
+      std::pair<uint64_t, std::string> pkv(it.key(), format_value.c_str());
+      *writer << pkv;
+    }
+  }
+}
+
 int32_t MemorySparseTable::SaveCache(
     const std::string &path,
     const std::string &param,
@@ -18,6 +18,7 @@
 #include <assert.h>
 #include <pthread.h>
 
+#include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
@@ -115,6 +116,26 @@ class MemorySparseTable : public Table {
   virtual void CheckSavePrePatchDone();
 
  protected:
+  // Sets the shard numbers of this server from the config.
+  void InitializeShardNum();
+  // Loads file into the local shard shard_id.
+  virtual void LoadLocalShard(int shard_id,
+                              const std::string& file,
+                              int load_param);
+  // Reads file and retries it on failures, load_line(key, value) parses the
+  // value of each line.
+  void LoadShardFile(const std::string& file,
+                     int load_param,
+                     const std::function<void(uint64_t, char*)>& load_line);
+  // Writes the entries of the local shard shard_id that are saved to the
+  // cache model.
+  virtual void WriteCacheEntries(
+      int shard_id,
+      int save_param,
+      double cache_threshold,
+      paddle::framework::ChannelWriter<std::pair<uint64_t, std::string>>*
+          writer);
+
   virtual int32_t SavePatch(const std::string& path, int save_param);
   virtual int32_t LoadPatch(const std::vector<std::string>& file_list,
                             int save_param);
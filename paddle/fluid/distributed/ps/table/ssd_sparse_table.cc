@@ -14,6 +14,9 @@
 
 #include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
 #include "paddle/fluid/distributed/common/local_random.h"
@@ -25,6 +28,12 @@ PD_DECLARE_bool(pserver_create_value_when_push);
 PD_DECLARE_bool(pserver_enable_create_feasign_randomly);
 PD_DEFINE_bool(pserver_open_strict_check, false, "pserver_open_strict_check");
 PD_DEFINE_int32(pserver_load_batch_size, 5000, "load batch size for ssd");
+PD_DEFINE_int64(pserver_ssd_hot_tier_capacity,
+                0,
+                "max feasign num kept in memory by each local shard of the "
+                "ssd table, the coldest ones are moved to ssd in the "
+                "background, 0 means unlimited. The demotion stops at the "
+                "first pointer pull, whose values must stay in memory");
 PHI_DEFINE_EXPORTED_string(rocksdb_path,
                            "database",
                            "path of sparse table rocksdb file");
@@ -36,6 +45,16 @@ int32_t SSDSparseTable::Initialize() {
   MemorySparseTable::Initialize();
   _db = ::paddle::distributed::RocksDBHandler::GetInstance();
   _db->initialize(FLAGS_rocksdb_path, _real_local_shard_num);
+  _ssd_read_pool.resize(_task_pool_size);
+  for (auto& read_pool : _ssd_read_pool) {
+    read_pool.reset(new ::ThreadPool(1));
+  }
+  _demotion_scheduled.reset(new std::atomic<bool>[_real_local_shard_num]);
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    _demotion_scheduled[i] = false;
+  }
+  _demotion_epoch.assign(_real_local_shard_num, 0);
+  _compaction_pool.reset(new ::ThreadPool(1));
   VLOG(0) << "initialize SSDSparseTable succ";
   VLOG(0) << "SSD FLAGS_pserver_print_missed_key_num_every_push:"
           << FLAGS_pserver_print_missed_key_num_every_push;
@@ -51,8 +70,181 @@ int32_t SSDSparseTable::Initialize() {
   return 0;
 }
 
+SSDSparseTable::~SSDSparseTable() {
+  // Wait for the background demotions, they use the members of this class.
+  for (auto& shards_task : _shards_task_pool) {
+    shards_task->enqueue([]() -> int { return 0; }).wait();
+  }
+}
+
 int32_t SSDSparseTable::InitializeShard() { return 0; }
 
+void SSDSparseTable::ReadFromSSD(int shard_id,
+                                 const std::vector<uint64_t>& keys,
+                                 RocksDBItem* item) {
+  item->reset();
+  for (auto& key : keys) {
+    item->batch_keys.emplace_back(reinterpret_cast<const char*>(&key),
+                                  sizeof(uint64_t));
+  }
+  item->batch_values.resize(keys.size());
+  item->status.resize(keys.size());
+  if (keys.empty()) {
+    return;
+  }
+  _db->multi_get(shard_id,
+                 keys.size(),
+                 item->batch_keys.data(),
+                 item->batch_values.data(),
+                 item->status.data());
+}
+
+int32_t SSDSparseTable::PromoteReadValues(int shard_id,
+                                          const std::vector<uint64_t>& keys,
+                                          RocksDBItem* item) {
+  // An I/O error or a corrupted entry must not become a live value.
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const auto& status = item->status[i];
+    if (!status.ok() && !status.IsNotFound()) {
+      LOG(ERROR) << "SSDSparseTable read shard:" << shard_id
+                 << " key:" << keys[i] << " failed: " << status.ToString();
+      return -1;
+    }
+  }
+  auto& local_shard = _local_shards[shard_id];
+  std::vector<uint64_t> promoted_keys;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    // Not on SSD, or promoted by another request since the read.
+    if (item->status[i].IsNotFound() ||
+        local_shard.find(keys[i]) != local_shard.end()) {
+      continue;
+    }
+    size_t data_size = item->batch_values[i].size() / sizeof(float);
+    // from rocksdb to mem
+    auto& feature_value = local_shard[keys[i]];
+    feature_value.resize(data_size);
+    memcpy(const_cast<float*>(feature_value.data()),
+           ::paddle::string::str_to_float(item->batch_values[i].data()),
+           data_size * sizeof(float));
+    promoted_keys.push_back(keys[i]);
+  }
+  if (!promoted_keys.empty()) {
+    _db->del_batch(shard_id, promoted_keys);
+  }
+  return 0;
+}
+
+int32_t SSDSparseTable::PromoteFromSSD(int shard_id,
+                                       const std::vector<uint64_t>& keys) {
+  RocksDBItem item;
+  ReadFromSSD(shard_id, keys, &item);
+  return PromoteReadValues(shard_id, keys, &item);
+}
+
+int32_t SSDSparseTable::PromoteMissingKeys(
+    int shard_id, const std::vector<std::pair<uint64_t, int>>& keys) {
+  auto& local_shard = _local_shards[shard_id];
+  std::vector<uint64_t> missing_keys;
+  for (auto& key : keys) {
+    if (local_shard.find(key.first) == local_shard.end()) {
+      missing_keys.push_back(key.first);
+    }
+  }
+  if (missing_keys.empty()) {
+    return 0;
+  }
+  std::sort(missing_keys.begin(), missing_keys.end());
+  missing_keys.erase(std::unique(missing_keys.begin(), missing_keys.end()),
+                     missing_keys.end());
+  return PromoteFromSSD(shard_id, missing_keys);
+}
+
+size_t SSDSparseTable::DemoteColdValues(int shard_id) {
+  auto& shard = _local_shards[shard_id];
+  int64_t capacity = FLAGS_pserver_ssd_hot_tier_capacity;
+  if (capacity <= 0 || static_cast<int64_t>(shard.size()) <= capacity ||
+      _ptr_pull_used) {
+    return 0;
+  }
+  ++_demotion_epoch[shard_id];
+  // Demote down to 90% of the capacity, so the next demotion is not
+  // scheduled right after this one.
+  size_t demote_num = shard.size() - capacity + capacity / 10;
+  // Values SaveSSD asks for (unseen for days) go first, then the ones with
+  // the lowest show.
+  std::vector<std::pair<float, uint64_t>> scores;
+  scores.reserve(shard.size());
+  for (auto it = shard.begin(); it != shard.end(); ++it) {
+    float* value = const_cast<float*>(it.value().data());
+    float score = _value_accessor->SaveSSD(value)
+                      ? -1.0f
+                      : _value_accessor->GetField(value, "show");
+    scores.emplace_back(score, it.key());
+  }
+  demote_num = std::min(demote_num, scores.size());
+  std::nth_element(scores.begin(),
+                   scores.begin() + demote_num,
+                   scores.end(),
+                   [](const std::pair<float, uint64_t>& a,
+                      const std::pair<float, uint64_t>& b) {
+                     return a.first < b.first;
+                   });
+  scores.resize(demote_num);
+
+  size_t batch_size = FLAGS_pserver_load_batch_size;
+  std::vector<uint64_t> batch_keys;
+  std::vector<std::pair<char*, int>> ssd_keys;
+  std::vector<std::pair<char*, int>> ssd_values;
+  batch_keys.reserve(batch_size);
+  ssd_keys.reserve(batch_size);
+  ssd_values.reserve(batch_size);
+  for (size_t i = 0; i < scores.size(); ++i) {
+    batch_keys.push_back(scores[i].second);
+    if (batch_keys.size() < batch_size && i + 1 < scores.size()) {
+      continue;
+    }
+    for (auto& key : batch_keys) {
+      auto& feature_value = shard.find(key).value();
+      ssd_keys.emplace_back(reinterpret_cast<char*>(&key), sizeof(uint64_t));
+      ssd_values.emplace_back(
+          reinterpret_cast<char*>(const_cast<float*>(feature_value.data())),
+          feature_value.size() * sizeof(float));
+    }
+    _db->put_batch(shard_id, ssd_keys, ssd_values, ssd_keys.size());
+    for (auto& key : batch_keys) {
+      shard.erase(key);
+    }
+    batch_keys.clear();
+    ssd_keys.clear();
+    ssd_values.clear();
+  }
+  return demote_num;
+}
+
+void SSDSparseTable::ScheduleDemotion(int shard_id) {
+  if (_ptr_pull_used || _demotion_scheduled[shard_id].exchange(true)) {
+    return;
+  }
+  // Runs after the requests already queued on the shard, the caller does not
+  // wait for it.
+  _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+      [this, shard_id]() -> int {
+        size_t count = DemoteColdValues(shard_id);
+        _demotion_scheduled[shard_id] = false;
+        VLOG(1) << "SSDSparseTable demote shard:" << shard_id
+                << " count:" << count;
+        return 0;
+      });
+}
+
+void SSDSparseTable::ScheduleCompaction() {
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    _compaction_pool->enqueue([this, i]() -> int {
+      return _db->compact_range(i);
+    });
+  }
+}
+
 void SSDSparseTable::SetDayId(int day_id) { _day_id = day_id; }
 
 int32_t SSDSparseTable::Pull(TableContext& context) {
@@ -93,6 +285,7 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
                                    const uint64_t* keys,
                                    size_t num) {
   CostTimer timer("pserver_downpour_sparse_select_all");
+  auto start = std::chrono::steady_clock::now();
   size_t value_size = _value_accessor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_size =
       _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
@@ -100,96 +293,159 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
       _value_accessor->GetAccessorInfo().select_size / sizeof(float);
 
   {  // 从table取值 or create
-    std::vector<std::future<int>> tasks(_real_local_shard_num);
-    std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
-        _real_local_shard_num);
+    // A shard is pulled in two tasks on its thread: the first serves the keys
+    // in memory and starts one MultiGet of the others on the SSD read pool,
+    // the second promotes what was read. The shard thread serves other
+    // requests while the read is in flight.
+    struct ShardPull {
+      std::vector<std::pair<uint64_t, int>> keys;
+      // Served after the promotion, with their duplicates.
+      std::vector<std::pair<uint64_t, int>> waiting_keys;
+      // Unique and sorted as the comparator of the db.
+      std::vector<uint64_t> ssd_keys;
+      RocksDBItem ssd_item;
+      std::future<int> ssd_read;
+      uint64_t demotion_epoch = 0;
+    };
+    std::vector<ShardPull> pulls(_real_local_shard_num);
     for (size_t i = 0; i < num; ++i) {
       int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
-      task_keys[shard_id].emplace_back(keys[i], i);
+      pulls[shard_id].keys.emplace_back(keys[i], i);
+    }
+
+    auto select = [this, value_size, select_value_size, pull_values](
+                      float* data_buffer, size_t data_size, int pull_data_idx) {
+      for (size_t mf_idx = data_size; mf_idx < value_size; ++mf_idx) {
+        data_buffer[mf_idx] = 0.0;
+      }
+      float* select_data = pull_values + pull_data_idx * select_value_size;
+      _value_accessor->Select(&select_data, (const float**)&data_buffer, 1);
+    };
+
+    std::vector<std::future<int>> tasks(_real_local_shard_num);
+    for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+      tasks[shard_id] =
+          _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+              [this, shard_id, &pulls, value_size, &select]() -> int {
+                auto& pull = pulls[shard_id];
+                auto& local_shard = _local_shards[shard_id];
+                float data_buffer[value_size];  // NOLINT
+                for (auto& key : pull.keys) {
+                  auto itr = local_shard.find(key.first);
+                  if (itr == local_shard.end()) {
+                    pull.waiting_keys.push_back(key);
+                    pull.ssd_keys.push_back(key.first);
+                    continue;
+                  }
+                  size_t data_size = itr.value().size();
+                  memcpy(data_buffer,
+                         itr.value().data(),
+                         data_size * sizeof(float));
+                  select(data_buffer, data_size, key.second);
+                }
+                if (pull.ssd_keys.empty()) {
+                  return 0;
+                }
+                std::sort(pull.ssd_keys.begin(), pull.ssd_keys.end());
+                pull.ssd_keys.erase(
+                    std::unique(pull.ssd_keys.begin(), pull.ssd_keys.end()),
+                    pull.ssd_keys.end());
+                pull.demotion_epoch = _demotion_epoch[shard_id];
+                pull.ssd_read =
+                    _ssd_read_pool[shard_id % _ssd_read_pool.size()]->enqueue(
+                        [this, shard_id, &pull]() -> int {
+                          ReadFromSSD(shard_id, pull.ssd_keys, &pull.ssd_item);
+                          return 0;
+                        });
+                return 0;
+              });
     }
 
     std::atomic<uint32_t> missed_keys{0};
     for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+      auto& pull = pulls[shard_id];
+      tasks[shard_id].wait();
+      if (pull.ssd_keys.empty()) {
+        continue;
+      }
+      pull.ssd_read.wait();
       tasks[shard_id] =
           _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
               [this,
                shard_id,
-               &task_keys,
+               &pull,
                value_size,
                mf_value_size,
-               select_value_size,
-               pull_values,
+               &select,
                &missed_keys]() -> int {
-                auto& keys = task_keys[shard_id];
                 auto& local_shard = _local_shards[shard_id];
+                // A demotion that ran since the read may have moved some of
+                // the keys to SSD, read them again.
+                int ret = pull.demotion_epoch == _demotion_epoch[shard_id]
+                              ? PromoteReadValues(
+                                    shard_id, pull.ssd_keys, &pull.ssd_item)
+                              : PromoteFromSSD(shard_id, pull.ssd_keys);
+                if (ret != 0) {
+                  return -1;
+                }
                 float data_buffer[value_size];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
-                for (size_t i = 0; i < keys.size(); ++i) {
-                  uint64_t key = keys[i].first;
-                  auto itr = local_shard.find(key);
-                  size_t data_size = value_size - mf_value_size;
+                size_t create_size = value_size - mf_value_size;
+                for (auto key : pull.ssd_keys) {
+                  if (local_shard.find(key) != local_shard.end()) {
+                    continue;
+                  }
+                  ++missed_keys;
+                  if (FLAGS_pserver_create_value_when_push) {
+                    continue;
+                  }
+                  auto& feature_value = local_shard[key];
+                  feature_value.resize(create_size);
+                  _value_accessor->Create(&data_buffer_ptr, 1);
+                  memcpy(const_cast<float*>(feature_value.data()),
+                         data_buffer,
+                         create_size * sizeof(float));
+                }
+                for (auto& key : pull.waiting_keys) {
+                  auto itr = local_shard.find(key.first);
+                  size_t data_size = create_size;
                   if (itr == local_shard.end()) {
-                    // pull rocksdb
-                    std::string tmp_string("");
-                    if (_db->get(shard_id,
-                                 reinterpret_cast<char*>(&key),
-                                 sizeof(uint64_t),
-                                 tmp_string) > 0) {
-                      ++missed_keys;
-                      if (FLAGS_pserver_create_value_when_push) {
-                        memset(data_buffer, 0, sizeof(float) * data_size);
-                      } else {
-                        auto& feature_value = local_shard[key];
-                        feature_value.resize(data_size);
-                        float* data_ptr =
-                            const_cast<float*>(feature_value.data());
-                        _value_accessor->Create(&data_buffer_ptr, 1);
-                        memcpy(data_ptr,
-                               data_buffer_ptr,
-                               data_size * sizeof(float));
-                      }
-                    } else {
-                      data_size = tmp_string.size() / sizeof(float);
-                      memcpy(data_buffer_ptr,
-                             ::paddle::string::str_to_float(tmp_string),
-                             data_size * sizeof(float));
-                      // from rocksdb to mem
-                      auto& feature_value = local_shard[key];
-                      feature_value.resize(data_size);
-                      memcpy(const_cast<float*>(feature_value.data()),
-                             data_buffer_ptr,
-                             data_size * sizeof(float));
-                      _db->del_data(shard_id,
-                                    reinterpret_cast<char*>(&key),
-                                    sizeof(uint64_t));
-                    }
+                    // Not created until push.
+                    memset(data_buffer, 0, sizeof(float) * data_size);
                   } else {
                     data_size = itr.value().size();
-                    memcpy(data_buffer_ptr,
+                    memcpy(data_buffer,
                            itr.value().data(),
                            data_size * sizeof(float));
                   }
-                  for (size_t mf_idx = data_size; mf_idx < value_size;
-                       ++mf_idx) {
-                    data_buffer[mf_idx] = 0.0;
-                  }
-                  int pull_data_idx = keys[i].second;
-                  float* select_data =
-                      pull_values + pull_data_idx * select_value_size;
-                  _value_accessor->Select(
-                      &select_data, (const float**)&data_buffer_ptr, 1);
+                  select(data_buffer, data_size, key.second);
+                }
+                if (FLAGS_pserver_ssd_hot_tier_capacity > 0 &&
+                    static_cast<int64_t>(local_shard.size()) >
+                        FLAGS_pserver_ssd_hot_tier_capacity) {
+                  ScheduleDemotion(shard_id);
                 }
                 return 0;
               });
     }
+    int ret = 0;
     for (int i = 0; i < _real_local_shard_num; ++i) {
-      tasks[i].wait();
+      if (tasks[i].get() != 0) {
+        ret = -1;
+      }
     }
     if (FLAGS_pserver_print_missed_key_num_every_push) {
       LOG(WARNING) << "total pull keys:" << num
                    << " missed_keys:" << missed_keys.load();
     }
+    if (ret != 0) {
+      LOG(ERROR) << "SSDSparseTable pull failed on an SSD read error";
+      return ret;
+    }
   }
+  _pull_latency.Add(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count());
   return 0;
 }
 
@@ -199,6 +455,19 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
                                       size_t num,
                                       uint16_t pass_id) {
   CostTimer timer("pserver_ssd_sparse_select_all");
+  auto start = std::chrono::steady_clock::now();
+  // The returned pointers are held by the caller, so no value may be demoted
+  // from now on. A demotion already scheduled on the shard is waited for.
+  if (!_ptr_pull_used.exchange(true) &&
+      FLAGS_pserver_ssd_hot_tier_capacity > 0) {
+    LOG(WARNING) << "SSDSparseTable hot tier demotion is disabled by the "
+                    "pointer pull";
+  }
+  if (_demotion_scheduled[shard_id]) {
+    _shards_task_pool[shard_id % _shards_task_pool.size()]
+        ->enqueue([]() -> int { return 0; })
+        .wait();
+  }
   size_t value_size = _value_accessor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_size =
       _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
@@ -341,6 +610,9 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
       cur_ctx->reset();
     }
   }
+  _pull_latency.Add(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count());
   return 0;
 }
 
@@ -374,6 +646,12 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                &task_keys]() -> int {
                 auto& keys = task_keys[shard_id];
                 auto& local_shard = _local_shards[shard_id];
+                // Values demoted between the pull and this push are read
+                // back with one MultiGet before the update.
+                if (FLAGS_pserver_ssd_hot_tier_capacity > 0 &&
+                    PromoteMissingKeys(shard_id, keys) != 0) {
+                  return -1;
+                }
                 float data_buffer[value_col];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
                 for (size_t i = 0; i < keys.size(); ++i) {
@@ -422,8 +700,15 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                 return 0;
               });
     }
+    int ret = 0;
     for (int i = 0; i < _real_local_shard_num; ++i) {
-      tasks[i].wait();
+      if (tasks[i].get() != 0) {
+        ret = -1;
+      }
+    }
+    if (ret != 0) {
+      LOG(ERROR) << "SSDSparseTable push failed on an SSD read error";
+      return ret;
     }
   }
   /*
@@ -475,6 +760,12 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                   -> int {
                 auto& keys = task_keys[shard_id];
                 auto& local_shard = _local_shards[shard_id];
+                // Values demoted between the pull and this push are read
+                // back with one MultiGet before the update.
+                if (FLAGS_pserver_ssd_hot_tier_capacity > 0 &&
+                    PromoteMissingKeys(shard_id, keys) != 0) {
+                  return -1;
+                }
                 float data_buffer[value_col];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
                 for (size_t i = 0; i < keys.size(); ++i) {
@@ -522,8 +813,15 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                 return 0;
               });
     }
+    int ret = 0;
     for (int i = 0; i < _real_local_shard_num; ++i) {
-      tasks[i].wait();
+      if (tasks[i].get() != 0) {
+        ret = -1;
+      }
+    }
+    if (ret != 0) {
+      LOG(ERROR) << "SSDSparseTable push failed on an SSD read error";
+      return ret;
     }
   }
   return 0;
@@ -566,6 +864,7 @@ int32_t SSDSparseTable::Shrink(const std::string& param) {
               << mem_count << "] SSD[" << ssd_count << "]";
     // _db->flush(i);
   }
+  ScheduleCompaction();
   return 0;
 }
 
@@ -590,6 +889,7 @@ int32_t SSDSparseTable::UpdateTable() {
     _db->flush(i);
   }
   LOG(INFO) << "Table>> update count: " << count;
+  ScheduleCompaction();
   return 0;
 }
 
@@ -3016,6 +3316,11 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
 
 std::pair<int64_t, int64_t> SSDSparseTable::PrintTableStat() {
   int64_t feasign_size = LocalSize();
+  LOG(INFO) << "SSDSparseTable mem feasign: " << feasign_size
+            << " pull latency(us) p50: " << PullLatencyPercentile(50)
+            << " p90: " << PullLatencyPercentile(90)
+            << " p99: " << PullLatencyPercentile(99)
+            << " p999: " << PullLatencyPercentile(99.9);
   return {feasign_size, -1};
 }
 
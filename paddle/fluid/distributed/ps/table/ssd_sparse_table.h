@@ -14,6 +14,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/table/depends/rocksdb_warpper.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
@@ -60,11 +65,64 @@ class MemRegion {
   char* _buf;
 };
 
+// Lock free histogram of latencies in microseconds, bucket i counts the
+// samples in [2^(i-1), 2^i).
+class LatencyHistogram {
+ public:
+  static constexpr int kBucketNum = 32;
+
+  LatencyHistogram() { Reset(); }
+  void Add(uint64_t us) {
+    int bucket = 0;
+    while (us > 0 && bucket + 1 < kBucketNum) {
+      us >>= 1;
+      ++bucket;
+    }
+    _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+  // Upper bound in microseconds of the given percentile, 0 when empty.
+  uint64_t Percentile(double percent) const {
+    uint64_t counts[kBucketNum];
+    uint64_t total = 0;
+    for (int i = 0; i < kBucketNum; ++i) {
+      counts[i] = _buckets[i].load(std::memory_order_relaxed);
+      total += counts[i];
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketNum && total > 0; ++i) {
+      seen += counts[i];
+      if (seen >= total * percent / 100.0) {
+        return 1ULL << i;
+      }
+    }
+    return 0;
+  }
+  void Reset() {
+    for (auto& bucket : _buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  std::atomic<uint64_t> _buckets[kBucketNum];
+};
+
+// SSDSparseTable keeps the hot values in the memory shards and the cold ones
+// in RocksDB. A pull serves the in-memory keys of a shard and reads the missing
+// ones with one MultiGet on the SSD read pool, then a second task of the shard
+// promotes the values found on SSD to memory, so the task pool of the shard
+// does not wait for the read. A push reads the keys missing in memory with one
+// MultiGet as well, synchronously, since it updates the values. When
+// FLAGS_pserver_ssd_hot_tier_capacity is set, shards exceeding it demote their
+// coldest values (stale by SaveSSD first, then the lowest show) to SSD in the
+// background, until the first pointer pull, whose values must stay in memory.
+// Compaction of RocksDB after UpdateTable and Shrink runs on its own thread,
+// off the training path.
 class SSDSparseTable : public MemorySparseTable {
  public:
   typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
   SSDSparseTable() {}
-  virtual ~SSDSparseTable() {}
+  virtual ~SSDSparseTable();
 
   int32_t Initialize() override;
   int32_t InitializeShard() override;
@@ -134,13 +192,53 @@ class SSDSparseTable : public MemorySparseTable {
 
   void SetDayId(int day_id) override;
 
+  // Pull latency percentile in microseconds, over the pulls since the table
+  // was created or the last ResetPullLatency.
+  uint64_t PullLatencyPercentile(double percent) const {
+    return _pull_latency.Percentile(percent);
+  }
+  void ResetPullLatency() { _pull_latency.Reset(); }
+
  private:
+  // Reads keys from SSD with one MultiGet, keys must be sorted and unique.
+  void ReadFromSSD(int shard_id,
+                   const std::vector<uint64_t>& keys,
+                   RocksDBItem* item);
+  // Moves the values of keys read into item to the memory shard, except the
+  // keys already in memory. Returns -1 without moving any value when a read
+  // failed. Must run on the task pool of the shard.
+  int32_t PromoteReadValues(int shard_id,
+                            const std::vector<uint64_t>& keys,
+                            RocksDBItem* item);
+  // Reads keys from SSD and promotes the values found.
+  int32_t PromoteFromSSD(int shard_id, const std::vector<uint64_t>& keys);
+  // Promotes the keys of a push that are not in memory, with one MultiGet.
+  int32_t PromoteMissingKeys(int shard_id,
+                             const std::vector<std::pair<uint64_t, int>>& keys);
+  // Demotes the coldest values of the shard to SSD until it is below the hot
+  // tier capacity. Must run on the task pool of the shard.
+  size_t DemoteColdValues(int shard_id);
+  void ScheduleDemotion(int shard_id);
+  void ScheduleCompaction();
+
   RocksDBHandler* _db;
   int64_t _cache_tk_size;
   double _local_show_threshold{0.0};
   std::vector<paddle::framework::Channel<std::string>> _fs_channel;
   std::mutex _table_mutex;
   int _day_id = 0;
+  // The SSD reads of pulls are issued on their own pools, so the shard thread
+  // serves other requests while the MultiGet of the missed keys is in flight.
+  std::vector<std::shared_ptr<::ThreadPool>> _ssd_read_pool;
+  std::unique_ptr<std::atomic<bool>[]> _demotion_scheduled;
+  // Counts the demotions of each shard, a pull reads its keys again when a
+  // demotion ran between its read and its promotion.
+  std::vector<uint64_t> _demotion_epoch;
+  // The pointer pulls hold on to the memory values, no value is demoted
+  // after the first one.
+  std::atomic<bool> _ptr_pull_used{false};
+  LatencyHistogram _pull_latency;
+  std::unique_ptr<::ThreadPool> _compaction_pool;
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
   paddle::framework::AfsWrapper _afs_wrapper;  // afs api wrapper
 #endif
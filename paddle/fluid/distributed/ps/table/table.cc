@@ -21,6 +21,7 @@
 #include "paddle/fluid/distributed/ps/table/ctr_double_accessor.h"
 #include "paddle/fluid/distributed/ps/table/ctr_dymf_accessor.h"
 #include "paddle/fluid/distributed/ps/table/memory_dense_table.h"
+#include "paddle/fluid/distributed/ps/table/memory_flat_sparse_table.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_geo_table.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
 #include "paddle/fluid/distributed/ps/table/sparse_accessor.h"
@@ -36,6 +37,7 @@ REGISTER_PSCORE_CLASS(Table, BarrierTable);
 // REGISTER_PSCORE_CLASS(Table, DenseTensorTable);
 // REGISTER_PSCORE_CLASS(Table, GlobalStepTable);
 REGISTER_PSCORE_CLASS(Table, MemorySparseTable);
+REGISTER_PSCORE_CLASS(Table, MemoryFlatSparseTable);
 REGISTER_PSCORE_CLASS(Table, SSDSparseTable);
 REGISTER_PSCORE_CLASS(Table, MemorySparseGeoTable);
 
@@ -60,6 +62,14 @@ int32_t TableManager::Initialize() {
   return 0;
 }
 
+std::string TableManager::TableClass(const TableParameter &config) {
+  if (config.table_class() == "MemorySparseTable" &&
+      config.sparse_shard_type() == FLAT_OPEN_ADDRESSING_SHARD) {
+    return "MemoryFlatSparseTable";
+  }
+  return config.table_class();
+}
+
 int32_t Table::Initialize(const TableParameter &config,
                           const FsClientParameter &fs_config) {
   _config = config;
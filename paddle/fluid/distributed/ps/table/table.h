@@ -194,6 +194,11 @@ class TableManager {
   }
   int32_t Initialize();
 
+  // The registered class to create for config. MemorySparseTable is backed
+  // by MemoryFlatSparseTable when sparse_shard_type is
+  // FLAT_OPEN_ADDRESSING_SHARD.
+  static std::string TableClass(const TableParameter &config);
+
  private:
   TableManager() {}
   ~TableManager() {}
@@ -0,0 +1,403 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/memory_flat_sparse_table.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/fluid/framework/channel.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+constexpr int kEmbDim = 8;
+
+TableParameter MakeTableConfig(SparseShardType shard_type) {
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(10);
+  table_config.set_sparse_shard_type(shard_type);
+
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(kEmbDim);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+
+  // Zero initial range keeps the created values deterministic, so the two
+  // shard types can be compared value by value.
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto *naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.0);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+  return table_config;
+}
+
+std::unique_ptr<Table> CreateTable(SparseShardType shard_type,
+                                   double cache_rate = 0.0) {
+  TableParameter table_config = MakeTableConfig(shard_type);
+  if (cache_rate > 0.0) {
+    table_config.set_enable_sparse_table_cache(true);
+    table_config.set_sparse_table_cache_rate(cache_rate);
+    table_config.set_sparse_table_cache_file_num(1);
+  }
+  FsClientParameter fs_config;
+  std::unique_ptr<Table> table(
+      CREATE_PSCORE_CLASS(Table, TableManager::TableClass(table_config)));
+  table->SetShard(0, 1);
+  EXPECT_EQ(table->Initialize(table_config, fs_config), 0);
+  return table;
+}
+
+void Pull(Table *table,
+          const std::vector<uint64_t> &keys,
+          std::vector<float> *values) {
+  std::vector<uint32_t> fres(keys.size(), 1);
+  values->resize(keys.size() * (kEmbDim + 3));
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = PullSparseValue(keys, fres, kEmbDim);
+  table_context.pull_context.values = values->data();
+  table->Pull(table_context);
+}
+
+void Push(Table *table,
+          const std::vector<uint64_t> &keys,
+          const std::vector<float> &gradients) {
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.push_context.keys = keys.data();
+  table_context.push_context.values = gradients.data();
+  table_context.num = keys.size();
+  table->Push(table_context);
+}
+
+// Returns the sorted lines of each file under dir, keyed by the path
+// relative to dir.
+std::map<std::string, std::vector<std::string>> ReadSavedFiles(
+    const std::filesystem::path &dir) {
+  std::map<std::string, std::vector<std::string>> files;
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(dir)) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+    auto &lines =
+        files[std::filesystem::relative(entry.path(), dir).string()];
+    std::ifstream ifs(entry.path());
+    for (std::string line; std::getline(ifs, line);) {
+      lines.push_back(line);
+    }
+    std::sort(lines.begin(), lines.end());
+  }
+  return files;
+}
+
+// Keys drawn from a Zipfian distribution over [0, key_num), the usual shape
+// of CTR feature ids.
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(size_t key_num, double theta, uint32_t seed)
+      : cdf_(key_num), rng_(seed) {
+    double sum = 0.0;
+    for (size_t i = 0; i < key_num; ++i) {
+      sum += 1.0 / std::pow(static_cast<double>(i + 1), theta);
+      cdf_[i] = sum;
+    }
+    for (auto &c : cdf_) {
+      c /= sum;
+    }
+  }
+
+  uint64_t Next() {
+    double u = dist_(rng_);
+    size_t rank = std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin();
+    // Scatter the ranks over the key space so hot keys hit every shard.
+    return static_cast<uint64_t>(rank) * 0x9E3779B97F4A7C15ULL;
+  }
+
+ private:
+  std::vector<double> cdf_;
+  std::mt19937_64 rng_;
+  std::uniform_real_distribution<double> dist_{0.0, 1.0};
+};
+
+}  // namespace
+
+TEST(FlatSparseTableShard, InsertFindErase) {
+  FlatSparseTableShard<uint64_t> shard;
+  constexpr uint64_t kNum = 100000;
+  for (uint64_t key = 0; key < kNum; ++key) {
+    shard.upsert(key, 2, [key](auto &value, bool created) {
+      ASSERT_TRUE(created);
+      value.data()[0] = static_cast<float>(key);
+      value.data()[1] = 1.0f;
+    });
+  }
+  ASSERT_EQ(shard.size(), kNum);
+
+  // Growing a value keeps its prefix.
+  shard.upsert(7, 2, [](auto &value, bool created) {
+    ASSERT_FALSE(created);
+    value.resize(4);
+    value.data()[3] = 3.0f;
+  });
+  for (uint64_t key = 0; key < kNum; ++key) {
+    ASSERT_TRUE(shard.find(key, [key](const float *data, size_t size) {
+      ASSERT_EQ(size, key == 7 ? 4UL : 2UL);
+      ASSERT_EQ(data[0], static_cast<float>(key));
+    }));
+  }
+
+  size_t erased = shard.erase_if(
+      [](const uint64_t &key, auto &value) { return key % 2 == 0; });
+  ASSERT_EQ(erased, kNum / 2);
+  ASSERT_EQ(shard.erase(1), 1UL);
+  ASSERT_EQ(shard.erase(1), 0UL);
+  ASSERT_EQ(shard.size(), kNum / 2 - 1);
+  for (uint64_t key = 0; key < kNum; ++key) {
+    ASSERT_EQ(shard.contains(key), key % 2 == 1 && key != 1);
+  }
+  shard.clear();
+  ASSERT_TRUE(shard.empty());
+}
+
+TEST(FlatSparseTableShard, UpsertIfAndSnapshot) {
+  FlatSparseTableShard<uint64_t> shard;
+  auto set_key = [](uint64_t key) {
+    return [key](auto &value, bool created) {
+      value.data()[0] = static_cast<float>(key);
+    };
+  };
+  // A missing key is only created if asked to.
+  ASSERT_FALSE(shard.upsert_if(1, 1, [] { return false; }, set_key(1)));
+  ASSERT_FALSE(shard.contains(1));
+  ASSERT_TRUE(shard.upsert_if(1, 1, [] { return true; }, set_key(1)));
+  ASSERT_TRUE(shard.upsert_if(2, 1, [] { return true; }, set_key(2)));
+  // An existing key is always updated.
+  ASSERT_TRUE(shard.upsert_if(1, 1, [] { return false; }, set_key(1)));
+
+  std::map<uint64_t, float> snapshot;
+  shard.for_each_snapshot([&](const uint64_t &key, float *data, size_t size) {
+    ASSERT_EQ(size, 1UL);
+    snapshot[key] = data[0];
+    // Pushes are not blocked while the snapshot is read.
+    shard.upsert(key, 1, [](auto &value, bool created) {
+      value.data()[0] = -1.0f;
+    });
+  });
+  ASSERT_EQ(snapshot, (std::map<uint64_t, float>{{1, 1.0f}, {2, 2.0f}}));
+}
+
+TEST(FlatSparseTableShard, ConcurrentReadersDuringPush) {
+  FlatSparseTableShard<uint64_t> shard;
+  constexpr uint64_t kNum = 20000;
+  std::atomic<bool> stop{false};
+  std::thread writer([&] {
+    for (int round = 0; round < 5; ++round) {
+      for (uint64_t key = 0; key < kNum; ++key) {
+        shard.upsert(key, 4, [round](auto &value, bool created) {
+          for (size_t i = 0; i < value.size(); ++i) {
+            value.data()[i] = static_cast<float>(round);
+          }
+        });
+      }
+    }
+    stop = true;
+  });
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&] {
+      while (!stop) {
+        for (uint64_t key = 0; key < kNum; key += 7) {
+          shard.prefetch(key + 7);
+          shard.find(key, [](const float *data, size_t size) {
+            // A reader never observes a half written value.
+            for (size_t i = 1; i < size; ++i) {
+              ASSERT_EQ(data[i], data[0]);
+            }
+          });
+        }
+      }
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  ASSERT_EQ(shard.size(), kNum);
+}
+
+TEST(MemoryFlatSparseTable, SameResultAsMemorySparseTable) {
+  auto node_table = CreateTable(NODE_BUCKET_SHARD);
+  auto flat_table = CreateTable(FLAT_OPEN_ADDRESSING_SHARD);
+  ASSERT_NE(dynamic_cast<MemoryFlatSparseTable *>(flat_table.get()), nullptr);
+
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < 1000; ++key) {
+    keys.push_back(key * 31);
+  }
+  std::vector<float> gradients;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    for (int k = 0; k < kEmbDim + 4; ++k) {
+      gradients.push_back(0.01f * static_cast<float>((i + k) % 10));
+    }
+  }
+  for (int step = 0; step < 10; ++step) {
+    Push(node_table.get(), keys, gradients);
+    Push(flat_table.get(), keys, gradients);
+  }
+
+  std::vector<float> node_values, flat_values;
+  Pull(node_table.get(), keys, &node_values);
+  Pull(flat_table.get(), keys, &flat_values);
+  ASSERT_EQ(node_values.size(), flat_values.size());
+  for (size_t i = 0; i < node_values.size(); ++i) {
+    ASSERT_FLOAT_EQ(node_values[i], flat_values[i]);
+  }
+  ASSERT_EQ(node_table->PrintTableStat(), flat_table->PrintTableStat());
+}
+
+// Save, CacheShuffle and SaveCache write the same entries as
+// MemorySparseTable.
+TEST(MemoryFlatSparseTable, SaveAndCacheSameAsMemorySparseTable) {
+  auto node_table = CreateTable(NODE_BUCKET_SHARD, 0.1);
+  auto flat_table = CreateTable(FLAT_OPEN_ADDRESSING_SHARD, 0.1);
+
+  std::vector<uint64_t> keys;
+  std::vector<float> gradients;
+  for (uint64_t key = 0; key < 1000; ++key) {
+    keys.push_back(key * 31);
+    gradients.push_back(0.0f);                          // slot
+    gradients.push_back(static_cast<float>(key % 10));  // show
+    gradients.push_back(static_cast<float>(key % 2));   // click
+    for (int k = 0; k < kEmbDim + 1; ++k) {
+      gradients.push_back(0.01f * static_cast<float>((key + k) % 10));
+    }
+  }
+  for (int step = 0; step < 3; ++step) {
+    Push(node_table.get(), keys, gradients);
+    Push(flat_table.get(), keys, gradients);
+  }
+
+  const auto root = std::filesystem::temp_directory_path() /
+                    ("memory_flat_sparse_table_save_" +
+                     std::to_string(std::chrono::steady_clock::now()
+                                        .time_since_epoch()
+                                        .count()));
+  std::map<std::string, std::vector<std::string>> saved[2];
+  int32_t cache_size[2];
+  Table *tables[2] = {node_table.get(), flat_table.get()};
+  for (int t = 0; t < 2; ++t) {
+    auto dir = (root / std::to_string(t)).string();
+    // xbox delta
+    ASSERT_EQ(tables[t]->Save(dir, "1"), 0);
+    double cache_threshold = tables[t]->GetCacheThreshold();
+    ASSERT_GT(cache_threshold, 0.0);
+
+    auto shuffled_channel =
+        paddle::framework::MakeChannel<std::pair<uint64_t, std::string>>();
+    auto send_msg_func = [](int, int, std::string &) {
+      std::promise<int32_t> promise;
+      promise.set_value(0);
+      return promise.get_future();
+    };
+    ASSERT_EQ(tables[t]->CacheShuffle(dir,
+                                      "1",
+                                      cache_threshold,
+                                      send_msg_func,
+                                      shuffled_channel,
+                                      {tables[t]}),
+              0);
+    cache_size[t] = tables[t]->SaveCache(dir, "1", shuffled_channel);
+    saved[t] = ReadSavedFiles(dir);
+  }
+  std::filesystem::remove_all(root);
+
+  ASSERT_EQ(node_table->GetCacheThreshold(), flat_table->GetCacheThreshold());
+  EXPECT_GT(cache_size[1], 0);
+  EXPECT_LT(cache_size[1], static_cast<int32_t>(keys.size()));
+  ASSERT_EQ(cache_size[0], cache_size[1]);
+  ASSERT_EQ(saved[1].count("000_cache/part-000"), 1u);
+  EXPECT_EQ(saved[1]["000_cache/part-000"].size(),
+            static_cast<size_t>(cache_size[1]));
+  ASSERT_EQ(saved[0], saved[1]);
+}
+
+// Pull / push throughput on synthetic Zipfian keys for both shard types.
+TEST(MemoryFlatSparseTable, ZipfianPullPushBenchmark) {
+  constexpr size_t kKeyNum = 1000000;
+  constexpr size_t kBatchSize = 20000;
+  constexpr int kSteps = 50;
+
+  ZipfianGenerator generator(kKeyNum, 0.99, 2024);
+  std::vector<std::vector<uint64_t>> batches(kSteps);
+  for (auto &batch : batches) {
+    for (size_t i = 0; i < kBatchSize; ++i) {
+      batch.push_back(generator.Next());
+    }
+  }
+  std::vector<float> gradients(kBatchSize * (kEmbDim + 4), 0.01f);
+
+  for (auto shard_type : {NODE_BUCKET_SHARD, FLAT_OPEN_ADDRESSING_SHARD}) {
+    auto table = CreateTable(shard_type);
+    std::vector<float> values;
+    double pull_seconds = 0.0;
+    double push_seconds = 0.0;
+    for (auto &batch : batches) {
+      auto start = std::chrono::steady_clock::now();
+      Pull(table.get(), batch, &values);
+      auto mid = std::chrono::steady_clock::now();
+      Push(table.get(), batch, gradients);
+      auto end = std::chrono::steady_clock::now();
+      pull_seconds += std::chrono::duration<double>(mid - start).count();
+      push_seconds += std::chrono::duration<double>(end - mid).count();
+    }
+    double total_keys = static_cast<double>(kBatchSize) * kSteps;
+    LOG(INFO) << SparseShardType_Name(shard_type) << ": "
+              << total_keys / pull_seconds << " pull keys/sec, "
+              << total_keys / push_seconds << " push keys/sec, "
+              << table->PrintTableStat().first << " features";
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
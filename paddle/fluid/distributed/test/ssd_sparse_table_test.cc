@@ -0,0 +1,164 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+COMMON_DECLARE_string(rocksdb_path);
+PD_DECLARE_int64(pserver_ssd_hot_tier_capacity);
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+constexpr int kEmbDim = 8;
+constexpr int kShardNum = 10;
+
+std::unique_ptr<Table> CreateTable(const std::string& table_class) {
+  TableParameter table_config;
+  table_config.set_table_class(table_class);
+  table_config.set_shard_num(kShardNum);
+
+  TableAccessorParameter* accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(kEmbDim);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+  // Deterministic created values, so the tables can be compared.
+  for (auto* sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto* naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.0);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+
+  FsClientParameter fs_config;
+  std::unique_ptr<Table> table(CREATE_PSCORE_CLASS(Table, table_class));
+  table->SetShard(0, 1);
+  EXPECT_EQ(table->Initialize(table_config, fs_config), 0);
+  return table;
+}
+
+void Pull(Table* table,
+          const std::vector<uint64_t>& keys,
+          std::vector<float>* values) {
+  std::vector<uint32_t> fres(keys.size(), 1);
+  values->resize(keys.size() * (kEmbDim + 3));
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = PullSparseValue(keys, fres, kEmbDim);
+  table_context.pull_context.values = values->data();
+  table->Pull(table_context);
+}
+
+void Push(Table* table,
+          const std::vector<uint64_t>& keys,
+          const std::vector<float>& gradients) {
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.push_context.keys = keys.data();
+  table_context.push_context.values = gradients.data();
+  table_context.num = keys.size();
+  table->Push(table_context);
+}
+
+}  // namespace
+
+TEST(SSDSparseTable, HotTierDemotionKeepsValues) {
+  constexpr int64_t kCapacity = 20;
+  FLAGS_rocksdb_path = "ssd_sparse_table_test_db";
+  FLAGS_pserver_ssd_hot_tier_capacity = kCapacity;
+  auto ssd_table = CreateTable("SSDSparseTable");
+  auto mem_table = CreateTable("MemorySparseTable");
+
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < 1000; ++key) {
+    keys.push_back(key * 17);
+  }
+  std::vector<float> gradients;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    for (int k = 0; k < kEmbDim + 4; ++k) {
+      gradients.push_back(0.01f * static_cast<float>((i + k) % 10));
+    }
+  }
+
+  std::vector<float> ssd_values, mem_values;
+  for (int step = 0; step < 5; ++step) {
+    // Pull then push, as a training step does.
+    Pull(ssd_table.get(), keys, &ssd_values);
+    Pull(mem_table.get(), keys, &mem_values);
+    ASSERT_EQ(ssd_values, mem_values);
+    Push(ssd_table.get(), keys, gradients);
+    Push(mem_table.get(), keys, gradients);
+  }
+  Pull(ssd_table.get(), keys, &ssd_values);
+  Pull(mem_table.get(), keys, &mem_values);
+  ASSERT_EQ(ssd_values, mem_values);
+
+  // A pull with a single key runs after the demotions queued on its shard.
+  for (uint64_t key = 0; key < kShardNum; ++key) {
+    Pull(ssd_table.get(), {key}, &ssd_values);
+  }
+  auto* table = dynamic_cast<SSDSparseTable*>(ssd_table.get());
+  ASSERT_NE(table, nullptr);
+  EXPECT_LE(table->LocalSize(), (kCapacity + 1) * kShardNum);
+  EXPECT_GT(table->PullLatencyPercentile(50), 0UL);
+  EXPECT_GE(table->PullLatencyPercentile(99),
+            table->PullLatencyPercentile(50));
+
+  // The values of a pointer pull are held by the caller, no value is demoted
+  // after it.
+  std::vector<uint64_t> ptr_keys = {0, kShardNum};
+  std::vector<char*> ptr_values(ptr_keys.size());
+  TableContext ptr_context;
+  ptr_context.value_type = Sparse;
+  ptr_context.use_ptr = true;
+  ptr_context.shard_id = 0;
+  ptr_context.pull_context.keys = ptr_keys.data();
+  ptr_context.pull_context.ptr_values = ptr_values.data();
+  ptr_context.num = ptr_keys.size();
+  ASSERT_EQ(ssd_table->Pull(ptr_context), 0);
+  std::vector<uint64_t> new_keys;
+  for (uint64_t key = 0; key < 1000; ++key) {
+    new_keys.push_back(key * 17 + 1);
+  }
+  Pull(ssd_table.get(), new_keys, &ssd_values);
+  Push(ssd_table.get(), new_keys, gradients);
+  for (uint64_t key = 0; key < kShardNum; ++key) {
+    Pull(ssd_table.get(), {key}, &ssd_values);
+  }
+  EXPECT_GE(table->LocalSize(), static_cast<int64_t>(new_keys.size()));
+  FLAGS_pserver_ssd_hot_tier_capacity = 0;
+}
+
+}  // namespace distributed
+}  // namespace paddle
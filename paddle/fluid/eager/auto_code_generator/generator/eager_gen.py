@@ -191,6 +191,30 @@ def ParseArguments():
     return args
 
 
+# The saved tensors whose backward only uses whether their values are
+# positive, so they can be compressed into bit masks, see
+# egr::SavedTensorUsage::kSign.
+SIGN_ONLY_SAVED_TENSORS = {
+    "relu_grad": ["out"],
+    "leaky_relu_grad": ["x"],
+    "dropout_grad": ["mask"],
+}
+
+# The saved tensors whose backward is too sensitive to their precision to
+# compress them, e.g. the probabilities of softmax and the statistics of the
+# normalizations, see egr::SavedTensorUsage::kExact.
+EXACT_SAVED_TENSORS = {
+    "softmax_grad": ["out"],
+    "log_softmax_grad": ["out"],
+    "cross_entropy_with_softmax_grad": ["softmax"],
+    "fused_softmax_mask_grad": ["out"],
+    "fused_softmax_mask_upper_triangle_grad": ["Out"],
+    "layer_norm_grad": ["mean", "variance"],
+    "group_norm_grad": ["mean", "variance"],
+    "batch_norm_grad": ["saved_mean", "saved_variance"],
+    "rms_norm_grad": ["inv_var"],
+}
+
 ######################
 # Code Gen Templates #
 ######################
@@ -2300,9 +2324,22 @@ class DygraphNodeGenerator(DygraphFunctionGeneratorBase):
             no_need_buffer = "true" if tname in no_need_buffers else "false"
             tensor_wrapper_name = GetSavedName(tname)
             if IsPlainTensorType(ttype):
+                tensor_wrapper_args = no_need_buffer
+                if tname in SIGN_ONLY_SAVED_TENSORS.get(
+                    self.backward_api_name, []
+                ):
+                    tensor_wrapper_args += ", egr::SavedTensorUsage::kSign"
+                elif tname in EXACT_SAVED_TENSORS.get(
+                    self.backward_api_name, []
+                ):
+                    tensor_wrapper_args += ", egr::SavedTensorUsage::kExact"
                 set_tensor_wrapper_methods_str += (
                     SET_PLAIN_TENSOR_WRAPPER_TEMPLATE.format(
-                        tname, tname, tensor_wrapper_name, tname, no_need_buffer
+                        tname,
+                        tname,
+                        tensor_wrapper_name,
+                        tname,
+                        tensor_wrapper_args,
                     )
                 )
 
@@ -14,12 +14,25 @@
 
 #include "paddle/fluid/eager/backward.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+#include "paddle/common/flags.h"
 #include "paddle/fluid/eager/general_grad.h"
 #include "paddle/phi/core/memory/stats.h"
+#include "paddle/phi/core/threadpool.h"
 #include "paddle/phi/kernels/autotune/switch_autotune.h"
 
+COMMON_DECLARE_int32(eager_backward_num_threads);
+
 namespace egr {
 
+using GradTensorHolderMap =
+    std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>;
+
 std::unordered_map<GradNodeBase*, int> getInDegreeMap(
     const std::deque<GradNodeBase*>& init_queue) {
   // Calculate in_degree for each node
@@ -100,6 +113,347 @@ void DuplicateCheck(const std::vector<paddle::Tensor>& inputs, bool is_input) {
   }
 }
 
+namespace {
+
+// Adds the grad outputs of node to the GradTensorHolders of its next nodes,
+// and calls on_ready for the next nodes whose in-degree drops to 0.
+void PropagateGradOutputs(
+    GradNodeBase* node,
+    paddle::small_vector<std::vector<paddle::Tensor>, kSlotSmallVectorSize>*
+        grad_output_tensors_ptr,
+    bool create_graph,
+    GradTensorHolderMap* node_input_buffers_dict_ptr,
+    std::unordered_map<GradNodeBase*, int>* node_in_degree_map_ptr,
+    const std::function<void(GradNodeBase*)>& on_ready) {
+  auto& grad_output_tensors = *grad_output_tensors_ptr;
+  auto& node_input_buffers_dict = *node_input_buffers_dict_ptr;
+  auto& node_in_degree_map = *node_in_degree_map_ptr;
+  const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+      metas = node->OutputMeta();
+  PADDLE_ENFORCE(metas.size() == grad_output_tensors.size() || metas.empty(),
+                 common::errors::Fatal(
+                     "Number of edges should be either empty ( for leaf node "
+                     ") or the same as number of output grad tensors, but we "
+                     "got edges size is: %d, grad_output size is: %d",
+                     metas.size(),
+                     grad_output_tensors.size()));
+
+  for (size_t i = 0; i < metas.size(); i++) {
+    for (size_t j = 0; j < metas[i].size(); j++) {
+      const Edge& edge = metas[i][j].GetEdge();
+      if (!edge.IsInitialized()) {
+        continue;
+      }
+      auto edge_rank = edge.GetEdgeRankInfo();
+      // Since we make edge has as same rank as bwd outputs, we indexing them
+      // with the same rank(i, j)
+      auto next_node_shared = edge.GetMutableGradNode();
+      VLOG(3) << "Node: " << node->name() << " addr:" << node
+              << ", Found pending node: " << next_node_shared->name()
+              << " addr: " << next_node_shared.get();
+      // Next node could be nullptr if it is leaf tensor with no
+      // AccumulationNode attached
+      // Or it could also originated from dispensable inputs
+      if (!next_node_shared || !next_node_shared.get() ||
+          grad_output_tensors[i].empty()) {
+        continue;
+      }
+
+      PADDLE_ENFORCE_LT(
+          j,
+          grad_output_tensors[i].size(),
+          common::errors::Fatal(
+              "Rank of grad_output_tensors should be less than "
+              "grad_output_tensors[i].size(), which is: %d. This error may "
+              "indicate autoprune or autograd api error. ",
+              grad_output_tensors.size()));
+      paddle::Tensor& grad_output_tensor = grad_output_tensors[i][j];
+
+      if ((!grad_output_tensor.defined() ||
+           !grad_output_tensor.initialized())) {
+        VLOG(7) << "We get grad_output_tensor with slot: " << i
+                << ", rank: " << j << " as uninitialized or undefined tensor";
+      }
+
+      VLOG(7) << "Get Edge and grad_output_tensor with slot: " << i
+              << ", rank: " << j
+              << " 's name is: " << grad_output_tensor.name();
+
+      auto* next_node = next_node_shared.get();
+      if (!node_input_buffers_dict.count(next_node)) {
+        const auto& input_meta = next_node->InputMeta();
+        auto grad_tensor_holder =
+            std::make_unique<GradTensorHolder>(input_meta);
+        VLOG(7) << "Construct GradTensorHolder for grad node: "
+                << next_node->name();
+        node_input_buffers_dict[next_node] = std::move(grad_tensor_holder);
+      }
+
+      VLOG(3) << "Sum or Move grad inputs for edge slot: " << edge_rank.first
+              << ", rank: " << edge_rank.second;
+
+      node_input_buffers_dict[next_node]->add(edge_rank.first,
+                                              edge_rank.second,
+                                              grad_output_tensor,
+                                              create_graph);
+
+      // Update queue
+      node_in_degree_map[next_node]--;
+      VLOG(7) << next_node->name()
+              << " ref_cnt is: " << node_in_degree_map[next_node];
+
+      PADDLE_ENFORCE(
+          node_in_degree_map[next_node] >= 0,
+          common::errors::Fatal(
+              "Detected in-degree value smaller than zero. For Node: %s"
+              "Node's in-degree cannot be negative.",
+              next_node->name()));
+
+      if (node_in_degree_map[next_node] == 0) {
+        on_ready(next_node);
+      }
+    }
+  }
+}
+
+// The force sequential nodes are released in the order they are recorded in
+// the forward, the others are released as soon as they are ready.
+class ForceSequentialNodes {
+ public:
+  explicit ForceSequentialNodes(
+      const std::unordered_map<GradNodeBase*, int>& node_in_degree_map) {
+    std::queue<GradNodeBase*> forward_queue =
+        egr::Controller::Instance().GetForceSequentialNodes();
+    while (!forward_queue.empty()) {
+      if (node_in_degree_map.count(forward_queue.front())) {
+        nodes_set_.insert(forward_queue.front());
+        nodes_queue_.push_front(forward_queue.front());
+      }
+      forward_queue.pop();
+    }
+  }
+
+  bool Contains(GradNodeBase* node) const { return nodes_set_.count(node); }
+
+  void Release(GradNodeBase* node,
+               const std::function<void(GradNodeBase*)>& release) {
+    if (!nodes_set_.count(node)) {
+      release(node);
+      return;
+    }
+    if (nodes_queue_.front() != node) {
+      ready_nodes_.insert(node);
+      return;
+    }
+    nodes_queue_.pop_front();
+    release(node);
+    while (!nodes_queue_.empty() && ready_nodes_.count(nodes_queue_.front())) {
+      ready_nodes_.erase(nodes_queue_.front());
+      release(nodes_queue_.front());
+      nodes_queue_.pop_front();
+    }
+  }
+
+ private:
+  std::deque<GradNodeBase*> nodes_queue_;
+  std::set<GradNodeBase*> nodes_set_;
+  std::set<GradNodeBase*> ready_nodes_;
+};
+
+// Set in the threads of the parallel backward, so a backward started by a grad
+// node, e.g. of a PyLayer, runs in its own thread instead of waiting for the
+// thread pool it occupies.
+thread_local bool in_parallel_backward = false;
+
+// The pool is recreated when FLAGS_eager_backward_num_threads changes, a
+// running backward keeps the old one alive until it finishes.
+std::shared_ptr<phi::ThreadPool> ParallelBackwardThreadPool() {
+  static std::mutex mutex;
+  static std::shared_ptr<phi::ThreadPool> pool;
+  static int num_threads = 0;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!pool || num_threads != std::max(FLAGS_eager_backward_num_threads, 1)) {
+    num_threads = std::max(FLAGS_eager_backward_num_threads, 1);
+    pool = std::make_shared<phi::ThreadPool>(num_threads);
+  }
+  return pool;
+}
+
+bool UseParallelBackward(const phi::Place& place,
+                         bool create_graph,
+                         bool is_general_grad) {
+  return FLAGS_eager_backward_num_threads > 0 && phi::is_cpu_place(place) &&
+         !create_graph && !is_general_grad && !in_parallel_backward;
+}
+
+/**
+ * Runs the grad nodes of a backward in the threads of
+ * ParallelBackwardThreadPool as soon as their in-degrees drop to 0, so the
+ * independent branches of the graph run concurrently.
+ *
+ * The GradTensorHolders and the in-degrees are only touched under mutex_.
+ * The accumulation nodes, which run the reduce hooks of the leaf tensors, the
+ * nodes with gradient hooks and the force sequential nodes run in the calling
+ * thread in the order they get ready, which keeps the order of the force
+ * sequential nodes.
+ */
+class ParallelBackwardExecutor {
+ public:
+  ParallelBackwardExecutor(GradTensorHolderMap* node_input_buffers_dict,
+                           std::unordered_map<GradNodeBase*, int>* in_degree,
+                           ForceSequentialNodes* force_sequential_nodes,
+                           bool retain_graph,
+                           const phi::Place& place)
+      : node_input_buffers_dict_(node_input_buffers_dict),
+        node_in_degree_map_(in_degree),
+        force_sequential_nodes_(force_sequential_nodes),
+        retain_graph_(retain_graph),
+        place_(place),
+        tracer_(egr::Controller::Instance().GetCurrentTracer()),
+        has_grad_(egr::Controller::Instance().HasGrad()),
+        pool_(ParallelBackwardThreadPool()) {}
+
+  // Takes the startup nodes out of queue and runs the backward.
+  void Run(std::deque<GradNodeBase*>* queue) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (GradNodeBase* node : *queue) {
+      // The others are dispatched when their in-degrees drop to 0.
+      auto iter = node_in_degree_map_->find(node);
+      if (iter == node_in_degree_map_->end() || iter->second == 0) {
+        Dispatch(node);
+      }
+    }
+    queue->clear();
+
+    while (true) {
+      cv_.wait(lock, [this] {
+        return !calling_thread_nodes_.empty() || num_pending_nodes_ == 0;
+      });
+      if (calling_thread_nodes_.empty()) break;
+      GradNodeBase* node = calling_thread_nodes_.front();
+      calling_thread_nodes_.pop_front();
+      if (!error_) {
+        lock.unlock();
+        RunNodeAndCatch(node);
+        lock.lock();
+      }
+      --num_pending_nodes_;
+    }
+    if (error_) std::rethrow_exception(error_);
+  }
+
+ private:
+  bool RunsInCallingThread(GradNodeBase* node) const {
+    return dynamic_cast<egr::GradNodeAccumulation*>(node) ||
+           node->GradientHooksRegistered() ||
+           force_sequential_nodes_->Contains(node);
+  }
+
+  // Requires mutex_.
+  void Dispatch(GradNodeBase* node) {
+    ++num_pending_nodes_;
+    if (RunsInCallingThread(node)) {
+      calling_thread_nodes_.push_back(node);
+      cv_.notify_all();
+      return;
+    }
+    pool_->Run([this, node] { RunInWorker(node); });
+  }
+
+  void RunInWorker(GradNodeBase* node) {
+    egr::Controller::Instance().SetCurrentTracer(tracer_);
+    egr::Controller::Instance().SetHasGrad(has_grad_);
+    in_parallel_backward = true;
+    bool skip;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      skip = error_ != nullptr;
+    }
+    if (!skip) RunNodeAndCatch(node);
+    in_parallel_backward = false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    --num_pending_nodes_;
+    cv_.notify_all();
+  }
+
+  void RunNodeAndCatch(GradNodeBase* node) {
+    try {
+      RunNode(node);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) error_ = std::current_exception();
+    }
+  }
+
+  void RunNode(GradNodeBase* node) {
+    VLOG(3) << "Preparing GradNode:" << node->name() << " addr:" << node;
+    std::unique_ptr<GradTensorHolder> node_input_buffer;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto node_input_buffer_iter = node_input_buffers_dict_->find(node);
+      PADDLE_ENFORCE_NE(
+          node_input_buffer_iter,
+          node_input_buffers_dict_->end(),
+          common::errors::Fatal(
+              "Unable to find next node in the GradTensorHolder \n"
+              "Trying to run Node without configuring its "
+              "GradTensorHolder."));
+      node_input_buffer = std::move(node_input_buffer_iter->second);
+      node_input_buffers_dict_->erase(node_input_buffer_iter);
+    }
+
+    EnforceGradNodeHasInput(node);
+
+    paddle::small_vector<std::vector<paddle::Tensor>, kSlotSmallVectorSize>
+        grad_output_tensors;
+    {
+      phi::RecordEvent grad_node_record_event(
+          "Global_" + std::string((*node).name()),
+          phi::TracerEventType::Operator,
+          1);
+      grad_output_tensors = (*node)(node_input_buffer->Buffers(),
+                                    /*create_graph=*/false,
+                                    /*is_new_grad=*/false);
+    }
+
+    if (!retain_graph_) {
+      node->ClearTensorWrappers();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    PropagateGradOutputs(
+        node,
+        &grad_output_tensors,
+        /*create_graph=*/false,
+        node_input_buffers_dict_,
+        node_in_degree_map_,
+        [this](GradNodeBase* next_node) {
+          force_sequential_nodes_->Release(
+              next_node, [this](GradNodeBase* ready) { Dispatch(ready); });
+        });
+    paddle::memory::LogDeviceMemoryStats(place_, std::string((*node).name()));
+  }
+
+  GradTensorHolderMap* node_input_buffers_dict_;
+  std::unordered_map<GradNodeBase*, int>* node_in_degree_map_;
+  ForceSequentialNodes* force_sequential_nodes_;
+  const bool retain_graph_;
+  const phi::Place place_;
+  const std::shared_ptr<paddle::imperative::Tracer> tracer_;
+  const bool has_grad_;
+  const std::shared_ptr<phi::ThreadPool> pool_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  // The nodes dispatched but not finished yet.
+  int num_pending_nodes_{0};
+  std::deque<GradNodeBase*> calling_thread_nodes_;
+  std::exception_ptr error_;
+};
+
+}  // namespace
+
 GeneralGrad* GeneralGrad::general_grad_ = new GeneralGrad();
 
 std::vector<paddle::Tensor> RunBackward(
@@ -223,26 +577,29 @@ std::vector<paddle::Tensor> RunBackward(
   std::unordered_map<GradNodeBase*, int> node_in_degree_map =
       getInDegreeMap(queue);
 
-  std::queue<GradNodeBase*> force_sequential_nodes_forward_queue =
-      egr::Controller::Instance().GetForceSequentialNodes();
-  std::deque<GradNodeBase*> force_sequential_nodes_queue;
-  std::set<GradNodeBase*> force_sequential_nodes_set;
-  std::set<GradNodeBase*> ready_force_sequential_nodes;
-  auto force_sequential_nodes_size =
-      force_sequential_nodes_forward_queue.size();
-  for (size_t i = 0; i < force_sequential_nodes_size; ++i) {
-    if (node_in_degree_map.count(
-            force_sequential_nodes_forward_queue.front())) {
-      force_sequential_nodes_set.insert(
-          force_sequential_nodes_forward_queue.front());
-      force_sequential_nodes_queue.push_front(
-          force_sequential_nodes_forward_queue.front());
-    }
-    force_sequential_nodes_forward_queue.pop();
-  }
+  ForceSequentialNodes force_sequential_nodes(node_in_degree_map);
 
   VLOG(5) << "Startup_ops's size is " << queue.size();
 
+  if (UseParallelBackward(place, create_graph, is_general_grad)) {
+    VLOG(3) << "Run backward in " << FLAGS_eager_backward_num_threads
+            << " threads";
+    ParallelBackwardExecutor executor(&node_input_buffers_dict,
+                                      &node_in_degree_map,
+                                      &force_sequential_nodes,
+                                      retain_graph,
+                                      place);
+    executor.Run(&queue);
+  }
+
+  auto add_next_node_func = [&queue](GradNodeBase* next_node) {
+    if (dynamic_cast<egr::GradNodeAccumulation*>(next_node)) {
+      queue.push_front(next_node);
+    } else {
+      queue.push_back(next_node);
+    }
+  };
+
   /* --- Topological Visit --- */
   // 1. Pop queue
   // 2. Run node
@@ -312,116 +669,15 @@ std::vector<paddle::Tensor> RunBackward(
     node_input_buffers_dict.erase(node_input_buffer_iter);
 
     // Prepare GradTensorHolder for next node
-    const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
-        metas = node->OutputMeta();
-    PADDLE_ENFORCE(metas.size() == grad_output_tensors.size() || metas.empty(),
-                   common::errors::Fatal(
-                       "Number of edges should be either empty ( for leaf node "
-                       ") or the same as number of output grad tensors, but we "
-                       "got edges size is: %d, grad_output size is: %d",
-                       metas.size(),
-                       grad_output_tensors.size()));
-
-    for (size_t i = 0; i < metas.size(); i++) {
-      for (size_t j = 0; j < metas[i].size(); j++) {
-        const Edge& edge = metas[i][j].GetEdge();
-        if (!edge.IsInitialized()) {
-          continue;
-        }
-        auto edge_rank = edge.GetEdgeRankInfo();
-        // Since we make edge has as same rank as bwd outputs, we indexing them
-        // with the same rank(i, j)
-        auto next_node_shared = edge.GetMutableGradNode();
-        VLOG(3) << "Node: " << node->name() << " addr:" << node
-                << ", Found pending node: " << next_node_shared->name()
-                << " addr: " << next_node_shared.get();
-        // Next node could be nullptr if it is leaf tensor with no
-        // AccumulationNode attached
-        // Or it could also originated from dispensable inputs
-        if (!next_node_shared || !next_node_shared.get() ||
-            grad_output_tensors[i].empty()) {
-          continue;
-        }
-
-        PADDLE_ENFORCE_LT(
-            j,
-            grad_output_tensors[i].size(),
-            common::errors::Fatal(
-                "Rank of grad_output_tensors should be less than "
-                "grad_output_tensors[i].size(), which is: %d. This error may "
-                "indicate autoprune or autograd api error. ",
-                grad_output_tensors.size()));
-        paddle::Tensor& grad_output_tensor = grad_output_tensors[i][j];
-
-        if ((!grad_output_tensor.defined() ||
-             !grad_output_tensor.initialized())) {
-          VLOG(7) << "We get grad_output_tensor with slot: " << i
-                  << ", rank: " << j << " as uninitialized or undefined tensor";
-        }
-
-        VLOG(7) << "Get Edge and grad_output_tensor with slot: " << i
-                << ", rank: " << j
-                << " 's name is: " << grad_output_tensor.name();
-
-        auto* next_node = next_node_shared.get();
-        if (!node_input_buffers_dict.count(next_node)) {
-          const auto& input_meta = next_node->InputMeta();
-          auto grad_tensor_holder =
-              std::make_unique<GradTensorHolder>(input_meta);
-          VLOG(7) << "Construct GradTensorHolder for grad node: "
-                  << next_node->name();
-          node_input_buffers_dict[next_node] = std::move(grad_tensor_holder);
-        }
-
-        VLOG(3) << "Sum or Move grad inputs for edge slot: " << edge_rank.first
-                << ", rank: " << edge_rank.second;
-
-        node_input_buffers_dict[next_node]->add(edge_rank.first,
-                                                edge_rank.second,
-                                                grad_output_tensor,
-                                                create_graph);
-
-        // Update queue
-        node_in_degree_map[next_node]--;
-        VLOG(7) << next_node->name()
-                << " ref_cnt is: " << node_in_degree_map[next_node];
-
-        PADDLE_ENFORCE(
-            node_in_degree_map[next_node] >= 0,
-            common::errors::Fatal(
-                "Detected in-degree value smaller than zero. For Node: %s"
-                "Node's in-degree cannot be negative.",
-                next_node->name()));
-
-        auto add_next_node_func = [&queue](GradNodeBase* next_node) {
-          if (dynamic_cast<egr::GradNodeAccumulation*>(next_node)) {
-            queue.push_front(next_node);
-          } else {
-            queue.push_back(next_node);
-          }
-        };
-        if (node_in_degree_map[next_node] == 0) {
-          if (force_sequential_nodes_set.count(next_node)) {
-            if (force_sequential_nodes_queue.front() == next_node) {
-              force_sequential_nodes_queue.pop_front();
-              add_next_node_func(next_node);
-              while (ready_force_sequential_nodes.count(
-                  force_sequential_nodes_queue.front())) {
-                ready_force_sequential_nodes.erase(
-                    force_sequential_nodes_queue.front());
-                add_next_node_func(force_sequential_nodes_queue.front());
-                force_sequential_nodes_queue.pop_front();
-              }
-            } else {
-              ready_force_sequential_nodes.insert(next_node);
-              continue;
-            }
-          } else {
-            add_next_node_func(next_node);
-          }
-        }
-      }
-    }
+    PropagateGradOutputs(node,
+                         &grad_output_tensors,
+                         create_graph,
+                         &node_input_buffers_dict,
+                         &node_in_degree_map,
+                         [&](GradNodeBase* next_node) {
+                           force_sequential_nodes.Release(next_node,
+                                                          add_next_node_func);
+                         });
     paddle::memory::LogDeviceMemoryStats(place, std::string((*node).name()));
   }
 
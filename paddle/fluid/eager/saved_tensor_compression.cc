@@ -0,0 +1,201 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/eager/saved_tensor_compression.h"
+
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/eager/utils.h"
+#include "paddle/phi/api/include/api.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/core/enforce.h"
+
+COMMON_DECLARE_string(eager_saved_tensor_compression);
+
+namespace egr {
+
+namespace {
+
+// The small tensors are not worth the extra kernels.
+constexpr int64_t kMinCompressNumel = 4096;
+
+template <typename T>
+void PackSigns(const T* x, int64_t numel, uint8_t* bits) {
+  std::memset(bits, 0, (numel + 7) / 8);
+  for (int64_t i = 0; i < numel; ++i) {
+    if (x[i] > static_cast<T>(0)) {
+      bits[i >> 3] |= static_cast<uint8_t>(1 << (i & 7));
+    }
+  }
+}
+
+template <typename T>
+void UnpackSigns(const uint8_t* bits, int64_t numel, T* x) {
+  for (int64_t i = 0; i < numel; ++i) {
+    x[i] = static_cast<T>((bits[i >> 3] >> (i & 7)) & 1);
+  }
+}
+
+// Calls fn with a null pointer of the type of dtype, returns false if dtype
+// can't be saved as a bit mask.
+template <typename Fn>
+bool VisitMaskType(phi::DataType dtype, Fn fn) {
+  switch (dtype) {
+    case phi::DataType::FLOAT32:
+      fn(static_cast<float*>(nullptr));
+      return true;
+    case phi::DataType::FLOAT64:
+      fn(static_cast<double*>(nullptr));
+      return true;
+    case phi::DataType::FLOAT16:
+      fn(static_cast<phi::dtype::float16*>(nullptr));
+      return true;
+    case phi::DataType::BFLOAT16:
+      fn(static_cast<phi::dtype::bfloat16*>(nullptr));
+      return true;
+    case phi::DataType::UINT8:
+      fn(static_cast<uint8_t*>(nullptr));
+      return true;
+    case phi::DataType::BOOL:
+      fn(static_cast<bool*>(nullptr));
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+std::shared_ptr<CompressedSavedTensor> CompressedSavedTensor::Compress(
+    const paddle::Tensor& tensor, SavedTensorUsage usage) {
+  const std::string& policy = FLAGS_eager_saved_tensor_compression;
+  if (policy.empty()) return nullptr;
+  PADDLE_ENFORCE_EQ(
+      policy == "bf16" || policy == "int8",
+      true,
+      common::errors::InvalidArgument(
+          "FLAGS_eager_saved_tensor_compression should be empty, bf16 or "
+          "int8, but got %s.",
+          policy));
+  if (usage == SavedTensorUsage::kExact) return nullptr;
+  if (!tensor.initialized() || !tensor.is_dense_tensor()) return nullptr;
+  const auto* dense_tensor =
+      static_cast<const phi::DenseTensor*>(tensor.impl().get());
+  if (!dense_tensor->meta().is_contiguous() ||
+      dense_tensor->numel() < kMinCompressNumel) {
+    return nullptr;
+  }
+
+  const phi::DataType dtype = dense_tensor->dtype();
+  const phi::DenseTensorMeta meta(
+      dtype, dense_tensor->dims(), dense_tensor->layout());
+  const int64_t numel = dense_tensor->numel();
+
+  if (usage == SavedTensorUsage::kSign) {
+    if (!phi::is_cpu_place(tensor.place())) return nullptr;
+    paddle::Tensor bits = paddle::experimental::empty(
+        {(numel + 7) / 8}, phi::DataType::UINT8, phi::CPUPlace());
+    bool packed = VisitMaskType(dtype, [&](auto* type_tag) {
+      using T = std::remove_pointer_t<decltype(type_tag)>;
+      PackSigns(dense_tensor->data<T>(), numel, bits.data<uint8_t>());
+    });
+    if (!packed) return nullptr;
+    std::shared_ptr<CompressedSavedTensor> compressed(
+        new CompressedSavedTensor(Format::kBitMask, meta));
+    compressed->data_ = bits;
+    return compressed;
+  }
+
+  if ((dtype != phi::DataType::FLOAT32 && dtype != phi::DataType::FLOAT64) ||
+      EagerUtils::IsLeafTensor(tensor)) {
+    return nullptr;
+  }
+  if (policy == "bf16") {
+    std::shared_ptr<CompressedSavedTensor> compressed(
+        new CompressedSavedTensor(Format::kBFloat16, meta));
+    compressed->data_ =
+        paddle::experimental::cast(tensor, phi::DataType::BFLOAT16);
+    return compressed;
+  }
+
+  const int rank = dense_tensor->dims().size();
+  const int channel_axis = rank == 4 ? 1 : rank - 1;
+  std::vector<int64_t> reduce_axes;
+  for (int axis = 0; axis < rank; ++axis) {
+    if (axis != channel_axis) reduce_axes.push_back(axis);
+  }
+  // An all-zero channel gets a tiny scale instead of 0.
+  paddle::Tensor scale = paddle::experimental::scale(
+      paddle::experimental::clip(
+          paddle::experimental::max(
+              paddle::experimental::abs(tensor), reduce_axes, true),
+          std::numeric_limits<float>::min(),
+          std::numeric_limits<float>::max()),
+      1.0 / 127,
+      0.0,
+      true);
+  std::shared_ptr<CompressedSavedTensor> compressed(
+      new CompressedSavedTensor(Format::kInt8, meta));
+  compressed->data_ = paddle::experimental::cast(
+      paddle::experimental::round(paddle::experimental::divide(tensor, scale),
+                                  0),
+      phi::DataType::INT8);
+  compressed->scale_ = scale;
+  return compressed;
+}
+
+std::shared_ptr<phi::DenseTensor> CompressedSavedTensor::Decompress() const {
+  paddle::Tensor restored;
+  switch (format_) {
+    case Format::kBFloat16:
+      restored = paddle::experimental::cast(data_, meta_.dtype);
+      break;
+    case Format::kInt8:
+      restored = paddle::experimental::multiply(
+          paddle::experimental::cast(data_, meta_.dtype), scale_);
+      break;
+    case Format::kBitMask: {
+      const int64_t numel = common::product(meta_.dims);
+      restored = paddle::experimental::empty(
+          common::vectorize(meta_.dims), meta_.dtype, phi::CPUPlace());
+      VisitMaskType(meta_.dtype, [&](auto* type_tag) {
+        using T = std::remove_pointer_t<decltype(type_tag)>;
+        UnpackSigns(data_.data<uint8_t>(), numel, restored.data<T>());
+      });
+      break;
+    }
+  }
+  auto restored_tensor = std::make_shared<phi::DenseTensor>(
+      *static_cast<phi::DenseTensor*>(restored.impl().get()));
+  restored_tensor->set_meta(meta_);
+  return restored_tensor;
+}
+
+int64_t CompressedSavedTensor::CompressedBytes() const {
+  int64_t bytes = static_cast<int64_t>(data_.numel()) *
+                  static_cast<int64_t>(phi::SizeOf(data_.dtype()));
+  if (scale_.initialized()) {
+    bytes += static_cast<int64_t>(scale_.numel()) *
+             static_cast<int64_t>(phi::SizeOf(scale_.dtype()));
+  }
+  return bytes;
+}
+
+}  // namespace egr
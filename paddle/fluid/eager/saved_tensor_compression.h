@@ -0,0 +1,79 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+#include "paddle/phi/api/include/tensor.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace egr {
+
+// How the backward uses a tensor saved in a TensorWrapper.
+enum class SavedTensorUsage {
+  // The values are used.
+  kValue,
+  // Only whether the values are positive is used, e.g. the out of relu.
+  kSign,
+  // The values are used and are too sensitive to precision to be compressed,
+  // e.g. the out of softmax.
+  kExact,
+};
+
+/**
+ * A tensor saved for the backward in the compressed form chosen by
+ * FLAGS_eager_saved_tensor_compression:
+ *
+ * - kBFloat16: the float values in bfloat16.
+ * - kInt8: the float values in int8, with the max magnitude of each channel
+ *   as its scale. The channel is dim 1 of 4-D tensors, e.g. NCHW
+ *   activations, and the last dim of the others.
+ * - kBitMask: one bit per value for SavedTensorUsage::kSign, restored as 0
+ *   and 1. Only on CPU.
+ *
+ * Only the activations are compressed. The leaf tensors, e.g. the parameters,
+ * are kept alive outside of the backward anyway, so a compressed copy of them
+ * would only add memory. The tensors saved as SavedTensorUsage::kExact are
+ * never compressed.
+ */
+class CompressedSavedTensor {
+ public:
+  enum class Format { kBFloat16, kInt8, kBitMask };
+
+  // Returns nullptr if the tensor is not compressed.
+  static std::shared_ptr<CompressedSavedTensor> Compress(
+      const paddle::Tensor& tensor, SavedTensorUsage usage);
+
+  // Restores a tensor of the meta of the saved one.
+  std::shared_ptr<phi::DenseTensor> Decompress() const;
+
+  Format format() const { return format_; }
+
+  // The bytes the compressed form takes.
+  int64_t CompressedBytes() const;
+
+ private:
+  CompressedSavedTensor(Format format, const phi::DenseTensorMeta& meta)
+      : format_(format), meta_(meta) {}
+
+  const Format format_;
+  // The meta of the saved tensor, with offset 0.
+  const phi::DenseTensorMeta meta_;
+  paddle::Tensor data_;
+  // The scales of kInt8, broadcastable to data_.
+  paddle::Tensor scale_;
+};
+
+}  // namespace egr
@@ -27,6 +27,7 @@
 #pragma once
 #include "paddle/fluid/eager/autograd_meta.h"
 #include "paddle/fluid/eager/grad_node_info.h"
+#include "paddle/fluid/eager/saved_tensor_compression.h"
 #include "paddle/fluid/eager/utils.h"
 #include "paddle/phi/api/lib/utils/allocator.h"
 #ifndef PADDLE_NO_PYTHON
@@ -40,7 +41,8 @@ class TensorWrapper {
  public:
   TensorWrapper() = default;
   explicit TensorWrapper(const paddle::Tensor& tensor,
-                         bool no_need_buffer = false) {
+                         bool no_need_buffer = false,
+                         SavedTensorUsage usage = SavedTensorUsage::kValue) {
     // set inplace_version_snapshot_ according to tensor's current inplace
     // version.
     if (tensor.initialized() && tensor.is_dense_tensor()) {
@@ -122,7 +124,17 @@ class TensorWrapper {
         packed_value_ = (*pack_hook)(tensor);
       } else {
 #endif
-        intermidiate_tensor_.set_impl(tensor.impl());
+        compressed_tensor_ = CompressedSavedTensor::Compress(tensor, usage);
+        if (compressed_tensor_) {
+          // Keep the meta and the inplace version counter of the tensor, the
+          // data is restored from compressed_tensor_ in recover.
+          auto meta_tensor = std::make_shared<phi::DenseTensor>(
+              *static_cast<phi::DenseTensor*>(tensor.impl().get()));
+          meta_tensor->clear();
+          intermidiate_tensor_.set_impl(meta_tensor);
+        } else {
+          intermidiate_tensor_.set_impl(tensor.impl());
+        }
 #ifndef PADDLE_NO_PYTHON
       }
 #endif
@@ -191,6 +203,11 @@ class TensorWrapper {
 #endif
 
     paddle::Tensor recovered_tensor = intermidiate_tensor_;
+    if (compressed_tensor_) {
+      // Restore a new tensor each time, so the wrapper keeps the compressed
+      // form when the graph is retained.
+      recovered_tensor.set_impl(compressed_tensor_->Decompress());
+    }
 
     std::shared_ptr<GradNodeBase> new_grad_node = weak_grad_node_.lock();
     if (new_grad_node) {
@@ -216,7 +233,10 @@ class TensorWrapper {
 
   paddle::Tensor get_intermidiate_tensor() { return intermidiate_tensor_; }
 
-  void clear() { intermidiate_tensor_.reset(); }
+  void clear() {
+    intermidiate_tensor_.reset();
+    compressed_tensor_.reset();
+  }
 
  private:
   void check_inplace_version() {
@@ -270,6 +290,7 @@ class TensorWrapper {
   paddle::Tensor intermidiate_tensor_;
   std::weak_ptr<egr::GradNodeBase> weak_grad_node_;
   uint32_t inplace_version_snapshot_ = 0;
+  std::shared_ptr<CompressedSavedTensor> compressed_tensor_;
 #ifndef PADDLE_NO_PYTHON
   std::shared_ptr<egr::PyObjectHolderBase> packed_value_;
   std::shared_ptr<egr::UnPackHookBase> unpack_hook_;
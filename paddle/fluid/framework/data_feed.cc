@@ -19,7 +19,10 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/data_feed.h"
 
+#include <algorithm>
+
 #include "paddle/fluid/framework/fleet/ps_gpu_wrapper.h"
+#include "paddle/fluid/framework/pipelined_line_file_reader.h"
 #ifdef _LINUX
 #include <stdio_ext.h>
 #include <sys/mman.h>
@@ -32,6 +35,7 @@ limitations under the License. */
 
 USE_INT_STAT(STAT_total_feasign_num_in_mem);
 COMMON_DECLARE_bool(enable_ins_parser_file);
+COMMON_DECLARE_int32(data_feed_parse_thread_num);
 namespace paddle::framework {
 
 DLManager& global_dlmanager_pool() {
@@ -142,6 +146,7 @@ class BufferedLineFileReader {
   size_t sample_line_ = 0;
   size_t error_line_ = 0;
 };
+
 void RecordCandidateList::ReSize(size_t length) {
   mutex_.lock();
   capacity_ = length;
@@ -1169,6 +1174,72 @@ int MultiSlotInMemoryDataFeed::ParseInstanceFromSo(
   return parser->ParseInstance(len, str, instances);
 }
 
+void MultiSlotInMemoryDataFeed::LoadIntoMemory() {
+  if (!so_parser_name_.empty() || FLAGS_data_feed_parse_thread_num <= 0) {
+    InMemoryDataFeed<Record>::LoadIntoMemory();
+    return;
+  }
+#ifdef _LINUX
+  VLOG(3) << "LoadIntoMemoryByPipeline() begin, thread_id=" << thread_id_;
+  std::string filename;
+  const int parse_thread_num = FLAGS_data_feed_parse_thread_num;
+  PipelinedLineFileReader line_reader(parse_thread_num);
+  while (this->PickOneFile(&filename)) {
+    VLOG(3) << "PickOneFile, filename=" << filename
+            << ", thread_id=" << thread_id_;
+#ifdef PADDLE_WITH_BOX_PS
+    if (BoxWrapper::GetInstance()->UseAfsApi()) {
+      this->fp_ = BoxWrapper::GetInstance()->afs_manager->GetFile(
+          filename, this->pipe_command_);
+    } else {
+#endif
+      int err_no = 0;
+      this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_, true);
+#ifdef PADDLE_WITH_BOX_PS
+    }
+#endif
+    PADDLE_ENFORCE_EQ(this->fp_ != nullptr,
+                      true,
+                      common::errors::InvalidArgument(
+                          "This fp should not be null, please check!"));
+    __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
+    std::vector<std::unique_ptr<ChannelWriter<Record>>> writers;
+    std::vector<uint64_t> fea_nums(parse_thread_num, 0);
+    for (int tid = 0; tid < parse_thread_num; ++tid) {
+      writers.emplace_back(
+          std::make_unique<ChannelWriter<Record>>(input_channel_));
+    }
+    platform::Timer timeline;
+    timeline.Start();
+    line_reader.read_file(
+        this->fp_.get(),
+        [this, &writers, &fea_nums](int tid, const std::string& line) {
+          Record instance;
+          ParseOneInstanceFromLine(line.c_str(), &instance);
+          fea_nums[tid] += instance.uint64_feasigns_.size();
+          *writers[tid] << std::move(instance);
+          return true;
+        },
+        0);
+    for (int tid = 0; tid < parse_thread_num; ++tid) {
+      writers[tid]->Flush();
+      fea_num_ += fea_nums[tid];
+    }
+    STAT_ADD(STAT_total_feasign_num_in_mem, fea_num_);
+    {
+      std::lock_guard<std::mutex> flock(*mutex_for_fea_num_);
+      *total_fea_num_ += fea_num_;
+      fea_num_ = 0;
+    }
+    timeline.Pause();
+    VLOG(3) << "LoadIntoMemoryByPipeline() read all lines, file=" << filename
+            << ", cost time=" << timeline.ElapsedSec()
+            << " seconds, thread_id=" << thread_id_;
+  }
+  VLOG(3) << "LoadIntoMemoryByPipeline() end, thread_id=" << thread_id_;
+#endif
+}
+
 bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
 #ifdef _LINUX
   thread_local string::LineFileReader reader;
@@ -1176,141 +1247,145 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
   if (!reader.getline(&*(fp_.get()))) {
     return false;
   } else {
-    const char* str = reader.get();
-    std::string line = std::string(str);
-    // VLOG(3) << line;
-    char* endptr = const_cast<char*>(str);
-    int pos = 0;
-    if (parse_ins_id_) {
-      int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
-      PADDLE_ENFORCE_EQ(num == 1,
-                        true,
-                        common::errors::InvalidArgument(
-                            "Num should be equal to 1, but received %d.", num));
-      pos = static_cast<int>(endptr - str + 1);
-      size_t len = 0;
-      while (str[pos + len] != ' ') {
-        ++len;
-      }
-      instance->ins_id_ = std::string(str + pos, len);
-      pos += static_cast<int>(len) + 1;
-      VLOG(3) << "ins_id " << instance->ins_id_;
-    }
-    if (parse_content_) {
-      int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
-      PADDLE_ENFORCE_EQ(num == 1,
-                        true,
-                        common::errors::InvalidArgument(
-                            "Num should be equal to 1, but received %d.", num));
-      pos = static_cast<int>(endptr - str + 1);
-      size_t len = 0;
-      while (str[pos + len] != ' ') {
-        ++len;
-      }
-      instance->content_ = std::string(str + pos, len);
-      pos += static_cast<int>(len) + 1;
-      VLOG(3) << "content " << instance->content_;
-    }
-    if (parse_logkey_) {
-      int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
-      PADDLE_ENFORCE_EQ(num == 1,
-                        true,
-                        common::errors::InvalidArgument(
-                            "Num should be equal to 1, but received %d.", num));
-      pos = static_cast<int>(endptr - str + 1);
-      size_t len = 0;
-      while (str[pos + len] != ' ') {
-        ++len;
-      }
-      // parse_logkey
-      std::string log_key = std::string(str + pos, len);
-      uint64_t search_id;
-      uint32_t cmatch;
-      uint32_t rank;
-      GetMsgFromLogKey(log_key, &search_id, &cmatch, &rank);
-
-      instance->ins_id_ = log_key;
-      instance->search_id = search_id;
-      instance->cmatch = cmatch;
-      instance->rank = rank;
-      pos += static_cast<int>(len) + 1;
+    ParseOneInstanceFromLine(reader.get(), instance);
+    fea_num_ += instance->uint64_feasigns_.size();
+    return true;
+  }
+#else
+  return false;
+#endif
+}
+
+void MultiSlotInMemoryDataFeed::ParseOneInstanceFromLine(const char* str,
+                                                         Record* instance) {
+  std::string line = std::string(str);
+  // VLOG(3) << line;
+  char* endptr = const_cast<char*>(str);
+  int pos = 0;
+  if (parse_ins_id_) {
+    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+    PADDLE_ENFORCE_EQ(num == 1,
+                      true,
+                      common::errors::InvalidArgument(
+                          "Num should be equal to 1, but received %d.", num));
+    pos = static_cast<int>(endptr - str + 1);
+    size_t len = 0;
+    while (str[pos + len] != ' ') {
+      ++len;
     }
-    for (size_t i = 0; i < use_slots_index_.size(); ++i) {
-      int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
-      PADDLE_ENFORCE_NE(
-          num,
-          0,
-          common::errors::InvalidArgument(
-              "The number of ids can not be zero, you need padding "
-              "it in data generator; or if there is something wrong with "
-              "the data, please check if the data contains unresolvable "
-              "characters.\nplease check this error line: %s, \n Specifically, "
-              "something wrong happened(the length of this slot's feasign is 0)"
-              "when we parse the %d th slots."
-              "Maybe something wrong around this slot"
-              "\nWe detect the feasign number of this slot is %d, "
-              "which is illegal.",
-              str,
-              i,
-              num));
+    instance->ins_id_ = std::string(str + pos, len);
+    pos += static_cast<int>(len) + 1;
+    VLOG(3) << "ins_id " << instance->ins_id_;
+  }
+  if (parse_content_) {
+    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+    PADDLE_ENFORCE_EQ(num == 1,
+                      true,
+                      common::errors::InvalidArgument(
+                          "Num should be equal to 1, but received %d.", num));
+    pos = static_cast<int>(endptr - str + 1);
+    size_t len = 0;
+    while (str[pos + len] != ' ') {
+      ++len;
+    }
+    instance->content_ = std::string(str + pos, len);
+    pos += static_cast<int>(len) + 1;
+    VLOG(3) << "content " << instance->content_;
+  }
+  if (parse_logkey_) {
+    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+    PADDLE_ENFORCE_EQ(num == 1,
+                      true,
+                      common::errors::InvalidArgument(
+                          "Num should be equal to 1, but received %d.", num));
+    pos = static_cast<int>(endptr - str + 1);
+    size_t len = 0;
+    while (str[pos + len] != ' ') {
+      ++len;
+    }
+    // parse_logkey
+    std::string log_key = std::string(str + pos, len);
+    uint64_t search_id;
+    uint32_t cmatch;
+    uint32_t rank;
+    GetMsgFromLogKey(log_key, &search_id, &cmatch, &rank);
+
+    instance->ins_id_ = log_key;
+    instance->search_id = search_id;
+    instance->cmatch = cmatch;
+    instance->rank = rank;
+    pos += static_cast<int>(len) + 1;
+  }
+  for (size_t i = 0; i < use_slots_index_.size(); ++i) {
+    int idx = use_slots_index_[i];
+    int num = strtol(&str[pos], &endptr, 10);
+    PADDLE_ENFORCE_NE(
+        num,
+        0,
+        common::errors::InvalidArgument(
+            "The number of ids can not be zero, you need padding "
+            "it in data generator; or if there is something wrong with "
+            "the data, please check if the data contains unresolvable "
+            "characters.\nplease check this error line: %s, \n Specifically, "
+            "something wrong happened(the length of this slot's feasign is 0)"
+            "when we parse the %d th slots."
+            "Maybe something wrong around this slot"
+            "\nWe detect the feasign number of this slot is %d, "
+            "which is illegal.",
+            str,
+            i,
+            num));
 #ifdef PADDLE_WITH_PSLIB
-      if (parse_uid_ && all_slots_[i] == uid_slot_) {
-        PADDLE_ENFORCE(num == 1 && all_slots_type_[i][0] == 'u',
-                       common::errors::PreconditionNotMet(
-                           "The uid has to be uint64 and single.\n"
-                           "please check this error line: %s",
-                           str));
+    if (parse_uid_ && all_slots_[i] == uid_slot_) {
+      PADDLE_ENFORCE(num == 1 && all_slots_type_[i][0] == 'u',
+                     common::errors::PreconditionNotMet(
+                         "The uid has to be uint64 and single.\n"
+                         "please check this error line: %s",
+                         str));
 
-        char* uidptr = endptr;
-        uint64_t feasign = (uint64_t)strtoull(uidptr, &uidptr, 10);
-        instance->uid_ = feasign;
-      }
+      char* uidptr = endptr;
+      uint64_t feasign = (uint64_t)strtoull(uidptr, &uidptr, 10);
+      instance->uid_ = feasign;
+    }
 #endif
-      if (idx != -1) {
-        if (all_slots_type_[i][0] == 'f') {  // float
-          for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
-            // if float feasign is equal to zero, ignore it
-            // except when slot is dense
-            if (fabs(feasign) < 1e-6 && !use_slots_is_dense_[i]) {
-              continue;
-            }
-            FeatureFeasign f;
-            f.float_feasign_ = feasign;
-            instance->float_feasigns_.emplace_back(f, idx);
-          }
-        } else if (all_slots_type_[i][0] == 'u') {  // uint64
-          for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
-            // if uint64 feasign is equal to zero, ignore it
-            // except when slot is dense
-            if (feasign == 0 && !use_slots_is_dense_[i]) {
-              continue;
-            }
-            FeatureFeasign f;
-            f.uint64_feasign_ = feasign;
-            instance->uint64_feasigns_.emplace_back(f, idx);
+    if (idx != -1) {
+      if (all_slots_type_[i][0] == 'f') {  // float
+        for (int j = 0; j < num; ++j) {
+          float feasign = strtof(endptr, &endptr);
+          // if float feasign is equal to zero, ignore it
+          // except when slot is dense
+          if (fabs(feasign) < 1e-6 && !use_slots_is_dense_[i]) {
+            continue;
           }
+          FeatureFeasign f;
+          f.float_feasign_ = feasign;
+          instance->float_feasigns_.emplace_back(f, idx);
         }
-        pos = endptr - str;
-      } else {
-        for (int j = 0; j <= num; ++j) {
-          // pos = line.find_first_of(' ', pos + 1);
-          while (line[pos + 1] != ' ') {
-            pos++;
+      } else if (all_slots_type_[i][0] == 'u') {  // uint64
+        for (int j = 0; j < num; ++j) {
+          uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+          // if uint64 feasign is equal to zero, ignore it
+          // except when slot is dense
+          if (feasign == 0 && !use_slots_is_dense_[i]) {
+            continue;
           }
+          FeatureFeasign f;
+          f.uint64_feasign_ = feasign;
+          instance->uint64_feasigns_.emplace_back(f, idx);
+        }
+      }
+      pos = endptr - str;
+    } else {
+      for (int j = 0; j <= num; ++j) {
+        // pos = line.find_first_of(' ', pos + 1);
+        while (line[pos + 1] != ' ') {
+          pos++;
         }
       }
     }
-    instance->float_feasigns_.shrink_to_fit();
-    instance->uint64_feasigns_.shrink_to_fit();
-    fea_num_ += instance->uint64_feasigns_.size();
-    return true;
   }
-#else
-  return false;
-#endif
+  instance->float_feasigns_.shrink_to_fit();
+  instance->uint64_feasigns_.shrink_to_fit();
 }
 
 bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
@@ -2214,6 +2289,8 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemory() {
   VLOG(3) << "SlotRecord LoadIntoMemory() begin, thread_id=" << thread_id_;
   if (!so_parser_name_.empty()) {
     LoadIntoMemoryByLib();
+  } else if (FLAGS_data_feed_parse_thread_num > 0) {
+    LoadIntoMemoryByPipeline();
   } else {
     LoadIntoMemoryByCommand();
   }
@@ -2483,6 +2560,81 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByCommand() {
 #endif
 }
 
+void SlotRecordInMemoryDataFeed::LoadIntoMemoryByPipeline() {
+#ifdef _LINUX
+  std::string filename;
+  const int parse_thread_num = FLAGS_data_feed_parse_thread_num;
+  PipelinedLineFileReader line_reader(parse_thread_num);
+  line_reader.set_sample_rate(sample_rate_);
+
+  while (this->PickOneFile(&filename)) {
+    VLOG(3) << "PickOneFile, filename=" << filename
+            << ", thread_id=" << thread_id_;
+    int lines = 0;
+    // Each parse thread fills its own block of records from the pool.
+    std::vector<std::vector<SlotRecord>> record_vecs(parse_thread_num);
+    std::vector<int> offsets(parse_thread_num, 0);
+    platform::Timer timeline;
+    timeline.Start();
+    for (auto& record_vec : record_vecs) {
+      SlotRecordPool().get(&record_vec, OBJPOOL_BLOCK_SIZE);
+    }
+
+    do {
+      int err_no = 0;
+      this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_, true);
+      PADDLE_ENFORCE_EQ(this->fp_ != nullptr,
+                        true,
+                        common::errors::InvalidArgument(
+                            "This fp should not be null, please check!"));
+      __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
+
+      lines = line_reader.read_file(
+          this->fp_.get(),
+          [this, &record_vecs, &offsets, &filename](int tid,
+                                                    const std::string& line) {
+            auto& record_vec = record_vecs[tid];
+            int& offset = offsets[tid];
+            if (ParseOneInstance(line, &record_vec[offset])) {
+              ++offset;
+            } else {
+              LOG(WARNING) << "read file:[" << filename
+                           << "] item error, line:[" << line << "]";
+              return false;
+            }
+            if (offset >= OBJPOOL_BLOCK_SIZE) {
+              input_channel_->Write(std::move(record_vec));
+              record_vec.clear();
+              SlotRecordPool().get(&record_vec, OBJPOOL_BLOCK_SIZE);
+              offset = 0;
+            }
+            return true;
+          },
+          lines);
+    } while (line_reader.is_error());
+    for (int tid = 0; tid < parse_thread_num; ++tid) {
+      auto& record_vec = record_vecs[tid];
+      int offset = offsets[tid];
+      if (offset > 0) {
+        input_channel_->WriteMove(offset, &record_vec[0]);
+        if (offset < OBJPOOL_BLOCK_SIZE) {
+          SlotRecordPool().put(&record_vec[offset],
+                               (OBJPOOL_BLOCK_SIZE - offset));
+        }
+      } else {
+        SlotRecordPool().put(&record_vec);
+      }
+    }
+    timeline.Pause();
+    VLOG(3) << "LoadIntoMemoryByPipeline() read all lines, file=" << filename
+            << ", lines=" << lines << ", cost time=" << timeline.ElapsedSec()
+            << " seconds, thread_id=" << thread_id_;
+  }
+  VLOG(3) << "LoadIntoMemoryByPipeline() end, thread_id=" << thread_id_
+          << ", total size: " << line_reader.file_size();
+#endif
+}
+
 static void parser_log_key(const std::string& log_key,
                            uint64_t* search_id,
                            uint32_t* cmatch,
@@ -1946,10 +1946,14 @@ class MultiSlotInMemoryDataFeed : public InMemoryDataFeed<Record> {
   virtual ~MultiSlotInMemoryDataFeed() {}
   virtual void Init(const DataFeedDesc& data_feed_desc);
   // void SetRecord(Record* records) { records_ = records; }
+  // Parses on FLAGS_data_feed_parse_thread_num threads if it is set.
+  void LoadIntoMemory() override;
 
  protected:
   virtual bool ParseOneInstance(Record* instance);
   virtual bool ParseOneInstanceFromPipe(Record* instance);
+  // Thread safe, the feasign num is left to the caller.
+  void ParseOneInstanceFromLine(const char* str, Record* instance);
   virtual void ParseOneInstanceFromSo(const char* str UNUSED,
                                       Record* instance UNUSED,
                                       CustomParser* parser UNUSED) {}
@@ -1988,6 +1992,9 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   virtual void LoadIntoMemoryByLib(void);
   virtual void LoadIntoMemoryByLine(void);
   virtual void LoadIntoMemoryByFile(void);
+  // Reads the files on this thread and parses them on
+  // FLAGS_data_feed_parse_thread_num threads.
+  virtual void LoadIntoMemoryByPipeline(void);
   void SetInputChannel(void* channel) override {
     input_channel_ = static_cast<ChannelObject<SlotRecord>*>(channel);
   }
@@ -0,0 +1,274 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/io/mapped_params.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/phi/core/memory/malloc.h"
+#ifndef _WIN32
+#include "paddle/phi/core/memory/allocation/mmap_allocator.h"
+#endif
+
+namespace paddle::framework {
+
+namespace {
+
+constexpr char kMappedParamsMagic[8] = {
+    'P', 'D', 'M', 'P', 'A', 'R', 'A', 'M'};
+constexpr uint32_t kMappedParamsVersion = 1;
+
+struct MappedParamsHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t tensor_num;
+  uint64_t meta_offset;
+  uint64_t meta_size;
+  char reserved[32];
+};
+static_assert(sizeof(MappedParamsHeader) == 64,
+              "The header of mapped params should be 64 bytes.");
+
+size_t AlignUp(size_t size) {
+  return (size + kMappedParamsAlignment - 1) / kMappedParamsAlignment *
+         kMappedParamsAlignment;
+}
+
+// A tensor in the mapped file, keeps the whole mapping alive.
+class MappedTensorAllocation : public phi::Allocation {
+ public:
+  MappedTensorAllocation(std::shared_ptr<phi::Allocation> file,
+                         void* ptr,
+                         size_t size)
+      : phi::Allocation(ptr, size, phi::CPUPlace()), file_(std::move(file)) {}
+
+ private:
+  std::shared_ptr<phi::Allocation> file_;
+};
+
+std::shared_ptr<phi::Allocation> MapFile(const std::string& file_path) {
+#ifndef _WIN32
+  return memory::allocation::AllocateMemoryMapFileAllocation(file_path);
+#else
+  std::ifstream fin(file_path, std::ios::binary | std::ios::ate);
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fin),
+      true,
+      common::errors::Unavailable("Failed to open file %s.", file_path));
+  size_t size = fin.tellg();
+  fin.seekg(0, std::ios::beg);
+  auto file = memory::AllocShared(phi::CPUPlace(), size);
+  fin.read(static_cast<char*>(file->ptr()), size);
+  return file;
+#endif
+}
+
+// Reads the meta section with bounds checking.
+class MetaReader {
+ public:
+  MetaReader(const char* data, size_t size, const std::string& file_path)
+      : data_(data), size_(size), file_path_(file_path) {}
+
+  template <typename T>
+  T Read() {
+    PADDLE_ENFORCE_LE(
+        pos_ + sizeof(T),
+        size_,
+        common::errors::InvalidArgument(
+            "The meta of mapped params file %s is truncated.", file_path_));
+    T value;
+    std::memcpy(&value, data_ + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return value;
+  }
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t pos_{0};
+  const std::string& file_path_;
+};
+
+}  // namespace
+
+bool IsMappedParamsFile(const std::string& file_path) {
+  std::ifstream fin(file_path, std::ios::binary);
+  char magic[sizeof(kMappedParamsMagic)];
+  if (!fin.read(magic, sizeof(magic))) {
+    return false;
+  }
+  return std::memcmp(magic, kMappedParamsMagic, sizeof(magic)) == 0;
+}
+
+void SaveMappedParams(const std::vector<const phi::DenseTensor*>& tensors,
+                      const std::string& file_path) {
+  std::ofstream fout(file_path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fout),
+      true,
+      common::errors::Unavailable("Cannot open %s to save variables.",
+                                  file_path));
+
+  MappedParamsHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMappedParamsMagic, sizeof(kMappedParamsMagic));
+  header.version = kMappedParamsVersion;
+  header.tensor_num = static_cast<uint32_t>(tensors.size());
+  fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  std::string meta;
+  auto append_meta = [&meta](const auto& value) {
+    meta.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  const char padding[kMappedParamsAlignment] = {0};
+  size_t offset = sizeof(header);
+  for (auto* tensor : tensors) {
+    PADDLE_ENFORCE_EQ(tensor->lod().empty(),
+                      true,
+                      common::errors::Unimplemented(
+                          "Mapped params do not support tensors with LoD."));
+    phi::DenseTensor cpu_tensor;
+    const phi::DenseTensor* src = tensor;
+    if (tensor->initialized() && !phi::is_cpu_place(tensor->place())) {
+      TensorCopySync(*tensor, phi::CPUPlace(), &cpu_tensor);
+      src = &cpu_tensor;
+    }
+    size_t data_offset = AlignUp(offset);
+    fout.write(padding, data_offset - offset);
+    size_t data_size = src->numel() * phi::SizeOf(src->dtype());
+    if (data_size > 0) {
+      fout.write(static_cast<const char*>(src->data()), data_size);
+    }
+    offset = data_offset + data_size;
+
+    append_meta(static_cast<int32_t>(src->dtype()));
+    append_meta(static_cast<uint32_t>(src->dims().size()));
+    for (int i = 0; i < src->dims().size(); ++i) {
+      append_meta(static_cast<int64_t>(src->dims()[i]));
+    }
+    append_meta(static_cast<uint64_t>(data_offset));
+    append_meta(static_cast<uint64_t>(data_size));
+  }
+  header.meta_offset = AlignUp(offset);
+  header.meta_size = meta.size();
+  fout.write(padding, header.meta_offset - offset);
+  fout.write(meta.data(), meta.size());
+  fout.seekp(0);
+  fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fout),
+      true,
+      common::errors::Unavailable("Failed to write file %s.", file_path));
+}
+
+void LoadMappedParams(const std::string& file_path,
+                      const std::vector<phi::DenseTensor*>& out,
+                      const phi::Place& place) {
+  auto file = MapFile(file_path);
+  const char* base = static_cast<const char*>(file->ptr());
+  size_t file_size = file->size();
+
+  PADDLE_ENFORCE_GE(
+      file_size,
+      sizeof(MappedParamsHeader),
+      common::errors::InvalidArgument(
+          "The mapped params file %s is too small.", file_path));
+  MappedParamsHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  PADDLE_ENFORCE_EQ(
+      std::memcmp(header.magic, kMappedParamsMagic, sizeof(header.magic)),
+      0,
+      common::errors::InvalidArgument(
+          "The file %s is not a mapped params file.", file_path));
+  PADDLE_ENFORCE_EQ(header.version,
+                    kMappedParamsVersion,
+                    common::errors::Unimplemented(
+                        "The version of mapped params file %s is %d, only "
+                        "version %d is supported.",
+                        file_path,
+                        header.version,
+                        kMappedParamsVersion));
+  PADDLE_ENFORCE_EQ(
+      header.tensor_num,
+      out.size(),
+      common::errors::InvalidArgument(
+          "The mapped params file %s has %d tensors, but %d are loaded.",
+          file_path,
+          header.tensor_num,
+          out.size()));
+  PADDLE_ENFORCE_LE(header.meta_offset + header.meta_size,
+                    file_size,
+                    common::errors::InvalidArgument(
+                        "The mapped params file %s is truncated.", file_path));
+
+  MetaReader reader(base + header.meta_offset, header.meta_size, file_path);
+  for (auto* tensor : out) {
+    auto dtype = static_cast<phi::DataType>(reader.Read<int32_t>());
+    std::vector<int64_t> dims(reader.Read<uint32_t>());
+    for (auto& dim : dims) {
+      dim = reader.Read<int64_t>();
+    }
+    auto data_offset = reader.Read<uint64_t>();
+    auto data_size = reader.Read<uint64_t>();
+    PADDLE_ENFORCE_LE(
+        data_offset + data_size,
+        header.meta_offset,
+        common::errors::InvalidArgument(
+            "The mapped params file %s is damaged.", file_path));
+
+    phi::DenseTensor cpu_tensor;
+    phi::DenseTensor* dst = phi::is_cpu_place(place) ? tensor : &cpu_tensor;
+    dst->clear();
+    dst->Resize(common::make_ddim(dims));
+    PADDLE_ENFORCE_EQ(
+        dst->numel() * phi::SizeOf(dtype),
+        data_size,
+        common::errors::InvalidArgument(
+            "The mapped params file %s is damaged.", file_path));
+    dst->ResetHolderWithType(
+        std::make_shared<MappedTensorAllocation>(
+            file, const_cast<char*>(base) + data_offset, data_size),
+        dtype);
+    if (dst != tensor) {
+      TensorCopySync(cpu_tensor, place, tensor);
+    }
+  }
+  VLOG(3) << "Mapped " << out.size() << " params from " << file_path;
+}
+
+void ConvertToMappedParams(const std::string& params_file,
+                           const std::string& mapped_params_file) {
+  std::ifstream fin(params_file, std::ios::binary);
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fin),
+      true,
+      common::errors::Unavailable("Failed to open file %s.", params_file));
+  std::vector<std::unique_ptr<phi::DenseTensor>> tensors;
+  while (fin.peek() != EOF) {
+    tensors.emplace_back(std::make_unique<phi::DenseTensor>());
+    DeserializeFromStream(fin, tensors.back().get());
+  }
+  std::vector<const phi::DenseTensor*> tensor_ptrs;
+  for (auto& tensor : tensors) {
+    tensor_ptrs.push_back(tensor.get());
+  }
+  SaveMappedParams(tensor_ptrs, mapped_params_file);
+  VLOG(3) << "Converted " << tensors.size() << " params from " << params_file
+          << " to " << mapped_params_file;
+}
+
+}  // namespace paddle::framework
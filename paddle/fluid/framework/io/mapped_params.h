@@ -0,0 +1,55 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * Mapped params is a combined parameter file laid out to be memory mapped:
+ *
+ *   header   | magic "PDMPARAM", version, tensor num, meta offset and size
+ *   data     | raw tensor data, each one aligned to kMappedParamsAlignment
+ *   meta     | dtype, dims, data offset and size of each tensor
+ *
+ * The tensors are in the order of the load_combine file it is converted from,
+ * so it can replace the params file of a model as is. Loaded on CPU, the
+ * tensors point into the mapped file instead of owning a copy, so processes
+ * serving the same model share the weights through the page cache.
+ */
+constexpr size_t kMappedParamsAlignment = 64;
+
+// Whether file_path starts with the magic of mapped params.
+bool IsMappedParamsFile(const std::string& file_path);
+
+void SaveMappedParams(const std::vector<const phi::DenseTensor*>& tensors,
+                      const std::string& file_path);
+
+// Loads the tensors of a mapped params file into out, which must have as many
+// tensors as the file. On CPU the tensors share the memory of the mapped
+// file, on other places they are copied from it.
+void LoadMappedParams(const std::string& file_path,
+                      const std::vector<phi::DenseTensor*>& out,
+                      const phi::Place& place);
+
+// Converts a combined params file saved by save_combine to mapped params.
+void ConvertToMappedParams(const std::string& params_file,
+                           const std::string& mapped_params_file);
+
+}  // namespace framework
+}  // namespace paddle
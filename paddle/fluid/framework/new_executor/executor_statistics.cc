@@ -14,17 +14,22 @@
 
 #include "paddle/fluid/framework/new_executor/executor_statistics.h"
 
+#include <chrono>
 #include <fstream>
 #include <functional>
 #include <map>
+#include <mutex>
 #include <ostream>
 #include <queue>
 #include <set>
+#include <sstream>
 #include <unordered_map>
 #include <vector>
 
 #include "glog/logging.h"
+#include "paddle/common/enforce.h"
 #include "paddle/common/flags.h"
+#include "paddle/phi/core/memory/stats.h"
 #include "paddle/phi/core/os_info.h"
 #include "paddle/phi/core/platform/profiler/utils.h"
 
@@ -34,6 +39,11 @@ PHI_DEFINE_EXPORTED_string(static_executor_perfstat_filepath,
                            "FLAGS_static_executor_perfstat_filepath "
                            "enables performance statistics for the static "
                            "graph executor.");
+PHI_DEFINE_EXPORTED_bool(executor_op_counters,
+                         false,
+                         "FLAGS_executor_op_counters enables the always-on "
+                         "per instruction counters of the pir interpreter, "
+                         "see DumpExecutorOpCounters.");
 
 namespace paddle::framework {
 
@@ -574,4 +584,268 @@ void StaticGraphExecutorPerfStatistics(
   }
 }
 
+namespace {
+
+uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// The slots have a single writer, a relaxed load and store is enough.
+template <typename T>
+void AddRelaxed(std::atomic<T>* value, T delta) {
+  value->store(value->load(std::memory_order_relaxed) + delta,
+               std::memory_order_relaxed);
+}
+
+size_t HistogramBucket(uint64_t ns) {
+  uint64_t us = ns / 1000;
+  size_t bucket = 0;
+  while (us > 0 && bucket + 1 < InstructionCounters::kHistogramBuckets) {
+    us >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+void WriteJsonString(const std::string& str, std::ostream* os) {
+  *os << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      *os << '\\';
+    }
+    *os << c;
+  }
+  *os << '"';
+}
+
+std::mutex& CountersMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::vector<std::weak_ptr<InstructionCounters>>& CountersRegistry() {
+  static std::vector<std::weak_ptr<InstructionCounters>> registry;
+  return registry;
+}
+
+std::vector<std::shared_ptr<InstructionCounters>> LivingCounters() {
+  std::lock_guard<std::mutex> guard(CountersMutex());
+  auto& registry = CountersRegistry();
+  std::vector<std::shared_ptr<InstructionCounters>> counters;
+  for (auto it = registry.begin(); it != registry.end();) {
+    if (auto ptr = it->lock()) {
+      counters.emplace_back(std::move(ptr));
+      ++it;
+    } else {
+      it = registry.erase(it);
+    }
+  }
+  return counters;
+}
+
+}  // namespace
+
+InstructionCounters::Recorder::Recorder(InstructionCounters* counters,
+                                        size_t instr_id,
+                                        const phi::Place& place,
+                                        Kind kind)
+    : counters_(counters), instr_id_(instr_id), place_(place), kind_(kind) {
+  if (counters_ != nullptr) {
+    const auto* bytes = memory::CurrentThreadAllocFreeBytes(place_);
+    start_allocated_ = bytes->allocated;
+    start_freed_ = bytes->freed;
+    start_ns_ = NowNs();
+  }
+}
+
+InstructionCounters::Recorder::~Recorder() {
+  if (counters_ == nullptr) {
+    return;
+  }
+  uint64_t elapsed_ns = NowNs() - start_ns_;
+  const auto* bytes = memory::CurrentThreadAllocFreeBytes(place_);
+  int64_t allocated = bytes->allocated - start_allocated_;
+  int64_t freed = bytes->freed - start_freed_;
+  Slot* slot = counters_->GetSlot(instr_id_);
+  if (slot == nullptr) {
+    return;
+  }
+  if (kind_ == Kind::kRun) {
+    AddRelaxed<uint64_t>(&slot->run_count, 1);
+    AddRelaxed(&slot->run_ns, elapsed_ns);
+    AddRelaxed<uint64_t>(&slot->run_hist[HistogramBucket(elapsed_ns)], 1);
+  } else {
+    AddRelaxed(&slot->gc_ns, elapsed_ns);
+  }
+  AddRelaxed(&slot->allocated_bytes, allocated);
+  AddRelaxed(&slot->freed_bytes, freed);
+}
+
+InstructionCounters::InstructionCounters(std::vector<std::string> instr_names)
+    : instr_names_(std::move(instr_names)),
+      slots_(new Slot[instr_names_.size()]()) {
+  static std::atomic<uint64_t> next_id{0};
+  id_ = next_id++;
+}
+
+void InstructionCounters::MarkReady(size_t instr_id) {
+  if (Slot* slot = GetSlot(instr_id)) {
+    slot->ready_ns.store(NowNs(), std::memory_order_relaxed);
+  }
+}
+
+void InstructionCounters::MarkStart(size_t instr_id) {
+  Slot* slot = GetSlot(instr_id);
+  if (slot == nullptr) {
+    return;
+  }
+  uint64_t ready_ns = slot->ready_ns.load(std::memory_order_relaxed);
+  if (ready_ns == 0) {
+    return;  // not scheduled through the workqueue, e.g. trace run
+  }
+  slot->ready_ns.store(0, std::memory_order_relaxed);
+  uint64_t delay_ns = NowNs() - ready_ns;
+  AddRelaxed(&slot->queue_ns, delay_ns);
+  AddRelaxed<uint64_t>(&slot->queue_hist[HistogramBucket(delay_ns)], 1);
+}
+
+void InstructionCounters::WriteJson(std::ostream* os) const {
+  auto write_hist =
+      [os](const std::array<std::atomic<uint64_t>, kHistogramBuckets>& hist) {
+        *os << '[';
+        for (size_t i = 0; i < hist.size(); ++i) {
+          *os << (i == 0 ? "" : ",") << hist[i].load(std::memory_order_relaxed);
+        }
+        *os << ']';
+      };
+  *os << "{\"interpreter\":" << id_ << ",\"instructions\":[";
+  bool first = true;
+  for (size_t i = 0; i < instr_names_.size(); ++i) {
+    const Slot& slot = slots_[i];
+    uint64_t run_count = slot.run_count.load(std::memory_order_relaxed);
+    if (run_count == 0) {
+      continue;
+    }
+    *os << (first ? "" : ",") << "{\"id\":" << i << ",\"name\":";
+    first = false;
+    WriteJsonString(instr_names_[i], os);
+    *os << ",\"run_count\":" << run_count
+        << ",\"run_us\":" << slot.run_ns.load(std::memory_order_relaxed) / 1000
+        << ",\"queue_us\":"
+        << slot.queue_ns.load(std::memory_order_relaxed) / 1000
+        << ",\"gc_us\":" << slot.gc_ns.load(std::memory_order_relaxed) / 1000
+        << ",\"allocated_bytes\":"
+        << slot.allocated_bytes.load(std::memory_order_relaxed)
+        << ",\"freed_bytes\":"
+        << slot.freed_bytes.load(std::memory_order_relaxed)
+        << ",\"run_us_hist\":";
+    write_hist(slot.run_hist);
+    *os << ",\"queue_us_hist\":";
+    write_hist(slot.queue_hist);
+    *os << '}';
+  }
+  *os << "]}";
+}
+
+void InstructionCounters::WritePrometheus(const std::string& metric,
+                                          std::ostream* os) const {
+  for (size_t i = 0; i < instr_names_.size(); ++i) {
+    const Slot& slot = slots_[i];
+    if (slot.run_count.load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    std::ostringstream labels;
+    labels << "interpreter=\"" << id_ << "\",instr=\"" << i << "\",op=";
+    WriteJsonString(instr_names_[i], &labels);
+    auto write_hist =
+        [&](const std::array<std::atomic<uint64_t>, kHistogramBuckets>& hist,
+            uint64_t sum_ns) {
+          uint64_t count = 0;
+          for (size_t b = 0; b + 1 < hist.size(); ++b) {
+            count += hist[b].load(std::memory_order_relaxed);
+            *os << metric << "_bucket{" << labels.str() << ",le=\""
+                << static_cast<double>(1ULL << b) * 1e-6 << "\"} " << count
+                << "\n";
+          }
+          count += hist.back().load(std::memory_order_relaxed);
+          *os << metric << "_bucket{" << labels.str() << ",le=\"+Inf\"} "
+              << count << "\n";
+          *os << metric << "_sum{" << labels.str() << "} " << sum_ns * 1e-9
+              << "\n";
+          *os << metric << "_count{" << labels.str() << "} " << count << "\n";
+        };
+    if (metric == "paddle_executor_op_run_seconds") {
+      write_hist(slot.run_hist, slot.run_ns.load(std::memory_order_relaxed));
+    } else if (metric == "paddle_executor_op_queue_seconds") {
+      write_hist(slot.queue_hist,
+                 slot.queue_ns.load(std::memory_order_relaxed));
+    } else if (metric == "paddle_executor_op_gc_seconds_total") {
+      *os << metric << "{" << labels.str() << "} "
+          << slot.gc_ns.load(std::memory_order_relaxed) * 1e-9 << "\n";
+    } else if (metric == "paddle_executor_op_allocated_bytes_total") {
+      *os << metric << "{" << labels.str() << "} "
+          << slot.allocated_bytes.load(std::memory_order_relaxed) << "\n";
+    } else if (metric == "paddle_executor_op_freed_bytes_total") {
+      *os << metric << "{" << labels.str() << "} "
+          << slot.freed_bytes.load(std::memory_order_relaxed) << "\n";
+    }
+  }
+}
+
+std::shared_ptr<InstructionCounters> CreateInstructionCounters(
+    std::vector<std::string> instr_names) {
+  if (!FLAGS_executor_op_counters) {
+    return nullptr;
+  }
+  auto counters = std::make_shared<InstructionCounters>(std::move(instr_names));
+  std::lock_guard<std::mutex> guard(CountersMutex());
+  CountersRegistry().emplace_back(counters);
+  return counters;
+}
+
+std::string DumpExecutorOpCounters(const std::string& format) {
+  auto counters = LivingCounters();
+  std::ostringstream os;
+  if (format == "json") {
+    os << '[';
+    for (size_t i = 0; i < counters.size(); ++i) {
+      os << (i == 0 ? "" : ",");
+      counters[i]->WriteJson(&os);
+    }
+    os << ']';
+  } else if (format == "prometheus") {
+    const std::vector<std::array<const char*, 3>> metrics = {
+        {"paddle_executor_op_run_seconds",
+         "histogram",
+         "Wall time of the instruction runs."},
+        {"paddle_executor_op_queue_seconds",
+         "histogram",
+         "Delay from the instruction being ready to running."},
+        {"paddle_executor_op_gc_seconds_total",
+         "counter",
+         "Wall time of the garbage collection after the instruction runs."},
+        {"paddle_executor_op_allocated_bytes_total",
+         "counter",
+         "Memory allocated by the instruction runs."},
+        {"paddle_executor_op_freed_bytes_total",
+         "counter",
+         "Memory freed by the instruction runs and their gc."}};
+    for (auto& metric : metrics) {
+      os << "# HELP " << metric[0] << " " << metric[2] << "\n";
+      os << "# TYPE " << metric[0] << " " << metric[1] << "\n";
+      for (auto& counter : counters) {
+        counter->WritePrometheus(metric[0], &os);
+      }
+    }
+  } else {
+    PADDLE_THROW(common::errors::InvalidArgument(
+        "The format of executor op counters should be json or prometheus, "
+        "but got %s.",
+        format));
+  }
+  return os.str();
+}
+
 }  // namespace paddle::framework
@@ -14,9 +14,15 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
 
 #include "paddle/fluid/platform/profiler/event_node.h"
+#include "paddle/phi/common/place.h"
 
 namespace paddle {
 namespace framework {
@@ -24,5 +30,95 @@ namespace framework {
 void StaticGraphExecutorPerfStatistics(
     std::shared_ptr<const platform::NodeTrees> profiling_data);
 
+// Always-on counters of the instructions of an interpreter, unlike the
+// statistics above they do not need the profiler. Enabled by
+// FLAGS_executor_op_counters, for each instruction they count the wall time
+// of its run, the time from being ready to running, i.e. the queueing delay
+// in the workqueue, the memory allocated by its run on the running thread,
+// the memory freed by its gc and the time of its gc.
+//
+// An instruction never runs on two threads at the same time, so its slot has
+// a single writer and is updated without read-modify-write atomics or locks.
+// Slots are cache line aligned, the workers do not share lines.
+class InstructionCounters {
+ public:
+  // Bucket i of a histogram counts the durations in [2^(i-1), 2^i) us, the
+  // last bucket counts all longer ones.
+  static constexpr size_t kHistogramBuckets = 24;
+
+  // Records the wall time, and the bytes allocated and freed on this thread,
+  // between its construction and destruction as the run or the gc of an
+  // instruction.
+  class Recorder {
+   public:
+    enum class Kind { kRun, kGC };
+
+    Recorder(InstructionCounters* counters,
+             size_t instr_id,
+             const phi::Place& place,
+             Kind kind);
+    ~Recorder();
+
+   private:
+    InstructionCounters* counters_;
+    size_t instr_id_;
+    phi::Place place_;
+    Kind kind_;
+    uint64_t start_ns_{0};
+    int64_t start_allocated_{0};
+    int64_t start_freed_{0};
+  };
+
+  explicit InstructionCounters(std::vector<std::string> instr_names);
+
+  // The instruction becomes ready to run, e.g. it is pushed to the workqueue.
+  void MarkReady(size_t instr_id);
+
+  // The instruction starts to run, records the delay since MarkReady.
+  void MarkStart(size_t instr_id);
+
+  // Writes the counters as a json object.
+  void WriteJson(std::ostream* os) const;
+
+  // Writes the samples of the given metric in prometheus text format, see
+  // DumpExecutorOpCounters for the metrics.
+  void WritePrometheus(const std::string& metric, std::ostream* os) const;
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> ready_ns;
+    std::atomic<uint64_t> run_count;
+    std::atomic<uint64_t> run_ns;
+    std::atomic<uint64_t> queue_ns;
+    std::atomic<uint64_t> gc_ns;
+    std::atomic<int64_t> allocated_bytes;
+    std::atomic<int64_t> freed_bytes;
+    std::array<std::atomic<uint64_t>, kHistogramBuckets> run_hist;
+    std::array<std::atomic<uint64_t>, kHistogramBuckets> queue_hist;
+  };
+
+  Slot* GetSlot(size_t instr_id) {
+    return instr_id < instr_names_.size() ? &slots_[instr_id] : nullptr;
+  }
+
+  std::vector<std::string> instr_names_;
+  std::unique_ptr<Slot[]> slots_;
+  uint64_t id_;
+};
+
+// Creates the counters of an interpreter and registers them for
+// DumpExecutorOpCounters, returns nullptr if FLAGS_executor_op_counters is
+// off.
+std::shared_ptr<InstructionCounters> CreateInstructionCounters(
+    std::vector<std::string> instr_names);
+
+// Dumps the counters of all the living interpreters in format "json" or
+// "prometheus". The prometheus metrics, labeled by interpreter, instruction id
+// and op name, are the histograms paddle_executor_op_run_seconds and
+// paddle_executor_op_queue_seconds and the counters
+// paddle_executor_op_gc_seconds_total, paddle_executor_op_allocated_bytes_total
+// and paddle_executor_op_freed_bytes_total.
+std::string DumpExecutorOpCounters(const std::string& format);
+
 }  // namespace framework
 }  // namespace paddle
@@ -16,6 +16,7 @@
 
 #include "paddle/cinn/hlir/dialect/runtime/ir/jit_kernel_op.h"
 #include "paddle/cinn/hlir/dialect/runtime/ir/runtime_dialect.h"
+#include "paddle/cinn/hlir/framework/pir/shape_specialization.h"
 #include "paddle/cinn/hlir/framework/pir_compiler.h"
 #include "paddle/common/errors.h"
 #include "paddle/common/performance_statistician.h"
@@ -83,7 +84,8 @@ class CinnJitInstruction::FnPtrImpl {
         }};
 
     for (const auto& [_, binding_info] : cinn_kernel_info_.symbol_args_map) {
-      func_args_.emplace_back(std::visit(GetSymbolArg, binding_info));
+      symbol_args_.push_back(std::visit(GetSymbolArg, binding_info));
+      func_args_.emplace_back(symbol_args_.back());
     }
 
     if (VLOG_IS_ON(4)) {
@@ -134,8 +136,14 @@ class CinnJitInstruction::FnPtrImpl {
         cudaGraphExecDestroy(instance);
         cudaStreamDestroy(stream);
       } else {
+        // Labeled by the kernel, so that the kernels of a program are
+        // measured one by one.
+        const std::string label = FLAGS_cinn_kernel_execution_label + "\n" +
+                                  cinn_kernel_info_.fn_name;
+        ps.Start(label);
         ((lower_func_ptr_g)cinn_kernel_info_.CX86_fn_ptr)(
             static_cast<void*>(func_args_.data()), func_args_.size(), stream);
+        ps.End(label);
       }
       cudaDeviceSynchronize();
     } else {
@@ -185,12 +193,19 @@ class CinnJitInstruction::FnPtrImpl {
       }
     }
     func_args_.clear();
+    symbol_args_.clear();
   }
 
+  const CINNKernelInfo& cinn_kernel_info() const { return cinn_kernel_info_; }
+
+  const std::vector<int64_t>& symbol_args() const { return symbol_args_; }
+
  private:
   CINNKernelInfo cinn_kernel_info_;
 
   std::vector<cinn_pod_value_t> func_args_;
+  // The values of the symbol args in func_args_.
+  std::vector<int64_t> symbol_args_;
 };
 
 CinnJitInstruction::CinnJitInstruction(
@@ -284,15 +299,26 @@ void CinnJitInstruction::Run() {
     fn_ptr_impl_->InferShape(
         tensor_args_, input_tensor_size, output_tensor_size);
   }
+  FnPtrImpl* specialized_fn_ptr_impl = GetSpecializedFnPtrImpl();
   for (size_t i = 0; i < tensor_args_.size(); ++i) {
     dev_ctx_->Alloc(tensor_args_[i], tensor_args_[i]->dtype());
   }
 
   // 2. exexute kernel
-  fn_ptr_impl_->Run(tensor_args_, running_stream, is_gpu);
+  specialized_fn_ptr_impl->Run(tensor_args_, running_stream, is_gpu);
 
   // 3. release resource
   fn_ptr_impl_->FreeFuncArgs();
+  if (specialized_fn_ptr_impl != fn_ptr_impl_.get()) {
+    specialized_fn_ptr_impl->FreeFuncArgs();
+    // The next run may use the dynamic shape kernel, which only infers the
+    // temporary spaces of unknown sizes.
+    const auto& temp_space_sizes =
+        fn_ptr_impl_->cinn_kernel_info().temp_space_sizes;
+    for (size_t i = 0; i < temp_space_tensors_.size(); ++i) {
+      temp_space_tensors_[i].Resize({temp_space_sizes[i]});
+    }
+  }
   for (auto& tensor : temp_space_tensors_) {
     tensor.clear();
   }
@@ -302,6 +328,27 @@ void CinnJitInstruction::Run() {
 #endif
 }
 
+CinnJitInstruction::FnPtrImpl* CinnJitInstruction::GetSpecializedFnPtrImpl() {
+  const auto& shape_specialization =
+      fn_ptr_impl_->cinn_kernel_info().shape_specialization;
+  if (shape_specialization == nullptr) return fn_ptr_impl_.get();
+  const auto* kernel_info =
+      shape_specialization->Lookup(fn_ptr_impl_->symbol_args());
+  if (kernel_info == nullptr) return fn_ptr_impl_.get();
+
+  auto& fn_ptr_impl = specialized_fn_ptr_impls_[kernel_info];
+  if (fn_ptr_impl == nullptr) {
+    fn_ptr_impl = std::make_shared<FnPtrImpl>(*kernel_info);
+  }
+  // The output shapes are inferred by the dynamic shape kernel, only the
+  // temporary spaces differ.
+  for (size_t i = 0; i < temp_space_tensors_.size(); ++i) {
+    temp_space_tensors_[i].Resize({kernel_info->temp_space_sizes[i]});
+  }
+  fn_ptr_impl->InitFuncArgs(tensor_args_);
+  return fn_ptr_impl.get();
+}
+
 const std::string& CinnJitInstruction::Name() const {
   static const std::string name = "cinn_jit";
   return name;
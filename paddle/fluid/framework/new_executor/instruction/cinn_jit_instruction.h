@@ -15,12 +15,17 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
 
 namespace pir {
 class Operation;
 }
 
+namespace cinn::hlir::framework::pir {
+struct CINNKernelInfo;
+}  // namespace cinn::hlir::framework::pir
+
 namespace paddle {
 namespace framework {
 class Scope;
@@ -43,7 +48,15 @@ class CinnJitInstruction : public InstructionBase {
  private:
   class FnPtrImpl;
 
+  // Returns the static kernel compiled for the current shapes by the shape
+  // specialization of the kernel, or fn_ptr_impl_ if there is none.
+  FnPtrImpl* GetSpecializedFnPtrImpl();
+
   std::shared_ptr<FnPtrImpl> fn_ptr_impl_{nullptr};
+  // The static kernels run by this instruction.
+  std::unordered_map<const cinn::hlir::framework::pir::CINNKernelInfo*,
+                     std::shared_ptr<FnPtrImpl>>
+      specialized_fn_ptr_impls_;
 
   phi::Place place_;
 
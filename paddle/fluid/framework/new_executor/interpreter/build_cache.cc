@@ -0,0 +1,363 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/build_cache.h"
+
+#include <xxhash.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/platform/enforce.h"
+
+COMMON_DECLARE_bool(new_executor_sequential_run);
+COMMON_DECLARE_bool(new_executor_serial_run);
+COMMON_DECLARE_bool(add_dependency_for_communication_op);
+
+namespace paddle::framework::interpreter {
+
+namespace {
+
+constexpr char kBuildCacheMagic[8] = {'P', 'D', 'B', 'L', 'D', 'C', 'C', 'H'};
+constexpr uint32_t kBuildCacheVersion = 2;
+
+struct BuildCacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t key;
+  uint64_t op_num;
+  uint64_t edge_num;
+  uint64_t event_num;
+  uint64_t live_op_num;
+  uint64_t live_ops_digest;
+};
+
+size_t WordsPerRow(size_t op_num) { return (op_num + 63) / 64; }
+
+size_t ExpectedFileSize(const BuildCacheHeader& header) {
+  size_t pair_num = header.edge_num + header.event_num + header.live_op_num;
+  return sizeof(BuildCacheHeader) + pair_num * 2 * sizeof(uint32_t) +
+         header.op_num * WordsPerRow(header.op_num) * sizeof(uint64_t);
+}
+
+size_t PairNum(const std::map<size_t, std::set<size_t>>& ids) {
+  size_t pair_num = 0;
+  for (const auto& item : ids) {
+    pair_num += item.second.size();
+  }
+  return pair_num;
+}
+
+template <typename T>
+void AppendPod(std::string* buffer, const T& value) {
+  buffer->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void AppendPair(std::string* buffer, size_t first, size_t second) {
+  AppendPod(buffer, static_cast<uint32_t>(first));
+  AppendPod(buffer, static_cast<uint32_t>(second));
+}
+
+void AppendPairs(std::string* buffer,
+                 const std::map<size_t, std::set<size_t>>& ids) {
+  for (const auto& item : ids) {
+    for (size_t id : item.second) {
+      AppendPair(buffer, item.first, id);
+    }
+  }
+}
+
+void AppendString(std::string* buffer, const std::string& str) {
+  buffer->append(str);
+  buffer->push_back('\0');
+}
+
+std::pair<size_t, size_t> ReadPair(const char** cursor) {
+  uint32_t pair[2];
+  std::memcpy(pair, *cursor, sizeof(pair));
+  *cursor += sizeof(pair);
+  return {pair[0], pair[1]};
+}
+
+void AppendVarIds(
+    std::string* buffer,
+    const std::unordered_map<::pir::Value, std::vector<int>>& vars) {
+  // The map is unordered, sort the ids so that the key is stable across
+  // processes.
+  std::vector<int> ids;
+  for (const auto& item : vars) {
+    ids.insert(ids.end(), item.second.begin(), item.second.end());
+  }
+  std::sort(ids.begin(), ids.end());
+  AppendPod(buffer, static_cast<uint64_t>(ids.size()));
+  for (int id : ids) {
+    AppendPod(buffer, static_cast<int32_t>(id));
+  }
+}
+
+// A read-only view of the cache file, backed by mmap on POSIX systems.
+class CacheFileView {
+ public:
+  explicit CacheFileView(const std::string& path) {
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* ptr = mmap(nullptr,
+                       static_cast<size_t>(st.st_size),
+                       PROT_READ,
+                       MAP_PRIVATE,
+                       fd,
+                       0);
+      if (ptr != MAP_FAILED) {
+        mapped_ = ptr;
+        data_ = static_cast<const char*>(ptr);
+        size_ = static_cast<size_t>(st.st_size);
+      }
+    }
+    close(fd);
+#else
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin.is_open()) {
+      return;
+    }
+    std::stringstream ss;
+    ss << fin.rdbuf();
+    buffer_ = ss.str();
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+  }
+
+  ~CacheFileView() {
+#if !defined(_WIN32)
+    if (mapped_ != nullptr) {
+      munmap(mapped_, size_);
+    }
+#endif
+  }
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const char* data_{nullptr};
+  size_t size_{0};
+  void* mapped_{nullptr};
+  std::string buffer_;
+};
+
+}  // namespace
+
+PirBuildCache::PirBuildCache(const std::string& cache_dir,
+                             const phi::Place& place,
+                             const std::vector<InstructionBase*>& instructions)
+    : op_num_(instructions.size()), key_(0) {
+  std::string buffer;
+  buffer.append(place.DebugString());
+  AppendPod(&buffer, static_cast<uint8_t>(FLAGS_new_executor_sequential_run));
+  AppendPod(&buffer, static_cast<uint8_t>(FLAGS_new_executor_serial_run));
+  AppendPod(&buffer,
+            static_cast<uint8_t>(FLAGS_add_dependency_for_communication_op));
+  AppendPod(&buffer, static_cast<uint64_t>(op_num_));
+  // The stream events depend on which instructions share a device context,
+  // number the contexts in the order they are first used.
+  std::unordered_map<const phi::DeviceContext*, uint32_t> context_ids;
+  for (const InstructionBase* instr : instructions) {
+    AppendString(&buffer, instr->Name());
+    AppendPod(&buffer, static_cast<int32_t>(instr->KernelType()));
+    AppendVarIds(&buffer, instr->Inputs());
+    AppendVarIds(&buffer, instr->Outputs());
+    auto context_id = context_ids.emplace(
+        &instr->DeviceContext(), static_cast<uint32_t>(context_ids.size()));
+    AppendPod(&buffer, context_id.first->second);
+    AppendString(&buffer, instr->GetExecutionStream());
+    AppendPod(&buffer, static_cast<int32_t>(instr->GetStreamPriority()));
+    AppendPod(&buffer, static_cast<uint8_t>(instr->IsForceRecordEvent()));
+    AppendString(&buffer, instr->EventToRecordInfo());
+    AppendPod(&buffer,
+              static_cast<uint64_t>(instr->EventsToWaitInfo().size()));
+    for (const std::string& event : instr->EventsToWaitInfo()) {
+      AppendString(&buffer, event);
+    }
+  }
+  key_ = XXH64(buffer.data(), buffer.size(), kBuildCacheVersion);
+
+  std::stringstream ss;
+  ss << cache_dir << "/_pir_build_cache_" << std::hex << key_ << ".bin";
+  cache_path_ = ss.str();
+}
+
+bool PirBuildCache::Load(PirBuildAnalysis* analysis) const {
+  CacheFileView view(cache_path_);
+  if (view.data() == nullptr || view.size() < sizeof(BuildCacheHeader)) {
+    VLOG(4) << "No build cache found at " << cache_path_;
+    return false;
+  }
+  BuildCacheHeader header;
+  std::memcpy(&header, view.data(), sizeof(header));
+  if (std::memcmp(header.magic, kBuildCacheMagic, sizeof(kBuildCacheMagic)) !=
+          0 ||
+      header.version != kBuildCacheVersion || header.key != key_ ||
+      header.op_num != op_num_ || view.size() != ExpectedFileSize(header)) {
+    VLOG(1) << "Ignore mismatched build cache " << cache_path_;
+    return false;
+  }
+
+  const char* cursor = view.data() + sizeof(header);
+  analysis->downstream_map.clear();
+  for (uint64_t i = 0; i < header.edge_num; ++i) {
+    auto edge = ReadPair(&cursor);
+    analysis->downstream_map[edge.first].insert(edge.second);
+  }
+
+  const size_t words_per_row = WordsPerRow(op_num_);
+  analysis->op_happens_before.assign(op_num_,
+                                     std::vector<bool>(op_num_, false));
+  for (size_t row = 0; row < op_num_; ++row) {
+    std::vector<bool>& bits = analysis->op_happens_before[row];
+    for (size_t word_idx = 0; word_idx < words_per_row; ++word_idx) {
+      uint64_t word;
+      std::memcpy(&word, cursor, sizeof(word));
+      cursor += sizeof(word);
+      for (size_t bit = 0; word != 0; ++bit, word >>= 1) {
+        if (word & 1) {
+          bits[word_idx * 64 + bit] = true;
+        }
+      }
+    }
+  }
+
+  analysis->event_pairs.clear();
+  analysis->event_pairs.reserve(header.event_num);
+  for (uint64_t i = 0; i < header.event_num; ++i) {
+    analysis->event_pairs.push_back(ReadPair(&cursor));
+  }
+
+  analysis->last_live_ops_digest = header.live_ops_digest;
+  analysis->last_live_ops.clear();
+  for (uint64_t i = 0; i < header.live_op_num; ++i) {
+    auto live_op = ReadPair(&cursor);
+    analysis->last_live_ops[live_op.first].insert(live_op.second);
+  }
+  VLOG(1) << "Load build cache from " << cache_path_ << ", op_num "
+          << op_num_ << ", edge_num " << header.edge_num << ", event_num "
+          << header.event_num;
+  return true;
+}
+
+void PirBuildCache::Save(const PirBuildAnalysis& analysis) const {
+  const std::vector<std::vector<bool>>& op_happens_before =
+      analysis.op_happens_before;
+  PADDLE_ENFORCE_EQ(op_happens_before.size(),
+                    op_num_,
+                    common::errors::InvalidArgument(
+                        "The size of op_happens_before (%d) should be equal "
+                        "to the number of instructions (%d).",
+                        op_happens_before.size(),
+                        op_num_));
+  BuildCacheHeader header;
+  std::memcpy(header.magic, kBuildCacheMagic, sizeof(kBuildCacheMagic));
+  header.version = kBuildCacheVersion;
+  header.reserved = 0;
+  header.key = key_;
+  header.op_num = op_num_;
+  header.edge_num = PairNum(analysis.downstream_map);
+  header.event_num = analysis.event_pairs.size();
+  header.live_op_num = PairNum(analysis.last_live_ops);
+  header.live_ops_digest = analysis.last_live_ops_digest;
+
+  std::string buffer;
+  buffer.reserve(ExpectedFileSize(header));
+  AppendPod(&buffer, header);
+  AppendPairs(&buffer, analysis.downstream_map);
+  const size_t words_per_row = WordsPerRow(op_num_);
+  for (const std::vector<bool>& bits : op_happens_before) {
+    for (size_t word_idx = 0; word_idx < words_per_row; ++word_idx) {
+      uint64_t word = 0;
+      size_t end = std::min(op_num_, (word_idx + 1) * 64);
+      for (size_t col = word_idx * 64; col < end; ++col) {
+        if (bits[col]) {
+          word |= (uint64_t(1) << (col - word_idx * 64));
+        }
+      }
+      AppendPod(&buffer, word);
+    }
+  }
+  for (const auto& event : analysis.event_pairs) {
+    AppendPair(&buffer, event.first, event.second);
+  }
+  AppendPairs(&buffer, analysis.last_live_ops);
+
+  // Write to a private temporary file first, then publish it atomically.
+  std::stringstream tmp_path;
+#if !defined(_WIN32)
+  tmp_path << cache_path_ << ".tmp." << getpid();
+#else
+  tmp_path << cache_path_ << ".tmp." << reinterpret_cast<uintptr_t>(this);
+#endif
+  {
+    std::ofstream fout(tmp_path.str(), std::ios::binary | std::ios::trunc);
+    if (!fout.is_open()) {
+      LOG(WARNING) << "Can not write build cache to " << tmp_path.str();
+      return;
+    }
+    fout.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!fout.good()) {
+      LOG(WARNING) << "Failed to write build cache to " << tmp_path.str();
+      fout.close();
+      std::remove(tmp_path.str().c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.str().c_str(), cache_path_.c_str()) != 0) {
+    LOG(WARNING) << "Failed to publish build cache to " << cache_path_;
+    std::remove(tmp_path.str().c_str());
+    return;
+  }
+  VLOG(1) << "Save build cache to " << cache_path_ << ", op_num " << op_num_
+          << ", edge_num " << header.edge_num << ", event_num "
+          << header.event_num;
+}
+
+uint64_t PirBuildCache::Digest(const std::map<size_t, std::set<size_t>>& ops) {
+  std::string buffer;
+  for (const auto& item : ops) {
+    AppendPod(&buffer, static_cast<uint64_t>(item.first));
+    AppendPod(&buffer, static_cast<uint64_t>(item.second.size()));
+    for (size_t op : item.second) {
+      AppendPod(&buffer, static_cast<uint64_t>(op));
+    }
+  }
+  return XXH64(buffer.data(), buffer.size(), kBuildCacheVersion);
+}
+
+}  // namespace paddle::framework::interpreter
@@ -0,0 +1,84 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/phi/common/place.h"
+
+namespace paddle {
+namespace framework {
+class InstructionBase;
+namespace interpreter {
+
+// The build results of PirInterpreter that only depend on the program, see
+// PirBuildCache.
+struct PirBuildAnalysis {
+  // The downstream map and the op happens-before matrix of
+  // PirDependencyBuilder.
+  std::map<size_t, std::set<size_t>> downstream_map;
+  std::vector<std::vector<bool>> op_happens_before;
+  // The (recorder, waiter) pairs of the event info of PirStreamAnalyzer, in
+  // the ids of the instructions merged across two steps.
+  std::vector<std::pair<size_t, size_t>> event_pairs;
+  // The last live ops of each variable after the shrink, and the digest of
+  // them before the shrink. They are only used if the digest matches, since
+  // the variables to check depend on their types in the scope.
+  uint64_t last_live_ops_digest{0};
+  std::map<size_t, std::set<size_t>> last_live_ops;
+};
+
+// PirBuildCache persists the build analysis of PirInterpreter to a file, so
+// that a new process running the same program can skip the dependency
+// analysis, the stream event analysis and the shrink of the last live ops,
+// which are all quadratic in the number of ops.
+//
+// The cache file is keyed by a hash of the instruction list (name, kernel
+// type, the variable ids it reads and writes, its device context and
+// stream), the place and the flags that affect the dependency analysis. A
+// file with a different key is ignored and overwritten. Files are written to
+// a temporary path and renamed, so concurrent processes never observe a
+// partially written cache, and are read back through mmap where it is
+// available.
+class PirBuildCache {
+ public:
+  PirBuildCache(const std::string& cache_dir,
+                const phi::Place& place,
+                const std::vector<InstructionBase*>& instructions);
+
+  const std::string& CachePath() const { return cache_path_; }
+
+  uint64_t Key() const { return key_; }
+
+  // Returns false if there is no valid cache file for the instructions.
+  bool Load(PirBuildAnalysis* analysis) const;
+
+  void Save(const PirBuildAnalysis& analysis) const;
+
+  static uint64_t Digest(const std::map<size_t, std::set<size_t>>& ops);
+
+ private:
+  size_t op_num_;
+  uint64_t key_;
+  std::string cache_path_;
+};
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
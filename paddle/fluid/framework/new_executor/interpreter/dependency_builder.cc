@@ -764,6 +764,26 @@ void PirDependencyBuilder::BuildDownstreamMap() {
   }
 }
 
+void PirDependencyBuilder::RestoreDependency(
+    std::vector<paddle::framework::InstructionBase*> instructions,
+    std::map<size_t, std::set<size_t>>&& downstream_map,
+    std::vector<std::vector<bool>>&& op_happens_before) {
+  PADDLE_ENFORCE_EQ(
+      op_happens_before.size(),
+      instructions.size(),
+      common::errors::InvalidArgument(
+          "The restored op_happens_before has %d rows, but there are %d "
+          "instructions.",
+          op_happens_before.size(),
+          instructions.size()));
+  std::tie(op_downstream_map_, op_happens_before_) = GetDependency();
+  instructions_ = instructions;
+  op_num_ = instructions_.size();
+  *op_downstream_map_ = std::move(downstream_map);
+  *op_happens_before_ = std::move(op_happens_before);
+  is_build_ = true;
+}
+
 void PirDependencyBuilder::ShareDependencyFrom(
     const PirDependencyBuilder& src) {
   std::tie(op_downstream_map_, op_happens_before_) = src.GetDependency();
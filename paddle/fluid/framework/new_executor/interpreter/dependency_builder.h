@@ -122,6 +122,13 @@ class PirDependencyBuilder : public DependencyBuilder {
 
   void BuildDownstreamMap();
 
+  // Restore the dependency built by another process (see PirBuildCache)
+  // instead of analyzing the instructions, Build returns it afterwards.
+  void RestoreDependency(
+      std::vector<paddle::framework::InstructionBase*> instructions,
+      std::map<size_t, std::set<size_t>>&& downstream_map,
+      std::vector<std::vector<bool>>&& op_happens_before);
+
   void ShareDependencyFrom(const PirDependencyBuilder& src);
 
   bool IsSameDeviceContext(size_t op1, size_t op2) const {
@@ -37,6 +37,16 @@ PHI_DEFINE_EXPORTED_string(force_sync_ops,
                            "",
                            "Pattern to force sync ops in executor.");
 
+PHI_DEFINE_EXPORTED_bool(
+    new_executor_numa_aware_scheduling,
+    false,
+    "Enable NUMA-aware, continuation-style host scheduling in executor.");
+
+PHI_DEFINE_EXPORTED_bool(
+    new_executor_build_cache,
+    false,
+    "Cache the build results of executor next to the model in inference.");
+
 PD_DECLARE_bool(new_executor_serial_run);
 
 namespace paddle::framework::interpreter {
@@ -131,6 +141,9 @@ void ExecutionConfig::AnalyzeThreadPoolConfig(const phi::Place& place,
     std::tie(host_num_threads, device_num_threads) =
         GetThreadPoolConfig(place, op_num);
   }
+  if (FLAGS_new_executor_numa_aware_scheduling) {
+    host_numa_aware_scheduling = true;
+  }
 }
 
 void ExecutionConfig::Log(int log_level) {
@@ -141,7 +154,10 @@ void ExecutionConfig::Log(int log_level) {
           << "used_for_control_flow_op = " << used_for_control_flow_op << "\n"
           << "used_for_jit = " << used_for_jit << "\n"
           << "device_num_threads = " << device_num_threads << "\n"
-          << "host_num_threads = " << host_num_threads << "\n";
+          << "host_num_threads = " << host_num_threads << "\n"
+          << "host_numa_aware_scheduling = " << host_numa_aware_scheduling
+          << "\n"
+          << "build_cache_dir = " << build_cache_dir << "\n";
 
   log_str << "force_root_scope_vars = [";
   for (const std::string& var : force_root_scope_vars) {
@@ -34,6 +34,15 @@ struct ExecutionConfig {
   size_t device_num_threads{0};
   size_t host_num_threads{0};
 
+  // Pin host workers to NUMA nodes, steal work inside the node first and
+  // run ready host successors on the current worker (continuation-style)
+  // instead of going through the queue.
+  bool host_numa_aware_scheduling{false};
+
+  // Directory of the serialized dependency analysis (see PirBuildCache),
+  // empty means the build results are not cached.
+  std::string build_cache_dir;
+
   std::set<std::pair<int, std::string>>
       force_sync_ops;  // set{pair<op_id, name>}, -1 matches any op_id, ""
                        // matches any name
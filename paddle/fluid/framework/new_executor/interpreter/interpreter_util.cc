@@ -90,7 +90,10 @@ class SingleStreamGuard {
 };
 
 const std::vector<WorkQueueOptions> ConstructWorkQueueOptions(
-    size_t host_num_threads, size_t device_num_threads, EventsWaiter* waiter) {
+    size_t host_num_threads,
+    size_t device_num_threads,
+    EventsWaiter* waiter,
+    bool host_numa_aware) {
   std::vector<WorkQueueOptions> group_options;
   // for execute host Kernel
   group_options.emplace_back(/*name*/ "HostTasks",
@@ -100,6 +103,7 @@ const std::vector<WorkQueueOptions> ConstructWorkQueueOptions(
                              /*track_task*/ false,
                              /*detached*/ true,
                              /*events_waiter*/ waiter);
+  group_options.back().numa_aware = host_numa_aware;
   // for launch device Kernel
   group_options.emplace_back(/*name*/ "DeviceKernelLaunch",
                              /*num_threads*/ device_num_threads,
@@ -113,10 +117,11 @@ const std::vector<WorkQueueOptions> ConstructWorkQueueOptions(
 
 AsyncWorkQueue::AsyncWorkQueue(size_t host_num_threads,
                                size_t device_num_threads,
-                               EventsWaiter* waiter)
+                               EventsWaiter* waiter,
+                               bool host_numa_aware)
     : host_num_thread_(host_num_threads),
       queue_group_(CreateWorkQueueGroup(ConstructWorkQueueOptions(
-          host_num_threads, device_num_threads, waiter))) {}
+          host_num_threads, device_num_threads, waiter, host_numa_aware))) {}
 
 void AsyncWorkQueue::AddTask(const OpFuncType& op_func_type,
                              std::function<void()> fn) {
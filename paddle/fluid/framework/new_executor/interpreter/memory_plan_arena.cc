@@ -0,0 +1,227 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/memory_plan_arena.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/framework/new_executor/pir_adaptor/pir_adaptor_util.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_attribute.h"
+#include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/fluid/pir/transforms/general/memory_planning_pass.h"
+#include "paddle/phi/core/memory/malloc.h"
+#include "paddle/pir/include/core/block.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/core/operation.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+namespace {
+
+// A tensor inside the arena, it keeps the arena alive as long as the tensor
+// holds it.
+class ArenaView : public phi::Allocation {
+ public:
+  ArenaView(std::shared_ptr<phi::Allocation> arena, int64_t offset, size_t size)
+      : phi::Allocation(static_cast<uint8_t*>(arena->ptr()) + offset,
+                        size,
+                        arena->place()),
+        arena_(std::move(arena)) {}
+
+ private:
+  std::shared_ptr<phi::Allocation> arena_;
+};
+
+struct PlannedTensor {
+  phi::DenseTensor* tensor;
+  int64_t offset;
+  size_t size;
+  size_t instr_id;
+};
+
+struct PlaceArena {
+  phi::Place place;
+  int64_t size;
+  const phi::DeviceContext* dev_ctx{nullptr};
+  bool valid{true};
+  std::vector<PlannedTensor> tensors;
+};
+
+}  // namespace
+
+std::unique_ptr<MemoryPlanArena> MemoryPlanArena::Create(
+    const ::pir::Block& block,
+    const ValueExecutionInfo& value_exe_info,
+    const std::vector<std::unique_ptr<InstructionBase>>& instructions,
+    const std::set<std::string>& skip_gc_vars) {
+  auto* module_op = block.GetParentOp();
+  if (!module_op || !module_op->HasAttribute(::pir::kAttrMemoryPlanArenas)) {
+    return nullptr;
+  }
+
+  std::vector<PlaceArena> place_arenas;
+  for (auto arena_attr :
+       module_op->attribute<::pir::ArrayAttribute>(::pir::kAttrMemoryPlanArenas)
+           .AsVector()) {
+    auto items = arena_attr.dyn_cast<::pir::ArrayAttribute>();
+    place_arenas.push_back(
+        {items.at(0).dyn_cast<paddle::dialect::PlaceAttribute>().data(),
+         items.at(1).dyn_cast<::pir::Int64Attribute>().data()});
+  }
+
+  std::unordered_map<::pir::Value, size_t> producers;
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    for (const auto& [value, _] : instructions[i]->Outputs()) {
+      producers[value] = i;
+    }
+  }
+
+  for (auto& op : block) {
+    if (!op.HasAttribute(::pir::kAttrMemoryPlanOffsets)) continue;
+    auto offsets =
+        op.attribute<::pir::ArrayAttribute>(::pir::kAttrMemoryPlanOffsets)
+            .AsVector();
+    for (uint32_t i = 0; i < op.num_results() && i < offsets.size(); ++i) {
+      int64_t offset = offsets[i].dyn_cast<::pir::Int64Attribute>().data();
+      if (offset < 0) continue;
+      ::pir::Value value = op.result(i);
+      auto type =
+          value.type().dyn_cast<paddle::dialect::AllocatedDenseTensorType>();
+      std::string var_name = value_exe_info.GetVarName(value);
+      auto* var = value_exe_info.GetVarByValue(value);
+      auto producer = producers.find(value);
+      if (!type || var_name.empty() || skip_gc_vars.count(var_name) ||
+          !var || !var->IsType<phi::DenseTensor>() ||
+          producer == producers.end()) {
+        VLOG(4) << "Skip the memory plan of " << var_name;
+        continue;
+      }
+      auto arena = std::find_if(
+          place_arenas.begin(), place_arenas.end(), [&](const auto& item) {
+            return item.place == type.place();
+          });
+      if (arena == place_arenas.end()) continue;
+      const auto* dev_ctx = &instructions[producer->second]->DeviceContext();
+      if (!arena->dev_ctx) arena->dev_ctx = dev_ctx;
+      if (arena->dev_ctx != dev_ctx) arena->valid = false;
+      size_t size = common::product(type.dims()) *
+                    phi::SizeOf(paddle::dialect::TransToPhiDataType(
+                        type.dtype()));
+      arena->tensors.push_back({var->GetMutable<phi::DenseTensor>(),
+                                offset,
+                                size,
+                                producer->second});
+    }
+  }
+
+  auto memory_plan_arena = std::make_unique<MemoryPlanArena>();
+  std::unordered_set<const phi::DenseTensor*> bound;
+  for (auto& place_arena : place_arenas) {
+    if (!place_arena.valid) {
+      VLOG(1) << "Drop the memory plan on " << place_arena.place
+              << ", the tensors are written on different streams.";
+      continue;
+    }
+    if (place_arena.tensors.empty() || place_arena.size <= 0) continue;
+    auto arena = memory::AllocShared(place_arena.place,
+                                     static_cast<size_t>(place_arena.size));
+    for (const auto& planned : place_arena.tensors) {
+      // An inplace output shares the variable of its input, the tensor is
+      // bound once, for the instruction writing it first.
+      if (!bound.insert(planned.tensor).second) continue;
+      memory_plan_arena->bindings_.push_back(
+          {planned.tensor,
+           std::make_shared<ArenaView>(arena, planned.offset, planned.size),
+           planned.instr_id});
+    }
+    memory_plan_arena->arenas_.push_back(std::move(arena));
+    VLOG(1) << "Bind " << place_arena.tensors.size()
+            << " tensors into an arena of " << place_arena.size
+            << " bytes on " << place_arena.place;
+  }
+  if (memory_plan_arena->bindings_.empty()) return nullptr;
+
+  // The inplace outputs share the variable of their input, the view outputs
+  // share its buffer, so a buffer is checked by its address.
+  std::unordered_map<const phi::DenseTensor*, const void*> ptrs;
+  for (const auto& binding : memory_plan_arena->bindings_) {
+    ptrs[binding.tensor] = binding.view->ptr();
+  }
+  auto& outputs = memory_plan_arena->outputs_;
+  outputs.resize(instructions.size());
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    for (const auto& [value, _] : instructions[i]->Outputs()) {
+      auto* var = value_exe_info.GetVarByValue(value);
+      if (!var || !var->IsType<phi::DenseTensor>()) continue;
+      const auto* tensor = &var->Get<phi::DenseTensor>();
+      auto ptr = ptrs.find(tensor);
+      outputs[i].push_back({tensor, ptr != ptrs.end() ? ptr->second : nullptr});
+    }
+  }
+  return memory_plan_arena;
+}
+
+void MemoryPlanArena::Bind() const {
+  for (const auto& binding : bindings_) {
+    if (binding.tensor->Holder() != binding.view) {
+      binding.tensor->ResetHolder(binding.view);
+    }
+  }
+}
+
+bool MemoryPlanArena::Check(size_t instr_id) const {
+  bool aliased = false;
+  for (const auto& output : outputs_.at(instr_id)) {
+    // Freed by the garbage collector after its last use.
+    const auto* holder = output.tensor->Holder().get();
+    if (!holder) continue;
+    if (output.ptr ? holder->ptr() != output.ptr
+                   : dynamic_cast<const ArenaView*>(holder) != nullptr) {
+      VLOG(1) << "Drop the memory plan, the output " << output.tensor
+              << " of instruction " << instr_id
+              << " does not hold its planned buffer.";
+      aliased = true;
+      break;
+    }
+  }
+  if (!aliased) return true;
+  // The buffers of the tensors already written stay with them, the others
+  // are allocated by the kernels.
+  for (const auto& binding : bindings_) {
+    if (binding.instr_id > instr_id &&
+        binding.tensor->Holder() == binding.view) {
+      binding.tensor->clear();
+    }
+  }
+  return false;
+}
+
+void MemoryPlanArena::Unbind() const {
+  for (const auto& binding : bindings_) {
+    if (binding.tensor->Holder() == binding.view) {
+      binding.tensor->clear();
+    }
+  }
+}
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
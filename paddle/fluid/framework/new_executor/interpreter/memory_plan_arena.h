@@ -0,0 +1,89 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/core/allocator.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace pir {
+class Block;
+}  // namespace pir
+
+namespace paddle {
+namespace framework {
+class InstructionBase;
+class ValueExecutionInfo;
+
+namespace interpreter {
+
+// Binds the tensors planned by memory_planning_pass to their offsets inside
+// the arenas, one allocation per place for the whole lifetime of the
+// interpreter. The offsets are only valid when the instructions run in the
+// order of the block.
+class MemoryPlanArena final {
+ public:
+  // Returns nullptr if the block has no memory plan. The plan of a place is
+  // dropped if its tensors are written by instructions on different device
+  // contexts, as the reuse of the memory is only ordered in one stream.
+  static std::unique_ptr<MemoryPlanArena> Create(
+      const ::pir::Block& block,
+      const ValueExecutionInfo& value_exe_info,
+      const std::vector<std::unique_ptr<InstructionBase>>& instructions,
+      const std::set<std::string>& skip_gc_vars);
+
+  // The garbage collector drops the holders after the last use, so the
+  // tensors are bound again before every run.
+  void Bind() const;
+
+  // Runs after the instruction of index instr_id. A kernel may share the
+  // buffer of its input with its output although the op declares neither
+  // inplace nor view, so each output must still hold its planned buffer, and
+  // the outputs not planned must not hold any buffer of the arenas. Otherwise
+  // the tensors of the instructions not run yet are unbound and false is
+  // returned, the caller drops the plan.
+  bool Check(size_t instr_id) const;
+
+  // Unbinds the tensors still holding their views, after the run that
+  // dropped the plan.
+  void Unbind() const;
+
+  size_t num_tensors() const { return bindings_.size(); }
+
+ private:
+  struct Binding {
+    phi::DenseTensor* tensor;
+    std::shared_ptr<phi::Allocation> view;
+    size_t instr_id;
+  };
+
+  struct Output {
+    const phi::DenseTensor* tensor;
+    // The planned address, nullptr if the tensor is not planned.
+    const void* ptr;
+  };
+
+  std::vector<std::shared_ptr<phi::Allocation>> arenas_;
+  std::vector<Binding> bindings_;
+  // The dense tensor outputs of each instruction.
+  std::vector<std::vector<Output>> outputs_;
+};
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
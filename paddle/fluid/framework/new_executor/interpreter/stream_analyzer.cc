@@ -870,4 +870,37 @@ PirStreamAnalyzer::GetEventInfo() const {
   return event_info_;
 }
 
+std::vector<std::pair<size_t, size_t>> PirStreamAnalyzer::EventPairs() const {
+  std::vector<std::pair<size_t, size_t>> event_pairs;
+  for (auto& context_item : *event_info_) {
+    for (auto& waiter_item : context_item.second) {
+      for (size_t recorder_instr_id : waiter_item.second) {
+        event_pairs.emplace_back(recorder_instr_id, waiter_item.first);
+      }
+    }
+  }
+  return event_pairs;
+}
+
+void PirStreamAnalyzer::RestoreEventInfo(
+    const std::vector<std::unique_ptr<paddle::framework::InstructionBase>>&
+        instructions,
+    const std::vector<std::pair<size_t, size_t>>& event_pairs) {
+  if (is_event_info_build_) {
+    return;
+  }
+  // The event info is keyed by the device context of the recorder, the
+  // instruction i + instructions.size() is the instruction i of the next
+  // step.
+  for (auto& event_pair : event_pairs) {
+    size_t recorder_instr_id = event_pair.first;
+    const DeviceContext* recorder_context =
+        &instructions.at(recorder_instr_id % instructions.size())
+             ->DeviceContext();
+    (*event_info_)[recorder_context][event_pair.second].insert(
+        recorder_instr_id);
+  }
+  is_event_info_build_ = true;
+}
+
 }  // namespace paddle::framework::interpreter
@@ -15,6 +15,7 @@
 #pragma once
 #include <future>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/new_executor/interpreter/dependency_builder.h"
@@ -144,6 +145,17 @@ class PirStreamAnalyzer {
 
   void ShareEventInfoFrom(const PirStreamAnalyzer& src);
 
+  // The (recorder, waiter) pairs of the event info, in the ids of the
+  // instructions merged across two steps (see PirBuildCache).
+  std::vector<std::pair<size_t, size_t>> EventPairs() const;
+
+  // Restore the event info analyzed by another process instead of analyzing
+  // the instructions, ConstructEvents creates the events from it afterwards.
+  void RestoreEventInfo(
+      const std::vector<std::unique_ptr<paddle::framework::InstructionBase>>&
+          instructions,
+      const std::vector<std::pair<size_t, size_t>>& event_pairs);
+
   void SetForceEventsToWaitInfo(
       std::unordered_map<std::string, std::shared_ptr<EventInter>>*
           program_force_events_to_wait) {
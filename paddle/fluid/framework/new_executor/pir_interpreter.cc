@@ -15,11 +15,13 @@
 #include "paddle/fluid/framework/new_executor/pir_interpreter.h"
 
 #include <chrono>
+#include <numeric>
 #include <unordered_set>
 
 #include "paddle/common/flags.h"
 
 #include "paddle/fluid/framework/details/nan_inf_utils.h"
+#include "paddle/fluid/framework/new_executor/interpreter/build_cache.h"
 #include "paddle/fluid/framework/new_executor/interpreter/interpreter_util.h"
 #include "paddle/fluid/framework/new_executor/interpreter/static_build.h"
 #include "paddle/fluid/framework/operator.h"
@@ -88,6 +90,7 @@ COMMON_DECLARE_bool(enable_pir_in_executor);
 COMMON_DECLARE_bool(enable_pir_in_executor_trace_run);
 COMMON_DECLARE_bool(enable_collect_shape);
 COMMON_DECLARE_int32(low_precision_op_list);
+COMMON_DECLARE_bool(executor_op_counters);
 
 #define CREATE_INSTR(instr_name)                                   \
   vec_instruction_base_.emplace_back(std::make_unique<instr_name>( \
@@ -414,7 +417,8 @@ std::shared_ptr<interpreter::AsyncWorkQueue> PirInterpreter::GetWorkQueue() {
     async_work_queue_ = std::make_shared<interpreter::AsyncWorkQueue>(
         execution_config_.host_num_threads,
         execution_config_.device_num_threads,
-        nullptr);
+        nullptr,
+        execution_config_.host_numa_aware_scheduling);
   }
   return async_work_queue_;
 }
@@ -1065,7 +1069,8 @@ std::vector<std::string> PirInterpreter::DebugInfo() {
   return {block_info, instr_info, depend_info};
 }
 
-void PirInterpreter::BuildInstructionDependences() {
+void PirInterpreter::BuildInstructionDependences(
+    interpreter::PirBuildAnalysis* cached_analysis) {
   // analysis the dependences between instructions, add next_instr_list to each
   // instr, and set the dependency_count_
   size_t instr_num = vec_instruction_base_.size();
@@ -1077,6 +1082,15 @@ void PirInterpreter::BuildInstructionDependences() {
   for (auto& instr : vec_instruction_base_) {
     instructions_ptr.push_back(instr.get());
   }
+
+  // Restore the dependency analysis from the build cache if it hits.
+  if (cached_analysis != nullptr) {
+    ir_dependency_builder_.RestoreDependency(
+        instructions_ptr,
+        std::move(cached_analysis->downstream_map),
+        std::move(cached_analysis->op_happens_before));
+  }
+
   auto downstream_map = ir_dependency_builder_.Build(instructions_ptr);
 
   for (size_t instr_id = 0; instr_id < instr_num; ++instr_id) {
@@ -1273,6 +1287,18 @@ void PirInterpreter::RecordStreamForGC(InstructionBase* instr) {
 #endif
 }
 
+void PirInterpreter::CreateOpCountersIfEnabled() {
+  if (!FLAGS_executor_op_counters || op_counters_) {
+    return;
+  }
+  std::vector<std::string> instr_names;
+  instr_names.reserve(vec_instruction_base_.size());
+  for (auto& instr : vec_instruction_base_) {
+    instr_names.push_back(instr->Name());
+  }
+  op_counters_ = CreateInstructionCounters(std::move(instr_names));
+}
+
 void PirInterpreter::CheckGC(InstructionBase* instr) {
   phi::RecordEvent record("CheckGC", phi::TracerEventType::UserDefined, 10);
 
@@ -1305,7 +1331,8 @@ void PirInterpreter::CheckGC(InstructionBase* instr) {
   instr->ClearEagerGCVars();
 }
 
-void PirInterpreter::CalculateLastLiveOps() {
+void PirInterpreter::CalculateLastLiveOps(
+    interpreter::PirBuildAnalysis* build_analysis, bool is_cache_hit) {
   VLOG(4) << "PirInterpreter(): " << this << " start CalculateLastLiveOps";
   // calculate last_live_ops_
   for (size_t op_idx = 0; op_idx < vec_instruction_base_.size(); ++op_idx) {
@@ -1369,6 +1396,20 @@ void PirInterpreter::CalculateLastLiveOps() {
   }
   VLOG(4) << "clear the last_live_ops list for all vars in skip_gc_vars";
 
+  // The shrunk lists in the build cache are valid if the lists before the
+  // shrink are the same, which depend on the variable types in the scope.
+  const std::map<size_t, std::set<size_t>>* cached_last_live_ops = nullptr;
+  if (build_analysis != nullptr) {
+    uint64_t digest = interpreter::PirBuildCache::Digest(last_live_ops_);
+    if (!is_cache_hit) {
+      build_analysis->last_live_ops_digest = digest;
+    } else if (build_analysis->last_live_ops_digest == digest) {
+      cached_last_live_ops = &build_analysis->last_live_ops;
+    } else {
+      VLOG(1) << "Ignore the cached last_live_ops, the variables differ";
+    }
+  }
+
   // shrink, find the downstream op that has no other op in the
   // downstream list happens before it
   // For example,
@@ -1386,6 +1427,18 @@ void PirInterpreter::CalculateLastLiveOps() {
   VLOG(4) << "var_ref_count_.size() : " << var_ref_count_.size();
   for (size_t i = 0; i < last_live_ops_.size(); ++i) {
     std::set<size_t> minumum_last_live_ops;
+    if (cached_last_live_ops != nullptr) {
+      auto iter = cached_last_live_ops->find(i);
+      if (iter != cached_last_live_ops->end()) {
+        minumum_last_live_ops = iter->second;
+      }
+      for (size_t item : minumum_last_live_ops) {
+        vec_instruction_base_[item]->AddGCCheckVar(i);
+      }
+      last_live_ops_[i] = minumum_last_live_ops;
+      var_ref_count_[i] = static_cast<int>(last_live_ops_[i].size());
+      continue;
+    }
     for (size_t item : last_live_ops_[i]) {
       bool not_before_any = true;
       // find the op that is not executed before any
@@ -1409,6 +1462,9 @@ void PirInterpreter::CalculateLastLiveOps() {
     var_ref_count_[i] = static_cast<int>(last_live_ops_[i].size());
   }
   VLOG(4) << "shrink the last_live_ops list for all vars in skip_gc_vars";
+  if (build_analysis != nullptr && !is_cache_hit) {
+    build_analysis->last_live_ops = last_live_ops_;
+  }
 
   for (auto& dep : *dependency_count_) {
     deps_.emplace_back(std::make_shared<interpreter::OpDepInfo>(dep));
@@ -1497,7 +1553,7 @@ paddle::framework::FetchList PirInterpreter::Run(
     VLOG(4) << "Done PreAnalysis";
 
     if (FLAGS_enable_pir_in_executor_trace_run || onednn_op_num_ ||
-        execution_config_.used_for_inference ||
+        memory_plan_arena_ || execution_config_.used_for_inference ||
         ((execution_config_.used_for_jit || execution_config_.used_for_cinn) &&
          (sync_op_num_ == 0))) {
       LOG_FIRST_N(INFO, 1) << "pir interpreter is running by trace mode ...";
@@ -1512,7 +1568,7 @@ paddle::framework::FetchList PirInterpreter::Run(
     is_shared_results_build_ = true;
   } else {
     if (FLAGS_enable_pir_in_executor_trace_run || onednn_op_num_ ||
-        execution_config_.used_for_inference ||
+        memory_plan_arena_ || execution_config_.used_for_inference ||
         ((execution_config_.used_for_jit || execution_config_.used_for_cinn) &&
          (sync_op_num_ == 0))) {
       TraceRunImpl();
@@ -1582,7 +1638,7 @@ FetchList PirInterpreter::Run(const std::vector<std::string>& feed_names,
 
     // Run
     if (FLAGS_enable_pir_in_executor_trace_run || onednn_op_num_ ||
-        execution_config_.used_for_inference ||
+        memory_plan_arena_ || execution_config_.used_for_inference ||
         ((execution_config_.used_for_jit || execution_config_.used_for_cinn) &&
          (sync_op_num_ == 0))) {
       LOG_FIRST_N(INFO, 1) << "pir interpreter is running by trace mode ...";
@@ -1597,7 +1653,7 @@ FetchList PirInterpreter::Run(const std::vector<std::string>& feed_names,
     is_shared_results_build_ = true;
   } else {
     if (FLAGS_enable_pir_in_executor_trace_run || onednn_op_num_ ||
-        execution_config_.used_for_inference ||
+        memory_plan_arena_ || execution_config_.used_for_inference ||
         ((execution_config_.used_for_jit || execution_config_.used_for_cinn) &&
          (sync_op_num_ == 0))) {
       TraceRunImpl();
@@ -1631,10 +1687,14 @@ void PirInterpreter::TraceRunImpl() {
   if (!gc_) {
     gc_ = CreateInterpreterCoreGarbageCollector(place_, vec_instruction_base_);
   }
+  CreateOpCountersIfEnabled();
 
   interpreter::ResetAtomicGuard guard(&deps_, &refs_);
   VLOG(4) << "Tracing Instruction List";
 
+  if (memory_plan_arena_) {
+    memory_plan_arena_->Bind();
+  }
   TraceRunInstructionList(vec_instruction_base_);
   VLOG(4) << "Done TraceRunInstructionList";
 #ifdef PADDLE_WITH_CUSTOM_DEVICE
@@ -1649,6 +1709,7 @@ void PirInterpreter::MultiThreadRunImpl() {
   if (!gc_) {
     gc_ = CreateInterpreterCoreGarbageCollector(place_, vec_instruction_base_);
   }
+  CreateOpCountersIfEnabled();
 
   interpreter::ResetAtomicGuard guard(&deps_, &refs_);
   VLOG(4) << "Multi Thread Run Instruction List";
@@ -1694,6 +1755,8 @@ void PirInterpreter::TraceRunInstructionList(
     }
   }
 
+  // Set when a kernel aliased a planned buffer, see MemoryPlanArena::Check.
+  bool memory_plan_dropped = false;
   for (size_t idx = 0; idx < trace_execute_order_.size(); idx++) {
     auto instr_id = trace_execute_order_[idx];
     InstructionBase* instr_node = vec_instruction_base_.at(instr_id).get();
@@ -1701,6 +1764,10 @@ void PirInterpreter::TraceRunInstructionList(
     VLOG(6) << "Run InstructionBase " << instr_node->Name() << "[" << instr_id
             << "], op id: " << instr_node->Operation()->id();
     RunInstructionBase(instr_node);
+    if (memory_plan_arena_ && !memory_plan_dropped &&
+        !memory_plan_arena_->Check(instr_id)) {
+      memory_plan_dropped = true;
+    }
 
     if (UNLIKELY(exception_holder_.IsCaught())) {
       VLOG(4) << "Exception caught";
@@ -1708,6 +1775,11 @@ void PirInterpreter::TraceRunInstructionList(
     }
   }
 
+  if (memory_plan_dropped) {
+    memory_plan_arena_->Unbind();
+    memory_plan_arena_.reset();
+  }
+
   if (UNLIKELY(exception_holder_.IsCaught())) {
     VLOG(1) << "Exception caught " << exception_holder_.Type();
     PADDLE_ENFORCE_EQ(
@@ -1748,6 +1820,9 @@ void PirInterpreter::MultiThreadRunInstructionList(
     if ((*dependency_count_)[i] == 0) {
       // NOTE(zhiqiu): hot fix for jit input var
       RecordMemcpyD2H(vec_instr.at(i).get());
+      if (op_counters_) {
+        op_counters_->MarkReady(i);
+      }
       if (FLAGS_new_executor_serial_run) {
         RunInstructionBaseAsync(i);
       } else {
@@ -1857,11 +1932,29 @@ void PirInterpreter::RunNextInstructions(InstructionBase* instr,
   auto IsReady = [this](size_t next_id) {
     VLOG(4) << "op_id: " << next_id
             << ", remain deps: " << deps_[next_id]->DynamicDep();
-    return deps_[next_id]->CheckAndDecrease();
+    bool is_ready = deps_[next_id]->CheckAndDecrease();
+    if (is_ready && op_counters_) {
+      op_counters_->MarkReady(next_id);
+    }
+    return is_ready;
   };
 
+  // In NUMA-aware scheduling, one ready host successor is kept on the
+  // current worker if nothing else is left to run here, which saves a round
+  // trip through the queue and keeps its inputs in the local cache.
+  const bool allow_continuation =
+      execution_config_.host_numa_aware_scheduling &&
+      instr->KernelType() != OpFuncType::kGpuAsync;
+  int64_t continuation_id = -1;
+
   for (size_t next_instr_id : instr->NextInstrsInDifferenceThread()) {
     if (IsReady(next_instr_id)) {
+      if (allow_continuation && continuation_id < 0 &&
+          vec_instruction_base_[next_instr_id]->KernelType() !=
+              OpFuncType::kGpuAsync) {
+        continuation_id = static_cast<int64_t>(next_instr_id);
+        continue;
+      }
       async_work_queue_->AddTask(
           vec_instruction_base_[next_instr_id]->KernelType(),
           [this, next_instr_id]() { RunInstructionBaseAsync(next_instr_id); });
@@ -1873,6 +1966,17 @@ void PirInterpreter::RunNextInstructions(InstructionBase* instr,
       reserved_next_ops->push(next_instr_id);
     }
   }
+
+  if (continuation_id >= 0) {
+    size_t next_instr_id = static_cast<size_t>(continuation_id);
+    if (reserved_next_ops->empty()) {
+      reserved_next_ops->push(next_instr_id);
+    } else {
+      async_work_queue_->AddTask(
+          vec_instruction_base_[next_instr_id]->KernelType(),
+          [this, next_instr_id]() { RunInstructionBaseAsync(next_instr_id); });
+    }
+  }
 }
 
 void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
@@ -1881,6 +1985,9 @@ void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
 
   auto cur_place = instr_node->DeviceContext().GetPlace();
   SetDeviceId(cur_place);
+  if (op_counters_) {
+    op_counters_->MarkStart(instr_node->Id());
+  }
 
   try {
     instr_node->WaitEvent(cur_place);
@@ -1924,6 +2031,11 @@ void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
       {
         phi::RecordEvent record(
             "InstrRun", phi::TracerEventType::UserDefined, 10);
+        InstructionCounters::Recorder recorder(
+            op_counters_.get(),
+            instr_node->Id(),
+            cur_place,
+            InstructionCounters::Recorder::Kind::kRun);
         instr_node->Run();
       }
 
@@ -1948,7 +2060,14 @@ void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
               << " runs on " << phi::GetCurrentThreadName() << "\n"
               << "After: " << cur_place << " "
               << instr_node->DebugStringEx(scope_, value_exe_info_.get());
-      CheckGC(instr_node);
+      {
+        InstructionCounters::Recorder recorder(
+            op_counters_.get(),
+            instr_node->Id(),
+            cur_place,
+            InstructionCounters::Recorder::Kind::kGC);
+        CheckGC(instr_node);
+      }
       VLOG(4) << "done CheckGC";
       memory::LogDeviceMemoryStats(cur_place, instr_node->Name());
     }
@@ -2004,10 +2123,29 @@ void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
 }
 
 void PirInterpreter::PreAnalysis() {
-  BuildInstructionDependences();
+  // Restore the analysis from the build cache if one exists for these
+  // instructions, otherwise analyze them and save it for later processes.
+  std::unique_ptr<interpreter::PirBuildCache> build_cache = nullptr;
+  interpreter::PirBuildAnalysis build_analysis;
+  bool is_cache_hit = false;
+  if (!execution_config_.build_cache_dir.empty() && !is_shared_results_build_) {
+    std::vector<paddle::framework::InstructionBase*> instructions_ptr;
+    for (auto& instr : vec_instruction_base_) {
+      instructions_ptr.push_back(instr.get());
+    }
+    build_cache = std::make_unique<interpreter::PirBuildCache>(
+        execution_config_.build_cache_dir, place_, instructions_ptr);
+    is_cache_hit = build_cache->Load(&build_analysis);
+  }
+
+  BuildInstructionDependences(is_cache_hit ? &build_analysis : nullptr);
   VLOG(4) << "Done BuildInstructionDependences";
 
   ir_stream_analyzer_.SetForceEventsToWaitInfo(force_events_to_wait_);
+  if (is_cache_hit) {
+    ir_stream_analyzer_.RestoreEventInfo(vec_instruction_base_,
+                                         build_analysis.event_pairs);
+  }
   ir_stream_analyzer_.ConstructEvents(vec_instruction_base_);
   VLOG(4) << "Done ConstructEvents";
 
@@ -2016,9 +2154,17 @@ void PirInterpreter::PreAnalysis() {
   ConstructEventForJitInput();
   VLOG(4) << "AddEventToWait for JitInputVars";
 
-  CalculateLastLiveOps();
+  CalculateLastLiveOps(build_cache ? &build_analysis : nullptr, is_cache_hit);
   VLOG(4) << "Done CalculateLastLiveOps";
 
+  if (build_cache != nullptr && !is_cache_hit) {
+    auto dependency = ir_dependency_builder_.GetDependency();
+    build_analysis.downstream_map = *std::get<0>(dependency);
+    build_analysis.op_happens_before = *std::get<1>(dependency);
+    build_analysis.event_pairs = ir_stream_analyzer_.EventPairs();
+    build_cache->Save(build_analysis);
+  }
+
   if (VLOG_IS_ON(2)) {
     std::vector<std::string> instr_debug_info = DebugInfo();
     for (auto& item : instr_debug_info) {
@@ -2030,6 +2176,18 @@ void PirInterpreter::PreAnalysis() {
                               ir_instruction_scheduling_priority_less);
   VLOG(4) << "Done AnalyseExecuteOrderForTrace";
 
+  memory_plan_arena_ =
+      interpreter::MemoryPlanArena::Create(*ir_block_,
+                                           *value_exe_info_,
+                                           vec_instruction_base_,
+                                           execution_config_.skip_gc_vars);
+  if (memory_plan_arena_) {
+    // The offsets are planned in the order of the block, which is also a
+    // topological order of the instructions.
+    std::iota(trace_execute_order_.begin(), trace_execute_order_.end(), 0);
+    VLOG(4) << "Done MemoryPlanArena";
+  }
+
   AnalyzeForceSyncOps();
   VLOG(4) << "Done AnalyzeForceSyncOps";
 
@@ -14,7 +14,9 @@
 
 #pragma once
 #include <memory>
+#include "paddle/fluid/framework/new_executor/executor_statistics.h"
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/framework/new_executor/interpreter/memory_plan_arena.h"
 #include "paddle/fluid/framework/new_executor/interpreter_base_impl.h"
 #include "paddle/pir/include/core/value.h"
 
@@ -28,6 +30,9 @@ class Block;
 
 namespace paddle {
 namespace framework {
+namespace interpreter {
+struct PirBuildAnalysis;
+}  // namespace interpreter
 class ValueExecutionInfo;
 class PirInterpreter : public InterpreterBaseImpl {
   using ExecutionConfig = interpreter::ExecutionConfig;
@@ -135,7 +140,10 @@ class PirInterpreter : public InterpreterBaseImpl {
       InstructionSchedulingPriorityLess compare);
   void AnalyzeForceSyncOps();
   void ConstructEventForJitInput();
-  void CalculateLastLiveOps();
+  // build_analysis is the cached analysis if is_cache_hit, otherwise the
+  // analysis to be saved, or nullptr if there is no build cache.
+  void CalculateLastLiveOps(interpreter::PirBuildAnalysis* build_analysis,
+                            bool is_cache_hit);
 
   // gc
   void ClearLoDTensorArrayInLocalScope();
@@ -189,6 +197,9 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   std::unique_ptr<InterpreterCoreGarbageCollector> gc_;
 
+  // nullptr unless FLAGS_executor_op_counters is on
+  std::shared_ptr<InstructionCounters> op_counters_;
+
   // last_live_ops_[i] contains the id of operators that last access the i-th
   // var
   std::map<size_t, std::set<size_t>> last_live_ops_;
@@ -206,6 +217,10 @@ class PirInterpreter : public InterpreterBaseImpl {
   int64_t onednn_op_num_{-1};
   std::vector<size_t> trace_execute_order_;
 
+  // Not null if the block is planned by memory_planning_pass, then the
+  // instructions run by trace in the order of the block.
+  std::unique_ptr<interpreter::MemoryPlanArena> memory_plan_arena_;
+
   std::vector<PirHookFunc> pir_output_hookfuncs_;
   std::vector<PirHookFunc> pir_input_hookfuncs_;
 
@@ -224,7 +239,9 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   void BuildInstruction();
 
-  void BuildInstructionDependences();
+  // The dependency of cached_analysis is moved out if it is not nullptr.
+  void BuildInstructionDependences(
+      interpreter::PirBuildAnalysis* cached_analysis);
 
   void TraceRunImpl();
 
@@ -247,6 +264,8 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   ::pir::Value GetValueByName(const std::string& var_name);
 
+  void CreateOpCountersIfEnabled();
+
   void CheckGC(InstructionBase* instr);
 
   void RecordStreamForGC(InstructionBase* instr);
@@ -409,7 +409,8 @@ ProgramInterpreter::GetWorkQueue() {
     async_work_queue_ = std::make_shared<interpreter::AsyncWorkQueue>(
         execution_config_.host_num_threads,
         execution_config_.device_num_threads,
-        nullptr);
+        nullptr,
+        execution_config_.host_numa_aware_scheduling);
   }
   return async_work_queue_;
 }
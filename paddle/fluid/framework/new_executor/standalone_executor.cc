@@ -24,6 +24,7 @@
 
 #include "paddle/fluid/ir_adaptor/translator/translate.h"
 #include "paddle/fluid/pir/transforms/general/inplace_pass.h"
+#include "paddle/fluid/pir/transforms/general/memory_planning_pass.h"
 #include "paddle/pir/include/core/program.h"
 #include "paddle/pir/include/pass/pass.h"
 #include "paddle/pir/include/pass/pass_manager.h"
@@ -31,6 +32,7 @@
 COMMON_DECLARE_bool(enable_pir_in_executor);
 COMMON_DECLARE_bool(enable_pir_api);
 COMMON_DECLARE_bool(pir_apply_inplace_pass);
+COMMON_DECLARE_bool(pir_apply_memory_planning_pass);
 
 namespace paddle::framework {
 StandaloneExecutor::StandaloneExecutor(const phi::Place& place,
@@ -116,9 +118,15 @@ StandaloneExecutor::StandaloneExecutor(const phi::Place& place,
       std::shared_ptr<pir::Program> shared_program = std::move(kernel_program);
       plan_.SetIrProgram("job_" + std::to_string(job_idx), shared_program);
 
-      if (FLAGS_pir_apply_inplace_pass) {
+      if (FLAGS_pir_apply_inplace_pass ||
+          FLAGS_pir_apply_memory_planning_pass) {
         pir::PassManager pm(pir::IrContext::Instance(), 3);
-        pm.AddPass(pir::CreateInplacePass());
+        if (FLAGS_pir_apply_inplace_pass) {
+          pm.AddPass(pir::CreateInplacePass());
+        }
+        if (FLAGS_pir_apply_memory_planning_pass) {
+          pm.AddPass(pir::CreateMemoryPlanningPass());
+        }
         pm.Run(shared_program.get());
       }
 
@@ -17,6 +17,7 @@
 #include "paddle/fluid/framework/new_executor/workqueue/event_count.h"
 #include "paddle/fluid/framework/new_executor/workqueue/run_queue.h"
 #include "paddle/fluid/framework/new_executor/workqueue/thread_environment.h"
+#include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 #include "paddle/phi/core/os_info.h"
 
@@ -33,10 +34,12 @@ class ThreadPoolTempl {
                   int num_threads,
                   bool allow_spinning,
                   bool always_spinning,
+                  bool numa_aware = false,
                   Environment env = Environment())
       : env_(env),
         allow_spinning_(allow_spinning),
         always_spinning_(always_spinning),
+        numa_aware_(numa_aware),
         global_steal_partition_(EncodePartition(0, num_threads)),
         blocked_(0),
         done_(false),
@@ -60,6 +63,11 @@ class ThreadPoolTempl {
     }
     for (int i = 0; i < num_threads_; i++) {
       SetStealPartition(i, EncodePartition(0, num_threads_));
+    }
+    if (numa_aware_) {
+      AssignNumaPartitions();
+    }
+    for (int i = 0; i < num_threads_; i++) {
       thread_data_[i].thread.reset(
           env_.CreateThread([this, i]() { WorkerLoop(i); }));
     }
@@ -226,15 +234,18 @@ class ThreadPoolTempl {
   };
 
   struct ThreadData {
-    constexpr ThreadData() : thread(), steal_partition(0), queue() {}
+    ThreadData() : thread(), steal_partition(0), queue() {}
     std::unique_ptr<Thread> thread;
     std::atomic<unsigned> steal_partition;
     Queue queue;
+    // Cpus the worker is pinned to, empty if the worker is not pinned.
+    std::vector<int> cpus;
   };
 
   Environment env_;
   const bool allow_spinning_;
   const bool always_spinning_;
+  const bool numa_aware_;
   std::vector<std::vector<unsigned>> all_coprimes_;
   unsigned global_steal_partition_;
   std::atomic<unsigned> blocked_;
@@ -250,6 +261,10 @@ class ThreadPoolTempl {
     std::string thr_name = name_ + "_thread_" + std::to_string(thread_id);
     VLOG(1) << thr_name << " started ";
     phi::SetCurrentThreadName(thr_name);
+    if (!thread_data_[thread_id].cpus.empty() &&
+        !BindCurrentThreadToCpus(thread_data_[thread_id].cpus)) {
+      VLOG(1) << thr_name << " failed to bind to its NUMA node";
+    }
     PerThread* pt = GetPerThread();
     pt->pool = this;
     pt->rand = GlobalThreadIdHash();
@@ -317,6 +332,44 @@ class ThreadPoolTempl {
     }
   }
 
+  // Splits the workers into contiguous groups, one per NUMA node, in
+  // proportion to the number of cpus on each node. Each worker is pinned to
+  // the cpus of its node and steals from its own group first (LocalSteal)
+  // before falling back to the whole pool (GlobalSteal), which keeps
+  // follow-on tasks and the data they touch on the same socket.
+  void AssignNumaPartitions() {
+    std::vector<std::vector<int>> nodes = GetNumaNodeCpus();
+    if (nodes.size() <= 1) {
+      // Single node, stealing and placement are already local.
+      return;
+    }
+    size_t total_cpus = 0;
+    for (const auto& cpus : nodes) {
+      total_cpus += cpus.size();
+    }
+    std::vector<std::pair<unsigned, unsigned>> partitions(num_threads_);
+    unsigned start = 0;
+    size_t seen_cpus = 0;
+    for (size_t node = 0; node < nodes.size(); ++node) {
+      seen_cpus += nodes[node].size();
+      unsigned limit =
+          node + 1 == nodes.size()
+              ? num_threads_
+              : static_cast<unsigned>(seen_cpus * num_threads_ / total_cpus);
+      if (limit <= start) {
+        continue;
+      }
+      for (unsigned i = start; i < limit; ++i) {
+        partitions[i] = std::make_pair(start, limit);
+        thread_data_[i].cpus = nodes[node];
+      }
+      VLOG(1) << name_ << " binds threads [" << start << ", " << limit
+              << ") to NUMA node " << node;
+      start = limit;
+    }
+    SetStealPartitions(partitions);
+  }
+
   // Steal tries to steal work from other worker threads in the range [start,
   // limit) in best-effort manner.
   Task Steal(unsigned start, unsigned limit) {
@@ -50,7 +50,8 @@ class WorkQueueImpl : public WorkQueue {
     queue_ = new NonblockingThreadPool(options_.name,
                                        static_cast<int>(options_.num_threads),
                                        options_.allow_spinning,
-                                       options_.always_spinning);
+                                       options_.always_spinning,
+                                       options_.numa_aware);
   }
 
   ~WorkQueueImpl() override {
@@ -142,7 +143,8 @@ WorkQueueGroupImpl::WorkQueueGroupImpl(
         NonblockingThreadPool(options.name,
                               static_cast<int>(options.num_threads),
                               options.allow_spinning,
-                              options.always_spinning);
+                              options.always_spinning,
+                              options.numa_aware);
   }
 }
 
@@ -102,6 +102,9 @@ struct WorkQueueOptions {
   // false and set events_waiter.
   bool detached{true};
   EventsWaiter* events_waiter{nullptr};  // not owned
+  // Pin worker threads to NUMA nodes and steal work inside the node first.
+  // Only takes effect on Linux machines with more than one NUMA node.
+  bool numa_aware{false};
 };
 
 class WorkQueue {
@@ -16,6 +16,14 @@
 
 #include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace paddle::framework {
 
@@ -55,4 +63,79 @@ void AlignedFree(void* mem_ptr) {
 #endif
 }
 
+namespace {
+
+// Parses a sysfs cpulist string such as "0-3,8-11,16".
+std::vector<int> ParseCpuList(const std::string& cpulist) {
+  std::vector<int> cpus;
+  std::stringstream ss(cpulist);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    size_t dash = range.find('-');
+    int first = std::atoi(range.substr(0, dash).c_str());
+    int last = dash == std::string::npos
+                   ? first
+                   : std::atoi(range.substr(dash + 1).c_str());
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+}  // namespace
+
+std::vector<std::vector<int>> GetNumaNodeCpus() {
+  std::vector<std::vector<int>> nodes;
+#if defined(__linux__)
+  // Node ids may be sparse, stop after a run of missing nodes.
+  constexpr int kMaxMissingNodes = 8;
+  for (int node = 0, missing = 0; missing < kMaxMissingNodes; ++node) {
+    std::ifstream fin("/sys/devices/system/node/node" + std::to_string(node) +
+                      "/cpulist");
+    if (!fin.is_open()) {
+      ++missing;
+      continue;
+    }
+    missing = 0;
+    std::string cpulist;
+    std::getline(fin, cpulist);
+    std::vector<int> cpus = ParseCpuList(cpulist);
+    if (!cpus.empty()) {
+      nodes.emplace_back(std::move(cpus));
+    }
+  }
+#endif
+  if (nodes.empty()) {
+    std::vector<int> cpus;
+    int num_cpus = static_cast<int>(std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      cpus.push_back(cpu);
+    }
+    nodes.emplace_back(std::move(cpus));
+  }
+  return nodes;
+}
+
+bool BindCurrentThreadToCpus(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  if (cpus.empty()) {
+    return false;
+  }
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &mask);
+    }
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#else
+  return false;
+#endif
+}
+
 }  // namespace paddle::framework
@@ -21,6 +21,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/framework/new_executor/workqueue/events_waiter.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -69,6 +70,15 @@ void* AlignedMalloc(size_t size, size_t alignment);
 
 void AlignedFree(void* memory_ptr);
 
+// Returns the cpu ids of each NUMA node, indexed by node id. Nodes without
+// any online cpu are skipped. If the topology is unavailable (non-Linux
+// system or no sysfs), all online cpus are reported as a single node.
+std::vector<std::vector<int>> GetNumaNodeCpus();
+
+// Binds the calling thread to the given cpus. Returns false if the binding
+// is not supported or failed, in which case the thread is left unbound.
+bool BindCurrentThreadToCpus(const std::vector<int>& cpus);
+
 template <typename Notifier>
 class TaskTracker {
  public:
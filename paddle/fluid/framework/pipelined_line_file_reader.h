@@ -0,0 +1,232 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/common/enforce.h"
+#include "paddle/fluid/framework/channel.h"
+#include "paddle/phi/core/platform/timer.h"
+
+namespace paddle {
+namespace framework {
+
+// Reads a file in blocks on the calling thread and parses chunks of whole
+// lines on parse threads, so that reading, parsing and writing the records to
+// the channel overlap. The chunk queue is bounded: when the consumers of the
+// input channel fall behind, the parse threads block on it and the reader
+// blocks on the chunk queue in turn.
+class PipelinedLineFileReader {
+  static const int CHUNK_QUEUE_SIZE_PER_THREAD = 2;
+
+ public:
+  static const size_t DEFAULT_BLOCK_SIZE = 4 * 1024 * 1024;
+
+  // Parses one line on the parse thread thread_id, returns false on bad lines.
+  typedef std::function<bool(int thread_id, const std::string&)> LineFunc;
+
+  explicit PipelinedLineFileReader(int thread_num,
+                                   size_t block_size = DEFAULT_BLOCK_SIZE)
+      : thread_num_(thread_num), block_size_(block_size) {
+    PADDLE_ENFORCE_GT(
+        thread_num,
+        0,
+        common::errors::InvalidArgument(
+            "The parse thread num should be greater than 0, but got %d.",
+            thread_num));
+    PADDLE_ENFORCE_GT(block_size,
+                      0UL,
+                      common::errors::InvalidArgument(
+                          "The block size should be greater than 0."));
+    buff_ = reinterpret_cast<char*>(
+        calloc(block_size_ + 1, sizeof(char)));  // NOLINT
+  }
+  ~PipelinedLineFileReader() { free(buff_); }  // NOLINT
+
+  // Reads fp to the end and parses all lines but the first skip_lines ones,
+  // returns the number of lines read, including the skipped ones.
+  int read_file(FILE* fp, LineFunc func, int skip_lines) {
+    auto chunks =
+        MakeChannel<std::string>(thread_num_ * CHUNK_QUEUE_SIZE_PER_THREAD);
+    error_line_ = 0;
+    std::vector<uint64_t> parse_lines(thread_num_, 0);
+    std::vector<double> parse_sec(thread_num_, 0);
+    std::vector<std::exception_ptr> errors(thread_num_);
+    std::vector<std::thread> parsers;
+    for (int tid = 0; tid < thread_num_; ++tid) {
+      parsers.emplace_back([&, tid] {
+        SampleFunc spfunc = get_sample_func();
+        platform::Timer timeline;
+        std::string chunk;
+        std::string line;
+        while (chunks->Get(chunk)) {
+          if (errors[tid]) {
+            continue;  // drain the queue so that the reader does not block
+          }
+          timeline.Resume();
+          try {
+            const char* ptr = chunk.data();
+            const char* end = ptr + chunk.size();
+            while (ptr < end) {
+              const char* eol = reinterpret_cast<const char*>(
+                  memchr(ptr, '\n', end - ptr));
+              if (eol == nullptr) {
+                eol = end;
+              }
+              if (spfunc()) {
+                line.assign(ptr, eol - ptr);
+                ++parse_lines[tid];
+                if (!func(tid, line)) {
+                  ++error_line_;
+                }
+              }
+              ptr = eol + 1;
+            }
+          } catch (...) {
+            errors[tid] = std::current_exception();
+            error_line_ = MAX_ERROR_LINES + 1;
+          }
+          timeline.Pause();
+        }
+        parse_sec[tid] = timeline.ElapsedSec();
+      });
+    }
+
+    platform::Timer read_timeline;
+    platform::Timer blocked_timeline;
+    platform::Timer total_timeline;
+    total_timeline.Start();
+    int lines = 0;
+    total_len_ = 0;
+    auto dispatch = [&](std::string* chunk) {
+      const char* begin = chunk->data();
+      const char* end = begin + chunk->size();
+      int chunk_lines = static_cast<int>(std::count(begin, end, '\n'));
+      // The previous tries have parsed the lines before skip_lines.
+      for (; lines < skip_lines && begin < end; ++lines, --chunk_lines) {
+        begin = reinterpret_cast<const char*>(memchr(begin, '\n', end - begin));
+        ++begin;
+      }
+      lines += chunk_lines;
+      if (begin == end) {
+        return;
+      }
+      chunk->erase(0, begin - chunk->data());
+      blocked_timeline.Resume();
+      chunks->Put(std::move(*chunk));
+      blocked_timeline.Pause();
+    };
+    std::string remain;
+    size_t ret = 0;
+    while (!is_error()) {
+      read_timeline.Resume();
+      ret = fread(buff_, sizeof(char), block_size_, fp);
+      read_timeline.Pause();
+      if (ret == 0) {
+        break;
+      }
+      total_len_ += ret;
+      // The bytes after the last '\n' of the block wait for the next block.
+      char* tail = buff_ + ret;
+      while (tail != buff_ && tail[-1] != '\n') {
+        --tail;
+      }
+      if (tail == buff_) {
+        remain.append(buff_, ret);
+        continue;
+      }
+      std::string chunk;
+      chunk.swap(remain);
+      chunk.append(buff_, tail - buff_);
+      remain.assign(tail, buff_ + ret - tail);
+      dispatch(&chunk);
+    }
+    if (!is_error() && !remain.empty()) {
+      remain.push_back('\n');
+      dispatch(&remain);
+    }
+    chunks->Close();
+    for (auto& parser : parsers) {
+      parser.join();
+    }
+    total_timeline.Pause();
+    for (auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+
+    uint64_t total_parse_lines = 0;
+    double avg_parse_sec = 0;
+    for (int tid = 0; tid < thread_num_; ++tid) {
+      total_parse_lines += parse_lines[tid];
+      avg_parse_sec += parse_sec[tid] / thread_num_;
+    }
+    double mb = total_len_ / 1024.0 / 1024.0;
+    VLOG(1) << "PipelinedLineFileReader read " << mb << "MB in "
+            << total_timeline.ElapsedSec() << "s, read stage "
+            << mb / std::max(read_timeline.ElapsedSec(), 1e-6)
+            << "MB/s, blocked on parse " << blocked_timeline.ElapsedSec()
+            << "s; parse stage " << thread_num_ << " threads, "
+            << total_parse_lines << " records, "
+            << mb / std::max(avg_parse_sec, 1e-6) << "MB/s, "
+            << total_parse_lines / std::max(avg_parse_sec, 1e-6)
+            << " records/s";
+    return lines;
+  }
+  uint64_t file_size() { return total_len_; }
+  void set_sample_rate(float r) { sample_rate_ = r; }
+  bool is_error() { return (error_line_ > MAX_ERROR_LINES); }
+
+ private:
+  typedef std::function<bool()> SampleFunc;
+  static const size_t MAX_ERROR_LINES = 10;
+
+  SampleFunc get_sample_func() {
+    if (std::abs(sample_rate_ - 1.0f) < 1e-5f) {
+      return []() { return true; };
+    }
+    auto random_engine =
+        std::make_shared<std::default_random_engine>(std::random_device()());
+    return [this, random_engine]() {
+      return std::uniform_real_distribution<float>(0.0f, 1.0f)(
+                 *random_engine) < sample_rate_;
+    };
+  }
+
+ private:
+  int thread_num_;
+  size_t block_size_;
+  char* buff_ = nullptr;
+  uint64_t total_len_ = 0;
+  float sample_rate_ = 1.0f;
+  std::atomic<size_t> error_line_{0};
+};
+
+}  // namespace framework
+}  // namespace paddle
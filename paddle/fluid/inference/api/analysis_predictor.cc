@@ -29,6 +29,7 @@
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/feed_hook.h"
+#include "paddle/fluid/framework/io/mapped_params.h"
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/naive_executor.h"
@@ -119,6 +120,7 @@
 #include "paddle/fluid/pir/transforms/general/constant_folding_pass.h"
 #include "paddle/fluid/pir/transforms/general/dead_code_elimination_pass.h"
 #include "paddle/fluid/pir/transforms/general/inplace_pass.h"
+#include "paddle/fluid/pir/transforms/general/memory_planning_pass.h"
 #include "paddle/fluid/pir/transforms/general/params_sync_among_devices_pass.h"
 #include "paddle/fluid/pir/transforms/general/remove_shadow_feed_pass.h"
 #include "paddle/fluid/pir/transforms/general/replace_fetch_with_shadow_output_pass.h"
@@ -134,7 +136,9 @@
 #include "paddle/pir/include/pass/pass_registry.h"
 
 COMMON_DECLARE_bool(pir_apply_inplace_pass);
+COMMON_DECLARE_bool(pir_apply_memory_planning_pass);
 COMMON_DECLARE_bool(enable_pir_api);
+COMMON_DECLARE_bool(new_executor_build_cache);
 
 namespace paddle {
 namespace {
@@ -1029,6 +1033,9 @@ void AnalysisPredictor::OptimizeInferencePirProgram() {
   if (FLAGS_pir_apply_inplace_pass) {
     lowered_pm.AddPass(::pir::CreateInplacePass());
   }
+  if (FLAGS_pir_apply_memory_planning_pass) {
+    lowered_pm.AddPass(::pir::CreateMemoryPlanningPass());
+  }
   if (!config_.glog_info_disabled()) {
     lowered_pm.EnablePrintStatistics();
   }
@@ -1293,6 +1300,11 @@ bool AnalysisPredictor::PrepareExecutor() {
     execution_config.skip_gc_vars.insert(output_names.begin(),
                                          output_names.end());
 
+    if (FLAGS_new_executor_build_cache) {
+      // Save the build results next to the (optimized) model.
+      execution_config.build_cache_dir = GetOptimizedModelPath();
+    }
+
     if (config_.new_ir_enabled()) {
       executor_->PrepareInterpreterCore(
           sub_scope_, *pir_program_, execution_config);
@@ -3774,6 +3786,11 @@ void ConvertToMixedPrecision(const std::string &model_file,
                                                        white_list);
 }
 
+void ConvertToMappedParams(const std::string &params_file,
+                           const std::string &mapped_params_file) {
+  paddle::framework::ConvertToMappedParams(params_file, mapped_params_file);
+}
+
 }  // namespace paddle_infer
 
 namespace paddle_infer {
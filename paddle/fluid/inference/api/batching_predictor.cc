@@ -0,0 +1,450 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/enforce.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle_infer {
+namespace services {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Bucket i holds the latencies in [2^(i-1), 2^i) us, the last one is open.
+constexpr size_t kNumLatencyBuckets = 32;
+
+size_t LatencyBucket(Clock::duration latency) {
+  auto us =
+      std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+  size_t bucket = 0;
+  while (us > 0 && bucket + 1 < kNumLatencyBuckets) {
+    us >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+// Calls visitor with a value of the C++ type of dtype, returns false for the
+// types Tensor can not copy.
+template <typename Visitor>
+bool VisitDataType(DataType dtype, Visitor &&visitor) {
+  switch (dtype) {
+    case DataType::FLOAT32:
+      visitor(float());
+      return true;
+    case DataType::FLOAT64:
+      visitor(double());
+      return true;
+    case DataType::INT64:
+      visitor(int64_t());
+      return true;
+    case DataType::INT32:
+      visitor(int32_t());
+      return true;
+    case DataType::UINT8:
+      visitor(uint8_t());
+      return true;
+    case DataType::INT8:
+      visitor(int8_t());
+      return true;
+    case DataType::BOOL:
+      visitor(bool());
+      return true;
+    case DataType::FLOAT16:
+      visitor(phi::dtype::float16());
+      return true;
+    case DataType::BFLOAT16:
+      visitor(phi::dtype::bfloat16());
+      return true;
+    default:
+      return false;
+  }
+}
+
+size_t SizeOfDataType(DataType dtype) {
+  size_t size = 0;
+  VisitDataType(dtype, [&size](auto value) { size = sizeof(value); });
+  return size;
+}
+
+int64_t NumelOf(const std::vector<int> &shape) {
+  int64_t numel = 1;
+  for (int dim : shape) {
+    numel *= dim;
+  }
+  return numel;
+}
+
+}  // namespace
+
+struct BatchingPredictor::Impl {
+  struct Request {
+    const std::vector<PaddleTensor> *inputs;
+    std::vector<PaddleTensor> *outputs;
+    // Requests are only merged when their signatures (input names, data
+    // types and non-batch dimensions) are equal.
+    std::string signature;
+    int rows;
+    Clock::time_point enqueue_time;
+    std::promise<bool> done;
+  };
+  using RequestPtr = std::shared_ptr<Request>;
+
+  Impl(const Config &config, const BatchingConfig &batching_config);
+  ~Impl();
+
+  bool Run(const std::vector<PaddleTensor> &inputs,
+           std::vector<PaddleTensor> *outputs);
+  BatchingStats GetStats() const;
+
+ private:
+  void WorkerLoop(Predictor *predictor);
+  // Waits for the next batch, returns false when the predictor is stopping
+  // and no request is left.
+  bool NextBatch(std::vector<RequestPtr> *batch);
+  // Takes the requests compatible with the front one up to max_batch_size
+  // rows. Requires mutex_.
+  void TakeBatch(std::vector<RequestPtr> *batch);
+  int CompatibleRows() const;
+  bool RunBatch(Predictor *predictor, const std::vector<RequestPtr> &batch);
+
+  BatchingConfig batching_config_;
+  std::unique_ptr<Predictor> main_pred_;
+  std::vector<std::unique_ptr<Predictor>> preds_;
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<RequestPtr> queue_;
+  bool stop_{false};
+
+  mutable std::mutex stats_mutex_;
+  BatchingStats stats_;
+};
+
+BatchingPredictor::Impl::Impl(const Config &config,
+                              const BatchingConfig &batching_config)
+    : batching_config_(batching_config) {
+  PADDLE_ENFORCE_GE(batching_config.max_batch_size,
+                    1,
+                    common::errors::InvalidArgument(
+                        "The max_batch_size of BatchingConfig should be "
+                        "greater than 0, but it's (%d)",
+                        batching_config.max_batch_size));
+  PADDLE_ENFORCE_GE(batching_config.max_wait_us,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The max_wait_us of BatchingConfig should not be "
+                        "negative, but it's (%d)",
+                        batching_config.max_wait_us));
+  PADDLE_ENFORCE_GE(batching_config.num_workers,
+                    1,
+                    common::errors::InvalidArgument(
+                        "The num_workers of BatchingConfig should be greater "
+                        "than 0, but it's (%d)",
+                        batching_config.num_workers));
+  stats_.queue_latency_us_hist.resize(kNumLatencyBuckets, 0);
+  stats_.exec_latency_us_hist.resize(kNumLatencyBuckets, 0);
+
+  main_pred_ = std::make_unique<Predictor>(config);
+  for (int i = 1; i < batching_config.num_workers; ++i) {
+    if (config.tensorrt_engine_enabled()) {
+      Config config_tmp(config);
+      preds_.emplace_back(new Predictor(config_tmp));
+    } else {
+      preds_.emplace_back(main_pred_->Clone());
+    }
+  }
+  workers_.emplace_back(&Impl::WorkerLoop, this, main_pred_.get());
+  for (auto &pred : preds_) {
+    workers_.emplace_back(&Impl::WorkerLoop, this, pred.get());
+  }
+}
+
+BatchingPredictor::Impl::~Impl() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+bool BatchingPredictor::Impl::Run(const std::vector<PaddleTensor> &inputs,
+                                  std::vector<PaddleTensor> *outputs) {
+  if (inputs.empty() || outputs == nullptr) {
+    LOG(ERROR) << "BatchingPredictor::Run needs inputs and outputs.";
+    return false;
+  }
+  auto request = std::make_shared<Request>();
+  request->inputs = &inputs;
+  request->outputs = outputs;
+  request->rows = -1;
+  for (auto &input : inputs) {
+    if (!input.lod.empty() || input.shape.empty()) {
+      LOG(ERROR) << "BatchingPredictor input " << input.name
+                 << " should be a dense tensor with a batch dimension.";
+      return false;
+    }
+    if (SizeOfDataType(input.dtype) == 0) {
+      LOG(ERROR) << "BatchingPredictor input " << input.name
+                 << " has an unsupported data type.";
+      return false;
+    }
+    if (input.data.length() <
+        NumelOf(input.shape) * SizeOfDataType(input.dtype)) {
+      LOG(ERROR) << "BatchingPredictor input " << input.name
+                 << " has less data than its shape.";
+      return false;
+    }
+    if (request->rows >= 0 && input.shape[0] != request->rows) {
+      LOG(ERROR) << "BatchingPredictor inputs should have the same batch "
+                    "size, but input "
+                 << input.name << " has " << input.shape[0] << " instead of "
+                 << request->rows;
+      return false;
+    }
+    request->rows = input.shape[0];
+    request->signature += input.name;
+    request->signature += ':' + std::to_string(static_cast<int>(input.dtype));
+    for (size_t i = 1; i < input.shape.size(); ++i) {
+      request->signature += ',' + std::to_string(input.shape[i]);
+    }
+    request->signature += ';';
+  }
+
+  auto done = request->done.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stop_) {
+      return false;
+    }
+    request->enqueue_time = Clock::now();
+    queue_.emplace_back(std::move(request));
+  }
+  cv_.notify_all();
+  return done.get();
+}
+
+int BatchingPredictor::Impl::CompatibleRows() const {
+  const auto &signature = queue_.front()->signature;
+  int rows = 0;
+  for (auto &request : queue_) {
+    if (request->signature == signature) {
+      rows += request->rows;
+      if (rows >= batching_config_.max_batch_size) {
+        break;
+      }
+    }
+  }
+  return rows;
+}
+
+void BatchingPredictor::Impl::TakeBatch(std::vector<RequestPtr> *batch) {
+  const std::string signature = queue_.front()->signature;
+  int rows = 0;
+  for (auto it = queue_.begin(); it != queue_.end();) {
+    if ((*it)->signature == signature &&
+        (batch->empty() ||
+         rows + (*it)->rows <= batching_config_.max_batch_size)) {
+      rows += (*it)->rows;
+      batch->emplace_back(std::move(*it));
+      it = queue_.erase(it);
+      if (rows >= batching_config_.max_batch_size) {
+        break;
+      }
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool BatchingPredictor::Impl::NextBatch(std::vector<RequestPtr> *batch) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return false;
+    }
+    auto deadline = queue_.front()->enqueue_time +
+                    std::chrono::microseconds(batching_config_.max_wait_us);
+    if (stop_ || CompatibleRows() >= batching_config_.max_batch_size ||
+        Clock::now() >= deadline) {
+      TakeBatch(batch);
+      // Let another worker start on the rest of the queue.
+      if (!queue_.empty()) {
+        cv_.notify_one();
+      }
+      return true;
+    }
+    // Woken up by new requests, the deadline or another worker taking the
+    // front request, re-check in each case.
+    cv_.wait_until(lock, deadline);
+  }
+}
+
+void BatchingPredictor::Impl::WorkerLoop(Predictor *predictor) {
+  std::vector<RequestPtr> batch;
+  while (NextBatch(&batch)) {
+    bool success = false;
+    try {
+      success = RunBatch(predictor, batch);
+    } catch (std::exception &e) {
+      LOG(ERROR) << "BatchingPredictor failed to run a batch of "
+                 << batch.size() << " requests: " << e.what();
+    }
+    for (auto &request : batch) {
+      request->done.set_value(success);
+    }
+    batch.clear();
+  }
+}
+
+bool BatchingPredictor::Impl::RunBatch(Predictor *predictor,
+                                       const std::vector<RequestPtr> &batch) {
+  auto start = Clock::now();
+  int total_rows = 0;
+  for (auto &request : batch) {
+    total_rows += request->rows;
+  }
+
+  // Feed: concatenate the rows of the requests, a single request is copied
+  // from its own buffer.
+  std::vector<char> buffer;
+  const auto &first_inputs = *batch.front()->inputs;
+  for (size_t i = 0; i < first_inputs.size(); ++i) {
+    const auto &first = first_inputs[i];
+    size_t row_bytes =
+        NumelOf(first.shape) / std::max(first.shape[0], 1) *
+        SizeOfDataType(first.dtype);
+    const void *data = first.data.data();
+    if (batch.size() > 1) {
+      buffer.resize(row_bytes * total_rows);
+      char *dst = buffer.data();
+      for (auto &request : batch) {
+        const auto &input = (*request->inputs)[i];
+        std::memcpy(dst, input.data.data(), row_bytes * input.shape[0]);
+        dst += row_bytes * input.shape[0];
+      }
+      data = buffer.data();
+    }
+    std::vector<int> shape = first.shape;
+    shape[0] = total_rows;
+    auto tensor = predictor->GetInputHandle(first.name);
+    tensor->Reshape(shape);
+    VisitDataType(first.dtype, [&](auto value) {
+      using T = decltype(value);
+      tensor->CopyFromCpu(static_cast<const T *>(data));
+    });
+  }
+
+  if (!predictor->Run()) {
+    return false;
+  }
+
+  // Fetch: split the outputs by rows.
+  for (auto &request : batch) {
+    request->outputs->clear();
+  }
+  for (auto &name : predictor->GetOutputNames()) {
+    auto tensor = predictor->GetOutputHandle(name);
+    std::vector<int> shape = tensor->shape();
+    DataType dtype = tensor->type();
+    size_t bytes = NumelOf(shape) * SizeOfDataType(dtype);
+    buffer.resize(bytes);
+    bool supported = VisitDataType(dtype, [&](auto value) {
+      using T = decltype(value);
+      tensor->CopyToCpu(reinterpret_cast<T *>(buffer.data()));
+    });
+    PADDLE_ENFORCE_EQ(supported,
+                      true,
+                      common::errors::Unimplemented(
+                          "The data type of output %s is not supported by "
+                          "BatchingPredictor.",
+                          name));
+    bool split = !shape.empty() && shape[0] == total_rows && batch.size() > 1;
+    size_t row_bytes = split ? bytes / total_rows : 0;
+    const char *src = buffer.data();
+    for (auto &request : batch) {
+      PaddleTensor output;
+      output.name = name;
+      output.dtype = dtype;
+      output.shape = shape;
+      size_t length = bytes;
+      if (split) {
+        output.shape[0] = request->rows;
+        length = row_bytes * request->rows;
+      }
+      output.data.Resize(length);
+      std::memcpy(output.data.data(), src, length);
+      if (split) {
+        src += length;
+      }
+      request->outputs->emplace_back(std::move(output));
+    }
+  }
+
+  auto end = Clock::now();
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  stats_.num_requests += batch.size();
+  stats_.num_batches += 1;
+  for (auto &request : batch) {
+    stats_.queue_latency_us_hist[LatencyBucket(start -
+                                               request->enqueue_time)] += 1;
+  }
+  stats_.exec_latency_us_hist[LatencyBucket(end - start)] += 1;
+  return true;
+}
+
+BatchingStats BatchingPredictor::Impl::GetStats() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return stats_;
+}
+
+BatchingPredictor::BatchingPredictor(const Config &config,
+                                     const BatchingConfig &batching_config)
+    : impl_(new Impl(config, batching_config)) {}
+
+BatchingPredictor::~BatchingPredictor() = default;
+
+bool BatchingPredictor::Run(const std::vector<PaddleTensor> &inputs,
+                            std::vector<PaddleTensor> *outputs) {
+  return impl_->Run(inputs, outputs);
+}
+
+BatchingStats BatchingPredictor::GetStats() const { return impl_->GetStats(); }
+
+}  // namespace services
+}  // namespace paddle_infer
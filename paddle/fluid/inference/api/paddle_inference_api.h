@@ -248,6 +248,19 @@ PD_INFER_DECL void ConvertToMixedPrecision(
     std::unordered_set<std::string> black_list = {},
     std::unordered_set<std::string> white_list = {});
 
+///
+/// \brief Convert a combined params file to the memory-mapped format. A model
+/// whose params file is converted loads its weights on CPU by mapping the
+/// file instead of copying it, so predictors in different processes share
+/// the weights through the page cache. The converted file is detected
+/// automatically when loading, no config change is needed.
+///
+/// \param[in] params_file the combined params file of the model
+/// \param[in] mapped_params_file the path to write the converted file to
+///
+PD_INFER_DECL void ConvertToMappedParams(const std::string& params_file,
+                                         const std::string& mapped_params_file);
+
 namespace services {
 ///
 /// \class PredictorPool
@@ -273,6 +286,72 @@ class PD_INFER_DECL PredictorPool {
   std::shared_ptr<Predictor> main_pred_;
   std::vector<std::unique_ptr<Predictor>> preds_;
 };
+
+///
+/// \brief Options of the BatchingPredictor.
+///
+struct PD_INFER_DECL BatchingConfig {
+  /// The max number of rows (summed over the batch dimension of the
+  /// requests) merged into one run.
+  int max_batch_size{8};
+  /// The max time in microseconds a request waits for others to join its
+  /// batch.
+  int64_t max_wait_us{1000};
+  /// The number of predictors running batches concurrently.
+  int num_workers{1};
+};
+
+///
+/// \brief Latency statistics of the BatchingPredictor. Bucket i of the
+/// histograms counts the latencies in [2^(i-1), 2^i) microseconds, bucket 0
+/// the ones below 1us.
+///
+struct PD_INFER_DECL BatchingStats {
+  uint64_t num_requests{0};
+  uint64_t num_batches{0};
+  /// Time from the submission of a request to the start of its batch.
+  std::vector<uint64_t> queue_latency_us_hist;
+  /// Time to feed, run and fetch one batch.
+  std::vector<uint64_t> exec_latency_us_hist;
+};
+
+///
+/// \class BatchingPredictor
+///
+/// \brief BatchingPredictor is a dynamic batching front-end of Predictor for
+/// serving. Concurrent requests with the same input names, data types and
+/// non-batch dimensions are merged along the batch dimension (dim 0) up to
+/// max_batch_size rows or until the oldest one has waited max_wait_us, run
+/// once, and the outputs are split back by rows. Outputs whose first
+/// dimension is not the batch size are returned to every request as a whole.
+///
+class PD_INFER_DECL BatchingPredictor {
+ public:
+  BatchingPredictor() = delete;
+  BatchingPredictor(const BatchingPredictor&) = delete;
+  BatchingPredictor& operator=(const BatchingPredictor&) = delete;
+
+  explicit BatchingPredictor(const Config& config,
+                             const BatchingConfig& batching_config = {});
+  ~BatchingPredictor();
+
+  ///
+  /// \brief Run one request, blocks until its batch is done. Thread safe.
+  ///
+  /// \param[in] inputs the input tensors, without LoD
+  /// \param[out] outputs the output tensors of this request
+  /// \return Whether the run is successful
+  ///
+  bool Run(const std::vector<PaddleTensor>& inputs,
+           std::vector<PaddleTensor>* outputs);
+
+  /// \brief Get the latency statistics since the construction.
+  BatchingStats GetStats() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
 }  // namespace services
 
 }  // namespace paddle_infer
@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/io/mapped_params.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/string_array.h"
 #include "paddle/fluid/framework/tensor_util.h"
@@ -44,7 +45,9 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                           "The number of variables to be loaded is %d, expect "
                           "it to be greater than 0.",
                           out_var_names.size()));
-    if (!model_from_memory) {
+    if (!model_from_memory && framework::IsMappedParamsFile(filename)) {
+      LoadMappedParams(ctx, place, filename, load_as_fp16);
+    } else if (!model_from_memory) {
       std::ifstream fin(filename, std::ios::binary);
       PADDLE_ENFORCE_EQ(
           static_cast<bool>(fin),
@@ -115,28 +118,7 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
 
         // Get data from fin to tensor
         paddle::framework::DeserializeFromStream(*buffer, tensor, dev_ctx);
-
-        auto in_dtype = tensor->dtype();
-        auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
-
-        if (in_dtype != out_dtype) {
-          // convert to float16 tensor
-          auto in_kernel_type =
-              phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, in_dtype);
-          auto out_kernel_type =
-              phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, out_dtype);
-          phi::DenseTensor fp16_tensor;
-          // copy LoD info to the new tensor
-          fp16_tensor.set_lod(tensor->lod());
-          framework::TransDataType(
-              in_kernel_type, out_kernel_type, *tensor, &fp16_tensor);
-
-          // reset output tensor
-          out_vars[i]->Clear();
-          tensor = out_vars[i]->GetMutable<phi::DenseTensor>();
-          tensor->set_lod(fp16_tensor.lod());
-          tensor->ShareDataWith(fp16_tensor);
-        }
+        CastToFP16(place, load_as_fp16, out_vars[i]);
       }
     }
     buffer->peek();
@@ -146,6 +128,61 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                           "Not allowed to load partial data via "
                           "load_combine_op, please use load_op instead."));
   }
+
+  // Loads a mapped params file, the tensors share the mapped file on CPU.
+  void LoadMappedParams(const framework::ExecutionContext &context,
+                        const phi::Place &place,
+                        const std::string &filename,
+                        bool load_as_fp16) const {
+    auto out_var_names = context.OutputNames("Out");
+    auto out_vars = context.MultiOutputVar("Out");
+    std::vector<phi::DenseTensor *> tensors;
+    for (size_t i = 0; i < out_vars.size(); i++) {
+      PADDLE_ENFORCE_NOT_NULL(
+          out_vars[i],
+          common::errors::InvalidArgument(
+              "The variable %s to be loaded cannot be found.",
+              out_var_names[i]));
+      PADDLE_ENFORCE_EQ(out_vars[i]->IsType<framework::Vocab>(),
+                        false,
+                        common::errors::Unimplemented(
+                            "Mapped params file %s can not hold the vocab %s.",
+                            filename,
+                            out_var_names[i]));
+      tensors.push_back(out_vars[i]->GetMutable<phi::DenseTensor>());
+    }
+    framework::LoadMappedParams(filename, tensors, place);
+    for (auto *out_var : out_vars) {
+      CastToFP16(place, load_as_fp16, out_var);
+    }
+  }
+
+  void CastToFP16(const phi::Place &place,
+                  bool load_as_fp16,
+                  framework::Variable *out_var) const {
+    auto *tensor = out_var->GetMutable<phi::DenseTensor>();
+    auto in_dtype = tensor->dtype();
+    auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
+
+    if (in_dtype != out_dtype) {
+      // convert to float16 tensor
+      auto in_kernel_type =
+          phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, in_dtype);
+      auto out_kernel_type =
+          phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, out_dtype);
+      phi::DenseTensor fp16_tensor;
+      // copy LoD info to the new tensor
+      fp16_tensor.set_lod(tensor->lod());
+      framework::TransDataType(
+          in_kernel_type, out_kernel_type, *tensor, &fp16_tensor);
+
+      // reset output tensor
+      out_var->Clear();
+      tensor = out_var->GetMutable<phi::DenseTensor>();
+      tensor->set_lod(fp16_tensor.lod());
+      tensor->ShareDataWith(fp16_tensor);
+    }
+  }
 };
 
 }  // namespace operators
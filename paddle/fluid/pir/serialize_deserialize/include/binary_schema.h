@@ -0,0 +1,171 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "paddle/common/enforce.h"
+
+namespace pir {
+/**
+ * The binary format encodes the same program as the json format, so the
+ * patches of version_compat apply to it by expanding it back to json. Every
+ * string, type and attribute is stored once in a table and referenced by its
+ * index, and the types and attributes are only parsed when first used.
+ *
+ * IMPORTANT!!!
+ * Bump kBinaryFormatVersion whenever the layout below changes.
+ *
+ *   file       : BinaryHeader, strings, types, attributes, program
+ *   strings    : varint n, n x (varint size, bytes)
+ *   types      : varint n, n x (varint size, cbor of the type json)
+ *   attributes : varint n, n x (varint size, cbor of the attribute json)
+ *   program    : varint n, n x region
+ *
+ *   region     : varint size, varint num_blocks, num_blocks x block
+ *   block      : varint num_args, num_args x type,
+ *                varint num_kwargs, num_kwargs x (string key, type),
+ *                varint num_ops, num_ops x op
+ *   op         : string name, then for PARAMETEROP
+ *                  type, string parameter_name, varint ParameterOpFlag bits,
+ *                  attrs dist_attrs, attrs quant_attrs
+ *                and for the other ops
+ *                  varint num_operands, num_operands x value_ref,
+ *                  varint num_results, num_results x type,
+ *                  attrs, attrs opresult_attrs (only if trainable),
+ *                  varint num_regions, num_regions x region
+ *   attrs      : varint n, n x (string name, attribute)
+ *
+ * string / type / attribute are varint indices into the tables. The values
+ * are numbered as the json format does, results from 1 and block arguments
+ * from -1 in the order they are defined, and a value_ref is the zigzag varint
+ * of (the id of the next value - the id of the operand), 0 for null.
+ */
+
+constexpr char kBinaryMagic[8] = {'P', 'I', 'R', 'B', 'I', 'N', '\0', '\0'};
+constexpr uint32_t kBinaryFormatVersion = 1;
+
+// BinaryHeader::flags
+constexpr uint32_t kBinaryTrainable = 1;
+
+struct BinaryHeader {
+  char magic[8];
+  uint32_t format_version;
+  uint32_t flags;
+  uint64_t pir_version;
+  uint64_t string_table_offset;
+  uint64_t type_table_offset;
+  uint64_t attr_table_offset;
+  uint64_t program_offset;
+};
+
+// The boolean attributes of builtin.parameter, packed into one varint.
+enum ParameterOpFlag : uint64_t {
+  kIsDistributed = 1 << 0,
+  kIsParameter = 1 << 1,
+  kNeedClip = 1 << 2,
+  kPersistable = 1 << 3,
+  kStopGradient = 1 << 4,
+  kTrainable = 1 << 5,
+};
+
+inline uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+class BinaryWriteBuffer {
+ public:
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      data_.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    data_.push_back(static_cast<char>(value));
+  }
+  void WriteBytes(const void* data, size_t size) {
+    data_.append(static_cast<const char*>(data), size);
+  }
+  void WriteString(std::string_view str) {
+    WriteVarint(str.size());
+    data_.append(str.data(), str.size());
+  }
+  const std::string& data() const { return data_; }
+  std::string* mutable_data() { return &data_; }
+  size_t size() const { return data_.size(); }
+
+ private:
+  std::string data_;
+};
+
+/** BinaryReadBuffer reads a region of the mapped file with bounds checking,
+ * it does not own the data. */
+class BinaryReadBuffer {
+ public:
+  BinaryReadBuffer() = default;
+  BinaryReadBuffer(const char* data, size_t size) : data_(data), size_(size) {}
+
+  uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      CheckRemaining(1);
+      uint8_t byte = static_cast<uint8_t>(data_[pos_++]);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) return value;
+    }
+    PADDLE_THROW(common::errors::InvalidArgument(
+        "Invalid varint in the binary program at offset %d.", pos_));
+  }
+  std::string_view ReadString() {
+    uint64_t size = ReadVarint();
+    return ReadBytes(size);
+  }
+  std::string_view ReadBytes(uint64_t size) {
+    CheckRemaining(size);
+    std::string_view bytes(data_ + pos_, size);
+    pos_ += size;
+    return bytes;
+  }
+  // Reads a varint size and returns the following bytes as a buffer.
+  BinaryReadBuffer ReadSection() {
+    auto bytes = ReadString();
+    return BinaryReadBuffer(bytes.data(), bytes.size());
+  }
+  bool empty() const { return pos_ == size_; }
+
+ private:
+  void CheckRemaining(uint64_t size) const {
+    PADDLE_ENFORCE_LE(
+        size,
+        size_ - pos_,
+        common::errors::InvalidArgument(
+            "The binary program is truncated, need %d bytes at offset %d "
+            "but only %d left.",
+            size,
+            pos_,
+            size_ - pos_));
+  }
+
+  const char* data_{nullptr};
+  size_t size_{0};
+  size_t pos_{0};
+};
+
+}  // namespace pir
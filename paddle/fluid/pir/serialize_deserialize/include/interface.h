@@ -45,6 +45,31 @@ void IR_API WriteModule(const pir::Program& program,
                         bool readable = false,
                         bool trainable = true);
 
+/**
+ * @brief Write the given PIR program into a file at the specified file path in
+ * the binary format, which is smaller and faster to load than the json one.
+ *
+ * @param[in] program      The PIR program to be written.
+ * @param[in] file_path    The path to the file to be written.
+ * @param[in] pir_version  The version number of PIR, used to identify or verify
+ * the written program version
+ * @param[in] overwrite    If the file already exists, this flag determines
+ * whether to overwrite the existing file.
+ * @param[in] trainable    (Optional parameter, default to true) If true,
+ * operation has opresult_attrs for training like stop_gradient,persistable;
+ * Otherwise, it may only has opinfo attrs.
+ *
+ * @return void。
+ *
+ * @note ReadModule detects the format of the file, so the binary file is read
+ * the same as the json one.
+ */
+void IR_API WriteModuleBinary(const pir::Program& program,
+                              const std::string& file_path,
+                              uint64_t pir_version,
+                              bool overwrite,
+                              bool trainable = true);
+
 /**
  * @brief Gets a PIR program from the specified file path.
  *
@@ -59,7 +84,8 @@ void IR_API WriteModule(const pir::Program& program,
  * funtune.
  *
  * @note If 'pir_version' is larger than the version of file, will trigger
- * version compatibility modification rule.
+ * version compatibility modification rule. Both the json and the binary files
+ * written by WriteModuleBinary are accepted.
  */
 bool IR_API ReadModule(const std::string& file_path,
                        pir::Program* program,
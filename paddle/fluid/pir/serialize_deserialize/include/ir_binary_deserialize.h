@@ -0,0 +1,105 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "paddle/fluid/pir/serialize_deserialize/include/binary_schema.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/ir_deserialize.h"
+#include "paddle/pir/include/core/program.h"
+
+namespace pir {
+/**
+ * BinaryProgramReader is used to deserialize pir program from the binary
+ * format described in binary_schema.h. The data, usually the mapped file,
+ * should outlive the reader, only the indices of the tables are built when
+ * constructed.
+ *
+ * The program is created directly if no patch applies, i.e. the file version
+ * is the current pir version. Otherwise GetProgramJson expands the program to
+ * the json of ProgramWriter, which is recovered by ProgramReader with the
+ * patches.
+ */
+
+class BinaryProgramReader {
+ public:
+  BinaryProgramReader(const char* data, size_t size);
+
+  BinaryProgramReader(BinaryProgramReader&&) = delete;
+  BinaryProgramReader(const BinaryProgramReader&) = delete;
+  BinaryProgramReader& operator=(const BinaryProgramReader&) = delete;
+  BinaryProgramReader& operator=(BinaryProgramReader&&) = delete;
+
+  /** IsBinaryProgram checks the magic number of data. */
+  static bool IsBinaryProgram(const char* data, size_t size);
+
+  uint64_t file_version() const { return header_.pir_version; }
+  bool trainable() const { return header_.flags & kBinaryTrainable; }
+
+  void RecoverProgram(pir::Program* recover_program);
+  Json GetProgramJson();
+
+  ~BinaryProgramReader() = default;
+
+ private:
+  const char* data_;
+  size_t size_;
+  BinaryHeader header_;
+
+  /** json_reader_ parses the types and attributes of the tables. */
+  ProgramReader json_reader_;
+
+  std::vector<std::string_view> strings_;
+  std::vector<std::string_view> type_entries_;
+  std::vector<std::string_view> attr_entries_;
+  /** The types, attributes and op infos are created on the first use. */
+  std::vector<std::optional<pir::Type>> types_;
+  std::vector<std::optional<pir::Attribute>> attrs_;
+  std::vector<std::optional<pir::OpInfo>> op_infos_;
+
+  /** values_ is indexed by id and block_args_ by -id, same as the id of
+   * ProgramWriter. */
+  std::vector<pir::Value> values_;
+  std::vector<pir::Value> block_args_;
+  int64_t value_id_ = 1;
+  int64_t blockarg_id_ = -1;
+  int64_t region_id_ = 0;
+  int64_t block_id_ = 0;
+
+  BinaryReadBuffer Section(uint64_t begin, uint64_t end) const;
+  std::vector<std::string_view> ReadTable(uint64_t begin, uint64_t end) const;
+
+  std::string_view GetString(uint64_t id) const;
+  pir::Type GetType(uint64_t id);
+  pir::Attribute GetAttribute(uint64_t id);
+  pir::OpInfo GetOpInfo(uint64_t name_id);
+  Json GetTypeJson(uint64_t id) const;
+  Json GetAttributeJson(uint64_t id) const;
+  int64_t ReadValueRef(BinaryReadBuffer* buffer) const;
+  pir::Value GetValue(int64_t id) const;
+
+  void ReadRegion(BinaryReadBuffer* buffer, pir::Region* region);
+  void ReadBlock(BinaryReadBuffer* buffer, pir::Block* block);
+  pir::Operation* ReadOp(BinaryReadBuffer* buffer);
+  pir::Operation* ReadParameterOp(BinaryReadBuffer* buffer);
+  void ReadAttributes(BinaryReadBuffer* buffer, pir::AttributeMap* attributes);
+
+  Json ExpandRegion(BinaryReadBuffer* buffer);
+  Json ExpandBlock(BinaryReadBuffer* buffer);
+  Json ExpandOp(BinaryReadBuffer* buffer);
+  Json ExpandParameterOp(BinaryReadBuffer* buffer);
+  Json ExpandAttributes(BinaryReadBuffer* buffer);
+};
+
+}  // namespace pir
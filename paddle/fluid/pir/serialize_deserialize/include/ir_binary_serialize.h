@@ -0,0 +1,78 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/pir/serialize_deserialize/include/binary_schema.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/ir_serialize.h"
+#include "paddle/pir/include/core/program.h"
+
+namespace pir {
+/**
+ * BinaryProgramWriter is used to serialize pir program to the binary format
+ * described in binary_schema.h.
+ *
+ */
+
+class BinaryProgramWriter {
+ public:
+  explicit BinaryProgramWriter(const uint64_t version, const bool trainable)
+      : version_(version), trainable_(trainable), json_writer_(version) {}
+
+  BinaryProgramWriter(BinaryProgramWriter&&) = delete;
+  BinaryProgramWriter(const BinaryProgramWriter&) = delete;
+  BinaryProgramWriter& operator=(const BinaryProgramWriter&) = delete;
+  BinaryProgramWriter& operator=(BinaryProgramWriter&&) = delete;
+
+  /** GetProgramBinary returns the content of the whole file. */
+  std::string GetProgramBinary(const pir::Program* program);
+
+  ~BinaryProgramWriter() = default;
+
+ private:
+  uint64_t version_;
+  bool trainable_;
+
+  /** json_writer_ writes the types and attributes of the tables. */
+  ProgramWriter json_writer_;
+
+  std::unordered_map<std::string, uint64_t> string_ids_;
+  std::vector<std::string> strings_;
+  std::unordered_map<pir::Type, uint64_t> type_ids_;
+  std::vector<std::string> types_;
+  std::unordered_map<pir::Attribute, uint64_t> attr_ids_;
+  std::vector<std::string> attrs_;
+
+  /** value_id_map is numbered the same as ProgramWriter. */
+  std::unordered_map<pir::Value, int64_t> value_id_map_;
+  int64_t value_id_ = 1;
+  int64_t blockarg_id_ = -1;
+
+  uint64_t GetStringId(const std::string& str);
+  uint64_t GetTypeId(const pir::Type& type);
+  uint64_t GetAttributeId(const pir::Attribute& attr);
+
+  void WriteRegion(const pir::Region* region, BinaryWriteBuffer* buffer);
+  void WriteBlock(pir::Block* block, BinaryWriteBuffer* buffer);
+  void WriteOp(const pir::Operation& op, BinaryWriteBuffer* buffer);
+  void WriteParameterOp(const pir::Operation& op, BinaryWriteBuffer* buffer);
+  void WriteValueRef(const pir::Value& value, BinaryWriteBuffer* buffer);
+  void WriteAttributes(
+      const std::vector<std::pair<std::string, pir::Attribute>>& attrs,
+      BinaryWriteBuffer* buffer);
+};
+
+}  // namespace pir
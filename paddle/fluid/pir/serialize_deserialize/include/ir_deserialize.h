@@ -38,6 +38,8 @@ class ProgramReader {
                              pir::Program* recover_program,
                              pir::PatchBuilder* builder);
   pir::Type RecoverType(Json* type_json);
+  /** RecoverAttribute parses the json of the attribute without patches. */
+  pir::Attribute RecoverAttribute(Json* attr_json);
   pir::AttributeMap RecoverOpAttributesMap(Json* attrs_json);
   ~ProgramReader() = default;
 
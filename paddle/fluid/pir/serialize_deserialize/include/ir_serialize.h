@@ -12,10 +12,34 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #pragma once
+#include <string>
+#include <utility>
+#include <vector>
 #include "paddle/fluid/pir/serialize_deserialize/include/third_party.h"
 #include "paddle/pir/include/core/program.h"
 
 namespace pir {
+/** DeleteCfStackOps deletes the cf.stack_create ops of block and their
+ * cf.tuple_push / cf.tuple_pop, which are not saved unless
+ * FLAGS_save_cf_stack_op is set.
+ */
+void DeleteCfStackOps(pir::Block* block);
+
+/** The attributes of op saved in ATTRS, which are the attributes of the op
+ * yaml info and the dist / quant attributes for pd_op, and all but the
+ * opresult attributes for the others. Shared by the json and binary format.
+ */
+std::vector<std::pair<std::string, pir::Attribute>> GetOpinfoAttributes(
+    pir::Operation* op);
+
+/** The attributes of op saved in OPRESULTS_ATTRS. */
+std::vector<std::pair<std::string, pir::Attribute>> GetOpresultAttributes(
+    const AttributeMap& attr_map);
+
+/** Checks that the ParameterOp only has the attributes its compressed format
+ * knows. */
+void CheckParameterOpAttributes(const pir::Operation& op);
+
 /**
  * ProgramWriter is used to serialize pir program to json object.
  *
@@ -35,6 +59,7 @@ class ProgramWriter {
   /** GetProgramJson is used by writeModulde api*/
   Json GetProgramJson(const pir::Program* program);
   Json GetTypeJson(const pir::Type& type);
+  Json GetAttributeJson(const pir::Attribute& attr);
   Json GetAttributesMapJson(const AttributeMap& attr_map);
 
   ~ProgramWriter() = default;
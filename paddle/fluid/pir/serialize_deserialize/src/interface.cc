@@ -14,7 +14,15 @@
 
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
 #include <stdio.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "paddle/common/enforce.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/ir_binary_deserialize.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/ir_binary_serialize.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/ir_deserialize.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/ir_serialize.h"
 #include "paddle/phi/common/port.h"
@@ -26,6 +34,93 @@ namespace pir {
 #define PIRVERSION "version"
 #define TRAINABLE "trainable"
 #define PIR "pir"
+
+namespace {
+
+// The content of a model file, mapped if possible so that the binary program
+// is read in place.
+class ModelFile {
+ public:
+  explicit ModelFile(const std::string& file_path) {
+#ifndef _WIN32
+    int fd = open(file_path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        data_ = static_cast<const char*>(addr);
+        size_ = st.st_size;
+        mapped_ = true;
+      }
+    }
+    if (fd >= 0) close(fd);
+    if (mapped_) return;
+#endif
+    std::ifstream fin(file_path, std::ios::binary);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fin),
+                      true,
+                      common::errors::Unavailable(
+                          "Cannot open %s to load the program.", file_path));
+    buffer_.assign(std::istreambuf_iterator<char>(fin),
+                   std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+  }
+
+  ~ModelFile() {
+#ifndef _WIN32
+    if (mapped_) munmap(const_cast<char*>(data_), size_);
+#endif
+  }
+
+  ModelFile(const ModelFile&) = delete;
+  ModelFile& operator=(const ModelFile&) = delete;
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const char* data_{nullptr};
+  size_t size_{0};
+  bool mapped_{false};
+  std::string buffer_;
+};
+
+void BuildPatch(uint64_t file_version,
+                int64_t pir_version,
+                PatchBuilder* builder) {
+  builder->SetFileVersion(file_version);
+  // Set max_version to the max version number of release pir plus 1.
+  auto max_version = RELEASE_VERSION + 1;
+  // If pir_version_ is not 0, we will build patch from file_version_ to
+  // pir_version_; If pir_version_ is 0, we will first build patch from
+  // file_version_ to max_version, and then add 0.yaml to the end.
+  auto version = pir_version == 0 ? max_version : pir_version;
+  VLOG(6) << "file_version: " << file_version
+          << ", pir_version: " << pir_version << ", final_version: " << version;
+  builder->BuildPatch(version, max_version);
+}
+
+bool ReadModuleBinary(const ModelFile& file,
+                      pir::Program* program,
+                      int64_t pir_version) {
+  BinaryProgramReader reader(file.data(), file.size());
+  if (reader.file_version() == (uint64_t)pir_version) {
+    reader.RecoverProgram(program);
+  } else {
+    // The patches apply to the json, so the program is expanded to the json
+    // of ProgramWriter first.
+    PatchBuilder builder(pir_version);
+    BuildPatch(reader.file_version(), pir_version, &builder);
+    Json program_json = reader.GetProgramJson();
+    ProgramReader json_reader(pir_version);
+    json_reader.RecoverProgram(&program_json, program, &builder);
+  }
+  return reader.trainable();
+}
+
+}  // namespace
+
 void WriteModule(const pir::Program& program,
                  const std::string& file_path,
                  uint64_t pir_version,
@@ -66,15 +161,44 @@ void WriteModule(const pir::Program& program,
   fout.close();
 }
 
+void WriteModuleBinary(const pir::Program& program,
+                       const std::string& file_path,
+                       uint64_t pir_version,
+                       bool overwrite,
+                       bool trainable) {
+  PADDLE_ENFORCE_EQ(
+      FileExists(file_path) && !overwrite,
+      false,
+      common::errors::PreconditionNotMet(
+          "%s exists!, cannot save to it when overwrite is set to false.",
+          file_path,
+          overwrite));
+
+  BinaryProgramWriter writer(pir_version, trainable);
+  std::string binary = writer.GetProgramBinary(&program);
+
+  MkDirRecursively(DirName(file_path).c_str());
+  std::ofstream fout(file_path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout),
+                    true,
+                    common::errors::Unavailable(
+                        "Cannot open %s to save variables.", file_path));
+  fout.write(binary.data(), binary.size());
+  fout.close();
+}
+
 bool ReadModule(const std::string& file_path,
                 pir::Program* program,
                 int64_t pir_version) {
-  std::ifstream f(file_path);
-  Json data = Json::parse(f);
   if (pir_version < 0) {
     pir_version = DEVELOP_VERSION;
     VLOG(6) << "pir_version is null, get pir_version: " << pir_version;
   }
+  ModelFile file(file_path);
+  if (BinaryProgramReader::IsBinaryProgram(file.data(), file.size())) {
+    return ReadModuleBinary(file, program, pir_version);
+  }
+  Json data = Json::parse(file.data(), file.data() + file.size());
 
   PatchBuilder builder(pir_version);
 
@@ -83,17 +207,7 @@ bool ReadModule(const std::string& file_path,
     uint64_t file_version =
         data.at(BASE_CODE).at(PIRVERSION).template get<uint64_t>();
     if (file_version != (uint64_t)pir_version) {
-      builder.SetFileVersion(file_version);
-      // Set max_version to the max version number of release pir plus 1.
-      auto max_version = RELEASE_VERSION + 1;
-      // If pir_version_ is not 0, we will build patch from file_version_ to
-      // pir_version_; If pir_version_ is 0, we will first build patch from
-      // file_version_ to max_version, and then add 0.yaml to the end.
-      auto version = pir_version == 0 ? max_version : pir_version;
-      VLOG(6) << "file_version: " << file_version
-              << ", pir_version: " << pir_version
-              << ", final_version: " << version;
-      builder.BuildPatch(version, max_version);
+      BuildPatch(file_version, pir_version, &builder);
     }
   } else {
     PADDLE_THROW(common::errors::InvalidArgument("Invalid model file."));
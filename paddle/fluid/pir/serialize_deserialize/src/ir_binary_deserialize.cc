@@ -0,0 +1,457 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "paddle/fluid/pir/serialize_deserialize/include/ir_binary_deserialize.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+
+namespace pir {
+
+namespace {
+
+BinaryHeader ReadHeader(const char* data, size_t size) {
+  PADDLE_ENFORCE_EQ(
+      BinaryProgramReader::IsBinaryProgram(data, size) &&
+          size >= sizeof(BinaryHeader),
+      true,
+      common::errors::InvalidArgument("Invalid binary model file."));
+  BinaryHeader header;
+  std::memcpy(&header, data, sizeof(BinaryHeader));
+  PADDLE_ENFORCE_EQ(header.format_version,
+                    kBinaryFormatVersion,
+                    common::errors::InvalidArgument(
+                        "The binary model file is in format version %d, "
+                        "but only version %d is supported.",
+                        header.format_version,
+                        kBinaryFormatVersion));
+  return header;
+}
+
+pir::ArrayAttribute GetOneBoolArrayAttribute(pir::IrContext* ctx,
+                                             bool value) {
+  return pir::ArrayAttribute::get(ctx, {pir::BoolAttribute::get(ctx, value)});
+}
+
+}  // namespace
+
+bool BinaryProgramReader::IsBinaryProgram(const char* data, size_t size) {
+  return size >= sizeof(kBinaryMagic) &&
+         std::memcmp(data, kBinaryMagic, sizeof(kBinaryMagic)) == 0;
+}
+
+BinaryProgramReader::BinaryProgramReader(const char* data, size_t size)
+    : data_(data),
+      size_(size),
+      header_(ReadHeader(data, size)),
+      json_reader_(header_.pir_version) {
+  strings_ =
+      ReadTable(header_.string_table_offset, header_.type_table_offset);
+  type_entries_ =
+      ReadTable(header_.type_table_offset, header_.attr_table_offset);
+  attr_entries_ = ReadTable(header_.attr_table_offset, header_.program_offset);
+  types_.resize(type_entries_.size());
+  attrs_.resize(attr_entries_.size());
+  op_infos_.resize(strings_.size());
+  VLOG(6) << "Binary program has " << strings_.size() << " strings, "
+          << type_entries_.size() << " types and " << attr_entries_.size()
+          << " attributes.";
+}
+
+BinaryReadBuffer BinaryProgramReader::Section(uint64_t begin,
+                                              uint64_t end) const {
+  PADDLE_ENFORCE_EQ(
+      begin <= end && end <= size_,
+      true,
+      common::errors::InvalidArgument(
+          "Invalid section [%d, %d) of the binary model file of size %d.",
+          begin,
+          end,
+          size_));
+  return BinaryReadBuffer(data_ + begin, end - begin);
+}
+
+std::vector<std::string_view> BinaryProgramReader::ReadTable(
+    uint64_t begin, uint64_t end) const {
+  BinaryReadBuffer buffer = Section(begin, end);
+  uint64_t num_entries = buffer.ReadVarint();
+  std::vector<std::string_view> entries;
+  entries.reserve(std::min<uint64_t>(num_entries, end - begin));
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    entries.push_back(buffer.ReadString());
+  }
+  return entries;
+}
+
+std::string_view BinaryProgramReader::GetString(uint64_t id) const {
+  PADDLE_ENFORCE_LT(id,
+                    strings_.size(),
+                    common::errors::InvalidArgument(
+                        "String id %d out of range %d.", id, strings_.size()));
+  return strings_[id];
+}
+
+Json BinaryProgramReader::GetTypeJson(uint64_t id) const {
+  PADDLE_ENFORCE_LT(
+      id,
+      type_entries_.size(),
+      common::errors::InvalidArgument(
+          "Type id %d out of range %d.", id, type_entries_.size()));
+  return Json::from_cbor(type_entries_[id].begin(), type_entries_[id].end());
+}
+
+Json BinaryProgramReader::GetAttributeJson(uint64_t id) const {
+  PADDLE_ENFORCE_LT(
+      id,
+      attr_entries_.size(),
+      common::errors::InvalidArgument(
+          "Attribute id %d out of range %d.", id, attr_entries_.size()));
+  return Json::from_cbor(attr_entries_[id].begin(), attr_entries_[id].end());
+}
+
+pir::Type BinaryProgramReader::GetType(uint64_t id) {
+  if (id < types_.size() && types_[id].has_value()) {
+    return *types_[id];
+  }
+  Json type_json = GetTypeJson(id);
+  types_[id] = json_reader_.RecoverType(&type_json);
+  return *types_[id];
+}
+
+pir::Attribute BinaryProgramReader::GetAttribute(uint64_t id) {
+  if (id < attrs_.size() && attrs_[id].has_value()) {
+    return *attrs_[id];
+  }
+  Json attr_json = GetAttributeJson(id);
+  attrs_[id] = json_reader_.RecoverAttribute(&attr_json);
+  return *attrs_[id];
+}
+
+pir::OpInfo BinaryProgramReader::GetOpInfo(uint64_t name_id) {
+  std::string op_name(GetString(name_id));
+  if (!op_infos_[name_id].has_value()) {
+    GetDecompressOpName(&op_name);
+    VLOG(4) << "Read op_name = " << op_name << ".";
+    op_infos_[name_id] =
+        pir::IrContext::Instance()->GetRegisteredOpInfo(op_name);
+  }
+  return *op_infos_[name_id];
+}
+
+int64_t BinaryProgramReader::ReadValueRef(BinaryReadBuffer* buffer) const {
+  uint64_t ref = buffer->ReadVarint();
+  if (ref == 0) {
+    return 0;  // NULL_VALUE
+  }
+  return value_id_ - ZigZagDecode(ref);
+}
+
+pir::Value BinaryProgramReader::GetValue(int64_t id) const {
+  if (id > 0 && static_cast<size_t>(id) < values_.size()) {
+    return values_[id];
+  }
+  if (id < 0 && static_cast<size_t>(-id) < block_args_.size()) {
+    return block_args_[-id];
+  }
+  PADDLE_ENFORCE_EQ(
+      id,
+      0,
+      common::errors::InvalidArgument("Value id %d is not defined.", id));
+  return pir::Value();
+}
+
+void BinaryProgramReader::RecoverProgram(pir::Program* recover_program) {
+  values_.assign(1, pir::Value());
+  block_args_.assign(1, pir::Value());
+  value_id_ = 1;
+  blockarg_id_ = -1;
+
+  BinaryReadBuffer buffer = Section(header_.program_offset, size_);
+  uint64_t num_regions = buffer.ReadVarint();
+  PADDLE_ENFORCE_EQ(
+      num_regions,
+      1,
+      common::errors::InvalidArgument(
+          "The redions size of program module should be 1 but got %d.",
+          num_regions));
+  BinaryReadBuffer region_buffer = buffer.ReadSection();
+  uint64_t num_blocks = region_buffer.ReadVarint();
+  PADDLE_ENFORCE_GT(num_blocks,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The region of program module has no block."));
+  ReadBlock(&region_buffer, &recover_program->module_op().block());
+  VLOG(6) << "Finish binary to program.";
+}
+
+void BinaryProgramReader::ReadRegion(BinaryReadBuffer* buffer,
+                                     pir::Region* region) {
+  BinaryReadBuffer region_buffer = buffer->ReadSection();
+  uint64_t num_blocks = region_buffer.ReadVarint();
+  for (uint64_t i = 0; i < num_blocks; ++i) {
+    region->emplace_back();
+    ReadBlock(&region_buffer, &(region->back()));
+  }
+}
+
+void BinaryProgramReader::ReadBlock(BinaryReadBuffer* buffer,
+                                    pir::Block* block) {
+  uint64_t num_args = buffer->ReadVarint();
+  for (uint64_t i = 0; i < num_args; ++i) {
+    block_args_.push_back(block->AddArg(GetType(buffer->ReadVarint())));
+    blockarg_id_--;
+  }
+  uint64_t num_kwargs = buffer->ReadVarint();
+  for (uint64_t i = 0; i < num_kwargs; ++i) {
+    std::string key(GetString(buffer->ReadVarint()));
+    block_args_.push_back(
+        block->AddKwarg(key, GetType(buffer->ReadVarint())));
+    blockarg_id_--;
+  }
+  uint64_t num_ops = buffer->ReadVarint();
+  for (uint64_t i = 0; i < num_ops; ++i) {
+    block->push_back(ReadOp(buffer));
+  }
+  VLOG(6) << "read block size" << block->size() << ".";
+}
+
+void BinaryProgramReader::ReadAttributes(BinaryReadBuffer* buffer,
+                                         pir::AttributeMap* attributes) {
+  uint64_t num_attrs = buffer->ReadVarint();
+  for (uint64_t i = 0; i < num_attrs; ++i) {
+    std::string name(GetString(buffer->ReadVarint()));
+    attributes->insert({name, GetAttribute(buffer->ReadVarint())});
+  }
+}
+
+pir::Operation* BinaryProgramReader::ReadParameterOp(
+    BinaryReadBuffer* buffer) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  std::vector<pir::Type> output_types{GetType(buffer->ReadVarint())};
+  pir::AttributeMap attributes;
+  attributes.insert(
+      {"parameter_name",
+       pir::StrAttribute::get(ctx,
+                              std::string(GetString(buffer->ReadVarint())))});
+  uint64_t flags = buffer->ReadVarint();
+  attributes.insert({"is_distributed",
+                     GetOneBoolArrayAttribute(ctx, flags & kIsDistributed)});
+  attributes.insert(
+      {"is_parameter", GetOneBoolArrayAttribute(ctx, flags & kIsParameter)});
+  attributes.insert(
+      {"need_clip", GetOneBoolArrayAttribute(ctx, flags & kNeedClip)});
+  if (trainable()) {
+    attributes.insert(
+        {"persistable", GetOneBoolArrayAttribute(ctx, flags & kPersistable)});
+    attributes.insert({"stop_gradient",
+                       GetOneBoolArrayAttribute(ctx, flags & kStopGradient)});
+    attributes.insert(
+        {"trainable", GetOneBoolArrayAttribute(ctx, flags & kTrainable)});
+  }
+  ReadAttributes(buffer, &attributes);  // dist attributes
+  ReadAttributes(buffer, &attributes);  // quant attributes
+
+  pir::OpInfo op_info = ctx->GetRegisteredOpInfo(pir::ParameterOp::name());
+  pir::Operation* op = Operation::Create({}, attributes, output_types, op_info);
+  values_.push_back(op->result(0));
+  value_id_++;
+  return op;
+}
+
+pir::Operation* BinaryProgramReader::ReadOp(BinaryReadBuffer* buffer) {
+  uint64_t name_id = buffer->ReadVarint();
+  if (GetString(name_id) == PARAMETEROP) {
+    return ReadParameterOp(buffer);
+  }
+  pir::OpInfo op_info = GetOpInfo(name_id);
+
+  uint64_t num_operands = buffer->ReadVarint();
+  std::vector<pir::Value> inputs;
+  inputs.reserve(num_operands);
+  for (uint64_t i = 0; i < num_operands; ++i) {
+    inputs.push_back(GetValue(ReadValueRef(buffer)));
+  }
+  uint64_t num_results = buffer->ReadVarint();
+  std::vector<pir::Type> output_types;
+  output_types.reserve(num_results);
+  for (uint64_t i = 0; i < num_results; ++i) {
+    output_types.push_back(GetType(buffer->ReadVarint()));
+  }
+  // The results are numbered before the values in the regions.
+  const size_t first_result = values_.size();
+  values_.resize(first_result + num_results);
+  value_id_ += num_results;
+
+  pir::AttributeMap attributes;
+  ReadAttributes(buffer, &attributes);
+  if (trainable()) {
+    ReadAttributes(buffer, &attributes);
+  }
+
+  uint64_t num_regions = buffer->ReadVarint();
+  pir::Operation* op = Operation::Create(
+      inputs, attributes, output_types, op_info, num_regions);
+  for (uint64_t i = 0; i < num_regions; ++i) {
+    ReadRegion(buffer, &(op->region(i)));
+  }
+  for (uint32_t i = 0; i < op->num_results(); ++i) {
+    values_[first_result + i] = op->result(i);
+  }
+  VLOG(6) << "Finish Read Operation " << op->name() << ".";
+  return op;
+}
+
+Json BinaryProgramReader::GetProgramJson() {
+  value_id_ = 1;
+  blockarg_id_ = -1;
+  region_id_ = 0;
+  block_id_ = 0;
+
+  BinaryReadBuffer buffer = Section(header_.program_offset, size_);
+  Json program_json;
+  program_json[REGIONS] = Json::array();
+  uint64_t num_regions = buffer.ReadVarint();
+  for (uint64_t i = 0; i < num_regions; ++i) {
+    program_json[REGIONS].emplace_back(ExpandRegion(&buffer));
+  }
+  VLOG(6) << "Finish binary to json.";
+  return program_json;
+}
+
+Json BinaryProgramReader::ExpandRegion(BinaryReadBuffer* buffer) {
+  Json region_json;
+  region_json[ID] = "region_" + std::to_string(region_id_++);
+  region_json[BLOCKS] = Json::array();
+  BinaryReadBuffer region_buffer = buffer->ReadSection();
+  uint64_t num_blocks = region_buffer.ReadVarint();
+  for (uint64_t i = 0; i < num_blocks; ++i) {
+    region_json[BLOCKS].emplace_back(ExpandBlock(&region_buffer));
+  }
+  return region_json;
+}
+
+Json BinaryProgramReader::ExpandBlock(BinaryReadBuffer* buffer) {
+  Json block_json;
+  block_json[ID] = "block_" + std::to_string(block_id_++);
+  Json args_json = Json::array();
+  uint64_t num_args = buffer->ReadVarint();
+  for (uint64_t i = 0; i < num_args; ++i) {
+    Json arg_json;
+    arg_json[ID] = blockarg_id_--;
+    arg_json[TYPE_TYPE] = GetTypeJson(buffer->ReadVarint());
+    args_json.emplace_back(arg_json);
+  }
+  block_json[BLOCKARGS] = args_json;
+  uint64_t num_kwargs = buffer->ReadVarint();
+  if (num_kwargs > 0) {
+    Json kwargs_json = Json::array();
+    for (uint64_t i = 0; i < num_kwargs; ++i) {
+      Json kwarg_json;
+      kwarg_json[KEYWORDNAME] = std::string(GetString(buffer->ReadVarint()));
+      kwarg_json[ID] = blockarg_id_--;
+      kwarg_json[TYPE_TYPE] = GetTypeJson(buffer->ReadVarint());
+      kwargs_json.emplace_back(kwarg_json);
+    }
+    block_json[KEYWORDBLOCKARGS] = kwargs_json;
+  }
+  Json ops_json = Json::array();
+  uint64_t num_ops = buffer->ReadVarint();
+  for (uint64_t i = 0; i < num_ops; ++i) {
+    ops_json.emplace_back(ExpandOp(buffer));
+  }
+  block_json[BLOCKOPS] = ops_json;
+  return block_json;
+}
+
+Json BinaryProgramReader::ExpandAttributes(BinaryReadBuffer* buffer) {
+  Json attrs_json = Json::array();
+  uint64_t num_attrs = buffer->ReadVarint();
+  for (uint64_t i = 0; i < num_attrs; ++i) {
+    Json attr_json;
+    attr_json[NAME] = std::string(GetString(buffer->ReadVarint()));
+    attr_json[ATTR_TYPE] = GetAttributeJson(buffer->ReadVarint());
+    attrs_json.emplace_back(attr_json);
+  }
+  return attrs_json;
+}
+
+Json BinaryProgramReader::ExpandParameterOp(BinaryReadBuffer* buffer) {
+  Json op_json = Json::object();
+  op_json[ID] = PARAMETEROP;
+  Json value_json;
+  value_json[VALUE_ID] = value_id_++;
+  value_json[TYPE_TYPE] = GetTypeJson(buffer->ReadVarint());
+  op_json[OPRESULTS] = value_json;
+
+  std::string parameter_name(GetString(buffer->ReadVarint()));
+  uint64_t flags = buffer->ReadVarint();
+  const auto Flag = [flags](ParameterOpFlag flag) {
+    return static_cast<int32_t>((flags & flag) != 0);
+  };
+  op_json[ATTRS] = {Flag(kIsDistributed),
+                    Flag(kIsParameter),
+                    Flag(kNeedClip),
+                    parameter_name};
+  op_json[DIST_ATTRS] = ExpandAttributes(buffer);
+  op_json[QUANT_ATTRS] = ExpandAttributes(buffer);
+  if (trainable()) {
+    op_json[OPRESULTS_ATTRS] = {
+        Flag(kPersistable), Flag(kStopGradient), Flag(kTrainable)};
+  }
+  return op_json;
+}
+
+Json BinaryProgramReader::ExpandOp(BinaryReadBuffer* buffer) {
+  std::string op_name(GetString(buffer->ReadVarint()));
+  if (op_name == PARAMETEROP) {
+    return ExpandParameterOp(buffer);
+  }
+  Json op_json = Json::object();
+  op_json[ID] = op_name;
+
+  Json operands_json = Json::array();
+  uint64_t num_operands = buffer->ReadVarint();
+  for (uint64_t i = 0; i < num_operands; ++i) {
+    Json operand_json = Json::object();
+    operand_json[VALUE_ID] = ReadValueRef(buffer);
+    operands_json.emplace_back(operand_json);
+  }
+  op_json[OPOPERANDS] = operands_json;
+
+  Json opresults_json = Json::array();
+  uint64_t num_results = buffer->ReadVarint();
+  for (uint64_t i = 0; i < num_results; ++i) {
+    Json value_json;
+    value_json[VALUE_ID] = value_id_++;
+    value_json[TYPE_TYPE] = GetTypeJson(buffer->ReadVarint());
+    opresults_json.emplace_back(value_json);
+  }
+  op_json[OPRESULTS] = opresults_json;
+
+  op_json[ATTRS] = ExpandAttributes(buffer);
+  if (trainable()) {
+    op_json[OPRESULTS_ATTRS] = ExpandAttributes(buffer);
+  }
+
+  uint64_t num_regions = buffer->ReadVarint();
+  for (uint64_t i = 0; i < num_regions; ++i) {
+    op_json[REGIONS].emplace_back(ExpandRegion(buffer));
+  }
+  return op_json;
+}
+
+}  // namespace pir
@@ -0,0 +1,253 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "paddle/fluid/pir/serialize_deserialize/include/ir_binary_serialize.h"
+#include "paddle/common/flags.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/operation.h"
+
+COMMON_DECLARE_bool(save_cf_stack_op);
+namespace pir {
+
+namespace {
+
+void WriteTable(const std::vector<std::string>& entries,
+                BinaryWriteBuffer* buffer) {
+  buffer->WriteVarint(entries.size());
+  for (const auto& entry : entries) {
+    buffer->WriteString(entry);
+  }
+}
+
+// Same as the defaults of WriteParameterOP for the missing attributes.
+bool GetOneBoolArrayAttribute(const pir::Operation& op,
+                              const std::string& name,
+                              bool default_value) {
+  if (op.attributes().count(name) == 0) {
+    return default_value;
+  }
+  return op.attributes()
+      .at(name)
+      .dyn_cast<pir::ArrayAttribute>()
+      .at(0)
+      .dyn_cast<pir::BoolAttribute>()
+      .data();
+}
+
+}  // namespace
+
+std::string BinaryProgramWriter::GetProgramBinary(
+    const pir::Program* program) {
+  BinaryWriteBuffer program_buffer;
+  auto top_level_op = program->module_op();
+  program_buffer.WriteVarint(top_level_op->num_regions());
+  for (size_t i = 0; i < top_level_op->num_regions(); ++i) {
+    WriteRegion(&top_level_op->region(i), &program_buffer);
+  }
+  VLOG(6) << "Finish write program, " << strings_.size() << " strings, "
+          << types_.size() << " types and " << attrs_.size()
+          << " attributes.";
+
+  BinaryWriteBuffer tables;
+  WriteTable(strings_, &tables);
+  const size_t type_table_offset = sizeof(BinaryHeader) + tables.size();
+  WriteTable(types_, &tables);
+  const size_t attr_table_offset = sizeof(BinaryHeader) + tables.size();
+  WriteTable(attrs_, &tables);
+
+  BinaryHeader header;
+  std::memcpy(header.magic, kBinaryMagic, sizeof(header.magic));
+  header.format_version = kBinaryFormatVersion;
+  header.flags = trainable_ ? kBinaryTrainable : 0;
+  header.pir_version = version_;
+  header.string_table_offset = sizeof(BinaryHeader);
+  header.type_table_offset = type_table_offset;
+  header.attr_table_offset = attr_table_offset;
+  header.program_offset = sizeof(BinaryHeader) + tables.size();
+
+  std::string result;
+  result.reserve(header.program_offset + program_buffer.size());
+  result.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  result.append(tables.data());
+  result.append(program_buffer.data());
+  return result;
+}
+
+uint64_t BinaryProgramWriter::GetStringId(const std::string& str) {
+  auto it = string_ids_.find(str);
+  if (it != string_ids_.end()) {
+    return it->second;
+  }
+  string_ids_.emplace(str, strings_.size());
+  strings_.push_back(str);
+  return strings_.size() - 1;
+}
+
+uint64_t BinaryProgramWriter::GetTypeId(const pir::Type& type) {
+  auto it = type_ids_.find(type);
+  if (it != type_ids_.end()) {
+    return it->second;
+  }
+  auto cbor = Json::to_cbor(json_writer_.GetTypeJson(type));
+  type_ids_.emplace(type, types_.size());
+  types_.emplace_back(cbor.begin(), cbor.end());
+  return types_.size() - 1;
+}
+
+uint64_t BinaryProgramWriter::GetAttributeId(const pir::Attribute& attr) {
+  auto it = attr_ids_.find(attr);
+  if (it != attr_ids_.end()) {
+    return it->second;
+  }
+  auto cbor = Json::to_cbor(json_writer_.GetAttributeJson(attr));
+  attr_ids_.emplace(attr, attrs_.size());
+  attrs_.emplace_back(cbor.begin(), cbor.end());
+  return attrs_.size() - 1;
+}
+
+void BinaryProgramWriter::WriteRegion(const pir::Region* region,
+                                      BinaryWriteBuffer* buffer) {
+  // Regions are prefixed with their size so that readers can skip them.
+  BinaryWriteBuffer region_buffer;
+  region_buffer.WriteVarint(region->size());
+  for (auto block : region->blocks()) {
+    WriteBlock(block, &region_buffer);
+  }
+  buffer->WriteString(region_buffer.data());
+}
+
+void BinaryProgramWriter::WriteBlock(pir::Block* block,
+                                     BinaryWriteBuffer* buffer) {
+  buffer->WriteVarint(block->args_size());
+  for (auto arg : block->args()) {
+    value_id_map_[arg] = blockarg_id_--;
+    buffer->WriteVarint(GetTypeId(arg.type()));
+  }
+  buffer->WriteVarint(block->kwargs_size());
+  for (auto item : block->kwargs()) {
+    value_id_map_[item.second] = blockarg_id_--;
+    buffer->WriteVarint(GetStringId(item.first));
+    buffer->WriteVarint(GetTypeId(item.second.type()));
+  }
+
+  if (!FLAGS_save_cf_stack_op) {
+    DeleteCfStackOps(block);
+  }
+  buffer->WriteVarint(block->size());
+  for (auto op : block->ops()) {
+    WriteOp(*op, buffer);
+  }
+}
+
+void BinaryProgramWriter::WriteValueRef(const pir::Value& value,
+                                        BinaryWriteBuffer* buffer) {
+  auto it = value ? value_id_map_.find(value) : value_id_map_.end();
+  if (it == value_id_map_.end()) {
+    buffer->WriteVarint(0);  // NULL_VALUE
+    return;
+  }
+  buffer->WriteVarint(ZigZagEncode(value_id_ - it->second));
+}
+
+void BinaryProgramWriter::WriteAttributes(
+    const std::vector<std::pair<std::string, pir::Attribute>>& attrs,
+    BinaryWriteBuffer* buffer) {
+  buffer->WriteVarint(attrs.size());
+  for (const auto& [name, attr] : attrs) {
+    buffer->WriteVarint(GetStringId(name));
+    buffer->WriteVarint(GetAttributeId(attr));
+  }
+}
+
+void BinaryProgramWriter::WriteParameterOp(const pir::Operation& op,
+                                           BinaryWriteBuffer* buffer) {
+  CheckParameterOpAttributes(op);
+  PADDLE_ENFORCE_GT(op.attributes().count("parameter_name"),
+                    0,
+                    common::errors::InvalidArgument(
+                        "parameter_name not found in ParameterOp"));
+  buffer->WriteVarint(GetStringId(PARAMETEROP));
+  value_id_map_[op.result(0)] = value_id_++;
+  buffer->WriteVarint(GetTypeId(op.result(0).type()));
+  buffer->WriteVarint(GetStringId(op.attributes()
+                                      .at("parameter_name")
+                                      .dyn_cast<pir::StrAttribute>()
+                                      .AsString()));
+
+  uint64_t flags = 0;
+  const auto SetFlag = [&](const std::string& name,
+                           bool default_value,
+                           ParameterOpFlag flag) {
+    if (GetOneBoolArrayAttribute(op, name, default_value)) {
+      flags |= flag;
+    }
+  };
+  SetFlag("is_distributed", false, kIsDistributed);
+  SetFlag("is_parameter", true, kIsParameter);
+  SetFlag("need_clip", false, kNeedClip);
+  SetFlag("persistable", true, kPersistable);
+  SetFlag("stop_gradient", true, kStopGradient);
+  SetFlag("trainable", true, kTrainable);
+  buffer->WriteVarint(flags);
+
+  std::vector<std::pair<std::string, pir::Attribute>> dist_attrs;
+  for (auto key : GetOpDistAttr()) {
+    if (op.attributes().count(key) > 0) {
+      dist_attrs.emplace_back(key, op.attributes().at(key));
+    }
+  }
+  WriteAttributes(dist_attrs, buffer);
+  std::vector<std::pair<std::string, pir::Attribute>> quant_attrs;
+  for (auto key : GetOpQuantAttr()) {
+    if (op.attributes().count(key) > 0) {
+      quant_attrs.emplace_back(key, op.attributes().at(key));
+    }
+  }
+  WriteAttributes(quant_attrs, buffer);
+}
+
+void BinaryProgramWriter::WriteOp(const pir::Operation& op,
+                                  BinaryWriteBuffer* buffer) {
+  if (op.isa<pir::ParameterOp>()) {
+    WriteParameterOp(op, buffer);
+    return;
+  }
+  auto op_name = op.name();
+  GetCompressOpName(&op_name);
+  buffer->WriteVarint(GetStringId(op_name));
+
+  buffer->WriteVarint(op.num_operands());
+  for (auto operand : op.operands()) {
+    WriteValueRef(operand.source(), buffer);
+  }
+  buffer->WriteVarint(op.num_results());
+  for (auto& opresult : op.results()) {
+    value_id_map_[opresult] = value_id_++;
+    buffer->WriteVarint(GetTypeId(opresult.type()));
+  }
+
+  WriteAttributes(GetOpinfoAttributes(const_cast<pir::Operation*>(&op)),
+                  buffer);
+  if (trainable_) {
+    WriteAttributes(GetOpresultAttributes(op.attributes()), buffer);
+  }
+
+  buffer->WriteVarint(op.num_regions());
+  for (size_t i = 0; i < op.num_regions(); ++i) {
+    WriteRegion(&op.region(i), buffer);
+  }
+  VLOG(6) << "Finish write Operation " << op.name() << ".";
+}
+
+}  // namespace pir
@@ -30,6 +30,10 @@ pir::Type ProgramReader::RecoverType(Json* type_json) {
   return ReadType(type_json);
 }
 
+pir::Attribute ProgramReader::RecoverAttribute(Json* attr_json) {
+  return pir::parseAttr(attr_json);
+}
+
 pir::AttributeMap ProgramReader::RecoverOpAttributesMap(Json* attrs_json) {
   Json empty_json = Json::array();
   std::unordered_map<std::string, Json> attr_patch;
@@ -24,6 +24,110 @@
 COMMON_DECLARE_bool(save_cf_stack_op);
 namespace pir {
 
+void DeleteCfStackOps(pir::Block* block) {
+  std::vector<pir::Operation*> delete_ops;
+  for (auto op : block->ops()) {
+    if (op->isa<pir::StackCreateOp>()) {
+      delete_ops.push_back(op);
+    }
+  }
+  VLOG(6) << "program before delete stack op :" << *(block->parent_program());
+  for (auto op : delete_ops) {
+    VLOG(0) << "Delete cf.stack_create / cf.tuple_push.";
+    auto stack_op = op->dyn_cast<pir::StackCreateOp>();
+    if (stack_op.inlet().HasOneUse()) {
+      auto tuple_push_op = stack_op.tuple_push_op();
+      auto block_in = tuple_push_op->GetParent();
+      block_in->erase(*tuple_push_op);
+    }
+    if (stack_op.outlet().HasOneUse()) {
+      auto tuple_pop_op = stack_op.tuple_pop_op();
+      auto block_in = tuple_pop_op->GetParent();
+      block_in->erase(*tuple_pop_op);
+    }
+    block->erase(*op);
+  }
+  VLOG(6) << "program after delete stack op :" << *(block->parent_program());
+}
+
+std::vector<std::pair<std::string, pir::Attribute>> GetOpinfoAttributes(
+    pir::Operation* op) {
+  std::vector<std::pair<std::string, pir::Attribute>> attrs;
+  const auto& attr_map = op->attributes();
+  if (op->dialect()->name() == "pd_op" &&
+      op->dyn_cast<paddle::dialect::OpYamlInfoInterface>()) {
+    auto [_1, attr_info, _3, _4, _5] =
+        op->dyn_cast<paddle::dialect::OpYamlInfoInterface>().GetOpInfo();
+    if (attr_info.size() != 0) {
+      for (const auto& val : attr_info) {
+        if (attr_map.find(val.name) != attr_map.end()) {
+          attrs.emplace_back(val.name, attr_map.at(val.name));
+        }
+      }
+    }
+    for (auto key : GetOpDistAttr()) {
+      if (attr_map.count(key) > 0) {
+        attrs.emplace_back(key, attr_map.at(key));
+      }
+    }
+    for (auto key : GetOpQuantAttr()) {
+      if (attr_map.count(key) > 0) {
+        attrs.emplace_back(key, attr_map.at(key));
+      }
+    }
+  } else {
+    for (auto& attr : attr_map) {
+      if (attr.first != "stop_gradient" && attr.first != "persistable" &&
+          attr.first != "op_callstack") {
+        attrs.emplace_back(attr.first, attr.second);
+      }
+    }
+  }
+  return attrs;
+}
+
+std::vector<std::pair<std::string, pir::Attribute>> GetOpresultAttributes(
+    const AttributeMap& attr_map) {
+  std::vector<std::pair<std::string, pir::Attribute>> attrs;
+  for (auto& attr : attr_map) {
+    if (attr.first == "stop_gradient" || attr.first == "persistable") {
+      attrs.emplace_back(attr.first, attr.second);
+    }
+  }
+  return attrs;
+}
+
+void CheckParameterOpAttributes(const pir::Operation& op) {
+  std::vector<std::string> AttrsNameList = {"is_distributed",
+                                            "is_parameter",
+                                            "need_clip",
+                                            "parameter_name",
+                                            "persistable",
+                                            "stop_gradient",
+                                            "trainable",
+                                            "op_callstack" /*no need*/};
+  std::vector<std::string> DistAttrsNameList = GetOpDistAttr();
+  std::vector<std::string> QuantAttrsNameList = GetOpQuantAttr();
+  AttrsNameList.insert(
+      AttrsNameList.end(), DistAttrsNameList.begin(), DistAttrsNameList.end());
+  AttrsNameList.insert(AttrsNameList.end(),
+                       QuantAttrsNameList.begin(),
+                       QuantAttrsNameList.end());
+  for (auto attr : op.attributes()) {
+    auto attr_name = attr.first;
+    auto it = std::find(AttrsNameList.begin(), AttrsNameList.end(), attr_name);
+    if (it == AttrsNameList.end()) {
+      PADDLE_ENFORCE(
+          false,
+          common::errors::InvalidArgument(
+              "attr name %s not supposed be serialized in WriteParameterOP, "
+              "please add it in order and add deserialization code in "
+              "ReadParameterOP.",
+              attr_name));
+    }
+  }
+}
+
 Json ProgramWriter::GetProgramJson(const pir::Program* program) {
   program_json = WriteProgram(program);
   VLOG(6) << "Finish program to json.";
@@ -36,6 +140,10 @@ Json ProgramWriter::GetTypeJson(const pir::Type& type) {
   return type_json;
 }
 
+Json ProgramWriter::GetAttributeJson(const pir::Attribute& attr) {
+  return pir::writeAttr(attr);
+}
+
 Json ProgramWriter::GetAttributesMapJson(const AttributeMap& attr_map) {
   Json attrs_json = Json::array();
   for (auto attr : attr_map) {
@@ -102,29 +210,7 @@ Json ProgramWriter::WriteBlock(pir::Block* block,
 
   /* delete cf.stack_create / cf.tuple_push */
   if (!FLAGS_save_cf_stack_op) {
-    std::vector<pir::Operation*> delete_ops;
-    for (auto op : block->ops()) {
-      if (op->isa<pir::StackCreateOp>()) {
-        delete_ops.push_back(op);
-      }
-    }
-    VLOG(6) << "program before delete stack op :" << *(block->parent_program());
-    for (auto op : delete_ops) {
-      VLOG(0) << "Delete cf.stack_create / cf.tuple_push.";
-      auto stack_op = op->dyn_cast<pir::StackCreateOp>();
-      if (stack_op.inlet().HasOneUse()) {
-        auto tuple_push_op = stack_op.tuple_push_op();
-        auto block_in = tuple_push_op->GetParent();
-        block_in->erase(*tuple_push_op);
-      }
-      if (stack_op.outlet().HasOneUse()) {
-        auto tuple_pop_op = stack_op.tuple_pop_op();
-        auto block_in = tuple_pop_op->GetParent();
-        block_in->erase(*tuple_pop_op);
-      }
-      block->erase(*op);
-    }
-    VLOG(6) << "program after delete stack op :" << *(block->parent_program());
+    DeleteCfStackOps(block);
   }
   for (auto op : block->ops()) {
     auto op_json = WriteOp(*op);
@@ -182,34 +268,7 @@ Json ProgramWriter::WriteValue(const pir::Value& value) {
                            .dyn_cast<pir::BoolAttribute>()  \
                            .data())
 Json ProgramWriter::WriteParameterOP(const pir::Operation& op) {
-  std::vector<std::string> AttrsNameList = {"is_distributed",
-                                            "is_parameter",
-                                            "need_clip",
-                                            "parameter_name",
-                                            "persistable",
-                                            "stop_gradient",
-                                            "trainable",
-                                            "op_callstack" /*no need*/};
-  std::vector<std::string> DistAttrsNameList = GetOpDistAttr();
-  std::vector<std::string> QuantAttrsNameList = GetOpQuantAttr();
-  AttrsNameList.insert(
-      AttrsNameList.end(), DistAttrsNameList.begin(), DistAttrsNameList.end());
-  AttrsNameList.insert(AttrsNameList.end(),
-                       QuantAttrsNameList.begin(),
-                       QuantAttrsNameList.end());
-  for (auto attr : op.attributes()) {
-    auto attr_name = attr.first;
-    auto it = std::find(AttrsNameList.begin(), AttrsNameList.end(), attr_name);
-    if (it == AttrsNameList.end()) {
-      PADDLE_ENFORCE(
-          false,
-          common::errors::InvalidArgument(
-              "attr name %s not supposed be serialized in WriteParameterOP, "
-              "please add it in order and add deserialization code in "
-              "ReadParameterOP.",
-              attr_name));
-    }
-  }
+  CheckParameterOpAttributes(op);
   // attr_name ; type
   // is_distributed; array(bool)
   // is_parameter; array(bool)
@@ -333,35 +392,8 @@ Json ProgramWriter::WriteAttributesMapOpinfo(pir::Operation* op,
                                              const AttributeMap& attr_map) {
   Json attrs_json = Json::array();
   VLOG(6) << "Start write Opinfo AttributeMap ...";
-  if (op->dialect()->name() == "pd_op" &&
-      op->dyn_cast<paddle::dialect::OpYamlInfoInterface>()) {
-    auto [_1, attr_info, _3, _4, _5] =
-        op->dyn_cast<paddle::dialect::OpYamlInfoInterface>().GetOpInfo();
-    if (attr_info.size() != 0) {
-      for (const auto& val : attr_info) {
-        if (attr_map.find(val.name) != attr_map.end()) {
-          attrs_json.emplace_back(
-              WriteAttribute(val.name, attr_map.at(val.name)));
-        }
-      }
-    }
-    for (auto key : GetOpDistAttr()) {
-      if (attr_map.count(key) > 0) {
-        attrs_json.emplace_back(WriteAttribute(key, attr_map.at(key)));
-      }
-    }
-    for (auto key : GetOpQuantAttr()) {
-      if (attr_map.count(key) > 0) {
-        attrs_json.emplace_back(WriteAttribute(key, attr_map.at(key)));
-      }
-    }
-  } else {
-    for (auto& attr : attr_map) {
-      if (attr.first != "stop_gradient" && attr.first != "persistable" &&
-          attr.first != "op_callstack") {
-        attrs_json.emplace_back(WriteAttribute(attr.first, attr.second));
-      }
-    }
+  for (auto& [name, attr] : GetOpinfoAttributes(op)) {
+    attrs_json.emplace_back(WriteAttribute(name, attr));
   }
 
   VLOG(6) << "Finish write Opinfo AttributeMap. ";
@@ -370,11 +402,8 @@ Json ProgramWriter::WriteAttributesMapOpinfo(pir::Operation* op,
 
 Json ProgramWriter::WriteAttributesMapOther(const AttributeMap& attr_map) {
   Json operesult_attrs_json = Json::array();
-  for (auto& attr : attr_map) {
-    if (attr.first == "stop_gradient" || attr.first == "persistable") {
-      operesult_attrs_json.emplace_back(
-          WriteAttribute(attr.first, attr.second));
-    }
+  for (auto& [name, attr] : GetOpresultAttributes(attr_map)) {
+    operesult_attrs_json.emplace_back(WriteAttribute(name, attr));
   }
 
   VLOG(6) << "Finish write Other AttributeMap. ";
@@ -14,6 +14,7 @@ limitations under the License. */
 #include <numeric>
 
 #include "glog/logging.h"
+#include "paddle/fluid/framework/io/mapped_params.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
 #include "paddle/phi/common/port.h"
@@ -206,6 +207,18 @@ void LoadCombineFunction(const std::string& file_path,
                         "it to be greater than 0.",
                         out->size()));
   const phi::DeviceContext* dev_ctx = GetDeviceContext(*(out->at(0)), place);
+  if (paddle::framework::IsMappedParamsFile(file_path)) {
+    paddle::framework::LoadMappedParams(file_path, *out, dev_ctx->GetPlace());
+    for (auto tensor : *out) {
+      auto in_dtype = tensor->dtype();
+      auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
+      if (in_dtype != out_dtype) {
+        auto cast_in = *tensor;
+        *tensor = CastTensorType(dev_ctx, cast_in, out_dtype);
+      }
+    }
+    return;
+  }
   for (size_t i = 0; i < names.size(); i++) {
     auto tensor = out->at(i);
     paddle::framework::DeserializeFromStream(fin, tensor, *dev_ctx);
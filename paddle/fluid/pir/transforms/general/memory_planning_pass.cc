@@ -0,0 +1,452 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/transforms/general/memory_planning_pass.h"
+
+#include <glog/logging.h>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_dialect.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
+#include "paddle/fluid/pir/dialect/operator/interface/op_yaml_info.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_attribute.h"
+#include "paddle/fluid/pir/dialect/operator/utils/op_yaml_info_parser.h"
+#include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/operation.h"
+#include "paddle/pir/include/pass/pass.h"
+#include "paddle/pir/include/pass/pass_registry.h"
+
+namespace {
+
+using TensorType = paddle::dialect::AllocatedDenseTensorType;
+
+// The alignment of the offsets, as the gpu allocators do.
+constexpr int64_t kAlignment = 256;
+
+// The tensors filled from outside of the program.
+const std::unordered_set<std::string> kExternalOps = {
+    "pd_op.feed",
+    "pd_op.data",
+    "pd_op.shadow_feed",
+};
+
+// The kernels of these ops may share the buffer of their input with their
+// output, although the yaml declares neither inplace nor view. Their operands
+// and results are not planned, MemoryPlanArena drops the plan at run time if
+// another kernel does so.
+const std::unordered_set<std::string> kAliasingOps = {
+    "pd_op.coalesce_tensor",
+    "pd_op.npu_identity",
+    "pd_op.onednn_to_paddle_layout",
+    "pd_op.shadow_feed",
+    "pd_op.shadow_feed_tensors",
+    "pd_op.transfer_layout",
+};
+
+int64_t AlignedSize(pir::Value value) {
+  auto type = value.type().dyn_cast<TensorType>();
+  if (!type) return 0;
+  int64_t numel = 1;
+  for (int i = 0; i < type.dims().size(); ++i) {
+    if (type.dims()[i] < 0) return 0;
+    numel *= type.dims()[i];
+  }
+  int64_t size =
+      numel * static_cast<int64_t>(phi::SizeOf(
+                  paddle::dialect::TransToPhiDataType(type.dtype())));
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+std::string UpperOpName(const pir::Operation& op) {
+  return op.attributes().at("op_name").dyn_cast<pir::StrAttribute>().AsString();
+}
+
+// The intermediate tensors of static shape produced by the kernel ops.
+bool IsCandidate(pir::Value value, const std::string& upper_op_name) {
+  if (!value.type() || !value.type().isa<TensorType>()) return false;
+  if (kExternalOps.count(upper_op_name)) return false;
+  auto persist_attr = value.attribute<pir::BoolAttribute>(kAttrIsPersistable);
+  if (persist_attr && persist_attr.data()) return false;
+  const auto& place = value.type().dyn_cast<TensorType>().place();
+  if (place.GetType() == phi::AllocationType::UNDEFINED) return false;
+  return AlignedSize(value) > 0;
+}
+
+// The tensors sharing one buffer because of inplace and view, and the span of
+// the op indices using it.
+struct Buffer {
+  std::vector<pir::Value> values;
+  int64_t size = 0;
+  size_t begin = std::numeric_limits<size_t>::max();
+  size_t end = 0;
+  int64_t offset = -1;
+};
+
+class MemoryPlanner {
+ public:
+  explicit MemoryPlanner(pir::Block* block) : block_(block) {
+    size_t index = 0;
+    for (auto& op : *block_) {
+      op_index_[&op] = index++;
+    }
+  }
+
+  std::string Plan() {
+    for (auto& op : *block_) {
+      Analyze(&op);
+    }
+    BuildBuffers();
+
+    std::stringstream log;
+    int64_t num_values = 0;
+    std::vector<std::pair<phi::Place, int64_t>> arenas;
+    for (auto& [place, buffers] : place_buffers_) {
+      int64_t arena_size = AssignOffsets(&buffers);
+      arenas.emplace_back(place, arena_size);
+      int64_t total_size = 0;
+      for (auto* buffer : buffers) {
+        total_size += buffer->size;
+        num_values += static_cast<int64_t>(buffer->values.size());
+      }
+      log << "--- memory planning on " << place << ": " << buffers.size()
+          << " buffers in an arena of " << arena_size
+          << " bytes, live peak with gc " << LivePeak(buffers)
+          << " bytes, without reuse " << total_size
+          << " bytes, allocator calls per run " << buffers.size() << " -> 0"
+          << "\n";
+    }
+    WriteAttributes(arenas);
+    std::string result = log.str();
+    if (!result.empty()) result.pop_back();
+    VLOG(3) << "memory planning: " << num_values << " tensors planned\n"
+            << result;
+    return result;
+  }
+
+ private:
+  // Visits the tensors a value stands for, the results of builtin.combine are
+  // the vectors of their inputs.
+  template <typename Fn>
+  void ForEachTensor(pir::Value value, const Fn& fn) {
+    if (!value) return;
+    auto* def_op = value.defining_op();
+    if (def_op && def_op->isa<pir::CombineOp>()) {
+      for (uint32_t i = 0; i < def_op->num_operands(); ++i) {
+        ForEachTensor(def_op->operand_source(i), fn);
+      }
+      return;
+    }
+    fn(value);
+  }
+
+  void Exclude(pir::Value value) {
+    ForEachTensor(value, [this](pir::Value v) { excluded_.insert(v); });
+  }
+
+  pir::Value Find(pir::Value value) {
+    auto it = parent_.find(value);
+    if (it == parent_.end()) {
+      parent_[value] = value;
+      return value;
+    }
+    if (it->second == value) return value;
+    pir::Value root = Find(it->second);
+    parent_[value] = root;
+    return root;
+  }
+
+  void Union(pir::Value lhs, pir::Value rhs) {
+    if (!lhs || !rhs) return;
+    parent_[Find(lhs)] = Find(rhs);
+  }
+
+  // The index of the top level op using the value, the last use of a value
+  // passed to builtin.combine is the last use of the vector.
+  size_t LastUse(pir::Value value) {
+    size_t last = op_index_.at(value.defining_op());
+    for (auto it = value.use_begin(); it != value.use_end(); ++it) {
+      auto* user = it->owner();
+      if (user->GetParent() != block_) continue;
+      if (user->isa<pir::CombineOp>()) {
+        last = std::max(last, LastUse(user->result(0)));
+      } else {
+        last = std::max(last, op_index_.at(user));
+      }
+    }
+    return last;
+  }
+
+  void Analyze(pir::Operation* op) {
+    // The values used in the nested blocks may be shared with the outputs of
+    // the control flow ops.
+    for (uint32_t i = 0; i < op->num_regions(); ++i) {
+      for (auto& block : op->region(i)) {
+        for (auto& nested_op : block) {
+          nested_op.Walk([this](pir::Operation* inner_op) {
+            for (uint32_t j = 0; j < inner_op->num_operands(); ++j) {
+              Exclude(inner_op->operand_source(j));
+            }
+          });
+        }
+      }
+    }
+
+    if (op->isa<pir::CombineOp>()) return;
+
+    if (op->dialect()->name() != paddle::dialect::KernelDialect::name() ||
+        !op->HasAttribute("op_name")) {
+      for (uint32_t i = 0; i < op->num_operands(); ++i) {
+        Exclude(op->operand_source(i));
+      }
+      return;
+    }
+
+    const std::string upper_op_name = UpperOpName(*op);
+    bool aliasing = kAliasingOps.count(upper_op_name) > 0;
+    bool escape_inputs = aliasing || upper_op_name == "pd_op.fetch";
+    for (uint32_t i = 0; i < op->num_results(); ++i) {
+      pir::Value result = op->result(i);
+      if (!result || !result.type()) continue;
+      if (!aliasing && IsCandidate(result, upper_op_name)) {
+        candidates_.push_back(result);
+      } else {
+        excluded_.insert(result);
+        // The inputs may be kept by the tensor arrays and other containers.
+        if (!result.type().isa<TensorType>()) escape_inputs = true;
+      }
+    }
+    if (escape_inputs) {
+      for (uint32_t i = 0; i < op->num_operands(); ++i) {
+        Exclude(op->operand_source(i));
+      }
+    }
+
+    pir::OpInfo op_info =
+        pir::IrContext::Instance()->GetRegisteredOpInfo(upper_op_name);
+    if (!op_info) return;
+    auto* yaml_interface =
+        op_info.GetInterfaceImpl<paddle::dialect::OpYamlInfoInterface>();
+    if (!yaml_interface) return;
+    paddle::dialect::OpYamlInfoParser parser(
+        yaml_interface->get_op_info_(upper_op_name),
+        paddle::dialect::IsLegacyOp(upper_op_name));
+    for (auto [out_slot, in_slot] : parser.GetInplaceIdMap()) {
+      if (out_slot < op->num_results() && in_slot < op->num_operands()) {
+        Union(op->result(out_slot), op->operand_source(in_slot));
+      }
+    }
+    for (const auto& out_name : parser.OutputNames()) {
+      if (!parser.HasView(out_name)) continue;
+      const auto& in_name = parser.ViewName(out_name);
+      uint32_t out_slot = parser.OutputName2Id().at(out_name);
+      uint32_t in_slot = parser.InputName2Id().at(in_name);
+      if (out_slot < op->num_results() && in_slot < op->num_operands()) {
+        Union(op->result(out_slot), op->operand_source(in_slot));
+      }
+    }
+  }
+
+  void BuildBuffers() {
+    std::unordered_set<pir::Value> candidate_set(candidates_.begin(),
+                                                 candidates_.end());
+    // An alias set is planned only if all of its tensors are candidates.
+    std::unordered_set<pir::Value> excluded_roots;
+    for (auto& [value, _] : parent_) {
+      if (!candidate_set.count(value) || excluded_.count(value)) {
+        excluded_roots.insert(Find(value));
+      }
+    }
+
+    std::unordered_map<pir::Value, Buffer*> root_buffers;
+    for (pir::Value value : candidates_) {
+      if (excluded_.count(value)) continue;
+      pir::Value root = Find(value);
+      if (excluded_roots.count(root)) continue;
+      auto it = root_buffers.find(root);
+      if (it == root_buffers.end()) {
+        buffers_.emplace_back(std::make_unique<Buffer>());
+        it = root_buffers.emplace(root, buffers_.back().get()).first;
+      }
+      Buffer* buffer = it->second;
+      buffer->values.push_back(value);
+      buffer->size = std::max(buffer->size, AlignedSize(value));
+      buffer->begin =
+          std::min(buffer->begin, op_index_.at(value.defining_op()));
+      buffer->end = std::max(buffer->end, LastUse(value));
+    }
+
+    for (auto& buffer : buffers_) {
+      const auto& place =
+          buffer->values.front().type().dyn_cast<TensorType>().place();
+      bool same_place = std::all_of(
+          buffer->values.begin(), buffer->values.end(), [&](pir::Value v) {
+            return v.type().dyn_cast<TensorType>().place() == place;
+          });
+      if (!same_place) continue;
+      auto it = std::find_if(place_buffers_.begin(),
+                             place_buffers_.end(),
+                             [&](const auto& item) {
+                               return item.first == place;
+                             });
+      if (it == place_buffers_.end()) {
+        place_buffers_.emplace_back(place, std::vector<Buffer*>{});
+        it = std::prev(place_buffers_.end());
+      }
+      it->second.push_back(buffer.get());
+    }
+  }
+
+  // Greedy by size: the largest buffers are placed first, each at the lowest
+  // offset of the smallest gap left by the placed buffers whose lifetimes
+  // overlap with it. Returns the size of the arena.
+  static int64_t AssignOffsets(std::vector<Buffer*>* buffers) {
+    std::stable_sort(
+        buffers->begin(), buffers->end(), [](const Buffer* a, const Buffer* b) {
+          return a->size > b->size;
+        });
+    std::vector<Buffer*> placed;
+    int64_t arena_size = 0;
+    for (Buffer* buffer : *buffers) {
+      std::vector<Buffer*> overlapped;
+      for (Buffer* other : placed) {
+        if (other->begin <= buffer->end && buffer->begin <= other->end) {
+          overlapped.push_back(other);
+        }
+      }
+      std::sort(overlapped.begin(),
+                overlapped.end(),
+                [](const Buffer* a, const Buffer* b) {
+                  return a->offset < b->offset;
+                });
+      int64_t best_offset = -1;
+      int64_t best_gap = std::numeric_limits<int64_t>::max();
+      int64_t prev_end = 0;
+      for (Buffer* other : overlapped) {
+        int64_t gap = other->offset - prev_end;
+        if (gap >= buffer->size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = prev_end;
+        }
+        prev_end = std::max(prev_end, other->offset + other->size);
+      }
+      buffer->offset = best_offset >= 0 ? best_offset : prev_end;
+      arena_size = std::max(arena_size, buffer->offset + buffer->size);
+      placed.push_back(buffer);
+    }
+    return arena_size;
+  }
+
+  // The peak of the live bytes when every tensor is allocated before its
+  // first use and freed after its last use, as the garbage collector does.
+  int64_t LivePeak(const std::vector<Buffer*>& buffers) const {
+    std::vector<int64_t> delta(op_index_.size() + 1, 0);
+    for (const Buffer* buffer : buffers) {
+      delta[buffer->begin] += buffer->size;
+      delta[buffer->end + 1] -= buffer->size;
+    }
+    int64_t live = 0, peak = 0;
+    for (int64_t d : delta) {
+      live += d;
+      peak = std::max(peak, live);
+    }
+    return peak;
+  }
+
+  void WriteAttributes(
+      const std::vector<std::pair<phi::Place, int64_t>>& arenas) {
+    pir::IrContext* ctx = pir::IrContext::Instance();
+    std::unordered_map<pir::Value, int64_t> offsets;
+    for (const auto& [_, buffers] : place_buffers_) {
+      for (const Buffer* buffer : buffers) {
+        for (pir::Value value : buffer->values) {
+          offsets[value] = buffer->offset;
+        }
+      }
+    }
+    for (auto& op : *block_) {
+      bool planned = false;
+      std::vector<pir::Attribute> op_offsets;
+      for (uint32_t i = 0; i < op.num_results(); ++i) {
+        auto it = offsets.find(op.result(i));
+        planned |= it != offsets.end();
+        op_offsets.push_back(pir::Int64Attribute::get(
+            ctx, it != offsets.end() ? it->second : -1));
+      }
+      if (planned) {
+        op.set_attribute(pir::kAttrMemoryPlanOffsets,
+                         pir::ArrayAttribute::get(ctx, op_offsets));
+      } else if (op.HasAttribute(pir::kAttrMemoryPlanOffsets)) {
+        op.erase_attribute(pir::kAttrMemoryPlanOffsets);
+      }
+    }
+
+    std::vector<pir::Attribute> arena_attrs;
+    for (const auto& [place, size] : arenas) {
+      arena_attrs.push_back(pir::ArrayAttribute::get(
+          ctx,
+          {paddle::dialect::PlaceAttribute::get(ctx, place),
+           pir::Int64Attribute::get(ctx, size)}));
+    }
+    block_->GetParentOp()->set_attribute(
+        pir::kAttrMemoryPlanArenas, pir::ArrayAttribute::get(ctx, arena_attrs));
+  }
+
+  pir::Block* block_;
+  std::unordered_map<const pir::Operation*, size_t> op_index_;
+  std::vector<pir::Value> candidates_;
+  std::unordered_set<pir::Value> excluded_;
+  std::unordered_map<pir::Value, pir::Value> parent_;
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+  std::vector<std::pair<phi::Place, std::vector<Buffer*>>> place_buffers_;
+};
+
+class MemoryPlanningPass : public pir::Pass {
+ public:
+  MemoryPlanningPass() : pir::Pass("memory_planning_pass", 3) {}
+
+  void Run(pir::Operation* op) override {
+    auto module_op = op->dyn_cast<pir::ModuleOp>();
+    PADDLE_ENFORCE_NOT_NULL(
+        module_op,
+        common::errors::InvalidArgument(
+            "memory_planning_pass should run on module op."));
+    MemoryPlanner planner(&module_op.block());
+    AddStatistics(planner.Plan());
+  }
+
+  bool CanApplyOn(pir::Operation* op) const override {
+    return op->isa<pir::ModuleOp>() && op->num_regions() > 0;
+  }
+};
+
+}  // namespace
+
+namespace pir {
+
+std::unique_ptr<pir::Pass> CreateMemoryPlanningPass() {
+  return std::make_unique<MemoryPlanningPass>();
+}
+
+}  // namespace pir
+
+REGISTER_IR_PASS(memory_planning_pass, MemoryPlanningPass);
@@ -0,0 +1,37 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "paddle/pir/include/core/dll_decl.h"
+
+namespace pir {
+
+class Pass;
+
+// The attribute of the kernel ops, the offset of each result in the arena of
+// its place, -1 if the result is not planned.
+constexpr char kAttrMemoryPlanOffsets[] = "memory_plan_offsets";
+// The attribute of the module op, an array of [place, arena size in bytes].
+constexpr char kAttrMemoryPlanArenas[] = "memory_plan_arenas";
+
+// Assigns the static shape intermediate tensors of the top level block to
+// offsets inside one arena per place, so that the tensors whose lifetimes do
+// not overlap in the order of the block share the memory. It should run after
+// inplace_pass, PirInterpreter binds the tensors to the offsets and runs the
+// block in order.
+std::unique_ptr<Pass> CreateMemoryPlanningPass();
+
+}  // namespace pir
@@ -1418,7 +1418,38 @@ void BindDistributed(py::module *m) {
             self.PrepareForBackward(params);
           },
           py::arg("tensors"),
-          py::call_guard<py::gil_scoped_release>());
+          py::call_guard<py::gil_scoped_release>())
+      .def("register_comm_hook",
+           &distributed::EagerReducer::RegisterCommHook,
+           py::arg("comm_hook"),
+           py::call_guard<py::gil_scoped_release>());
+
+  py::class_<distributed::CommHook, std::shared_ptr<distributed::CommHook>>(
+      *m, "CommHook")
+      .def("name", &distributed::CommHook::Name);
+
+  py::class_<distributed::CastCommHook,
+             distributed::CommHook,
+             std::shared_ptr<distributed::CastCommHook>>(*m, "CastCommHook")
+      .def(py::init([](py::handle py_dtype) {
+             auto comm_dtype =
+                 CastPyArg2DataType(py_dtype.ptr(), "CastCommHook", 0);
+             return std::make_shared<distributed::CastCommHook>(comm_dtype);
+           }),
+           py::arg("comm_dtype"));
+
+  py::class_<distributed::PowerSGDCommHook,
+             distributed::CommHook,
+             std::shared_ptr<distributed::PowerSGDCommHook>>(
+      *m, "PowerSGDCommHook")
+      .def(py::init<int, int>(),
+           py::arg("matrix_approximation_rank") = 1,
+           py::arg("start_iter") = 10);
+
+  py::class_<distributed::TopKCommHook,
+             distributed::CommHook,
+             std::shared_ptr<distributed::TopKCommHook>>(*m, "TopKCommHook")
+      .def(py::init<double>(), py::arg("ratio") = 0.01);
 
   py::class_<distributed::ProcessGroupIdMap,
              std::shared_ptr<distributed::ProcessGroupIdMap>>(
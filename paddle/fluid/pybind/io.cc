@@ -169,6 +169,13 @@ void BindIO(pybind11::module *m) {
          py::arg("overwrite") = true,
          py::arg("readable") = false,
          py::arg("trainable") = true);
+  m->def("serialize_pir_program_binary",
+         &pir::WriteModuleBinary,
+         py::arg("program"),
+         py::arg("file_path"),
+         py::arg("pir_version"),
+         py::arg("overwrite") = true,
+         py::arg("trainable") = true);
   m->def("deserialize_pir_program",
          &pir::ReadModule,
          py::arg("file_path"),
@@ -123,6 +123,7 @@ limitations under the License. */
 #include "paddle/fluid/pybind/pybind_variant_caster.h"
 #include "paddle/fluid/pybind/python_callable_registry.h"
 #include "paddle/fluid/pybind/xpu_streams_py.h"
+#include "paddle/phi/api/profiler/host_event_stream.h"
 #include "paddle/phi/backends/cpu/cpu_info.h"
 #include "paddle/phi/backends/device_manager.h"
 #include "paddle/phi/backends/dynload/dynamic_loader.h"
@@ -2980,6 +2981,29 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("disable_memory_recorder", &paddle::platform::DisableMemoryRecorder);
   m.def("enable_op_info_recorder", &phi::EnableOpInfoRecorder);
   m.def("disable_op_info_recorder", &phi::DisableOpInfoRecorder);
+  m.def(
+      "_start_host_event_streaming",
+      [](const std::string &path,
+         const std::string &format,
+         size_t ring_capacity,
+         uint32_t drain_interval_ms,
+         uint32_t trace_level) {
+        phi::HostEventStreamOptions options;
+        options.ring_capacity = ring_capacity;
+        options.drain_interval_ms = drain_interval_ms;
+        options.trace_level = trace_level;
+        phi::HostEventStreamer::GetInstance().Start(
+            phi::CreateHostEventStreamSink(path, format), options);
+      },
+      py::arg("path"),
+      py::arg("format") = "json",
+      py::arg("ring_capacity") = 1 << 14,
+      py::arg("drain_interval_ms") = 100,
+      py::arg("trace_level") = 2);
+  m.def(
+      "_stop_host_event_streaming",
+      []() { return phi::HostEventStreamer::GetInstance().Stop(); },
+      py::call_guard<py::gil_scoped_release>());
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   m.def("set_cublas_switch", phi::SetAllowTF32Cublas);
@@ -3178,6 +3202,10 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("clear_low_precision_op_list",
         [] { phi::KernelFactory::Instance().ClearLowPrecisionKernelList(); });
 
+  m.def("dump_executor_op_counters",
+        &framework::DumpExecutorOpCounters,
+        py::arg("format") = "json");
+
   m.def("enable_autotune", [] {
     return phi::autotune::AutoTuneStatus::Instance().EnableAutoTune();
   });
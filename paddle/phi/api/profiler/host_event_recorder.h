@@ -19,11 +19,14 @@
 #include <vector>
 
 #include "paddle/common/macros.h"
+#include "paddle/phi/api/profiler/host_event_stream.h"
 #include "paddle/phi/common/thread_data_registry.h"
 #include "paddle/phi/core/os_info.h"
 
 namespace phi {
 
+struct CommonEvent;
+
 template <typename HeadType, typename... RestTypes>
 struct ContainsStdString
     : std::conditional_t<
@@ -243,6 +246,14 @@ class HostEventRecorder {
   // It will cause deep-copy to harm performance.
   template <typename... Args>
   void RecordEvent(Args &&...args) {
+    if constexpr (std::is_same<EventType, CommonEvent>::value) {
+      // Keep nothing here while streaming, see HostEventStreamer.
+      if (UNLIKELY(HostEventStreamer::IsStreaming())) {
+        HostEventStreamer::GetInstance().RecordCommonEvent(
+            std::forward<Args>(args)...);
+        return;
+      }
+    }
     // Get thread local ThreadEventRecorder
     // If not exists, we create a new one.
     // Both HostEventRecorder and thread-local variable in
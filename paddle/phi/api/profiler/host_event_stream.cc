@@ -0,0 +1,424 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/api/profiler/host_event_stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/api/profiler/host_tracer.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/os_info.h"
+
+PHI_DECLARE_bool(enable_host_event_recorder_hook);
+
+namespace phi {
+
+namespace {
+
+// The events moved from a ring buffer to the sink at a time, 32 KB.
+constexpr size_t kDrainBatchSize = 256;
+
+uint64_t RoundUpToPowerOfTwo(size_t n) {
+  uint64_t power = 1;
+  while (power < n) power <<= 1;
+  return power;
+}
+
+const char *TracerEventTypeName(TracerEventType type) {
+  switch (type) {
+#define CASE_NAME(name)       \
+  case TracerEventType::name: \
+    return #name;
+    FOR_EACH_TRACER_EVENT_TYPES(CASE_NAME)
+#undef CASE_NAME
+    default:
+      return "Unknown";
+  }
+}
+
+void WriteJsonString(std::FILE *file, const char *str, size_t length) {
+  std::fputc('"', file);
+  for (size_t i = 0; i < length; ++i) {
+    const unsigned char c = static_cast<unsigned char>(str[i]);
+    if (c == '"' || c == '\\') {
+      std::fputc('\\', file);
+      std::fputc(c, file);
+    } else if (c < 0x20) {
+      std::fprintf(file, "\\u%04x", c);
+    } else {
+      std::fputc(c, file);
+    }
+  }
+  std::fputc('"', file);
+}
+
+// The timestamps of chrome tracing are in us, printed without going through
+// a double which can't hold an epoch time in ns.
+void WriteJsonMicroseconds(std::FILE *file, uint64_t ns) {
+  std::fprintf(file, "%" PRIu64 ".%03" PRIu64, ns / 1000, ns % 1000);
+}
+
+}  // namespace
+
+HostEventRingBuffer::HostEventRingBuffer(size_t capacity)
+    : events_(RoundUpToPowerOfTwo(std::max<size_t>(capacity, 1))),
+      mask_(events_.size() - 1) {}
+
+size_t HostEventRingBuffer::Pop(StreamedHostEvent *events, size_t max_num) {
+  const uint64_t tail = tail_.load(std::memory_order_relaxed);
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  const size_t num =
+      static_cast<size_t>(std::min<uint64_t>(head - tail, max_num));
+  for (size_t i = 0; i < num; ++i) {
+    events[i] = events_[(tail + i) & mask_];
+  }
+  tail_.store(tail + num, std::memory_order_release);
+  return num;
+}
+
+ChromeTraceStreamSink::ChromeTraceStreamSink(const std::string &path)
+    : file_(std::fopen(path.c_str(), "w")), process_id_(GetProcessId()) {
+  PADDLE_ENFORCE_NOT_NULL(
+      file_,
+      common::errors::Unavailable(
+          "Failed to open %s for the host event streaming.", path));
+  std::fputs("[\n", file_);
+}
+
+ChromeTraceStreamSink::~ChromeTraceStreamSink() {
+  if (file_ != nullptr) {
+    Close();
+  }
+}
+
+void ChromeTraceStreamSink::WriteSeparator() {
+  if (!is_first_) {
+    std::fputs(",\n", file_);
+  }
+  is_first_ = false;
+}
+
+void ChromeTraceStreamSink::WriteThreadName(uint64_t thread_id,
+                                            const std::string &thread_name) {
+  WriteSeparator();
+  std::fprintf(file_,
+               "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%" PRIu64
+               ",\"tid\":%" PRIu64 ",\"args\":{\"name\":",
+               process_id_,
+               thread_id);
+  WriteJsonString(file_, thread_name.data(), thread_name.size());
+  std::fputs("}}", file_);
+}
+
+void ChromeTraceStreamSink::WriteEvents(uint64_t thread_id,
+                                        const StreamedHostEvent *events,
+                                        size_t num_events) {
+  for (size_t i = 0; i < num_events; ++i) {
+    const StreamedHostEvent &event = events[i];
+    WriteSeparator();
+    std::fputs("{\"name\":", file_);
+    WriteJsonString(file_, event.name, event.name_length);
+    std::fprintf(file_,
+                 ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%" PRIu64
+                 ",\"tid\":%" PRIu64 ",\"ts\":",
+                 TracerEventTypeName(event.type),
+                 process_id_,
+                 thread_id);
+    WriteJsonMicroseconds(file_, event.start_ns);
+    std::fputs(",\"dur\":", file_);
+    WriteJsonMicroseconds(file_,
+                          event.end_ns > event.start_ns
+                              ? event.end_ns - event.start_ns
+                              : 0);
+    std::fputc('}', file_);
+  }
+}
+
+void ChromeTraceStreamSink::Flush() { std::fflush(file_); }
+
+void ChromeTraceStreamSink::Close() {
+  std::fputs("\n]\n", file_);
+  std::fclose(file_);
+  file_ = nullptr;
+}
+
+BinaryChunkStreamSink::BinaryChunkStreamSink(const std::string &path)
+    : file_(std::fopen(path.c_str(), "wb")) {
+  PADDLE_ENFORCE_NOT_NULL(
+      file_,
+      common::errors::Unavailable(
+          "Failed to open %s for the host event streaming.", path));
+  const uint64_t process_id = GetProcessId();
+  std::fwrite(kMagic, 1, sizeof(kMagic) - 1, file_);
+  std::fwrite(&process_id, sizeof(process_id), 1, file_);
+}
+
+BinaryChunkStreamSink::~BinaryChunkStreamSink() {
+  if (file_ != nullptr) {
+    Close();
+  }
+}
+
+void BinaryChunkStreamSink::WriteChunkHeader(ChunkKind kind,
+                                             uint32_t num,
+                                             uint64_t thread_id) {
+  const uint32_t chunk_kind = kind;
+  std::fwrite(&chunk_kind, sizeof(chunk_kind), 1, file_);
+  std::fwrite(&num, sizeof(num), 1, file_);
+  std::fwrite(&thread_id, sizeof(thread_id), 1, file_);
+}
+
+void BinaryChunkStreamSink::WriteThreadName(uint64_t thread_id,
+                                            const std::string &thread_name) {
+  WriteChunkHeader(
+      kThreadName, static_cast<uint32_t>(thread_name.size()), thread_id);
+  std::fwrite(thread_name.data(), 1, thread_name.size(), file_);
+}
+
+void BinaryChunkStreamSink::WriteEvents(uint64_t thread_id,
+                                        const StreamedHostEvent *events,
+                                        size_t num_events) {
+  WriteChunkHeader(kEvents, static_cast<uint32_t>(num_events), thread_id);
+  for (size_t i = 0; i < num_events; ++i) {
+    const StreamedHostEvent &event = events[i];
+    const uint32_t type = static_cast<uint32_t>(event.type);
+    std::fwrite(&event.start_ns, sizeof(event.start_ns), 1, file_);
+    std::fwrite(&event.end_ns, sizeof(event.end_ns), 1, file_);
+    std::fwrite(&type, sizeof(type), 1, file_);
+    std::fwrite(&event.name_length, sizeof(event.name_length), 1, file_);
+    std::fwrite(event.name, 1, event.name_length, file_);
+  }
+}
+
+void BinaryChunkStreamSink::Flush() { std::fflush(file_); }
+
+void BinaryChunkStreamSink::Close() {
+  std::fclose(file_);
+  file_ = nullptr;
+}
+
+std::unique_ptr<HostEventStreamSink> CreateHostEventStreamSink(
+    const std::string &path, const std::string &format) {
+  if (format == "json") {
+    return std::make_unique<ChromeTraceStreamSink>(path);
+  }
+  if (format == "binary") {
+    return std::make_unique<BinaryChunkStreamSink>(path);
+  }
+  PADDLE_THROW(common::errors::InvalidArgument(
+      "The format of the host event streaming should be json or binary, but "
+      "got %s.",
+      format));
+}
+
+struct HostEventStreamer::ThreadEventStream {
+  explicit ThreadEventStream(size_t ring_capacity)
+      : ring(ring_capacity),
+        thread_id(GetCurrentThreadSysId()),
+        thread_name(GetCurrentThreadName()) {}
+
+  HostEventRingBuffer ring;
+  uint64_t thread_id;
+  std::string thread_name;
+  // Only accessed by the drainer.
+  bool is_name_written = false;
+};
+
+std::atomic<bool> HostEventStreamer::streaming_{false};
+
+HostEventStreamer &HostEventStreamer::GetInstance() {
+  static HostEventStreamer instance;
+  return instance;
+}
+
+HostEventStreamer::~HostEventStreamer() { Stop(); }
+
+void HostEventStreamer::Start(std::unique_ptr<HostEventStreamSink> sink,
+                              const HostEventStreamOptions &options) {
+  PADDLE_ENFORCE_NOT_NULL(
+      sink,
+      common::errors::InvalidArgument(
+          "The sink of the host event streaming should not be null."));
+  PADDLE_ENFORCE_GT(options.ring_capacity,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The ring_capacity of the host event streaming should "
+                        "be greater than 0, but got %d.",
+                        options.ring_capacity));
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    PADDLE_ENFORCE_EQ(
+        stopped_,
+        true,
+        common::errors::PreconditionNotMet(
+            "The host event streaming has been started, stop it first."));
+    stopped_ = false;
+    options_ = options;
+    sink_ = std::move(sink);
+    streams_.clear();
+    retired_dropped_ = 0;
+    session_.fetch_add(1, std::memory_order_release);
+  }
+  drainer_ = std::thread([this] { DrainLoop(); });
+
+  prev_recorder_hook_ = FLAGS_enable_host_event_recorder_hook;
+  FLAGS_enable_host_event_recorder_hook = true;
+  HostTraceLevel::GetInstance().SetLevel(options.trace_level);
+  streaming_.store(true, std::memory_order_release);
+}
+
+uint64_t HostEventStreamer::Stop() {
+  if (!streaming_.exchange(false)) {
+    return 0;
+  }
+  FLAGS_enable_host_event_recorder_hook = prev_recorder_hook_;
+  HostTraceLevel::GetInstance().SetLevel(HostTraceLevel::kDisabled);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  drainer_.join();
+  // The events recorded before streaming_ was cleared.
+  Drain();
+
+  uint64_t dropped = retired_dropped_;
+  for (const auto &stream : streams_) {
+    dropped += stream->ring.dropped();
+  }
+  // A thread keeps its ring buffer until it exits or records in the next
+  // session.
+  streams_.clear();
+  sink_->Close();
+  sink_.reset();
+  if (dropped > 0) {
+    LOG(WARNING) << "The host event streaming dropped " << dropped
+                 << " events, increase the ring_capacity or decrease the "
+                    "drain_interval_ms to keep them.";
+  }
+  return dropped;
+}
+
+HostEventStreamer::ThreadEventStream *
+HostEventStreamer::GetThreadEventStream() {
+  struct LocalStream {
+    uint64_t session = 0;
+    std::shared_ptr<ThreadEventStream> stream;
+  };
+  thread_local LocalStream local;
+  if (UNLIKELY(local.session != session_.load(std::memory_order_acquire))) {
+    // The first event of this thread in the session.
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stopped_) {
+      return nullptr;
+    }
+    local.stream = std::make_shared<ThreadEventStream>(options_.ring_capacity);
+    local.session = session_.load(std::memory_order_relaxed);
+    streams_.push_back(local.stream);
+  }
+  return local.stream.get();
+}
+
+void HostEventStreamer::RecordCommonEvent(const char *name,
+                                          uint64_t start_ns,
+                                          uint64_t end_ns,
+                                          EventRole role UNUSED,
+                                          TracerEventType type) {
+  ThreadEventStream *stream = GetThreadEventStream();
+  if (stream != nullptr) {
+    stream->ring.Push(name, std::strlen(name), start_ns, end_ns, type);
+  }
+}
+
+void HostEventStreamer::RecordCommonEvent(const std::string &name,
+                                          uint64_t start_ns,
+                                          uint64_t end_ns,
+                                          EventRole role UNUSED,
+                                          TracerEventType type) {
+  ThreadEventStream *stream = GetThreadEventStream();
+  if (stream != nullptr) {
+    stream->ring.Push(name.data(), name.size(), start_ns, end_ns, type);
+  }
+}
+
+void HostEventStreamer::RecordCommonEvent(const std::string &name,
+                                          uint64_t start_ns,
+                                          uint64_t end_ns,
+                                          EventRole role,
+                                          TracerEventType type,
+                                          const std::string &attr UNUSED) {
+  // The attr is not exported to the trace, the same as HostTracer.
+  RecordCommonEvent(name, start_ns, end_ns, role, type);
+}
+
+void HostEventStreamer::DrainLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_) {
+    cv_.wait_for(lock,
+                 std::chrono::milliseconds(options_.drain_interval_ms),
+                 [this] { return stopped_; });
+    if (stopped_) {
+      break;
+    }
+    lock.unlock();
+    Drain();
+    lock.lock();
+  }
+}
+
+size_t HostEventStreamer::Drain() {
+  std::vector<std::shared_ptr<ThreadEventStream>> streams;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    streams = streams_;
+  }
+  std::vector<StreamedHostEvent> batch(kDrainBatchSize);
+  size_t num_drained = 0;
+  for (const auto &stream : streams) {
+    // Only the copies in streams_ and here are left once the thread exits.
+    const bool is_exited = stream.use_count() == 2;
+    if (!stream->is_name_written) {
+      if (stream->thread_name != kDefaultThreadName) {
+        sink_->WriteThreadName(stream->thread_id, stream->thread_name);
+      }
+      stream->is_name_written = true;
+    }
+    // Drain at most one ring of events so that a busy thread can't keep the
+    // drainer from the others.
+    size_t num_left = stream->ring.capacity();
+    while (num_left > 0) {
+      size_t num =
+          stream->ring.Pop(batch.data(), std::min(num_left, batch.size()));
+      if (num == 0) {
+        break;
+      }
+      sink_->WriteEvents(stream->thread_id, batch.data(), num);
+      num_left -= num;
+      num_drained += num;
+    }
+    if (is_exited) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      streams_.erase(std::find(streams_.begin(), streams_.end(), stream));
+      retired_dropped_ += stream->ring.dropped();
+    }
+  }
+  sink_->Flush();
+  return num_drained;
+}
+
+}  // namespace phi
@@ -0,0 +1,270 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "paddle/common/macros.h"
+#include "paddle/phi/api/profiler/event.h"
+#include "paddle/phi/api/profiler/trace_event.h"
+
+namespace phi {
+
+// A host event copied into the ring buffer of its thread. The name is inlined
+// so the event doesn't depend on the lifetime of the recorded string, longer
+// names are truncated.
+struct StreamedHostEvent {
+  static constexpr size_t kMaxNameLength = 103;
+
+  uint64_t start_ns;
+  uint64_t end_ns;
+  TracerEventType type;
+  uint32_t name_length;
+  char name[kMaxNameLength + 1];
+};
+static_assert(sizeof(StreamedHostEvent) == 128,
+              "sizeof StreamedHostEvent should be 128");
+
+// Single-producer single-consumer ring buffer of a fixed capacity. The
+// producer never blocks or allocates, an event pushed to a full buffer is
+// dropped and counted.
+class HostEventRingBuffer {
+ public:
+  // The capacity is rounded up to a power of 2.
+  explicit HostEventRingBuffer(size_t capacity);
+
+  DISABLE_COPY_AND_ASSIGN(HostEventRingBuffer);
+
+ public:
+  // Called by the producer thread only.
+  bool Push(const char *name,
+            size_t name_length,
+            uint64_t start_ns,
+            uint64_t end_ns,
+            TracerEventType type) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (UNLIKELY(head - tail_.load(std::memory_order_acquire) > mask_)) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    StreamedHostEvent &event = events_[head & mask_];
+    event.start_ns = start_ns;
+    event.end_ns = end_ns;
+    event.type = type;
+    event.name_length = static_cast<uint32_t>(
+        name_length < StreamedHostEvent::kMaxNameLength
+            ? name_length
+            : StreamedHostEvent::kMaxNameLength);
+    std::memcpy(event.name, name, event.name_length);
+    event.name[event.name_length] = '\0';
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Called by the consumer thread only. Moves at most max_num events to
+  // events and returns the number moved.
+  size_t Pop(StreamedHostEvent *events, size_t max_num);
+
+  size_t capacity() const { return mask_ + 1; }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  std::vector<StreamedHostEvent> events_;
+  const uint64_t mask_;
+  // The producer and the consumer write different cache lines.
+  alignas(64) std::atomic<uint64_t> head_{0};
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  alignas(64) std::atomic<uint64_t> dropped_{0};
+};
+
+// Where HostEventStreamer writes the drained events, called by the drainer
+// thread only.
+class HostEventStreamSink {
+ public:
+  virtual ~HostEventStreamSink() = default;
+
+  // Called once for each thread before its first events.
+  virtual void WriteThreadName(uint64_t thread_id,
+                               const std::string &thread_name) = 0;
+
+  virtual void WriteEvents(uint64_t thread_id,
+                           const StreamedHostEvent *events,
+                           size_t num_events) = 0;
+
+  // Called at the end of each drain.
+  virtual void Flush() = 0;
+
+  // Called once after the last events.
+  virtual void Close() = 0;
+};
+
+// Writes the events in the Chrome trace JSON array format. The closing
+// bracket is written by Close, chrome://tracing and Perfetto also load a
+// file without it, e.g. the one of a killed job.
+class ChromeTraceStreamSink : public HostEventStreamSink {
+ public:
+  explicit ChromeTraceStreamSink(const std::string &path);
+  ~ChromeTraceStreamSink() override;
+
+  void WriteThreadName(uint64_t thread_id,
+                       const std::string &thread_name) override;
+  void WriteEvents(uint64_t thread_id,
+                   const StreamedHostEvent *events,
+                   size_t num_events) override;
+  void Flush() override;
+  void Close() override;
+
+ private:
+  void WriteSeparator();
+
+  std::FILE *file_ = nullptr;
+  uint64_t process_id_;
+  bool is_first_ = true;
+};
+
+// Writes the events as binary chunks, the integers are in the host byte
+// order:
+//
+//   file    := "PDHEVT01" process_id:u64 chunk*
+//   chunk   := kind:u32 num:u32 thread_id:u64 payload
+//   payload := name_bytes[num]            if kind == kThreadName
+//            | event[num]                 if kind == kEvents
+//   event   := start_ns:u64 end_ns:u64 type:u32 name_length:u32
+//              name_bytes[name_length]
+class BinaryChunkStreamSink : public HostEventStreamSink {
+ public:
+  static constexpr char kMagic[9] = "PDHEVT01";
+  enum ChunkKind : uint32_t { kThreadName = 0, kEvents = 1 };
+
+  explicit BinaryChunkStreamSink(const std::string &path);
+  ~BinaryChunkStreamSink() override;
+
+  void WriteThreadName(uint64_t thread_id,
+                       const std::string &thread_name) override;
+  void WriteEvents(uint64_t thread_id,
+                   const StreamedHostEvent *events,
+                   size_t num_events) override;
+  void Flush() override;
+  void Close() override;
+
+ private:
+  void WriteChunkHeader(ChunkKind kind, uint32_t num, uint64_t thread_id);
+
+  std::FILE *file_ = nullptr;
+};
+
+// format is "json" for ChromeTraceStreamSink or "binary" for
+// BinaryChunkStreamSink.
+std::unique_ptr<HostEventStreamSink> CreateHostEventStreamSink(
+    const std::string &path, const std::string &format);
+
+struct HostEventStreamOptions {
+  // The events each thread buffers between two drains.
+  size_t ring_capacity = 1 << 14;
+  uint32_t drain_interval_ms = 100;
+  // Works like the trace_level of ProfilerOptions.
+  uint32_t trace_level = 2;
+};
+
+/**
+ * Streams the CommonEvents of HostEventRecorder to a sink instead of keeping
+ * them until the profiler stops, so that host tracing can stay on for a long
+ * running job with bounded memory.
+ *
+ * Each thread pushes its events to its own HostEventRingBuffer without any
+ * lock, and a drainer thread moves them to the sink every
+ * drain_interval_ms. The events of a thread that records faster than the
+ * drainer drains are dropped and counted rather than blocking the thread.
+ *
+ * The streaming shares the recorder hook with the Profiler, don't run both at
+ * the same time.
+ */
+class HostEventStreamer {
+ public:
+  // singleton
+  static HostEventStreamer &GetInstance();
+
+  static bool IsStreaming() {
+    return streaming_.load(std::memory_order_relaxed);
+  }
+
+  // Start and Stop are thread-unsafe, call them from one thread.
+  void Start(std::unique_ptr<HostEventStreamSink> sink,
+             const HostEventStreamOptions &options);
+
+  // Drains the remaining events and closes the sink. Returns the number of
+  // events dropped since Start.
+  uint64_t Stop();
+
+  // Overloads of the CommonEvent constructors, called by HostEventRecorder.
+  void RecordCommonEvent(const char *name,
+                         uint64_t start_ns,
+                         uint64_t end_ns,
+                         EventRole role,
+                         TracerEventType type);
+
+  void RecordCommonEvent(const std::string &name,
+                         uint64_t start_ns,
+                         uint64_t end_ns,
+                         EventRole role,
+                         TracerEventType type);
+
+  void RecordCommonEvent(const std::string &name,
+                         uint64_t start_ns,
+                         uint64_t end_ns,
+                         EventRole role,
+                         TracerEventType type,
+                         const std::string &attr);
+
+ private:
+  struct ThreadEventStream;
+
+  HostEventStreamer() = default;
+  ~HostEventStreamer();
+  DISABLE_COPY_AND_ASSIGN(HostEventStreamer);
+
+  ThreadEventStream *GetThreadEventStream();
+
+  void DrainLoop();
+
+  // Drains all threads once, returns the number of events drained.
+  size_t Drain();
+
+  static std::atomic<bool> streaming_;
+
+  // Bumped by Start to tell the threads to register a new stream.
+  std::atomic<uint64_t> session_{0};
+  HostEventStreamOptions options_;
+  std::unique_ptr<HostEventStreamSink> sink_;
+  std::mutex mutex_;  // guards streams_ and stopped_
+  std::condition_variable cv_;
+  bool stopped_ = true;
+  std::vector<std::shared_ptr<ThreadEventStream>> streams_;
+  std::thread drainer_;
+  // The events dropped by the threads exited since Start.
+  uint64_t retired_dropped_ = 0;
+  bool prev_recorder_hook_ = false;
+};
+
+}  // namespace phi
@@ -139,6 +139,57 @@ void GlooCommContext::Scatter(phi::DenseTensor* out_tensor,
   gloo::scatter(opts);
 }
 
+void GlooCommContext::AllToAll(phi::DenseTensor* out_tensor,
+                               const phi::DenseTensor& in_tensor,
+                               const std::vector<int64_t>& out_numel_each_rank,
+                               const std::vector<int64_t>& in_numel_each_rank,
+                               uint32_t tag) {
+  // The sizes of the blocks are checked by all_to_all, since the input and
+  // output can have different sizes, and either of them can be empty.
+  CommStaticCheck::CheckDataType(*out_tensor, in_tensor);
+  const auto DataOf = [](const phi::DenseTensor& tensor) -> void* {
+    if (tensor.numel() == 0) {
+      return nullptr;
+    }
+    CommStaticCheck::CheckPlace(tensor, phi::AllocationType::CPU);
+    return const_cast<void*>(tensor.data());
+  };
+  const size_t element_size = phi::SizeOf(in_tensor.dtype());
+  const auto ToBytes = [&](const std::vector<int64_t>& numel_each_rank) {
+    std::vector<size_t> bytes_each_rank;
+    bytes_each_rank.reserve(numel_each_rank.size());
+    for (int64_t numel : numel_each_rank) {
+      bytes_each_rank.push_back(numel * element_size);
+    }
+    return bytes_each_rank;
+  };
+  AllToAllOptions opts(gloo_context_);
+  opts.setInput(DataOf(in_tensor), ToBytes(in_numel_each_rank));
+  opts.setOutput(DataOf(*out_tensor), ToBytes(out_numel_each_rank));
+  opts.setTag(tag);
+  all_to_all(&opts);
+}
+
+void GlooCommContext::ReduceScatter(phi::DenseTensor* out_tensor,
+                                    const phi::DenseTensor& in_tensor,
+                                    int reduce_type,
+                                    uint32_t tag) {
+  // gloo only uses CPU now
+  CommStaticCheck::ScatterLikeShape(*out_tensor,
+                                    in_tensor,
+                                    /*dst_rank*/ rank_,
+                                    /*cur_rank*/ rank_,
+                                    size_,
+                                    phi::AllocationType::CPU);
+  RingReduceScatterOptions opts(gloo_context_);
+  const auto& dtype = in_tensor.dtype();
+  GENERATE_FUNC(dtype, SetInput, &opts, in_tensor);
+  GENERATE_FUNC(dtype, SetOutput, &opts, out_tensor);
+  GENERATE_FUNC(dtype, SetReduceFunc, &opts, reduce_type);
+  opts.setTag(tag);
+  reduce_scatter_ring(&opts);
+}
+
 void GlooCommContext::Barrier() {
   gloo::BarrierOptions opts(gloo_context_);
   gloo::barrier(opts);
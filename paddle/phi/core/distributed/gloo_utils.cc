@@ -23,8 +23,11 @@
 #include <array>
 #endif
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <utility>
 
 #include "paddle/common/errors.h"
 #include "paddle/phi/core/distributed/gloo_utils.h"
@@ -105,4 +108,197 @@ void send_recv(SendRecvOptions* opts) {
   }
 }
 
+namespace {
+
+// Calls fn(offset, nbytes) for the chunks of a message, returns the number of
+// the chunks.
+template <typename F>
+size_t ForEachChunk(size_t bytes, size_t chunk_bytes, const F& fn) {
+  size_t num_chunks = 0;
+  for (size_t offset = 0; offset < bytes; offset += chunk_bytes) {
+    fn(offset, std::min(chunk_bytes, bytes - offset));
+    ++num_chunks;
+  }
+  return num_chunks;
+}
+
+void MakeBlocks(const std::vector<size_t>& bytes_each_rank,
+                std::vector<size_t>* offsets,
+                std::vector<size_t>* bytes,
+                size_t* total_bytes) {
+  *bytes = bytes_each_rank;
+  offsets->resize(bytes_each_rank.size());
+  *total_bytes = 0;
+  for (size_t i = 0; i < bytes_each_rank.size(); ++i) {
+    (*offsets)[i] = *total_bytes;
+    *total_bytes += bytes_each_rank[i];
+  }
+}
+
+// At most kMaxInflightSteps peers of all_to_all are exchanging data at a time,
+// which keeps the links busy without posting the whole tensor at once.
+constexpr size_t kMaxInflightSteps = 4;
+
+}  // namespace
+
+void AllToAllOptions::setInput(void* ptr,
+                               const std::vector<size_t>& bytes_each_rank) {
+  size_t total_bytes = 0;
+  MakeBlocks(bytes_each_rank, &in_offsets, &in_bytes, &total_bytes);
+  this->in_ptr = reinterpret_cast<char*>(ptr);
+  this->in = context->createUnboundBuffer(ptr, total_bytes);
+}
+
+void AllToAllOptions::setOutput(void* ptr,
+                                const std::vector<size_t>& bytes_each_rank) {
+  size_t total_bytes = 0;
+  MakeBlocks(bytes_each_rank, &out_offsets, &out_bytes, &total_bytes);
+  this->out_ptr = reinterpret_cast<char*>(ptr);
+  this->out = context->createUnboundBuffer(ptr, total_bytes);
+}
+
+void all_to_all(AllToAllOptions* opts) {
+  const auto& context = opts->context;
+  const int rank = context->rank;
+  const int size = context->size;
+  PADDLE_ENFORCE_EQ(
+      opts->in_bytes.size() == static_cast<size_t>(size) &&
+          opts->out_bytes.size() == static_cast<size_t>(size),
+      true,
+      common::errors::InvalidArgument(
+          "The blocks of all_to_all must be given for each of the %d ranks.",
+          size));
+  PADDLE_ENFORCE_EQ(opts->in_bytes[rank],
+                    opts->out_bytes[rank],
+                    common::errors::InvalidArgument(
+                        "The block sent to rank %d itself has %d bytes, but "
+                        "the block received has %d bytes.",
+                        rank,
+                        opts->in_bytes[rank],
+                        opts->out_bytes[rank]));
+  if (opts->in_bytes[rank] > 0) {
+    std::memcpy(opts->out_ptr + opts->out_offsets[rank],
+                opts->in_ptr + opts->in_offsets[rank],
+                opts->in_bytes[rank]);
+  }
+  const auto slot = gloo::Slot::build(kAllToAllSlotPrefix, opts->tag);
+  const size_t chunk_bytes = std::max<size_t>(opts->chunk_bytes, 1);
+
+  // At step i, a rank sends to the rank i after it and receives from the rank
+  // i before it, so all the ranks talk to different peers at a time.
+  std::deque<std::pair<size_t, size_t>> inflight_steps;
+  const auto wait_step = [&]() {
+    const auto [num_sends, num_recvs] = inflight_steps.front();
+    inflight_steps.pop_front();
+    for (size_t i = 0; i < num_sends; ++i) {
+      opts->in->waitSend(opts->timeout);
+    }
+    for (size_t i = 0; i < num_recvs; ++i) {
+      opts->out->waitRecv(opts->timeout);
+    }
+  };
+  for (int step = 1; step < size; ++step) {
+    const int dst = (rank + step) % size;
+    const int src = (rank - step + size) % size;
+    const size_t num_recvs = ForEachChunk(
+        opts->out_bytes[src], chunk_bytes, [&](size_t offset, size_t nbytes) {
+          opts->out->recv(src, slot, opts->out_offsets[src] + offset, nbytes);
+        });
+    const size_t num_sends = ForEachChunk(
+        opts->in_bytes[dst], chunk_bytes, [&](size_t offset, size_t nbytes) {
+          opts->in->send(dst, slot, opts->in_offsets[dst] + offset, nbytes);
+        });
+    inflight_steps.emplace_back(num_sends, num_recvs);
+    if (inflight_steps.size() > kMaxInflightSteps) {
+      wait_step();
+    }
+  }
+  while (!inflight_steps.empty()) {
+    wait_step();
+  }
+}
+
+void reduce_scatter_ring(RingReduceScatterOptions* opts) {
+  const auto& context = opts->context;
+  const int rank = context->rank;
+  const int size = context->size;
+  const size_t block_bytes = opts->out_bytes;
+  PADDLE_ENFORCE_EQ(opts->in_bytes,
+                    block_bytes * size,
+                    common::errors::InvalidArgument(
+                        "The input of reduce_scatter must be %d times the "
+                        "size of the output, but got %d and %d bytes.",
+                        size,
+                        opts->in_bytes,
+                        block_bytes));
+  PADDLE_ENFORCE_NOT_NULL(
+      opts->reduce,
+      common::errors::InvalidArgument(
+          "The reduce function of reduce_scatter is not set."));
+  if (block_bytes == 0) return;
+  if (size == 1) {
+    std::memcpy(opts->out_ptr, opts->in_ptr, block_bytes);
+    return;
+  }
+
+  const auto slot = gloo::Slot::build(kReduceScatterSlotPrefix, opts->tag);
+  const size_t element_size = opts->element_size;
+  const size_t chunk_bytes =
+      std::max(element_size, opts->chunk_bytes / element_size * element_size);
+  const int right = (rank + 1) % size;
+  const int left = (rank - 1 + size) % size;
+
+  // The received partial result, and the partial results forwarded at the
+  // even and odd steps. A step writes the buffer to forward while the
+  // previous step is still sending the other one.
+  std::vector<char> recv_data(block_bytes);
+  std::vector<char> send_data[2] = {std::vector<char>(block_bytes),
+                                    std::vector<char>(block_bytes)};
+  auto recv_buffer =
+      context->createUnboundBuffer(recv_data.data(), block_bytes);
+  std::unique_ptr<gloo::transport::UnboundBuffer> send_buffers[2] = {
+      context->createUnboundBuffer(send_data[0].data(), block_bytes),
+      context->createUnboundBuffer(send_data[1].data(), block_bytes)};
+
+  // The partial result of block b starts at rank b + 1 and travels along the
+  // ring, each rank adds its own block b before forwarding it, so it reaches
+  // rank b complete after size - 1 steps.
+  const int first_block = (rank - 1 + size) % size;
+  size_t num_sends = ForEachChunk(
+      block_bytes, chunk_bytes, [&](size_t offset, size_t nbytes) {
+        opts->in->send(right, slot, first_block * block_bytes + offset, nbytes);
+      });
+  gloo::transport::UnboundBuffer* sending = opts->in.get();
+  for (int step = 0; step < size - 1; ++step) {
+    const bool is_last = step == size - 2;
+    const int block = ((rank - 2 - step) % size + size) % size;
+    const char* own = opts->in_ptr + block * block_bytes;
+    char* result = is_last ? opts->out_ptr : send_data[(step + 1) % 2].data();
+    gloo::transport::UnboundBuffer* forwarding =
+        is_last ? nullptr : send_buffers[(step + 1) % 2].get();
+
+    ForEachChunk(block_bytes, chunk_bytes, [&](size_t offset, size_t nbytes) {
+      recv_buffer->recv(left, slot, offset, nbytes);
+    });
+    // The chunks from the same rank arrive in order, each one is forwarded as
+    // soon as it is reduced.
+    const size_t num_forwards = ForEachChunk(
+        block_bytes, chunk_bytes, [&](size_t offset, size_t nbytes) {
+          recv_buffer->waitRecv(opts->timeout);
+          opts->reduce(result + offset,
+                       recv_data.data() + offset,
+                       own + offset,
+                       nbytes / element_size);
+          if (forwarding) {
+            forwarding->send(right, slot, offset, nbytes);
+          }
+        });
+    for (size_t i = 0; i < num_sends; ++i) {
+      sending->waitSend(opts->timeout);
+    }
+    sending = forwarding;
+    num_sends = is_last ? 0 : num_forwards;
+  }
+}
+
 }  // namespace phi::distributed
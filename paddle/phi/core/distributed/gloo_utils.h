@@ -22,6 +22,7 @@
 #include <climits>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "glog/logging.h"
 
@@ -208,5 +209,108 @@ class SendRecvOptions {
 
 void send_recv(SendRecvOptions* opts);
 
+constexpr uint8_t kAllToAllSlotPrefix = 0x09;
+constexpr uint8_t kReduceScatterSlotPrefix = 0x0a;
+
+// The messages of all_to_all and reduce_scatter_ring are split into chunks,
+// so the transfer of a chunk overlaps the reduction of the previous one.
+constexpr size_t kDefaultChunkBytes = 256 * 1024;
+
+class AllToAllOptions {
+ public:
+  explicit AllToAllOptions(const std::shared_ptr<gloo::Context>& context)
+      : context(context), timeout(context->getTimeout()) {}
+
+  // The block of rank i follows the blocks of the ranks before it.
+  void setInput(void* ptr, const std::vector<size_t>& bytes_each_rank);
+
+  void setOutput(void* ptr, const std::vector<size_t>& bytes_each_rank);
+
+  void setTag(uint32_t tag) { this->tag = tag; }
+
+  void setTimeout(std::chrono::milliseconds timeout) {
+    this->timeout = timeout;
+  }
+
+  void setChunkBytes(size_t chunk_bytes) { this->chunk_bytes = chunk_bytes; }
+
+ protected:
+  std::shared_ptr<gloo::Context> context;
+  std::unique_ptr<gloo::transport::UnboundBuffer> in;
+  std::unique_ptr<gloo::transport::UnboundBuffer> out;
+  char* in_ptr = nullptr;
+  char* out_ptr = nullptr;
+  std::vector<size_t> in_offsets;
+  std::vector<size_t> in_bytes;
+  std::vector<size_t> out_offsets;
+  std::vector<size_t> out_bytes;
+
+  uint32_t tag = 0;
+  std::chrono::milliseconds timeout;
+  size_t chunk_bytes = kDefaultChunkBytes;
+
+  friend void all_to_all(AllToAllOptions*);
+};
+
+// Sends the block i of the input to rank i, and receives the block i of the
+// output from rank i. Sizes of the blocks can differ, but the block sent to
+// a rank must match the block it receives.
+void all_to_all(AllToAllOptions* opts);
+
+class RingReduceScatterOptions {
+ public:
+  using Func = void (*)(void*, const void*, const void*, size_t);
+
+  explicit RingReduceScatterOptions(
+      const std::shared_ptr<gloo::Context>& context)
+      : context(context), timeout(context->getTimeout()) {}
+
+  // The input holds one block of the output size for each rank.
+  template <typename T>
+  void setInput(T* ptr, size_t elements) {
+    this->in_ptr = reinterpret_cast<char*>(ptr);
+    this->in_bytes = elements * sizeof(T);
+    this->in = context->createUnboundBuffer(ptr, in_bytes);
+  }
+
+  template <typename T>
+  void setOutput(T* ptr, size_t elements) {
+    this->out_ptr = reinterpret_cast<char*>(ptr);
+    this->out_bytes = elements * sizeof(T);
+    this->element_size = sizeof(T);
+  }
+
+  void setReduceFunction(Func fn) { this->reduce = fn; }
+
+  void setTag(uint32_t tag) { this->tag = tag; }
+
+  void setTimeout(std::chrono::milliseconds timeout) {
+    this->timeout = timeout;
+  }
+
+  void setChunkBytes(size_t chunk_bytes) { this->chunk_bytes = chunk_bytes; }
+
+ protected:
+  std::shared_ptr<gloo::Context> context;
+  std::unique_ptr<gloo::transport::UnboundBuffer> in;
+  char* in_ptr = nullptr;
+  size_t in_bytes = 0;
+  char* out_ptr = nullptr;
+  size_t out_bytes = 0;
+  size_t element_size = 1;
+  Func reduce = nullptr;
+
+  uint32_t tag = 0;
+  std::chrono::milliseconds timeout;
+  size_t chunk_bytes = kDefaultChunkBytes;
+
+  friend void reduce_scatter_ring(RingReduceScatterOptions*);
+};
+
+// Reduces the block i of the inputs of all ranks to the output of rank i
+// along a ring, so each rank sends and receives (size - 1) / size of the
+// input instead of the whole of it.
+void reduce_scatter_ring(RingReduceScatterOptions* opts);
+
 }  // namespace distributed
 }  // namespace phi
@@ -26,6 +26,7 @@
 #include "paddle/phi/core/memory/allocation/cpu_allocator.h"
 #include "paddle/phi/core/memory/allocation/naive_best_fit_allocator.h"
 #include "paddle/phi/core/memory/allocation/retry_allocator.h"
+#include "paddle/phi/core/memory/allocation/slab_allocator.h"
 #include "paddle/phi/core/memory/allocation/stat_allocator.h"
 #include "paddle/phi/core/platform/device_context.h"
 
@@ -242,8 +243,13 @@ class AllocatorFacadePrivate {
         break;
       }
 
-      case AllocatorStrategy::kAutoGrowth: {
-        InitNaiveBestFitCPUAllocator();
+      case AllocatorStrategy::kAutoGrowth:
+      case AllocatorStrategy::kAutoGrowthSlab: {
+        if (strategy_ == AllocatorStrategy::kAutoGrowthSlab) {
+          InitSlabCPUAllocator(allow_free_idle_chunk);
+        } else {
+          InitNaiveBestFitCPUAllocator();
+        }
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
         allow_free_idle_chunk_ = allow_free_idle_chunk;
         for (int dev_id = 0; dev_id < platform::GetGPUDeviceCount(); ++dev_id) {
@@ -831,6 +837,21 @@ class AllocatorFacadePrivate {
 #endif
   }
 
+  // Small CPU allocations are served from per-thread magazines, the rest goes
+  // to an auto-growth best-fit pool over the plain CPU allocator.
+  void InitSlabCPUAllocator(bool allow_free_idle_chunk) {
+    auto chunk_size = FLAGS_auto_growth_chunk_size_in_mb << 20;
+    VLOG(4) << "FLAGS_auto_growth_chunk_size_in_mb is "
+            << FLAGS_auto_growth_chunk_size_in_mb;
+    auto auto_growth_allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+        std::make_shared<CPUAllocator>(),
+        SlabAllocator::kMinSlabSize,
+        chunk_size,
+        allow_free_idle_chunk);
+    allocators_[phi::CPUPlace()] =
+        std::make_shared<SlabAllocator>(auto_growth_allocator);
+  }
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   void InitNaiveBestFitCUDAPinnedAllocator() {
     if (FLAGS_use_auto_growth_pinned_allocator) {
@@ -858,8 +879,8 @@ class AllocatorFacadePrivate {
   std::shared_ptr<Allocator> CreateCUDAAllocator(phi::GPUPlace p) {
     if (FLAGS_use_cuda_managed_memory) {
       PADDLE_ENFORCE_EQ(
-          strategy_,
-          AllocatorStrategy::kAutoGrowth,
+          IsAutoGrowthStrategy(strategy_),
+          true,
           common::errors::InvalidArgument(
               "CUDA managed memory is only implemented for auto_growth "
               "strategy, not support %s strategy.\n"
@@ -885,8 +906,8 @@ class AllocatorFacadePrivate {
 
   void InitCUDAAllocator(phi::GPUPlace p, gpuStream_t stream) {
     PADDLE_ENFORCE_EQ(
-        strategy_,
-        AllocatorStrategy::kAutoGrowth,
+        IsAutoGrowthStrategy(strategy_),
+        true,
         common::errors::Unimplemented(
             "Only support auto-growth strategy for StreamSafeCUDAAllocator, "
             "the allocator strategy %d is unsupported for multi-stream",
@@ -1266,8 +1287,8 @@ class AllocatorFacadePrivate {
 
   void InitStreamSafeXPUAllocator(phi::XPUPlace p, XPUStream stream) {
     PADDLE_ENFORCE_EQ(
-        strategy_,
-        AllocatorStrategy::kAutoGrowth,
+        IsAutoGrowthStrategy(strategy_),
+        true,
         common::errors::Unimplemented(
             "Only support auto-growth strategy for StreamSafeXPUAllocator, "
             "the allocator strategy %d is unsupported for multi-stream",
@@ -1375,8 +1396,8 @@ class AllocatorFacadePrivate {
   void InitStreamSafeCustomDeviceAllocator(phi::CustomPlace p,
                                            phi::stream::stream_t stream) {
     PADDLE_ENFORCE_EQ(
-        strategy_,
-        AllocatorStrategy::kAutoGrowth,
+        IsAutoGrowthStrategy(strategy_),
+        true,
         common::errors::Unimplemented(
             "Only support auto-growth strategy for "
             "StreamSafeCustomDeviceAllocator, "
@@ -1656,8 +1677,8 @@ const std::shared_ptr<Allocator>& AllocatorFacade::GetAutoGrowthAllocator(
 
 void* AllocatorFacade::GetBasePtr(
     const std::shared_ptr<phi::Allocation>& allocation) {
-  PADDLE_ENFORCE_EQ(GetAllocatorStrategy(),
-                    AllocatorStrategy::kAutoGrowth,
+  PADDLE_ENFORCE_EQ(IsAutoGrowthStrategy(GetAllocatorStrategy()),
+                    true,
                     common::errors::Unimplemented(
                         "GetBasePtr() is only implemented for auto_growth "
                         "strategy, not support allocator strategy: %d",
@@ -1835,8 +1856,8 @@ void AllocatorFacade::SetDefaultStream(const phi::GPUPlace& place,
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 void AllocatorFacade::PrepareMemoryPoolForCUDAGraph(int64_t id) {
-  PADDLE_ENFORCE_EQ(GetAllocatorStrategy(),
-                    AllocatorStrategy::kAutoGrowth,
+  PADDLE_ENFORCE_EQ(IsAutoGrowthStrategy(GetAllocatorStrategy()),
+                    true,
                     common::errors::InvalidArgument(
                         "CUDA Graph is only supported when the "
                         "FLAGS_allocator_strategy=\"auto_growth\", but got "
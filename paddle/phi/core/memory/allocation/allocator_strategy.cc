@@ -36,9 +36,13 @@ static AllocatorStrategy GetStrategyFromFlag() {
     return AllocatorStrategy::kThreadLocal;
   }
 
+  if (FLAGS_allocator_strategy == "auto_growth_slab") {
+    return AllocatorStrategy::kAutoGrowthSlab;
+  }
+
   PADDLE_THROW(common::errors::InvalidArgument(
       "Unsupported allocator strategy: %s, candidates are naive_best_fit, "
-      "auto_growth or thread_local.",
+      "auto_growth, auto_growth_slab or thread_local.",
       FLAGS_allocator_strategy));
 }
 
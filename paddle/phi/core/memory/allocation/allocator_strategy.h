@@ -19,10 +19,22 @@ namespace paddle {
 namespace memory {
 namespace allocation {
 
-enum class AllocatorStrategy { kNaiveBestFit, kAutoGrowth, kThreadLocal };
+// kAutoGrowthSlab is kAutoGrowth with a per-thread size-class slab cache in
+// front of the CPU allocator.
+enum class AllocatorStrategy {
+  kNaiveBestFit,
+  kAutoGrowth,
+  kThreadLocal,
+  kAutoGrowthSlab
+};
 
 extern AllocatorStrategy GetAllocatorStrategy();
 
+inline bool IsAutoGrowthStrategy(AllocatorStrategy strategy) {
+  return strategy == AllocatorStrategy::kAutoGrowth ||
+         strategy == AllocatorStrategy::kAutoGrowthSlab;
+}
+
 // Do nothing, just make sure linker do not prune this file.
 TEST_API void UseAllocatorStrategyGFlag();
 
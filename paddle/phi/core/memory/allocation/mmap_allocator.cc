@@ -18,6 +18,8 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <cstdlib>
 
 #include <atomic>
@@ -325,6 +327,42 @@ std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
   return std::make_shared<MemoryMapReaderAllocation>(ptr, size, ipc_name);
 }
 
+MemoryMapFileAllocation::~MemoryMapFileAllocation() {
+  if (this->size() > 0 && munmap(this->ptr(), this->size()) == -1) {
+    LOG(WARNING) << "could not unmap the file " << file_name_;
+  }
+  VLOG(3) << "~MemoryMapFileAllocation: " << file_name_;
+}
+
+std::shared_ptr<MemoryMapFileAllocation> AllocateMemoryMapFileAllocation(
+    const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_NE(
+      fd,
+      -1,
+      common::errors::Unavailable("Failed to open file %s.", file_name));
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    ::close(fd);
+    PADDLE_THROW(
+        common::errors::Unavailable("Failed to stat file %s.", file_name));
+  }
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  void *ptr = nullptr;
+  if (size > 0) {
+    // Writable but private, kernels and passes may modify the weights in
+    // place without touching the file.
+    ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+  PADDLE_ENFORCE_NE(
+      ptr,
+      MAP_FAILED,
+      common::errors::Unavailable("Memory map of file %s failed.", file_name));
+  VLOG(3) << "mmap file: " << file_name << " size: " << size;
+  return std::make_shared<MemoryMapFileAllocation>(ptr, size, file_name);
+}
+
 MemoryMapFdSet &MemoryMapFdSet::Instance() {  // NOLINT
   static MemoryMapFdSet set;
   return set;
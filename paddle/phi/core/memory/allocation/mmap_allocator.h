@@ -154,6 +154,29 @@ std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
     const std::string &ipc_name, size_t size);
 
+/* A read-only file mapped into memory, e.g. the model parameters of
+   inference. The mapping is private, pages are shared with the page cache of
+   all the processes mapping the same file until one of them writes to a page,
+   which then gets a private copy. */
+class MemoryMapFileAllocation : public Allocation {
+ public:
+  explicit MemoryMapFileAllocation(void *ptr,
+                                   size_t size,
+                                   std::string file_name)
+      : Allocation(ptr, size, phi::CPUPlace()),
+        file_name_(std::move(file_name)) {}
+
+  inline const std::string &file_name() const { return file_name_; }
+
+  ~MemoryMapFileAllocation() override;
+
+ private:
+  std::string file_name_;
+};
+
+std::shared_ptr<MemoryMapFileAllocation> AllocateMemoryMapFileAllocation(
+    const std::string &file_name);
+
 class MemoryMapFdSet {
  public:
   static MemoryMapFdSet &Instance();  // NOLINT
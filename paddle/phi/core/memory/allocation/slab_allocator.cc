@@ -0,0 +1,276 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation/slab_allocator.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/memory/allocation/spin_lock.h"
+#include "paddle/phi/core/memory/stats.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+namespace {
+
+using Magazine = std::vector<phi::Allocation*>;
+
+// Flush the thread local hit counter to the global stats every so often, the
+// miss path always flushes since it goes to the central depot anyway.
+constexpr uint64_t kStatFlushInterval = 1024;
+
+inline size_t SizeClassOf(size_t size) {
+  size_t cls = 0;
+  size_t class_size = SlabAllocator::kMinSlabSize;
+  while (class_size < size) {
+    class_size <<= 1;
+    ++cls;
+  }
+  return cls;
+}
+
+inline size_t SizeOfClass(size_t cls) {
+  return SlabAllocator::kMinSlabSize << cls;
+}
+
+}  // namespace
+
+// The state shared by a SlabAllocator and the thread caches that hold its
+// blocks. It is reference counted so that thread caches can outlive the
+// allocator and still return their blocks to the underlying allocator.
+class SlabAllocator::Central {
+ public:
+  explicit Central(std::shared_ptr<Allocator> underlying_allocator)
+      : underlying_allocator_(std::move(underlying_allocator)) {}
+
+  ~Central() { FreeDepot(); }
+
+  Allocator* underlying_allocator() { return underlying_allocator_.get(); }
+
+  // Fill an empty magazine, with a full one from the depot if there is one,
+  // otherwise with half a magazine of new blocks from the underlying
+  // allocator.
+  void Refill(size_t cls, Magazine* magazine) {
+    {
+      std::lock_guard<SpinLock> guard(depot_lock_);
+      auto& depot = depot_[cls];
+      if (!depot.empty()) {
+        magazine->swap(depot.back());
+        depot.pop_back();
+        return;
+      }
+    }
+    size_t class_size = SizeOfClass(cls);
+    for (size_t i = 0; i < kMagazineSize / 2; ++i) {
+      magazine->push_back(
+          underlying_allocator_->Allocate(class_size).release());
+    }
+  }
+
+  // Take a full magazine from a thread. It is kept in the depot for other
+  // threads, or returned to the underlying allocator if the depot is full.
+  void Drain(size_t cls, Magazine* magazine) {
+    Magazine full;
+    full.reserve(kMagazineSize);
+    full.swap(*magazine);
+    {
+      std::lock_guard<SpinLock> guard(depot_lock_);
+      auto& depot = depot_[cls];
+      if (depot.size() < kMaxDepotMagazines) {
+        depot.emplace_back(std::move(full));
+        return;
+      }
+    }
+    FreeBlocks(&full);
+  }
+
+  uint64_t FreeDepot() {
+    std::array<std::vector<Magazine>, kNumSizeClasses> depot;
+    {
+      std::lock_guard<SpinLock> guard(depot_lock_);
+      depot.swap(depot_);
+    }
+    uint64_t freed_size = 0;
+    for (size_t cls = 0; cls < kNumSizeClasses; ++cls) {
+      for (auto& magazine : depot[cls]) {
+        freed_size += magazine.size() * SizeOfClass(cls);
+        FreeBlocks(&magazine);
+      }
+    }
+    return freed_size;
+  }
+
+  void FreeBlocks(Magazine* magazine) {
+    for (phi::Allocation* block : *magazine) {
+      underlying_allocator_->Free(block);
+    }
+    magazine->clear();
+  }
+
+  void AddCounts(uint64_t hits, uint64_t misses) {
+    if (hits > 0) {
+      hit_count_.fetch_add(hits, std::memory_order_relaxed);
+      HOST_MEMORY_STAT_UPDATE(SlabHit, 0, static_cast<int64_t>(hits));
+    }
+    if (misses > 0) {
+      miss_count_.fetch_add(misses, std::memory_order_relaxed);
+      HOST_MEMORY_STAT_UPDATE(SlabMiss, 0, static_cast<int64_t>(misses));
+    }
+  }
+
+  uint64_t HitCount() const { return hit_count_.load(); }
+  uint64_t MissCount() const { return miss_count_.load(); }
+
+ private:
+  std::shared_ptr<Allocator> underlying_allocator_;
+  SpinLock depot_lock_;
+  std::array<std::vector<Magazine>, kNumSizeClasses> depot_;
+  std::atomic<uint64_t> hit_count_{0};
+  std::atomic<uint64_t> miss_count_{0};
+};
+
+namespace {
+
+// The magazines of one thread. A thread usually talks to a single
+// SlabAllocator (the CPU one), so a linear search is enough.
+class SlabThreadCache {
+ public:
+  struct Entry {
+    std::shared_ptr<SlabAllocator::Central> central;
+    std::array<Magazine, SlabAllocator::kNumSizeClasses> magazines;
+    uint64_t pending_hits{0};
+  };
+
+  ~SlabThreadCache() {
+    // NOTE: the stats may be destructed before the thread local cache at
+    // exit, so the pending counters are dropped here.
+    for (auto& entry : entries_) {
+      for (auto& magazine : entry.magazines) {
+        entry.central->FreeBlocks(&magazine);
+      }
+    }
+  }
+
+  Entry* Get(const std::shared_ptr<SlabAllocator::Central>& central) {
+    for (auto& entry : entries_) {
+      if (entry.central == central) {
+        return &entry;
+      }
+    }
+    entries_.emplace_back();
+    Entry* entry = &entries_.back();
+    entry->central = central;
+    for (auto& magazine : entry->magazines) {
+      magazine.reserve(SlabAllocator::kMagazineSize);
+    }
+    return entry;
+  }
+
+ private:
+  std::vector<Entry> entries_;
+};
+
+SlabThreadCache::Entry* GetThreadCache(
+    const std::shared_ptr<SlabAllocator::Central>& central) {
+  static thread_local SlabThreadCache cache;
+  return cache.Get(central);
+}
+
+}  // namespace
+
+SlabAllocator::SlabAllocator(std::shared_ptr<Allocator> underlying_allocator)
+    : central_(std::make_shared<Central>(std::move(underlying_allocator))) {
+  PADDLE_ENFORCE_NOT_NULL(
+      central_->underlying_allocator(),
+      common::errors::InvalidArgument(
+          "Underlying allocator of SlabAllocator must not be null."));
+  PADDLE_ENFORCE_EQ(
+      central_->underlying_allocator()->IsAllocThreadSafe(),
+      true,
+      common::errors::InvalidArgument(
+          "Underlying allocator of SlabAllocator must be thread safe."));
+}
+
+SlabAllocator::~SlabAllocator() = default;
+
+uint64_t SlabAllocator::HitCount() const { return central_->HitCount(); }
+
+uint64_t SlabAllocator::MissCount() const { return central_->MissCount(); }
+
+phi::Allocation* SlabAllocator::AllocateImpl(size_t size) {
+  if (size > kMaxSlabSize) {
+    return central_->underlying_allocator()->Allocate(size).release();
+  }
+  size_t cls = SizeClassOf(size);
+  auto* cache = GetThreadCache(central_);
+  Magazine& magazine = cache->magazines[cls];
+  if (LIKELY(!magazine.empty())) {
+    if (++cache->pending_hits == kStatFlushInterval) {
+      central_->AddCounts(cache->pending_hits, 0);
+      cache->pending_hits = 0;
+    }
+  } else {
+    central_->Refill(cls, &magazine);
+    central_->AddCounts(cache->pending_hits, 1);
+    cache->pending_hits = 0;
+  }
+  phi::Allocation* block = magazine.back();
+  magazine.pop_back();
+  return block;
+}
+
+void SlabAllocator::FreeImpl(phi::Allocation* allocation) {
+  if (allocation->size() > kMaxSlabSize) {
+    central_->underlying_allocator()->Free(allocation);
+    return;
+  }
+  // Blocks are allocated with the exact class size, the largest class that
+  // fits also tolerates an underlying allocator that rounds sizes up.
+  size_t cls = SizeClassOf(allocation->size());
+  if (SizeOfClass(cls) > allocation->size()) {
+    --cls;
+  }
+  auto* cache = GetThreadCache(central_);
+  Magazine& magazine = cache->magazines[cls];
+  if (UNLIKELY(magazine.size() == kMagazineSize)) {
+    central_->Drain(cls, &magazine);
+  }
+  magazine.push_back(allocation);
+}
+
+uint64_t SlabAllocator::ReleaseImpl(const phi::Place& place) {
+  // Only the calling thread's magazines can be drained safely, blocks cached
+  // by other threads stay there until they are reused or the thread exits.
+  auto* cache = GetThreadCache(central_);
+  central_->AddCounts(cache->pending_hits, 0);
+  cache->pending_hits = 0;
+  uint64_t released_size = 0;
+  for (size_t cls = 0; cls < kNumSizeClasses; ++cls) {
+    released_size += cache->magazines[cls].size() * SizeOfClass(cls);
+    central_->FreeBlocks(&cache->magazines[cls]);
+  }
+  released_size += central_->FreeDepot();
+  VLOG(10) << "SlabAllocator returns " << released_size
+           << " bytes to the underlying allocator";
+  return central_->underlying_allocator()->Release(place);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,73 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+#include "paddle/phi/core/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// SlabAllocator is a size-class front-end for a thread safe allocator
+// (usually AutoGrowthBestFitAllocator on CPU).
+//
+// Requests no larger than kMaxSlabSize are rounded up to a power-of-two size
+// class and served from a per-thread magazine without any lock. Freed blocks
+// go back to the magazine of the freeing thread. Full or empty magazines are
+// exchanged with a central depot in one locked operation, so the underlying
+// allocator is only reached once per magazine instead of once per block.
+// Larger requests are forwarded to the underlying allocator directly.
+//
+// Magazine hits and misses are reported as the "SlabHit" and "SlabMiss" host
+// memory stats.
+class SlabAllocator : public Allocator {
+ public:
+  static constexpr size_t kMinSlabSize = 64;
+  static constexpr size_t kMaxSlabSize = 4096;
+  static constexpr size_t kNumSizeClasses = 7;  // 64B, 128B, ..., 4KB
+  static constexpr size_t kMagazineSize = 64;
+  static constexpr size_t kMaxDepotMagazines = 16;
+
+  explicit SlabAllocator(std::shared_ptr<Allocator> underlying_allocator);
+
+  ~SlabAllocator() override;
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // The number of allocations served from / missed by the thread magazines,
+  // summed over all threads that have flushed their counters.
+  uint64_t HitCount() const;
+  uint64_t MissCount() const;
+
+  // The depot and counters shared with the thread caches, defined in
+  // slab_allocator.cc.
+  class Central;
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+
+  void FreeImpl(phi::Allocation* allocation) override;
+
+  uint64_t ReleaseImpl(const phi::Place& place) override;
+
+ private:
+  std::shared_ptr<Central> central_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
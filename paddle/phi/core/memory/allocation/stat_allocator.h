@@ -39,6 +39,8 @@ class StatAllocator : public Allocator {
       DEVICE_MEMORY_STAT_UPDATE(
           Allocated, allocation->place().GetDeviceId(), -allocation->size());
     }
+    CurrentThreadAllocFreeBytes(allocation->place())->freed +=
+        allocation->size();
     platform::RecordMemEvent(allocation->ptr(),
                              allocation->place(),
                              allocation->size(),
@@ -58,6 +60,7 @@ class StatAllocator : public Allocator {
       DEVICE_MEMORY_STAT_UPDATE(
           Allocated, place.GetDeviceId(), allocation->size());
     }
+    CurrentThreadAllocFreeBytes(place)->allocated += allocation->size();
     platform::RecordMemEvent(allocation->ptr(),
                              allocation->place(),
                              allocation->size(),
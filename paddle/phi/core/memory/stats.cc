@@ -14,6 +14,9 @@ limitations under the License. */
 
 #include "paddle/phi/core/memory/stats.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "paddle/common/flags.h"
 #include "paddle/common/macros.h"
 #include "paddle/phi/core/memory/allocation/spin_lock.h"
@@ -134,6 +137,23 @@ void LogDeviceMemoryStats(const phi::Place& place, const std::string& op_name) {
   }
 }
 
+ThreadAllocFreeBytes* CurrentThreadAllocFreeBytes(const phi::Place& place) {
+  struct Counters {
+    ThreadAllocFreeBytes host;
+    // Indexed by the device id.
+    std::vector<ThreadAllocFreeBytes> devices;
+  };
+  thread_local Counters counters;
+  if (phi::is_cpu_place(place) || phi::is_cuda_pinned_place(place)) {
+    return &counters.host;
+  }
+  size_t dev_id = std::max(place.GetDeviceId(), 0);
+  if (dev_id >= counters.devices.size()) {
+    counters.devices.resize(dev_id + 1);
+  }
+  return &counters.devices[dev_id];
+}
+
 #define DEVICE_MEMORY_STAT_REGISTER_WITH_ID(item, id) \
   StatRegistry::GetInstance()->Register(              \
       "Device" #item, id, Stat<DeviceMemoryStat##item##id>::GetInstance());
@@ -166,6 +186,8 @@ int RegisterAllStats() {
 
   HOST_MEMORY_STAT_REGISTER(Allocated);
   HOST_MEMORY_STAT_REGISTER(Reserved);
+  HOST_MEMORY_STAT_REGISTER(SlabHit);
+  HOST_MEMORY_STAT_REGISTER(SlabMiss);
   return 0;
 }
 
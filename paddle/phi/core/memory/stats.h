@@ -137,6 +137,17 @@ void HostMemoryStatUpdate(const std::string& stat_type,
 
 void LogDeviceMemoryStats(const phi::Place& place, const std::string& op_name);
 
+// The bytes allocated and freed through StatAllocator by the calling thread
+// on one place. They are counted apart, unlike the Allocated stat, so that the
+// frees of a span of code do not cancel its allocations.
+struct ThreadAllocFreeBytes {
+  int64_t allocated{0};
+  int64_t freed{0};
+};
+
+// The counters of the calling thread for the place, the host places share one.
+ThreadAllocFreeBytes* CurrentThreadAllocFreeBytes(const phi::Place& place);
+
 #define DEVICE_MEMORY_STAT_FUNC_SWITCH_CASE(item, id)               \
   case id:                                                          \
     stat = paddle::memory::Stat<                                    \
@@ -231,6 +242,10 @@ DEVICE_MEMORY_STAT_DECLARE(Reserved);
 
 HOST_MEMORY_STAT_DECLARE(Allocated);
 HOST_MEMORY_STAT_DECLARE(Reserved);
+// Number of small host allocations served from / missed by the per-thread
+// magazines of SlabAllocator.
+HOST_MEMORY_STAT_DECLARE(SlabHit);
+HOST_MEMORY_STAT_DECLARE(SlabMiss);
 
 }  // namespace memory
 }  // namespace paddle
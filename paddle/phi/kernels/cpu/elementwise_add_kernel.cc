@@ -34,15 +34,8 @@ void AddFunctor(const Context& dev_ctx,
     SameDimsElementwiseCompute<SameDimsAddFunctor<CPUContext, T>>()(
         dev_ctx, x, y, out);
   } else {
-    auto x_dims = x.dims();
-    auto y_dims = y.dims();
-    if (x_dims.size() >= y_dims.size()) {
-      funcs::ElementwiseCompute<funcs::AddFunctor<T>, T>(
-          dev_ctx, x, y, funcs::AddFunctor<T>(), out, axis);
-    } else {
-      funcs::ElementwiseCompute<funcs::InverseAddFunctor<T>, T>(
-          dev_ctx, x, y, funcs::InverseAddFunctor<T>(), out, axis);
-    }
+    funcs::CPUBroadcastCompute<funcs::AddFunctor<T>, T>(
+        dev_ctx, x, y, funcs::AddFunctor<T>(), out, axis);
   }
 }
 
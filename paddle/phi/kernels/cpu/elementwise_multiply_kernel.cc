@@ -32,15 +32,8 @@ void MultiplyKernel(const Context& dev_ctx,
     SameDimsElementwiseCompute<SameDimsMultiplyFunctor<CPUContext, T>>()(
         dev_ctx, x, y, out);
   } else {
-    auto x_dims = x.dims();
-    auto y_dims = y.dims();
-    if (x_dims.size() >= y_dims.size()) {
-      funcs::ElementwiseCompute<funcs::MultiplyFunctor<T>, T>(
-          dev_ctx, x, y, funcs::MultiplyFunctor<T>(), out, -1);
-    } else {
-      funcs::ElementwiseCompute<funcs::InverseMultiplyFunctor<T>, T>(
-          dev_ctx, x, y, funcs::InverseMultiplyFunctor<T>(), out, -1);
-    }
+    funcs::CPUBroadcastCompute<funcs::MultiplyFunctor<T>, T>(
+        dev_ctx, x, y, funcs::MultiplyFunctor<T>(), out, -1);
   }
 }
 
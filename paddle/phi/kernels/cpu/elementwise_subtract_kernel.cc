@@ -32,15 +32,8 @@ void SubtractKernel(const Context& dev_ctx,
     SameDimsElementwiseCompute<SameDimsSubtractFunctor<CPUContext, T>>()(
         dev_ctx, x, y, out);
   } else {
-    auto x_dims = x.dims();
-    auto y_dims = y.dims();
-    if (x_dims.size() >= y_dims.size()) {
-      funcs::ElementwiseCompute<funcs::SubtractFunctor<T>, T>(
-          dev_ctx, x, y, funcs::SubtractFunctor<T>(), out, -1);
-    } else {
-      funcs::ElementwiseCompute<funcs::InverseSubtractFunctor<T>, T>(
-          dev_ctx, x, y, funcs::InverseSubtractFunctor<T>(), out, -1);
-    }
+    funcs::CPUBroadcastCompute<funcs::SubtractFunctor<T>, T>(
+        dev_ctx, x, y, funcs::SubtractFunctor<T>(), out, -1);
   }
 }
 }  // namespace phi
@@ -0,0 +1,240 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/funcs/dims_simplifier.h"
+#include "paddle/phi/kernels/funcs/elementwise_utils.h"
+
+namespace phi {
+namespace funcs {
+
+/*
+ * CPU binary elementwise computation with broadcast on both sides.
+ *
+ * The dims of x, y and out are first merged by BroadcastDimsSimplifier, e.g.
+ * [N, C, H, W] + [C, 1, 1] becomes [N, C, H * W] + [1, C, 1]. The output is
+ * then computed row by row along the innermost merged dim, where each input
+ * is either contiguous or a scalar broadcast along the row, so that the inner
+ * loops are plain unit-stride loops the compiler vectorizes. The offsets of
+ * the rows are computed with the rank known at compile time for the common
+ * ranks, and the rows run in parallel on large outputs.
+ *
+ * Unlike ElementwiseCompute, y may be broadcast to x and x to y alike, so
+ * there is no need for the InverseXxxFunctor.
+ */
+namespace cpu_broadcast {
+
+constexpr int kMaxRank = phi::DDim::kMaxRank;
+// Below this output size the rows are not worth spreading over threads.
+constexpr int64_t kParallelNumel = 1 << 16;
+
+enum class RowPattern { kContiguous, kXScalar, kYScalar, kBothScalar };
+
+template <RowPattern Pattern, typename Functor, typename T, typename OutType>
+inline void ComputeRow(
+    const T* x, const T* y, OutType* out, int64_t n, Functor func) {
+  if (Pattern == RowPattern::kContiguous) {
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = func(x[i], y[i]);
+    }
+  } else if (Pattern == RowPattern::kXScalar) {
+    const T x_value = *x;
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = func(x_value, y[i]);
+    }
+  } else if (Pattern == RowPattern::kYScalar) {
+    const T y_value = *y;
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = func(x[i], y_value);
+    }
+  } else {
+    const OutType value = func(*x, *y);
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = value;
+    }
+  }
+}
+
+// Dims are ordered from the innermost, dims[0] is the row.
+struct BroadcastPlan {
+  int rank;
+  std::array<int64_t, kMaxRank> out_dims;
+  std::array<int64_t, kMaxRank> x_strides;
+  std::array<int64_t, kMaxRank> y_strides;
+};
+
+// Rank is the rank of the plan, or 0 if it is only known at runtime.
+template <int Rank,
+          RowPattern Pattern,
+          typename Functor,
+          typename T,
+          typename OutType>
+void ComputeRows(const BroadcastPlan& plan,
+                 const T* x,
+                 const T* y,
+                 OutType* out,
+                 Functor func) {
+  const int rank = Rank > 0 ? Rank : plan.rank;
+  const int64_t row_size = plan.out_dims[0];
+  int64_t rows = 1;
+  for (int k = 1; k < rank; ++k) {
+    rows *= plan.out_dims[k];
+  }
+#ifdef PADDLE_WITH_MKLML
+  // The integer functors enforce on the divisor, which cannot be thrown out
+  // of a parallel region.
+  const bool parallel =
+      !std::is_integral<T>::value && rows * row_size >= kParallelNumel;
+#pragma omp parallel for if (parallel)
+#endif
+  for (int64_t row = 0; row < rows; ++row) {
+    int64_t x_offset = 0;
+    int64_t y_offset = 0;
+    int64_t index = row;
+    for (int k = 1; k < rank; ++k) {
+      int64_t dim_index = index % plan.out_dims[k];
+      index /= plan.out_dims[k];
+      x_offset += dim_index * plan.x_strides[k];
+      y_offset += dim_index * plan.y_strides[k];
+    }
+    ComputeRow<Pattern, Functor, T, OutType>(
+        x + x_offset, y + y_offset, out + row * row_size, row_size, func);
+  }
+}
+
+template <RowPattern Pattern, typename Functor, typename T, typename OutType>
+void DispatchRank(const BroadcastPlan& plan,
+                  const T* x,
+                  const T* y,
+                  OutType* out,
+                  Functor func) {
+  switch (plan.rank) {
+    case 1:
+      ComputeRows<1, Pattern>(plan, x, y, out, func);
+      break;
+    case 2:
+      ComputeRows<2, Pattern>(plan, x, y, out, func);
+      break;
+    case 3:
+      ComputeRows<3, Pattern>(plan, x, y, out, func);
+      break;
+    case 4:
+      ComputeRows<4, Pattern>(plan, x, y, out, func);
+      break;
+    default:
+      ComputeRows<0, Pattern>(plan, x, y, out, func);
+      break;
+  }
+}
+
+// Builds the plan from the dims merged by BroadcastDimsSimplifier, which are
+// already ordered from the innermost. 0-D outputs are a single row of 1.
+inline BroadcastPlan MakeBroadcastPlan(
+    const BroadcastDimsSimplifier& simplifier) {
+  BroadcastPlan plan;
+  plan.rank = simplifier.rank;
+  if (plan.rank == 0) {
+    plan.rank = 1;
+    plan.out_dims[0] = 1;
+    plan.x_strides[0] = 0;
+    plan.y_strides[0] = 0;
+    return plan;
+  }
+  int64_t x_stride = 1;
+  int64_t y_stride = 1;
+  for (int k = 0; k < plan.rank; ++k) {
+    int64_t x_dim = simplifier.in_dims[0][k];
+    int64_t y_dim = simplifier.in_dims[1][k];
+    plan.out_dims[k] = simplifier.out_dims[k];
+    plan.x_strides[k] = x_dim == 1 ? 0 : x_stride;
+    plan.y_strides[k] = y_dim == 1 ? 0 : y_stride;
+    x_stride *= x_dim;
+    y_stride *= y_dim;
+  }
+  return plan;
+}
+
+}  // namespace cpu_broadcast
+
+// Computes z = func(x, y) with broadcast, axis is the same as in
+// ElementwiseCompute.
+template <typename Functor, typename T, typename OutType = T>
+void CPUBroadcastCompute(const CPUContext& dev_ctx,
+                         const DenseTensor& x,
+                         const DenseTensor& y,
+                         Functor func,
+                         DenseTensor* z,
+                         int axis = -1) {
+  using cpu_broadcast::RowPattern;
+  OutType* out_data = dev_ctx.Alloc<OutType>(z);
+  if (z->numel() == 0) {
+    return;
+  }
+  const T* x_data = x.data<T>();
+  const T* y_data = y.data<T>();
+  const int max_dim = std::max(x.dims().size(), y.dims().size());
+  axis = axis == -1 ? std::abs(x.dims().size() - y.dims().size()) : axis;
+  PADDLE_ENFORCE_GE(
+      axis,
+      0,
+      errors::InvalidArgument(
+          "Axis should be great than or equal to 0, but received axis is %d.",
+          axis));
+  PADDLE_ENFORCE_LE(
+      axis,
+      max_dim,
+      errors::InvalidArgument(
+          "Axis should be less than or equal to %d, but received axis is %d.",
+          max_dim,
+          axis));
+
+  // As in ElementwiseCompute, the trailing 1s of the smaller input may run
+  // past the output dims, e.g. [2, 3, 4] and [3, 4, 1] with axis = 1.
+  DenseTensor x_trimmed(x), y_trimmed(y);
+  DenseTensor* smaller =
+      x.dims().size() < y.dims().size() ? &x_trimmed : &y_trimmed;
+  if (axis + smaller->dims().size() > max_dim) {
+    smaller->Resize(TrimTrailingSingularDims(smaller->dims()));
+  }
+  BroadcastDimsSimplifier simplifier({&x_trimmed, &y_trimmed}, z->dims(), axis);
+  auto plan = cpu_broadcast::MakeBroadcastPlan(simplifier);
+
+  const bool x_row = plan.x_strides[0] != 0;
+  const bool y_row = plan.y_strides[0] != 0;
+  if (x_row && y_row) {
+    cpu_broadcast::DispatchRank<RowPattern::kContiguous>(
+        plan, x_data, y_data, out_data, func);
+  } else if (y_row) {
+    cpu_broadcast::DispatchRank<RowPattern::kXScalar>(
+        plan, x_data, y_data, out_data, func);
+  } else if (x_row) {
+    cpu_broadcast::DispatchRank<RowPattern::kYScalar>(
+        plan, x_data, y_data, out_data, func);
+  } else {
+    cpu_broadcast::DispatchRank<RowPattern::kBothScalar>(
+        plan, x_data, y_data, out_data, func);
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "paddle/phi/kernels/elementwise_kernel.h"
+#include "paddle/phi/kernels/funcs/cpu_broadcast.h"
 #include "paddle/phi/kernels/funcs/elementwise_base.h"
 #include "paddle/phi/kernels/funcs/elementwise_functor.h"
 #if defined(__NVCC__) || defined(__HIPCC__) || defined(__xpu__)
@@ -35,15 +36,8 @@ namespace phi {
       SameDimsElementwiseCompute<SameDims##name##Functor<CPUContext, T>>()( \
           dev_ctx, x, y, out);                                              \
     } else {                                                                \
-      auto x_dims = x.dims();                                               \
-      auto y_dims = y.dims();                                               \
-      if (x_dims.size() >= y_dims.size()) {                                 \
-        funcs::ElementwiseCompute<funcs::name##Functor<T>, T>(              \
-            dev_ctx, x, y, funcs::name##Functor<T>(), out, axis);           \
-      } else {                                                              \
-        funcs::ElementwiseCompute<funcs::Inverse##name##Functor<T>, T>(     \
-            dev_ctx, x, y, funcs::Inverse##name##Functor<T>(), out, axis);  \
-      }                                                                     \
+      funcs::CPUBroadcastCompute<funcs::name##Functor<T>, T>(               \
+          dev_ctx, x, y, funcs::name##Functor<T>(), out, axis);             \
     }                                                                       \
   }
 
@@ -58,6 +58,13 @@ using InsertionPoint = std::pair<Block *, Block::Iterator>;
 ///
 class Builder {
  public:
+  /// The listener is notified of the operations inserted by the builder.
+  class Listener {
+   public:
+    virtual ~Listener() = default;
+    virtual void NotifyOperationInserted(Operation *op) = 0;
+  };
+
   Builder(IrContext *context,
           Block *block,
           Block::Iterator insertion_point,
@@ -122,6 +129,10 @@ class Builder {
 
   const InsertionPoint &insertion_point() const { return insertion_point_; }
 
+  void set_listener(Listener *listener) { listener_ = listener; }
+
+  Listener *listener() const { return listener_; }
+
   /// Creates an operation given the fields represented as an OperationState.
   IR_API Operation *Build(OperationArgument &&argument);
 
@@ -172,6 +183,8 @@ class Builder {
   InsertionPoint insertion_point_;
 
   bool forbid_insert_without_position_;
+
+  Listener *listener_{nullptr};
 };
 
 template <typename OpTy, typename... Args>
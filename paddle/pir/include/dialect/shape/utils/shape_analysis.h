@@ -15,6 +15,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <optional>
 #include "paddle/pir/include/core/builtin_attribute.h"
 #include "paddle/pir/include/core/builtin_op.h"
@@ -252,6 +253,9 @@ class IR_API ShapeAnalysisManager {
  public:
   static ShapeAnalysisManager& Instance();
   ShapeConstraintIRAnalysis& Get(const pir::Program* program);
+  // Drops the analysis of program, e.g. a temporary program about to be
+  // destroyed.
+  void Erase(const pir::Program* program);
 
   ShapeAnalysisManager(const ShapeAnalysisManager&) = delete;
   ShapeAnalysisManager(ShapeAnalysisManager&&) = delete;
@@ -259,6 +263,8 @@ class IR_API ShapeAnalysisManager {
 
  private:
   ShapeAnalysisManager() {}
+  // Guards tables_, the programs may be analyzed by several threads.
+  std::mutex mutex_;
   std::unordered_map<uint64_t, std::shared_ptr<ShapeConstraintIRAnalysis>>
       tables_;
 };
@@ -16,6 +16,7 @@
 
 #include <any>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -37,8 +38,10 @@ class PassAdaptor;
 namespace detail {
 
 struct PassExecutionState {
-  explicit PassExecutionState(Operation* ir, const AnalysisManager& am)
-      : ir(ir), pass_failed(false), am(am) {}
+  explicit PassExecutionState(Operation* ir,
+                              const AnalysisManager& am,
+                              uint8_t opt_level = 0)
+      : ir(ir), pass_failed(false), am(am), opt_level(opt_level) {}
 
   // The IR currently being processed by pass.
   Operation* ir;
@@ -46,6 +49,9 @@ struct PassExecutionState {
   bool pass_failed;
   AnalysisManager am;
   PreservedAnalyses preserved_analyses;
+
+  // The opt level of the PassManager running the pass.
+  uint8_t opt_level;
 };
 
 struct PassInfo {
@@ -161,20 +167,23 @@ class IR_API Pass {
 
   virtual bool CanApplyOn(Operation* op) const;
 
+  // A region local pass only reads and modifies the operations in the regions
+  // of the operation it runs on, and keeps no state of its own in Run except
+  // the statistics. Running it on an operation does the same work as running
+  // it on each nested operation it can apply on. So when all the passes are
+  // region local, PassManager::EnableParallel runs them on the nested
+  // operations instead of on the top operation, in parallel for the ones
+  // sharing no value defined outside them.
+  virtual bool IsRegionLocal() const { return false; }
+
   virtual bool Initialize(IrContext* context) { return true; }
 
-  void AddStatistics(int64_t match_count) {
-    Set<int64_t>("__match_count__", new int64_t{match_count});
-  }
+  // The statistics may be added by the passes running in parallel.
+  void AddStatistics(int64_t match_count);
 
-  void AddStatistics(int64_t match_count_1, int64_t match_count_2) {
-    Set<int64_t>("__match_count_1__", new int64_t{match_count_1});
-    Set<int64_t>("__match_count_2__", new int64_t{match_count_2});
-  }
+  void AddStatistics(int64_t match_count_1, int64_t match_count_2);
 
-  void AddStatistics(const std::string& custom_log) {
-    Set<std::string>("__custom_log__", new std::string{custom_log});
-  }
+  void AddStatistics(const std::string& custom_log);
 
   AnalysisManager analysis_manager();
 
@@ -211,9 +220,31 @@ class IR_API PatternRewritePass : public Pass {
   void Run(Operation* op) override;
 
  private:
+  friend class PatternRewritePassGroup;
+
   FrozenRewritePatternSet patterns_;
 
   GreedyRewriteConfig config_;
 };
 
+// Applies the patterns of several PatternRewritePass in one traversal instead
+// of one traversal per pass. For each op the patterns are tried by benefit,
+// and in the order of the passes for the same benefit. Only the passes allowed
+// by the opt level of the PassManager are applied, and all the passes must
+// return the same config from InitializeConfig.
+class IR_API PatternRewritePassGroup : public Pass {
+ public:
+  PatternRewritePassGroup(
+      const std::string& name,
+      std::vector<std::unique_ptr<PatternRewritePass>>&& passes);
+
+ protected:
+  bool Initialize(IrContext* context) override;
+
+  void Run(Operation* op) override;
+
+ private:
+  std::vector<std::unique_ptr<PatternRewritePass>> passes_;
+};
+
 }  // namespace pir
@@ -53,6 +53,11 @@ class PassInstrumentation {
   virtual void RunAfterAnalysis(const std::string& name,
                                 TypeId id,
                                 Operation* op) {}
+
+  // The callbacks are called one at a time but may be called for different
+  // operations while the passes run in parallel. Return false if the
+  // callbacks read the IR outside the given operation.
+  virtual bool SupportParallel() const { return true; }
 };
 
 /// This class holds a collection of PassInstrumentation objects, and invokes
@@ -78,6 +83,8 @@ class IR_API PassInstrumentor {
 
   void RunAfterAnalysis(const std::string& name, TypeId id, Operation* op);
 
+  bool SupportParallel() const;
+
   // TODO(liuyuanle): Add other hooks.
 
  private:
@@ -113,6 +113,14 @@ class IR_API PassManager {
 
   void EnablePrintStatistics();
 
+  // Runs the pipelines of the nested operations on num_threads threads when
+  // all the passes are region local, see Pass::IsRegionLocal. The operations
+  // sharing a value defined outside them are still run one by one in a
+  // thread. num_threads = 0 means the number of cpus.
+  void EnableParallel(int num_threads = 0);
+
+  int num_threads() const { return num_threads_; }
+
   void AddInstrumentation(std::unique_ptr<PassInstrumentation> pi);
 
  private:
@@ -129,6 +137,8 @@ class IR_API PassManager {
 
   bool disable_log_{false};
 
+  int num_threads_{1};
+
   std::vector<std::unique_ptr<Pass>> passes_;
 
   std::unique_ptr<Pass> pass_adaptor_;
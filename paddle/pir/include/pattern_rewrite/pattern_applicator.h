@@ -18,6 +18,7 @@
 
 #include <functional>
 #include <unordered_map>
+#include <vector>
 
 #include "paddle/pir/include/core/op_info.h"
 #include "paddle/pir/include/core/operation.h"
@@ -34,6 +35,10 @@ class PatternApplicator {
   using CostModel = std::function<PatternBenefit(const Pattern&)>;
 
   explicit PatternApplicator(const FrozenRewritePatternSet& frozen_patter_list);
+  // The patterns of all the sets are tried by benefit, and in the order of the
+  // sets for the same benefit.
+  explicit PatternApplicator(
+      const std::vector<const FrozenRewritePatternSet*>& frozen_pattern_lists);
   ~PatternApplicator() = default;
 
   bool MatchAndRewrite(Operation* op,
@@ -51,7 +56,7 @@ class PatternApplicator {
   void WalkAllPatterns(std::function<void(const Pattern&)> walk);
 
  private:
-  const FrozenRewritePatternSet& frozen_pattern_list_;
+  std::vector<const FrozenRewritePatternSet*> frozen_pattern_lists_;
   std::unordered_map<OpInfo, std::vector<const RewritePattern*>> patterns_;
   std::vector<const RewritePattern*> any_op_patterns_;
 };
@@ -14,12 +14,25 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 #include "paddle/pir/include/core/dll_decl.h"
 #include "paddle/pir/include/core/region.h"
 
 namespace pir {
 
 class FrozenRewritePatternSet;
+class Pattern;
+
+/// The number of times a pattern is tried and applied.
+struct PatternStatistics {
+  int64_t num_tries = 0;
+  int64_t num_rewrites = 0;
+};
+
+using PatternStatisticsMap =
+    std::unordered_map<const Pattern*, PatternStatistics>;
 
 /// This enum will control which ops will be added to the worklist during the
 /// match rewrite process
@@ -57,6 +70,17 @@ class IR_API GreedyRewriteConfig {
   /// - ExistingOps: only pre-existing ops are added to the worklist.
   GreedyRewriteStrictness strict_mode = GreedyRewriteStrictness::AnyOp;
 
+  /// Scan the region only once, and then only process the ops added to the
+  /// worklist by the rewrites: the users of the replaced ops, the producers of
+  /// the erased ops, the updated ops and the ops inserted by the rewriter.
+  /// The patterns must change the ir through the rewriter only, the changes
+  /// made in other ways are not revisited. The number of rewrites is limited
+  /// to `max_iterations` times the number of ops in the region.
+  bool use_incremental_worklist = false;
+
+  /// If set, collect the number of tries and rewrites of each pattern.
+  PatternStatisticsMap* pattern_statistics{nullptr};
+
   static constexpr int64_t kNoLimit = -1;
 };
 
@@ -78,4 +102,11 @@ IR_API std::pair<bool, int64_t> ApplyPatternsGreedily(
     const FrozenRewritePatternSet& patterns,
     GreedyRewriteConfig config = GreedyRewriteConfig());
 
+/// Apply several pattern sets in one traversal. For each op the patterns are
+/// tried by benefit, and in the order of the sets for the same benefit.
+IR_API std::pair<bool, int64_t> ApplyPatternsGreedily(
+    Operation* op,
+    const std::vector<const FrozenRewritePatternSet*>& patterns,
+    GreedyRewriteConfig config = GreedyRewriteConfig());
+
 }  // namespace pir
@@ -37,6 +37,7 @@ Operation *Builder::Build(const std::vector<Value> &inputs,
 Operation *Builder::Insert(Operation *op) {
   if (insertion_point_.first) {
     insertion_point_.first->insert(insertion_point_.second, op);
+    if (listener_) listener_->NotifyOperationInserted(op);
   } else if (forbid_insert_without_position_) {
     IR_THROW("Insertion position not set, insert failed.");
   }
@@ -16,6 +16,8 @@
 
 #include <glog/logging.h>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 #include "paddle/common/enforce.h"
@@ -37,22 +39,22 @@ struct ParametricStorageManager {
   }
 
   // Get the storage of parametric type, if not in the cache, create and
-  // insert the cache.
+  // insert the cache. The cache is looked up with a shared lock first, so
+  // that the threads getting the existing storages do not block each other.
   StorageBase *GetOrCreate(std::size_t hash_value,
                            std::function<bool(StorageBase *)> equal_func,
                            std::function<StorageBase *()> constructor) {
-    if (parametric_instances_.count(hash_value) != 0) {
-      auto pr = parametric_instances_.equal_range(hash_value);
-      while (pr.first != pr.second) {
-        if (equal_func(pr.first->second)) {
-          VLOG(10) << "Found a cached parametric storage of: [param_hash="
-                   << hash_value << ", storage_ptr=" << pr.first->second
-                   << "].";
-          return pr.first->second;
-        }
-        ++pr.first;
+    {
+      std::shared_lock<std::shared_mutex> guard(mutex_);
+      if (StorageBase *storage = Find(hash_value, equal_func)) {
+        return storage;
       }
     }
+    std::unique_lock<std::shared_mutex> guard(mutex_);
+    // Created by other threads after the shared lock is released.
+    if (StorageBase *storage = Find(hash_value, equal_func)) {
+      return storage;
+    }
     StorageBase *storage = constructor();
     parametric_instances_.emplace(hash_value, storage);
     VLOG(10) << "No cache found, construct and cache a new parametric storage "
@@ -62,6 +64,22 @@ struct ParametricStorageManager {
   }
 
  private:
+  StorageBase *Find(std::size_t hash_value,
+                    const std::function<bool(StorageBase *)> &equal_func) {
+    auto pr = parametric_instances_.equal_range(hash_value);
+    while (pr.first != pr.second) {
+      if (equal_func(pr.first->second)) {
+        VLOG(10) << "Found a cached parametric storage of: [param_hash="
+                 << hash_value << ", storage_ptr=" << pr.first->second
+                 << "].";
+        return pr.first->second;
+      }
+      ++pr.first;
+    }
+    return nullptr;
+  }
+
+  std::shared_mutex mutex_;
   // In order to prevent hash conflicts, the unordered_multimap data structure
   // is used for storage.
   std::unordered_multimap<size_t, StorageBase *> parametric_instances_;
@@ -77,15 +95,20 @@ StorageManager::StorageBase *StorageManager::GetParametricStorageImpl(
     std::size_t hash_value,
     std::function<bool(const StorageBase *)> equal_func,
     std::function<StorageBase *()> constructor) {
-  std::lock_guard<pir::SpinLock> guard(parametric_instance_lock_);
   VLOG(10) << "Try to get a parametric storage of: [TypeId_hash="
            << std::hash<pir::TypeId>()(type_id) << ", param_hash=" << hash_value
            << "].";
-  if (parametric_instance_.find(type_id) == parametric_instance_.end()) {
-    IR_THROW("The input data pointer is null.");
+  ParametricStorageManager *parametric_storage = nullptr;
+  {
+    // Only guards the lookup, each type has its own lock for the storages.
+    std::lock_guard<pir::SpinLock> guard(parametric_instance_lock_);
+    auto it = parametric_instance_.find(type_id);
+    if (it == parametric_instance_.end()) {
+      IR_THROW("The input data pointer is null.");
+    }
+    parametric_storage = it->second.get();
   }
-  ParametricStorageManager &parametric_storage = *parametric_instance_[type_id];
-  return parametric_storage.GetOrCreate(hash_value, equal_func, constructor);
+  return parametric_storage->GetOrCreate(hash_value, equal_func, constructor);
 }
 
 StorageManager::StorageBase *StorageManager::GetParameterlessStorageImpl(
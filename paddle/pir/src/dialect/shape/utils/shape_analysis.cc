@@ -767,6 +767,7 @@ ShapeAnalysisManager& ShapeAnalysisManager::Instance() {
 
 ShapeConstraintIRAnalysis& ShapeAnalysisManager::Get(
     const pir::Program* program) {
+  std::lock_guard<std::mutex> lock(mutex_);
   auto it = tables_.find(program->module_op().operation()->id());
 
   if (it == tables_.end()) {
@@ -779,6 +780,11 @@ ShapeConstraintIRAnalysis& ShapeAnalysisManager::Get(
   return *it->second;
 }
 
+void ShapeAnalysisManager::Erase(const pir::Program* program) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  tables_.erase(program->module_op().operation()->id());
+}
+
 bool IsStaticShape(const Value& value) {
   const auto& value_type = value.type();
   if (!value || !value_type) {
@@ -45,6 +45,8 @@ class IRPrinting : public PassInstrumentation {
 
   ~IRPrinting() override = default;
 
+  bool SupportParallel() const override { return !option_->print_module(); }
+
   void RunBeforePass(Pass *pass, Operation *op) override {
     if (option_->print_on_change()) {
       // TODO(liuyuanle): support print on change
@@ -13,6 +13,17 @@
 // limitations under the License.
 
 #include "paddle/pir/include/pass/pass.h"
+
+#include <glog/logging.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "paddle/pir/include/core/ir_context.h"
 #include "paddle/pir/include/core/operation.h"
 #include "paddle/pir/include/core/program.h"
@@ -27,6 +38,77 @@
 
 namespace pir {
 
+namespace {
+
+// Set in the threads of PassAdaptor::RunParallel, where the passes keep their
+// execution states instead of in Pass::pass_state_.
+thread_local std::unordered_map<const Pass*,
+                                std::optional<detail::PassExecutionState>>*
+    parallel_pass_states = nullptr;
+
+// Guards the statistics of the passes and the instrumentations, which may be
+// used by the passes running in parallel.
+std::mutex& PassMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// Groups the operations so that the operations of different groups share no
+// value defined outside them. The order of the operations is kept in a group.
+std::vector<std::vector<Operation*>> GroupIndependentOps(
+    const std::vector<Operation*>& ops) {
+  std::vector<size_t> parent(ops.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  auto Find = [&](size_t i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+
+  std::unordered_map<Value, size_t> owners;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    std::unordered_set<Value> defined;
+    std::vector<Value> used;
+    ops[i]->Walk([&](Operation* nested) {
+      for (size_t j = 0; j < nested->num_regions(); ++j) {
+        for (auto& block : nested->region(j)) {
+          defined.insert(block.args().begin(), block.args().end());
+          for (auto& [_, kwarg] : block.kwargs()) {
+            defined.insert(kwarg);
+          }
+        }
+      }
+      if (nested == ops[i]) return;
+      for (auto result : nested->results()) {
+        defined.insert(result);
+      }
+      for (auto operand : nested->operands()) {
+        used.push_back(operand.source());
+      }
+    });
+    for (auto value : used) {
+      if (!value || defined.count(value)) continue;
+      auto [it, inserted] = owners.emplace(value, i);
+      if (!inserted) {
+        parent[Find(i)] = Find(it->second);
+      }
+    }
+  }
+
+  std::vector<std::vector<Operation*>> groups;
+  std::unordered_map<size_t, size_t> group_ids;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto [it, inserted] = group_ids.emplace(Find(i), groups.size());
+    if (inserted) groups.emplace_back();
+    groups[it->second].push_back(ops[i]);
+  }
+  return groups;
+}
+
+}  // namespace
+
 //===----------------------------------------------------------------------===//
 // Pass
 //===----------------------------------------------------------------------===//
@@ -43,21 +125,42 @@ Pass::~Pass() {
 bool Pass::CanApplyOn(Operation* op) const { return op->num_regions() > 0; }
 
 std::optional<detail::PassExecutionState>& Pass::pass_state() {
+  if (parallel_pass_states) {
+    return (*parallel_pass_states)[this];
+  }
   return pass_state_;
 }
 
 void Pass::SignalPassFailure() {
-  PADDLE_ENFORCE_EQ(pass_state_.has_value(),
+  auto& pass_state = this->pass_state();
+  PADDLE_ENFORCE_EQ(pass_state.has_value(),
                     true,
                     common::errors::InvalidArgument("pass state has no value"));
-  pass_state_->pass_failed = true;
+  pass_state->pass_failed = true;
 }
 
 AnalysisManager Pass::analysis_manager() {
-  PADDLE_ENFORCE_EQ(pass_state_.has_value(),
+  auto& pass_state = this->pass_state();
+  PADDLE_ENFORCE_EQ(pass_state.has_value(),
                     true,
                     common::errors::InvalidArgument("pass state has no value"));
-  return pass_state_->am;
+  return pass_state->am;
+}
+
+void Pass::AddStatistics(int64_t match_count) {
+  std::lock_guard<std::mutex> guard(PassMutex());
+  Set<int64_t>("__match_count__", new int64_t{match_count});
+}
+
+void Pass::AddStatistics(int64_t match_count_1, int64_t match_count_2) {
+  std::lock_guard<std::mutex> guard(PassMutex());
+  Set<int64_t>("__match_count_1__", new int64_t{match_count_1});
+  Set<int64_t>("__match_count_2__", new int64_t{match_count_2});
+}
+
+void Pass::AddStatistics(const std::string& custom_log) {
+  std::lock_guard<std::mutex> guard(PassMutex());
+  Set<std::string>("__custom_log__", new std::string{custom_log});
 }
 //===----------------------------------------------------------------------===//
 // PatternRewritePass
@@ -85,9 +188,104 @@ GreedyRewriteConfig PatternRewritePass::InitializeConfig() {
   return config;
 }
 
+namespace {
+
+void LogPatternStatistics(const std::string& pass_name,
+                          const PatternStatisticsMap& statistics) {
+  for (const auto& [pattern, pattern_statistics] : statistics) {
+    VLOG(1) << "Pass " << pass_name << ", pattern " << pattern->debug_name()
+            << ": tried " << pattern_statistics.num_tries << " times, applied "
+            << pattern_statistics.num_rewrites << " times";
+  }
+}
+
+}  // namespace
+
 void PatternRewritePass::Run(Operation* op) {
-  auto [_, num_rewrites] =
-      ApplyPatternsGreedily(op, patterns_, InitializeConfig());
+  GreedyRewriteConfig config = InitializeConfig();
+  PatternStatisticsMap statistics;
+  if (VLOG_IS_ON(1) && !config.pattern_statistics) {
+    config.pattern_statistics = &statistics;
+  }
+  auto [_, num_rewrites] = ApplyPatternsGreedily(op, patterns_, config);
+  LogPatternStatistics(name(), statistics);
+  AddStatistics(num_rewrites);
+}
+
+//===----------------------------------------------------------------------===//
+// PatternRewritePassGroup
+//===----------------------------------------------------------------------===//
+namespace {
+
+// The group runs if any of the passes is allowed to run, Run then applies the
+// patterns of the allowed passes only.
+uint8_t GroupOptLevel(
+    const std::string& name,
+    const std::vector<std::unique_ptr<PatternRewritePass>>& passes) {
+  PADDLE_ENFORCE_EQ(
+      passes.empty(),
+      false,
+      common::errors::InvalidArgument(
+          "The PatternRewritePassGroup [%s] requires at least one pass.",
+          name));
+  uint8_t opt_level = passes.front()->pass_info().opt_level;
+  for (const auto& pass : passes) {
+    opt_level = std::min(opt_level, pass->pass_info().opt_level);
+  }
+  return opt_level;
+}
+
+bool IsSameConfig(const GreedyRewriteConfig& lhs,
+                  const GreedyRewriteConfig& rhs) {
+  return lhs.use_top_down_traversal == rhs.use_top_down_traversal &&
+         lhs.max_iterations == rhs.max_iterations &&
+         lhs.max_num_rewrites == rhs.max_num_rewrites &&
+         lhs.region == rhs.region && lhs.strict_mode == rhs.strict_mode &&
+         lhs.use_incremental_worklist == rhs.use_incremental_worklist &&
+         lhs.pattern_statistics == rhs.pattern_statistics;
+}
+
+}  // namespace
+
+PatternRewritePassGroup::PatternRewritePassGroup(
+    const std::string& name,
+    std::vector<std::unique_ptr<PatternRewritePass>>&& passes)
+    : Pass(name, GroupOptLevel(name, passes)), passes_(std::move(passes)) {}
+
+bool PatternRewritePassGroup::Initialize(IrContext* context) {
+  const GreedyRewriteConfig config = passes_.front()->InitializeConfig();
+  for (auto& pass : passes_) {
+    PADDLE_ENFORCE_EQ(
+        IsSameConfig(pass->InitializeConfig(), config),
+        true,
+        common::errors::InvalidArgument(
+            "The passes of the PatternRewritePassGroup [%s] are applied in "
+            "one traversal and require the same GreedyRewriteConfig, but the "
+            "config of [%s] differs from the one of [%s].",
+            name(),
+            pass->name(),
+            passes_.front()->name()));
+    if (!pass->Initialize(context)) return false;
+  }
+  return true;
+}
+
+void PatternRewritePassGroup::Run(Operation* op) {
+  const uint8_t opt_level = pass_state()->opt_level;
+  std::vector<const FrozenRewritePatternSet*> patterns;
+  for (const auto& pass : passes_) {
+    if (opt_level < pass->pass_info().opt_level) continue;
+    patterns.push_back(&pass->patterns_);
+  }
+  if (patterns.empty()) return;
+
+  GreedyRewriteConfig config = passes_.front()->InitializeConfig();
+  PatternStatisticsMap statistics;
+  if (VLOG_IS_ON(1) && !config.pattern_statistics) {
+    config.pattern_statistics = &statistics;
+  }
+  auto [_, num_rewrites] = ApplyPatternsGreedily(op, patterns, config);
+  LogPatternStatistics(name(), statistics);
   AddStatistics(num_rewrites);
 }
 
@@ -101,6 +299,19 @@ void detail::PassAdaptor::Run(Operation* op, uint8_t opt_level, bool verify) {
 void detail::PassAdaptor::RunImpl(Operation* op,
                                   uint8_t opt_level,
                                   bool verify) {
+  if (CanRunParallel()) {
+    std::vector<Operation*> ops;
+    for (size_t i = 0; i < op->num_regions(); ++i) {
+      for (auto& block : op->region(i)) {
+        for (auto& op : block) {
+          ops.push_back(&op);
+        }
+      }
+    }
+    if (!RunParallel(ops, opt_level, verify)) return SignalPassFailure();
+    return;
+  }
+
   auto last_am = analysis_manager();
 
   for (size_t i = 0; i < op->num_regions(); ++i) {
@@ -116,6 +327,65 @@ void detail::PassAdaptor::RunImpl(Operation* op,
   return;
 }
 
+bool detail::PassAdaptor::CanRunParallel() const {
+  // The nested adaptors in the threads run serially.
+  if (pm_->num_threads_ <= 1 || parallel_pass_states) return false;
+  for (auto& pass : pm_->passes()) {
+    if (!pass->IsRegionLocal()) return false;
+  }
+  return !pm_->instrumentor_ || pm_->instrumentor_->SupportParallel();
+}
+
+bool detail::PassAdaptor::RunParallel(const std::vector<Operation*>& ops,
+                                      uint8_t opt_level,
+                                      bool verify) {
+  auto groups = GroupIndependentOps(ops);
+  auto* instrumentor = analysis_manager().GetPassInstrumentor();
+  const size_t num_threads =
+      std::min(static_cast<size_t>(pm_->num_threads_), groups.size());
+  VLOG(4) << "Run the pipelines of " << ops.size() << " operations in "
+          << groups.size() << " groups on " << num_threads << " threads.";
+
+  std::atomic<size_t> next_group{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
+  auto RunGroups = [&]() {
+    std::unordered_map<const Pass*, std::optional<PassExecutionState>> states;
+    auto* last_states = parallel_pass_states;
+    parallel_pass_states = &states;
+    try {
+      for (size_t i = next_group++; i < groups.size() && !failed;
+           i = next_group++) {
+        for (auto* op : groups[i]) {
+          AnalysisManagerHolder am(op, instrumentor);
+          if (!RunPipeline(*pm_, op, am, opt_level, verify)) {
+            failed = true;
+            break;
+          }
+        }
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(exception_mutex);
+      if (!exception) exception = std::current_exception();
+      failed = true;
+    }
+    parallel_pass_states = last_states;
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(RunGroups);
+  }
+  RunGroups();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (exception) std::rethrow_exception(exception);
+  return !failed;
+}
+
 bool detail::PassAdaptor::RunPipeline(const PassManager& pm,
                                       Operation* op,
                                       AnalysisManager am,
@@ -126,10 +396,15 @@ bool detail::PassAdaptor::RunPipeline(const PassManager& pm,
     instrumentor->RunBeforePipeline(op);
   }
 
-  for (auto& pass : pm.passes()) {
-    if (pass->CanApplyOn(op)) {
-      if (!RunPass(pass.get(), op, am, opt_level, verify)) {
-        return false;
+  // The region local passes run on the nested operations in parallel instead
+  // of on op, see Pass::IsRegionLocal.
+  auto* adaptor = static_cast<PassAdaptor*>(pm.pass_adaptor_.get());
+  if (!adaptor->CanRunParallel()) {
+    for (auto& pass : pm.passes()) {
+      if (pass->CanApplyOn(op)) {
+        if (!RunPass(pass.get(), op, am, opt_level, verify)) {
+          return false;
+        }
       }
     }
   }
@@ -153,7 +428,7 @@ bool detail::PassAdaptor::RunPass(Pass* pass,
                                   bool verify) {
   if (opt_level < pass->pass_info().opt_level) return true;
 
-  pass->pass_state_ = PassExecutionState(op, am);
+  pass->pass_state() = PassExecutionState(op, am, opt_level);
 
   PassInstrumentor* instrumentor = am.GetPassInstrumentor();
 
@@ -196,6 +471,13 @@ bool PassManager::Run(Operation* op) {
   return detail::PassAdaptor::RunPipeline(*this, op, am, opt_level_, verify_);
 }
 
+void PassManager::EnableParallel(int num_threads) {
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  num_threads_ = std::max(num_threads, 1);
+}
+
 bool PassManager::Initialize(IrContext* context) {
   for (auto& pass : passes()) {
     if (!pass->Initialize(context)) return false;
@@ -215,7 +497,8 @@ void PassManager::AddInstrumentation(std::unique_ptr<PassInstrumentation> pi) {
 //----------------------------------------------------------------------------------------------//
 namespace detail {
 struct PassInstrumentorImpl {
-  // TODO(wilber): Support multi-thread.
+  // The callbacks are guarded by PassMutex for the passes running in
+  // parallel.
   std::vector<std::unique_ptr<PassInstrumentation>> instrumentations;
 };
 }  // namespace detail
@@ -227,6 +510,7 @@ PassInstrumentor::~PassInstrumentor() = default;
 
 void PassInstrumentor::RunBeforePipeline(Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(PassMutex());
   for (auto& instr : impl_->instrumentations) {
     instr->RunBeforePipeline(op);
   }
@@ -234,6 +518,7 @@ void PassInstrumentor::RunBeforePipeline(Operation* op) {
 
 void PassInstrumentor::RunAfterPipeline(Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(PassMutex());
   for (auto it = impl_->instrumentations.rbegin();
        it != impl_->instrumentations.rend();
        ++it) {
@@ -243,6 +528,7 @@ void PassInstrumentor::RunAfterPipeline(Operation* op) {
 
 void PassInstrumentor::RunBeforePass(Pass* pass, Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(PassMutex());
   for (auto& instr : impl_->instrumentations) {
     instr->RunBeforePass(pass, op);
   }
@@ -250,6 +536,7 @@ void PassInstrumentor::RunBeforePass(Pass* pass, Operation* op) {
 
 void PassInstrumentor::RunAfterPass(Pass* pass, Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(PassMutex());
   for (auto it = impl_->instrumentations.rbegin();
        it != impl_->instrumentations.rend();
        ++it) {
@@ -261,6 +548,7 @@ void PassInstrumentor::RunBeforeAnalysis(const std::string& name,
                                          TypeId id,
                                          Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(PassMutex());
   for (auto& instr : impl_->instrumentations) {
     instr->RunBeforeAnalysis(name, id, op);
   }
@@ -270,6 +558,7 @@ void PassInstrumentor::RunAfterAnalysis(const std::string& name,
                                         TypeId id,
                                         Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> guard(PassMutex());
   for (auto it = impl_->instrumentations.rbegin();
        it != impl_->instrumentations.rend();
        ++it) {
@@ -277,6 +566,13 @@ void PassInstrumentor::RunAfterAnalysis(const std::string& name,
   }
 }
 
+bool PassInstrumentor::SupportParallel() const {
+  return std::all_of(
+      impl_->instrumentations.begin(),
+      impl_->instrumentations.end(),
+      [](const auto& instr) { return instr->SupportParallel(); });
+}
+
 void PassInstrumentor::AddInstrumentation(
     std::unique_ptr<PassInstrumentation> pi) {
   impl_->instrumentations.emplace_back(std::move(pi));
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "paddle/pir/include/pass/pass.h"
 
 namespace pir {
@@ -34,6 +36,13 @@ class PassAdaptor final : public Pass {
  private:
   void RunImpl(Operation* op, uint8_t opt_level, bool verify);
 
+  // Runs the pipelines of the nested operations on the threads of pm_.
+  bool RunParallel(const std::vector<Operation*>& ops,
+                   uint8_t opt_level,
+                   bool verify);
+
+  bool CanRunParallel() const;
+
   static bool RunPass(Pass* pass,
                       Operation* op,
                       AnalysisManager am,
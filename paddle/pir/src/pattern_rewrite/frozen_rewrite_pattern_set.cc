@@ -47,8 +47,8 @@ FrozenRewritePatternSet::FrozenRewritePatternSet(
       if (callback(info_map.second))
         impl_->op_specific_native_pattern_map_[info_map.second].push_back(
             pattern.get());
-      impl_->op_specific_native_patterns_.push_back(std::move(pattern));
     }
+    impl_->op_specific_native_patterns_.push_back(std::move(pattern));
   };
 
   for (std::unique_ptr<RewritePattern>& pat : patterns.native_patterns()) {
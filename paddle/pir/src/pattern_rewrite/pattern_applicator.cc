@@ -22,20 +22,25 @@ namespace pir {
 
 PatternApplicator::PatternApplicator(
     const FrozenRewritePatternSet& frozen_pattern_list)
-    : frozen_pattern_list_(frozen_pattern_list) {}
+    : frozen_pattern_lists_{&frozen_pattern_list} {}
+
+PatternApplicator::PatternApplicator(
+    const std::vector<const FrozenRewritePatternSet*>& frozen_pattern_lists)
+    : frozen_pattern_lists_(frozen_pattern_lists) {}
 
 void PatternApplicator::ApplyCostModel(const CostModel& model) {
   // TODO(wilber): remove impossible patterns.
   patterns_.clear();
-  for (const auto& it : frozen_pattern_list_.op_specific_native_patterns()) {
-    for (const RewritePattern* pattern : it.second) {
-      patterns_[it.first].push_back(pattern);
-    }
-  }
-
   any_op_patterns_.clear();
-  for (auto& pattern : frozen_pattern_list_.match_any_op_native_patterns()) {
-    any_op_patterns_.push_back(pattern.get());
+  for (const auto* frozen_pattern_list : frozen_pattern_lists_) {
+    for (const auto& it : frozen_pattern_list->op_specific_native_patterns()) {
+      for (const RewritePattern* pattern : it.second) {
+        patterns_[it.first].push_back(pattern);
+      }
+    }
+    for (auto& pattern : frozen_pattern_list->match_any_op_native_patterns()) {
+      any_op_patterns_.push_back(pattern.get());
+    }
   }
 
   // Sort by benefit based on the cost model.
@@ -59,11 +64,13 @@ void PatternApplicator::ApplyCostModel(const CostModel& model) {
 
 void PatternApplicator::WalkAllPatterns(
     std::function<void(const Pattern&)> walk) {
-  for (const auto& it : frozen_pattern_list_.op_specific_native_patterns())
-    for (auto* pattern : it.second) walk(*pattern);
+  for (const auto* frozen_pattern_list : frozen_pattern_lists_) {
+    for (const auto& it : frozen_pattern_list->op_specific_native_patterns())
+      for (auto* pattern : it.second) walk(*pattern);
 
-  for (const auto& it : frozen_pattern_list_.match_any_op_native_patterns())
-    walk(*it);
+    for (const auto& it : frozen_pattern_list->match_any_op_native_patterns())
+      walk(*it);
+  }
 }
 
 bool PatternApplicator::MatchAndRewrite(
@@ -73,9 +80,10 @@ bool PatternApplicator::MatchAndRewrite(
     std::function<void(const Pattern&)> on_failure,
     std::function<bool(const Pattern&)> on_success) {
   // whether there are patterns matching this operation type.
-  std::vector<const RewritePattern*> op_patterns;
+  static const std::vector<const RewritePattern*> kNoPatterns;
   auto pattern_it = patterns_.find(op->info());
-  if (pattern_it != patterns_.end()) op_patterns = pattern_it->second;
+  const auto& op_patterns =
+      pattern_it != patterns_.end() ? pattern_it->second : kNoPatterns;
 
   unsigned op_it = 0, op_e = op_patterns.size();
   unsigned any_it = 0, any_e = any_op_patterns_.size();
@@ -38,7 +38,7 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
  public:
   explicit GreedyPatternRewriteDriver(
       pir::IrContext* ctx,
-      const pir::FrozenRewritePatternSet& patterns,
+      const std::vector<const pir::FrozenRewritePatternSet*>& patterns,
       const pir::GreedyRewriteConfig& config)
       : pir::PatternRewriter(ctx),
         config_(config),
@@ -56,6 +56,7 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
   }
 
   std::pair<bool, int64_t> Simplify() {
+    if (config_.use_incremental_worklist) return SimplifyIncrementally();
     int64_t sum_num_rewrites = 0;
     int64_t num_rewrites = 0;
     int64_t iteration = 0;
@@ -65,24 +66,8 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
           config_.max_iterations != pir::GreedyRewriteConfig::kNoLimit)
         break;
       VLOG(6) << "Iteration[" << iteration << "] for PatternRewrite";
-      worklist_.clear();
-      worklist_map_.clear();
-
-      for (auto& block_item : region_) {
-        for (auto& op_item : block_item) {
-          worklist_.push_back(&op_item);
-        }
-      }
-      if (config_.use_top_down_traversal) {
-        // Reverse the list so out pop-back loop process them in-order.
-        std::reverse(worklist_.begin(), worklist_.end());
-      }
-      for (size_t i = 0; i < worklist_.size(); ++i) {
-        worklist_map_[worklist_[i]] = i;
-        VLOG(6) << "worklist[" << i << "] is " << worklist_[i]->name();
-      }
-
-      num_rewrites = ProcessWorklist();
+      SeedWorklist();
+      num_rewrites = ProcessWorklist(config_.max_num_rewrites);
       sum_num_rewrites += num_rewrites;
     } while (num_rewrites != 0);
     bool converged = num_rewrites == 0;
@@ -90,13 +75,53 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
   }
 
  private:
-  /// Process ops until the worklist is empty or `config.max_num_rewrites`
-  /// is reached. Return `true` if any IR was changed.
-  int64_t ProcessWorklist() {
+  /// Scan the region once, then only revisit the ops touched by the rewrites.
+  /// Converged if the worklist becomes empty within the rewrite budget.
+  std::pair<bool, int64_t> SimplifyIncrementally() {
+    SeedWorklist();
+    int64_t max_num_rewrites = config_.max_num_rewrites;
+    if (config_.max_iterations != pir::GreedyRewriteConfig::kNoLimit) {
+      int64_t budget = config_.max_iterations *
+                       std::max<int64_t>(static_cast<int64_t>(worklist_.size()),
+                                         1);
+      if (max_num_rewrites == pir::GreedyRewriteConfig::kNoLimit ||
+          budget < max_num_rewrites) {
+        max_num_rewrites = budget;
+      }
+    }
+    int64_t num_rewrites = ProcessWorklist(max_num_rewrites);
+    bool converged = std::all_of(worklist_.begin(),
+                                 worklist_.end(),
+                                 [](pir::Operation* op) { return !op; });
+    return std::make_pair(converged, num_rewrites);
+  }
+
+  void SeedWorklist() {
+    worklist_.clear();
+    worklist_map_.clear();
+
+    for (auto& block_item : region_) {
+      for (auto& op_item : block_item) {
+        worklist_.push_back(&op_item);
+      }
+    }
+    if (config_.use_top_down_traversal) {
+      // Reverse the list so out pop-back loop process them in-order.
+      std::reverse(worklist_.begin(), worklist_.end());
+    }
+    for (size_t i = 0; i < worklist_.size(); ++i) {
+      worklist_map_[worklist_[i]] = i;
+      VLOG(6) << "worklist[" << i << "] is " << worklist_[i]->name();
+    }
+  }
+
+  /// Process ops until the worklist is empty or `max_num_rewrites`
+  /// is reached. Return the number of rewrites.
+  int64_t ProcessWorklist(int64_t max_num_rewrites) {
     int64_t num_rewrites = 0;
     while (!worklist_.empty() &&
-           (num_rewrites < config_.max_num_rewrites ||
-            config_.max_num_rewrites == pir::GreedyRewriteConfig::kNoLimit)) {
+           (num_rewrites < max_num_rewrites ||
+            max_num_rewrites == pir::GreedyRewriteConfig::kNoLimit)) {
       auto* op = PopFromWorklist();
       if (op == nullptr) continue;
       VLOG(6) << "PopFromWorklist, get op: " << op->name();
@@ -107,7 +132,7 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
       // TODO(wilber): fold logical.
       // ...
 
-      bool match_result = matcher_.MatchAndRewrite(op, *this);
+      bool match_result = MatchAndRewrite(op);
       if (match_result) {
         ++num_rewrites;
       }
@@ -115,6 +140,24 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
     return num_rewrites;
   }
 
+  bool MatchAndRewrite(pir::Operation* op) {
+    auto* statistics = config_.pattern_statistics;
+    if (!statistics) return matcher_.MatchAndRewrite(op, *this);
+    return matcher_.MatchAndRewrite(
+        op,
+        *this,
+        {},
+        [statistics](const pir::Pattern& pattern) {
+          ++(*statistics)[&pattern].num_tries;
+        },
+        [statistics](const pir::Pattern& pattern) {
+          auto& pattern_statistics = (*statistics)[&pattern];
+          ++pattern_statistics.num_tries;
+          ++pattern_statistics.num_rewrites;
+          return true;
+        });
+  }
+
   void NotifyRootReplaced(pir::Operation* op,
                           const std::vector<pir::Value>& replacement) override {
     for (uint32_t i = 0; i < op->num_results(); ++i) {
@@ -153,7 +196,9 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
   void NotifyOperationInserted(pir::Operation* op) override {
     if (config_.strict_mode == pir::GreedyRewriteStrictness::ExistingAndNewOps)
       strict_mode_filtered_ops_.insert(op);
-    AddToWorklist(op);
+    // The full rescans pick up the new ops in the next iteration, and their
+    // number of rewrites is only bounded by `max_iterations`.
+    if (config_.use_incremental_worklist) AddToWorklist(op);
   }
 
   /// Add the given operation to the worklist.
@@ -213,9 +258,11 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
 
 namespace pir {
 
-std::pair<bool, int64_t> ApplyPatternsGreedily(
+namespace {
+
+std::pair<bool, int64_t> ApplyPatternSetsGreedily(
     Region& region,  // NOLINT
-    const FrozenRewritePatternSet& patterns,
+    const std::vector<const FrozenRewritePatternSet*>& patterns,
     GreedyRewriteConfig config) {
   if (!config.region) config.region = &region;
 
@@ -228,16 +275,33 @@ std::pair<bool, int64_t> ApplyPatternsGreedily(
   return std::make_pair(converged, num_rewrites);
 }
 
+}  // namespace
+
+std::pair<bool, int64_t> ApplyPatternsGreedily(
+    Region& region,  // NOLINT
+    const FrozenRewritePatternSet& patterns,
+    GreedyRewriteConfig config) {
+  return ApplyPatternSetsGreedily(region, {&patterns}, config);
+}
+
 IR_API std::pair<bool, int64_t> ApplyPatternsGreedily(
     Operation* op,
     const FrozenRewritePatternSet& patterns,
     GreedyRewriteConfig config) {
+  return ApplyPatternsGreedily(
+      op, std::vector<const FrozenRewritePatternSet*>{&patterns}, config);
+}
+
+IR_API std::pair<bool, int64_t> ApplyPatternsGreedily(
+    Operation* op,
+    const std::vector<const FrozenRewritePatternSet*>& patterns,
+    GreedyRewriteConfig config) {
   bool sum_converged = true;
   int64_t sum_num_rewrites = 0;
   for (uint32_t i = 0; i < op->num_regions(); ++i) {
     Region& region = op->region(i);
     auto [converged, num_rewrites] =
-        ApplyPatternsGreedily(region, patterns, config);
+        ApplyPatternSetsGreedily(region, patterns, config);
     sum_converged &= converged;
     sum_num_rewrites += num_rewrites;
   }
@@ -557,6 +557,25 @@ class DataParallel(Layer):
         finally:
             self.grad_need_sync = tmp_grad_need_sync
 
+    def register_comm_hook(self, comm_hook: core.CommHook | None) -> None:
+        """
+        Replaces the all-reduce of the dense gradients with a communication
+        hook, e.g. ``core.CastCommHook(paddle.float16)``,
+        ``core.PowerSGDCommHook(matrix_approximation_rank=1, start_iter=10)``
+        or ``core.TopKCommHook(ratio=0.01)``. The hooks keep their state by
+        gradient group, so a hook can only be registered to one model.
+        ``None`` restores the all-reduce.
+
+        On CPU the hooks run in a background thread, so the communication of a
+        group overlaps the backward of the next groups. The all-reduce of the
+        sparse gradients runs in the same thread, and no other collective of
+        the process group should be issued during the backward.
+        """
+        assert (
+            self._strategy.nranks > 1
+        ), "The comm hook only works with more than one rank."
+        self._reducer.register_comm_hook(comm_hook)
+
     def forward(self, *inputs: Any, **kwargs: Any) -> Tensor:
         outputs = self._layers(*inputs, **kwargs)
         if (
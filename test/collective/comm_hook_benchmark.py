@@ -0,0 +1,115 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Step time and convergence of DataParallel with the comm hooks.
+
+The ranks are processes on the local host training the same MLP with the
+gloo backend, e.g.
+
+    python comm_hook_benchmark.py --nranks 4 --hidden 1024 --steps 200
+
+For each hook it prints the mean step time after the warmup and the loss of
+the first and the last steps, the losses of the compressed hooks should
+follow the ones of the plain all-reduce.
+"""
+
+import argparse
+import time
+
+import numpy as np
+
+import paddle
+import paddle.distributed as dist
+from paddle.base import core
+
+HOOKS = {
+    "allreduce": lambda: None,
+    "cast_fp16": lambda: core.CastCommHook(paddle.float16),
+    "cast_bf16": lambda: core.CastCommHook(paddle.bfloat16),
+    "powersgd_rank4": lambda: core.PowerSGDCommHook(4, 10),
+    "topk_1%": lambda: core.TopKCommHook(0.01),
+}
+
+
+def build_model(hidden, layers):
+    blocks = []
+    for _ in range(layers):
+        blocks += [paddle.nn.Linear(hidden, hidden), paddle.nn.ReLU()]
+    return paddle.nn.Sequential(*blocks, paddle.nn.Linear(hidden, 1))
+
+
+def train(name, args):
+    rank = dist.get_rank()
+    paddle.seed(2024)
+    model = dist.DataParallel(build_model(args.hidden, args.layers))
+    model.register_comm_hook(HOOKS[name]())
+    optimizer = paddle.optimizer.SGD(
+        learning_rate=args.lr, parameters=model.parameters()
+    )
+
+    # Each rank regresses a different shard of the same linear target.
+    rng = np.random.RandomState(rank)
+    target = np.random.RandomState(0).randn(args.hidden, 1) / args.hidden
+    losses = []
+    times = []
+    for _ in range(args.steps):
+        x = rng.randn(args.batch_size, args.hidden).astype("float32")
+        y = (x @ target).astype("float32")
+        start = time.perf_counter()
+        loss = paddle.nn.functional.mse_loss(
+            model(paddle.to_tensor(x)), paddle.to_tensor(y)
+        )
+        loss.backward()
+        optimizer.step()
+        optimizer.clear_grad()
+        times.append(time.perf_counter() - start)
+        losses.append(float(loss))
+    step_time = np.mean(times[args.warmup :])
+    return step_time, losses[0], losses[-1]
+
+
+def worker(args):
+    paddle.device.set_device("cpu")
+    dist.init_parallel_env()
+    if dist.get_rank() == 0:
+        print(
+            f"{'hook':>16} {'step(ms)':>10} {'first_loss':>12} "
+            f"{'last_loss':>12}"
+        )
+    for name in args.hooks:
+        step_time, first_loss, last_loss = train(name, args)
+        if dist.get_rank() == 0:
+            print(
+                f"{name:>16} {step_time * 1e3:>10.2f} {first_loss:>12.6f} "
+                f"{last_loss:>12.6f}"
+            )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--nranks", type=int, default=4)
+    parser.add_argument("--hidden", type=int, default=1024)
+    parser.add_argument("--layers", type=int, default=4)
+    parser.add_argument("--batch-size", type=int, default=32)
+    parser.add_argument("--lr", type=float, default=0.01)
+    parser.add_argument("--steps", type=int, default=200)
+    parser.add_argument("--warmup", type=int, default=20)
+    parser.add_argument(
+        "--hooks", nargs="+", choices=list(HOOKS), default=list(HOOKS)
+    )
+    args = parser.parse_args()
+    dist.spawn(worker, args=(args,), nprocs=args.nranks, backend="gloo")
+
+
+if __name__ == "__main__":
+    main()
@@ -22,6 +22,88 @@ import paddle
 from paddle.base import core
 
 
+def rank_inputs(nranks, shape, dtype, seed):
+    # Every rank generates the inputs of all the ranks, so it knows the
+    # expected result.
+    return [
+        np.random.RandomState(seed + rank).random(shape).astype(dtype)
+        for rank in range(nranks)
+    ]
+
+
+def check_alltoall_single(pg, rows, row_shape, dtype, seed):
+    """all_to_all_single where rank src sends rows[src][dst] rows to dst."""
+    nranks, rank = pg.size(), pg.rank()
+    inputs = [
+        np.random.RandomState(seed + src)
+        .random([sum(rows[src]), *row_shape])
+        .astype(dtype)
+        for src in range(nranks)
+    ]
+    in_sizes = list(rows[rank])
+    out_sizes = [rows[src][rank] for src in range(nranks)]
+    expected = []
+    for src in range(nranks):
+        begin = sum(rows[src][:rank])
+        expected.append(inputs[src][begin : begin + rows[src][rank]])
+    tensor_in = paddle.to_tensor(inputs[rank])
+    tensor_out = paddle.zeros([sum(out_sizes), *row_shape], dtype)
+    task = pg.all_to_all_single(
+        tensor_out, tensor_in, out_sizes, in_sizes, True
+    )
+    task.wait()
+    np.testing.assert_array_equal(tensor_out, np.concatenate(expected))
+
+
+def check_alltoall(pg, shape, dtype, seed):
+    nranks, rank = pg.size(), pg.rank()
+    inputs = rank_inputs(nranks, shape, dtype, seed)
+    tensor_in = paddle.to_tensor(inputs[rank])
+    tensor_out = paddle.zeros(shape, dtype)
+    task = pg.all_to_all_tensor(tensor_out, tensor_in, True)
+    task.wait()
+    block = shape[0] // nranks
+    begin = block * rank
+    expected = np.concatenate([x[begin : begin + block] for x in inputs])
+    np.testing.assert_array_equal(tensor_out, expected)
+
+
+def check_reduce_scatter(pg, shape, dtype, seed):
+    nranks, rank = pg.size(), pg.rank()
+    in_shape = [shape[0] * nranks, *shape[1:]]
+    inputs = rank_inputs(nranks, in_shape, dtype, seed)
+    tensor_in = paddle.to_tensor(inputs[rank])
+    tensor_out = paddle.zeros(shape, dtype)
+    task = pg.reduce_scatter_tensor(
+        tensor_out, tensor_in, core.ReduceOp.SUM, True
+    )
+    task.wait()
+    begin = shape[0] * rank
+    # The ring adds the partial sums in another order than numpy does.
+    np.testing.assert_allclose(
+        tensor_out, sum(inputs)[begin : begin + shape[0]], rtol=1e-5
+    )
+
+
+def check_alltoall_and_reduce_scatter(pg, dtype):
+    """The cases of alltoall and reduce_scatter for any number of ranks."""
+    nranks = pg.size()
+    # Blocks of 512KB and 1MB, which are sent in 256KB chunks.
+    check_alltoall(pg, (nranks * 32, 64, 64), dtype, 2022)
+    check_reduce_scatter(pg, (64, 64, 64), dtype, 2023)
+    # Uneven blocks, some of them empty.
+    rows = [
+        [(src + 2 * dst) % 3 for dst in range(nranks)] for src in range(nranks)
+    ]
+    check_alltoall_single(pg, rows, (5,), dtype, 2024)
+    # Uneven blocks of 128KB rows, the larger ones span several chunks.
+    rows = [[src + dst + 1 for dst in range(nranks)] for src in range(nranks)]
+    check_alltoall_single(pg, rows, (256, 128), dtype, 2025)
+    # Empty tensors.
+    rows = [[0] * nranks for _ in range(nranks)]
+    check_alltoall_single(pg, rows, (5,), dtype, 2026)
+
+
 class TestProcessGroupFp32(unittest.TestCase):
     def setUp(self):
         paddle.seed(2022)
@@ -228,6 +310,44 @@ class TestProcessGroupFp32(unittest.TestCase):
         test_gather(pg.size() - 1)
         print("test gather api ok\n")
 
+        # test alltoall
+        # rank 0
+        x = np.random.random(self.shape).astype(self.dtype)
+        # rank 1
+        y = np.random.random(self.shape).astype(self.dtype)
+        tensor_in = paddle.to_tensor(x if pg.rank() == 0 else y)
+        tensor_out = paddle.zeros(self.shape, self.dtype)
+        task = pg.all_to_all_tensor(tensor_out, tensor_in, True)
+        task.wait()
+        block = self.shape[0] // 2
+        begin = block * pg.rank()
+        alltoall_result = np.concatenate(
+            [x[begin : begin + block], y[begin : begin + block]]
+        )
+        np.testing.assert_array_equal(tensor_out, alltoall_result)
+        print("test alltoall api ok\n")
+
+        # test reduce_scatter
+        in_shape = list(self.shape)
+        in_shape[0] *= 2
+        # rank 0
+        x = np.random.random(in_shape).astype(self.dtype)
+        # rank 1
+        y = np.random.random(in_shape).astype(self.dtype)
+        tensor_in = paddle.to_tensor(x if pg.rank() == 0 else y)
+        tensor_out = paddle.zeros(self.shape, self.dtype)
+        task = pg.reduce_scatter_tensor(
+            tensor_out, tensor_in, core.ReduceOp.SUM, True
+        )
+        task.wait()
+        begin = self.shape[0] * pg.rank()
+        reduce_scatter_result = (x + y)[begin : begin + self.shape[0]]
+        np.testing.assert_array_equal(tensor_out, reduce_scatter_result)
+        print("test reduce_scatter api ok\n")
+
+        check_alltoall_and_reduce_scatter(pg, self.dtype)
+        print("test large, uneven and empty alltoall api ok\n")
+
 
 if __name__ == "__main__":
     unittest.main()
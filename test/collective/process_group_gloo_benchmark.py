@@ -0,0 +1,117 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Bus bandwidth of the alltoall and reduce_scatter of ProcessGroupGloo.
+
+The ranks are processes on the local host talking through the loopback
+device, e.g.
+
+    python process_group_gloo_benchmark.py --nranks 4 --max-bytes 64M
+
+The bus bandwidth is the data size over the time, scaled by
+(nranks - 1) / nranks, which is the share each rank actually sends, so it is
+comparable between message sizes and numbers of ranks.
+"""
+
+import argparse
+import multiprocessing
+import time
+
+import numpy as np
+
+import paddle
+from paddle.base import core
+
+
+def parse_bytes(value):
+    units = {"K": 1 << 10, "M": 1 << 20, "G": 1 << 30}
+    if value[-1].upper() in units:
+        return int(value[:-1]) * units[value[-1].upper()]
+    return int(value)
+
+
+def measure(pg, run, warmup, iters):
+    for _ in range(warmup):
+        run()
+    pg.barrier().wait()
+    start = time.perf_counter()
+    for _ in range(iters):
+        run()
+    elapsed = np.array([(time.perf_counter() - start) / iters], "float64")
+    # The slowest rank decides the time of a collective.
+    elapsed = paddle.to_tensor(elapsed)
+    pg.allreduce(elapsed, core.ReduceOp.MAX).wait()
+    return float(elapsed.numpy()[0])
+
+
+def worker(rank, args):
+    paddle.device.set_device("cpu")
+    nranks = args.nranks
+    store = core.TCPStore("127.0.0.1", args.port, rank == 0, nranks, 30)
+    pg = core.ProcessGroupGloo.create(store, rank, nranks)
+
+    if rank == 0:
+        print(
+            f"{'collective':>16} {'bytes':>12} {'time(us)':>12} "
+            f"{'algbw(GB/s)':>12} {'busbw(GB/s)':>12}"
+        )
+    size = args.min_bytes
+    while size <= args.max_bytes:
+        numel = max(size // 4 // nranks, 1) * nranks
+        nbytes = numel * 4
+        data = paddle.ones([numel], "float32")
+        alltoall_out = paddle.zeros([numel], "float32")
+        reduce_scatter_out = paddle.zeros([numel // nranks], "float32")
+        collectives = {
+            "alltoall": lambda: pg.all_to_all_tensor(
+                alltoall_out, data, True
+            ).wait(),
+            "reduce_scatter": lambda: pg.reduce_scatter_tensor(
+                reduce_scatter_out, data, core.ReduceOp.SUM, True
+            ).wait(),
+        }
+        for name, run in collectives.items():
+            elapsed = measure(pg, run, args.warmup, args.iters)
+            algbw = nbytes / elapsed / 1e9
+            busbw = algbw * (nranks - 1) / nranks
+            if rank == 0:
+                print(
+                    f"{name:>16} {nbytes:>12} {elapsed * 1e6:>12.1f} "
+                    f"{algbw:>12.3f} {busbw:>12.3f}"
+                )
+        size *= 2
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--nranks", type=int, default=4)
+    parser.add_argument("--min-bytes", type=parse_bytes, default="4K")
+    parser.add_argument("--max-bytes", type=parse_bytes, default="64M")
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--iters", type=int, default=20)
+    parser.add_argument("--port", type=int, default=6273)
+    args = parser.parse_args()
+
+    context = multiprocessing.get_context("spawn")
+    processes = [
+        context.Process(target=worker, args=(rank, args))
+        for rank in range(args.nranks)
+    ]
+    for process in processes:
+        process.start()
+    for process in processes:
+        process.join()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,187 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+import paddle.distributed as dist
+from paddle import nn
+from paddle.base import core
+
+NRANKS = 2
+SHAPE = [16, 16]
+
+
+class Weight(nn.Layer):
+    # The gradient of the weight is the coefficient fed to forward.
+    def __init__(self):
+        super().__init__()
+        self.weight = self.create_parameter(
+            SHAPE, default_initializer=nn.initializer.Constant(0.0)
+        )
+
+    def forward(self, coef):
+        return (self.weight * coef).sum()
+
+
+def reduced_grads(comm_hook, coefs):
+    """The gradients reduced by comm_hook, for the coefs of this rank."""
+    model = paddle.DataParallel(Weight())
+    model.register_comm_hook(comm_hook)
+    grads = []
+    for coef in coefs:
+        model(paddle.to_tensor(coef)).backward()
+        grads.append(model._layers.weight.grad.numpy())
+        model.clear_gradients()
+    return grads
+
+
+def random_coefs(steps, zero_steps, integer):
+    """The coefs of all the ranks, steps random ones and zero_steps zeros."""
+    coefs = []
+    for rank in range(NRANKS):
+        rng = np.random.RandomState(2024 + rank)
+        if integer:
+            # Half integers are added up exactly in float32.
+            random = [rng.randint(-8, 8, SHAPE) / 2 for _ in range(steps)]
+        else:
+            random = [rng.uniform(-1, 1, SHAPE) for _ in range(steps)]
+        zeros = [np.zeros(SHAPE) for _ in range(zero_steps)]
+        coefs.append([c.astype("float32") for c in random + zeros])
+    return coefs
+
+
+def mean_grads(coefs):
+    return [sum(step) / NRANKS for step in zip(*coefs)]
+
+
+def check_cast(rank):
+    coefs = random_coefs(5, 0, integer=False)
+    expected = mean_grads(coefs)
+    plain = reduced_grads(None, coefs[rank])
+    cast = reduced_grads(core.CastCommHook(paddle.float16), coefs[rank])
+    for step in range(len(expected)):
+        np.testing.assert_allclose(plain[step], expected[step], rtol=1e-6)
+        # float16 keeps 11 significant bits.
+        np.testing.assert_allclose(
+            cast[step], plain[step], rtol=2e-3, atol=1e-3
+        )
+
+
+def check_error_feedback(rank, comm_hook, integer, atol):
+    # The errors left after the random steps are sent by the zero steps, so
+    # the reduced gradients add up to the mean gradients over all the steps.
+    coefs = random_coefs(5, 2 * SHAPE[0], integer)
+    grads = reduced_grads(comm_hook, coefs[rank])
+    np.testing.assert_allclose(
+        sum(grads), sum(mean_grads(coefs)), rtol=0, atol=atol
+    )
+    return grads
+
+
+def check_topk(rank):
+    ratio = 0.05
+    grads = check_error_feedback(
+        rank, core.TopKCommHook(ratio), integer=True, atol=0
+    )
+    # Each rank sends only k of the gradients.
+    k = int(ratio * np.prod(SHAPE))
+    assert np.count_nonzero(grads[0]) <= NRANKS * k
+
+
+def check_powersgd(rank):
+    grads = check_error_feedback(
+        rank, core.PowerSGDCommHook(1, 0), integer=False, atol=1e-5
+    )
+    # The reduced gradients are the rank 1 approximations.
+    assert np.linalg.matrix_rank(grads[0], tol=1e-5) == 1
+
+
+def linear_grads(comm_hook, rank):
+    """The reduced gradients of the weight and the bias of a linear layer."""
+    paddle.seed(2024)
+    model = paddle.DataParallel(nn.Linear(16, 8))
+    model.register_comm_hook(comm_hook)
+    x = np.random.RandomState(rank).randn(4, 16).astype("float32")
+    (model(paddle.to_tensor(x)) ** 2).sum().backward()
+    return model._layers.weight.grad.numpy(), model._layers.bias.grad.numpy()
+
+
+def check_powersgd_per_parameter(rank):
+    # The weight and the bias are fused in one group. The weight is
+    # approximated on its own, the bias is too small and is all-reduced as is.
+    plain_weight, plain_bias = linear_grads(None, rank)
+    weight, bias = linear_grads(core.PowerSGDCommHook(1, 0), rank)
+    assert np.linalg.matrix_rank(plain_weight, tol=1e-5) > 1
+    assert np.linalg.matrix_rank(weight, tol=1e-5) == 1
+    np.testing.assert_allclose(bias, plain_bias, rtol=1e-6)
+
+
+def final_loss_ratio(comm_hook, steps=200):
+    """The final loss of a linear regression over the initial one."""
+    paddle.seed(2024)
+    # The weight of 32 x 4 is compressed by PowerSGD of rank 1.
+    model = paddle.DataParallel(nn.Linear(32, 4))
+    model.register_comm_hook(comm_hook)
+    optimizer = paddle.optimizer.SGD(
+        learning_rate=0.1, parameters=model.parameters()
+    )
+    rng = np.random.RandomState(dist.get_rank())
+    target = np.random.RandomState(0).randn(32, 4) / np.sqrt(32)
+    losses = []
+    for _ in range(steps):
+        x = rng.randn(16, 32).astype("float32")
+        y = (x @ target).astype("float32")
+        loss = nn.functional.mse_loss(
+            model(paddle.to_tensor(x)), paddle.to_tensor(y)
+        )
+        loss.backward()
+        optimizer.step()
+        optimizer.clear_grad()
+        losses.append(float(loss))
+    return np.mean(losses[-10:]) / losses[0]
+
+
+def check_convergence():
+    comm_hooks = {
+        "cast_fp16": core.CastCommHook(paddle.float16),
+        "powersgd_rank1": core.PowerSGDCommHook(1, 10),
+        "topk_10%": core.TopKCommHook(0.1),
+    }
+    assert final_loss_ratio(None) < 1e-4
+    for name, comm_hook in comm_hooks.items():
+        ratio = final_loss_ratio(comm_hook)
+        assert ratio < 1e-2, f"{name} does not converge: {ratio}"
+
+
+def run_comm_hooks():
+    paddle.device.set_device("cpu")
+    dist.init_parallel_env()
+    rank = dist.get_rank()
+    check_cast(rank)
+    check_topk(rank)
+    check_powersgd(rank)
+    check_powersgd_per_parameter(rank)
+    check_convergence()
+
+
+class TestCommHookGloo(unittest.TestCase):
+    def test_comm_hooks(self):
+        dist.spawn(run_comm_hooks, backend="gloo", nprocs=NRANKS)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,62 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import multiprocessing
+import socket
+import unittest
+from contextlib import closing
+
+from process_group_gloo import check_alltoall_and_reduce_scatter
+
+import paddle
+from paddle.base import core
+
+
+def find_free_port():
+    with closing(socket.socket(socket.AF_INET, socket.SOCK_STREAM)) as s:
+        s.bind(('', 0))
+        return s.getsockname()[1]
+
+
+def worker(rank, nranks, port):
+    paddle.device.set_device("cpu")
+    store = core.TCPStore("127.0.0.1", port, rank == 0, nranks, 30)
+    pg = core.ProcessGroupGloo.create(store, rank, nranks)
+    check_alltoall_and_reduce_scatter(pg, "float32")
+    pg.barrier().wait()
+
+
+class TestProcessGroupGloo4Ranks(unittest.TestCase):
+    def test_alltoall_and_reduce_scatter(self):
+        # process_group_gloo.py runs the same cases on 2 ranks, the blocks of
+        # 4 ranks are exchanged over several steps.
+        nranks = 4
+        port = find_free_port()
+        context = multiprocessing.get_context("spawn")
+        procs = [
+            context.Process(target=worker, args=(rank, nranks, port))
+            for rank in range(nranks)
+        ]
+        for proc in procs:
+            proc.start()
+        for proc in procs:
+            proc.join(timeout=300)
+        for rank, proc in enumerate(procs):
+            if proc.is_alive():
+                proc.terminate()
+            self.assertEqual(proc.exitcode, 0, f"rank {rank} failed")
+
+
+if __name__ == '__main__':
+    unittest.main()
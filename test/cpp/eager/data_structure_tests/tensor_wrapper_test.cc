@@ -14,11 +14,18 @@
 
 #include "paddle/fluid/eager/tensor_wrapper.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/eager/utils.h"
 #include "test/cpp/eager/data_structure_tests/grad_node_test.h"
 
+COMMON_DECLARE_string(eager_saved_tensor_compression);
+
 TEST(TensorWrapper, Basic) {
   VLOG(6) << "Test Full reserved";
   paddle::Tensor et1;
@@ -106,3 +113,89 @@ TEST(TensorWrapper, Basic) {
       common::errors::Fatal(
           "Variable `tw2` should not be initialized after recover"));
 }
+
+namespace {
+
+template <typename T>
+paddle::Tensor CreateSavedTensor(const std::vector<T>& values,
+                                 phi::DataType dtype,
+                                 const phi::DDim& dims) {
+  paddle::Tensor tensor;
+  std::shared_ptr<phi::DenseTensor> dt = std::make_shared<phi::DenseTensor>(
+      std::make_unique<paddle::experimental::DefaultAllocator>(phi::CPUPlace())
+          .get(),
+      phi::DenseTensorMeta(dtype, dims));
+  std::copy(values.begin(), values.end(), dt->mutable_data<T>(phi::CPUPlace()));
+  tensor.set_impl(dt);
+  // An activation, which is not a leaf.
+  auto grad_test_node = std::make_shared<eager_test::GradTestNode>(
+      /* val */ 5.0, /* in_num */ 1, /* out_num */ 1);
+  egr::Edge edge(grad_test_node, 0, 0);
+  tensor.set_autograd_meta(std::make_shared<egr::AutogradMeta>(edge));
+  return tensor;
+}
+
+}  // namespace
+
+TEST(TensorWrapper, Compression) {
+  const phi::DDim dims = common::make_ddim({64, 128});
+  const int64_t numel = common::product(dims);
+  std::vector<float> values(numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    values[i] = static_cast<float>((i % 255) - 127) / 16.0f;
+  }
+  paddle::Tensor activation =
+      CreateSavedTensor(values, phi::DataType::FLOAT32, dims);
+
+  for (const std::string policy : {"bf16", "int8"}) {
+    FLAGS_eager_saved_tensor_compression = policy;
+    auto tw = egr::TensorWrapper(activation);
+    auto recovered = tw.recover();
+    ASSERT_EQ(recovered.dims(), dims);
+    ASSERT_EQ(recovered.dtype(), phi::DataType::FLOAT32);
+    EXPECT_NE(recovered.impl(), activation.impl());
+    const float* recovered_ptr =
+        static_cast<phi::DenseTensor*>(recovered.impl().get())->data<float>();
+    // The max relative error of bfloat16 is 2^-8, and the error of int8 is
+    // within a step of 127 / 16 / 127 per channel.
+    const float tolerance = policy == "bf16" ? 127.0f / 16 / 256 : 1.0f / 16;
+    for (int64_t i = 0; i < numel; ++i) {
+      EXPECT_NEAR(recovered_ptr[i], values[i], tolerance);
+    }
+  }
+
+  // The precision sensitive tensors, e.g. the out of softmax, are kept as is.
+  FLAGS_eager_saved_tensor_compression = "int8";
+  auto exact_tw =
+      egr::TensorWrapper(activation, false, egr::SavedTensorUsage::kExact);
+  EXPECT_EQ(exact_tw.recover().impl(), activation.impl());
+
+  // Only the signs of the relu out and the dropout mask are used.
+  std::vector<uint8_t> mask(numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    mask[i] = i % 3 == 0 ? 1 : 0;
+  }
+  paddle::Tensor mask_tensor =
+      CreateSavedTensor(mask, phi::DataType::UINT8, dims);
+  auto mask_tw =
+      egr::TensorWrapper(mask_tensor, false, egr::SavedTensorUsage::kSign);
+  auto recovered_mask = mask_tw.recover();
+  auto* mask_dt = static_cast<phi::DenseTensor*>(recovered_mask.impl().get());
+  const uint8_t* mask_ptr = mask_dt->data<uint8_t>();
+  for (int64_t i = 0; i < numel; ++i) {
+    EXPECT_EQ(mask_ptr[i], mask[i]);
+  }
+
+  // The inplace version is still checked.
+  static_cast<phi::DenseTensor*>(activation.impl().get())
+      ->InplaceVersionCounter()
+      .Bump();
+  FLAGS_eager_saved_tensor_compression = "bf16";
+  auto bumped_tw = egr::TensorWrapper(activation);
+  static_cast<phi::DenseTensor*>(activation.impl().get())
+      ->InplaceVersionCounter()
+      .Bump();
+  EXPECT_THROW(bumped_tw.recover(), common::enforce::EnforceNotMet);
+
+  FLAGS_eager_saved_tensor_compression = "";
+}
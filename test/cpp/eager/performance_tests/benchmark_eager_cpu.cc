@@ -33,6 +33,8 @@
 
 #include "paddle/phi/core/kernel_registry.h"
 
+COMMON_DECLARE_int32(eager_backward_num_threads);
+
 using namespace egr;            // NOLINT
 using namespace egr_utils_api;  // NOLINT
 
@@ -240,3 +242,48 @@ TEST(Benchmark, EagerIntermediateMLPCPU) {
     }
   }
 }
+
+TEST(Benchmark, EagerBranchyMatmulParallelBackwardCPU) {
+  // Prepare Device Contexts
+  eager_test::InitEnv(phi::CPUPlace());
+
+  for (int num_threads : {0, 2, 4, 8}) {
+    FLAGS_eager_backward_num_threads = num_threads;
+    for (const std::string mode : {"Accuracy", "Performance"}) {
+      phi::DDim ddim = common::make_ddim({BRANCHY_N, BRANCHY_N});
+      paddle::Tensor X =
+          eager_test::CreateTensorWithValue(ddim,
+                                            phi::CPUPlace(),
+                                            phi::DataType::FLOAT32,
+                                            phi::DataLayout::NCHW,
+                                            BRANCHY_X_VAL,
+                                            true);
+      RetainGradForTensor(X);
+
+      std::vector<paddle::Tensor> Ws;
+      for (size_t i = 0; i < BRANCHY_NUM_BRANCHES; i++) {
+        paddle::Tensor W =
+            eager_test::CreateTensorWithValue(ddim,
+                                              phi::CPUPlace(),
+                                              phi::DataType::FLOAT32,
+                                              phi::DataLayout::NCHW,
+                                              BRANCHY_W_VAL,
+                                              true);
+        RetainGradForTensor(W);
+        Ws.emplace_back(std::move(W));
+      }
+
+      if (mode == "Accuracy") {
+        benchmark_eager_branchy_matmul(X, Ws, true /* accuracy_check */);
+      } else if (mode == "Performance") {
+        double elapsed_time_ms = benchmark_eager_branchy_matmul(X, Ws);
+        std::cout << "Threads: " << num_threads
+                  << ", Backward Duration: " << elapsed_time_ms << " ms"
+                  << std::endl;
+      } else {
+        PADDLE_THROW(common::errors::Fatal("Unknown benchmark mode"));
+      }
+    }
+  }
+  FLAGS_eager_backward_num_threads = 0;
+}
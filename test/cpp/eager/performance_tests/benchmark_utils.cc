@@ -14,6 +14,7 @@
 
 #include "test/cpp/eager/performance_tests/benchmark_utils.h"
 
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <set>
@@ -152,6 +153,32 @@ void benchmark_eager_intermediate_mlp(const paddle::Tensor& X,
   }
 }
 
+double benchmark_eager_branchy_matmul(const paddle::Tensor& X,
+                                      const std::vector<paddle::Tensor>& Ws,
+                                      bool accuracy_check) {
+  // The branches only share X, so their grad nodes are independent.
+  std::vector<paddle::Tensor> target_tensors;
+  for (const paddle::Tensor& W : Ws) {
+    paddle::Tensor Out = X;
+    for (size_t i = 0; i < BRANCHY_DEPTH; i++) {
+      Out = matmul_ad_func(Out, W, false, false);
+    }
+    target_tensors.emplace_back(std::move(Out));
+  }
+
+  auto t_start = std::chrono::high_resolution_clock::now();
+  Backward(target_tensors, {});
+  auto t_end = std::chrono::high_resolution_clock::now();
+
+  if (accuracy_check) {
+    // X * W_b keeps the value of X, and so does the grad.
+    eager_test::CompareTensorWithValue<float>(target_tensors[0],
+                                              BRANCHY_X_VAL);
+    eager_test::CompareGradTensorWithValue<float>(X, Ws.size());
+  }
+  return std::chrono::duration<double, std::milli>(t_end - t_start).count();
+}
+
 }  // namespace egr
 
 namespace paddle {
@@ -32,6 +32,15 @@
 #define MLP_B_VAL 3.0
 #define MLP_NUM_LINEAR 1000
 
+/* Branchy MatMul Configurations */
+// Out_b = X[N, N] x W_b[N, N] x ... x W_b, BRANCHY_DEPTH times
+// for b in [0, BRANCHY_NUM_BRANCHES)
+#define BRANCHY_N 256
+#define BRANCHY_X_VAL 1.0
+#define BRANCHY_W_VAL (1.0 / BRANCHY_N)
+#define BRANCHY_DEPTH 8
+#define BRANCHY_NUM_BRANCHES 16
+
 namespace egr {
 
 inline std::unordered_map<std::string, float> compute_mlp_expected_results() {
@@ -65,6 +74,11 @@ void benchmark_eager_intermediate_mlp(const paddle::Tensor& X,
                                       const std::vector<paddle::Tensor>& Bs,
                                       bool accuracy_check = false);
 
+// Returns the elapsed time of the backward in ms.
+double benchmark_eager_branchy_matmul(const paddle::Tensor& X,
+                                      const std::vector<paddle::Tensor>& Ws,
+                                      bool accuracy_check = false);
+
 }  // namespace egr
 
 namespace paddle {
@@ -18,6 +18,7 @@
 
 #include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/eager/accumulation/accumulation_node.h"
 #include "paddle/fluid/eager/api/all.h"
 #include "paddle/fluid/eager/api/generated/eager_generated/backwards/scale_node.h"
@@ -31,6 +32,8 @@
 PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
 
+COMMON_DECLARE_int32(eager_backward_num_threads);
+
 namespace egr {
 
 TEST(Backward, SingleNodeEmptyGrad) {
@@ -342,4 +345,80 @@ TEST(Backward, WithAccumulation) {
   eager_test::CompareGradTensorWithValue<float>(leaf_tensor, 2500.0);
 }
 
+TEST(Backward, ParallelBranches) {
+  // Prepare Device Contexts
+  eager_test::InitEnv(phi::CPUPlace());
+  FLAGS_eager_backward_num_threads = 4;
+
+  // Prepare Inputs
+  phi::DDim ddim = common::make_ddim({4, 16, 16, 32});
+  const int num_branches = 8;
+
+  // Create Target Tensors
+  std::vector<paddle::Tensor> target_tensors;
+  for (int i = 0; i < num_branches; ++i) {
+    target_tensors.emplace_back(
+        eager_test::CreateTensorWithValue(ddim,
+                                          phi::CPUPlace(),
+                                          phi::DataType::FLOAT32,
+                                          phi::DataLayout::NCHW,
+                                          1.0 /*value*/,
+                                          false /*is_leaf*/));
+  }
+
+  paddle::Tensor leaf_tensor;
+  {
+    // Create the Node where the branches join
+    auto join_node_ptr = std::make_shared<GradNodeScale>(1, 1);
+    join_node_ptr->SetAttributes_scale(1.0 /*scale*/);
+    join_node_ptr->SetDefaultGradInOutMeta();
+
+    // Branch i: Target i -> Node(i + 1) -> Node(2) -> Join Node
+    for (int i = 0; i < num_branches; ++i) {
+      auto head_node_ptr = std::make_shared<GradNodeScale>(1, 1);
+      head_node_ptr->SetAttributes_scale(i + 1.0 /*scale*/);
+      head_node_ptr->SetDefaultGradInOutMeta();
+      auto tail_node_ptr = std::make_shared<GradNodeScale>(1, 1);
+      tail_node_ptr->SetAttributes_scale(2.0 /*scale*/);
+      tail_node_ptr->SetDefaultGradInOutMeta();
+
+      AutogradMeta* auto_grad_meta =
+          EagerUtils::autograd_meta(&(target_tensors[i]));
+      auto_grad_meta->SetGradNode(
+          std::dynamic_pointer_cast<GradNodeBase>(head_node_ptr));
+      auto_grad_meta->SetSingleOutRankWithSlot(0, 0);
+      auto_grad_meta->SetStopGradient(false);
+
+      auto head_out = paddle::Tensor();
+      auto* head_meta = EagerUtils::autograd_meta(&head_out);
+      head_meta->SetStopGradient(false);
+      head_meta->SetSingleOutRankWithSlot(0, 0);
+      head_meta->SetGradNode(tail_node_ptr);
+      head_node_ptr->SetGradOutMeta(head_out, 0);
+
+      auto tail_out = paddle::Tensor();
+      auto* tail_meta = EagerUtils::autograd_meta(&tail_out);
+      tail_meta->SetStopGradient(false);
+      tail_meta->SetSingleOutRankWithSlot(0, 0);
+      tail_meta->SetGradNode(join_node_ptr);
+      tail_node_ptr->SetGradOutMeta(tail_out, 0);
+    }
+
+    AutogradMeta* leaf_meta = EagerUtils::autograd_meta(&leaf_tensor);
+    // Connect Tensor and AccumulationNode via AutoGradMeta
+    auto acc_node_ptr = std::make_shared<egr::GradNodeAccumulation>(leaf_meta);
+    leaf_meta->SetGradNode(
+        std::dynamic_pointer_cast<GradNodeBase>(acc_node_ptr));
+    leaf_meta->SetSingleOutRankWithSlot(0, 0);
+    leaf_meta->SetStopGradient(false);
+    join_node_ptr->SetGradOutMeta(leaf_tensor, 0);
+  }
+
+  Backward(target_tensors, {});
+  FLAGS_eager_backward_num_threads = 0;
+
+  // (1 + 2 + ... + 8) * 2
+  eager_test::CompareGradTensorWithValue<float>(leaf_tensor, 72.0);
+}
+
 }  // namespace egr
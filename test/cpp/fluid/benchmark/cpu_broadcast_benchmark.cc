@@ -0,0 +1,123 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmark of CPUBroadcastCompute against ElementwiseCompute, the broadcast
+// used before, on the shapes of test_cpu_broadcast. It is built but not run
+// by ctest, run it on an otherwise idle machine.
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/kernels/funcs/cpu_broadcast.h"
+#include "paddle/phi/kernels/funcs/elementwise_base.h"
+#include "paddle/phi/kernels/funcs/elementwise_functor.h"
+
+namespace phi {
+namespace tests {
+namespace {
+
+constexpr int kNumWarmupSteps = 10;
+constexpr int kNumSteps = 100;
+
+void FillTensor(const phi::CPUContext& dev_ctx,
+                const std::vector<int64_t>& dims,
+                float start,
+                phi::DenseTensor* tensor) {
+  tensor->Resize(common::make_ddim(dims));
+  float* data = dev_ctx.Alloc<float>(tensor);
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = start + static_cast<float>(i % 97);
+  }
+}
+
+// The median time of a run in us.
+template <typename Fn>
+double MedianUS(Fn run) {
+  for (int i = 0; i < kNumWarmupSteps; ++i) {
+    run();
+  }
+  std::vector<double> latencies;
+  for (int i = 0; i < kNumSteps; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    auto end = std::chrono::steady_clock::now();
+    latencies.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  std::sort(latencies.begin(), latencies.end());
+  return latencies[latencies.size() / 2];
+}
+
+template <typename Functor, typename InverseFunctor>
+void RunBenchmark(const std::vector<int64_t>& x_dims,
+                  const std::vector<int64_t>& y_dims,
+                  const std::vector<int64_t>& out_dims,
+                  int axis = -1) {
+  auto* dev_ctx =
+      phi::DeviceContextPool::Instance().GetByPlace(phi::CPUPlace());
+  phi::DenseTensor x, y, out;
+  FillTensor(*dev_ctx, x_dims, 1.f, &x);
+  FillTensor(*dev_ctx, y_dims, 3.f, &y);
+  out.Resize(common::make_ddim(out_dims));
+
+  double ref_us = MedianUS([&] {
+    if (x_dims.size() >= y_dims.size()) {
+      funcs::ElementwiseCompute<Functor, float>(
+          *dev_ctx, x, y, Functor(), &out, axis);
+    } else {
+      funcs::ElementwiseCompute<InverseFunctor, float>(
+          *dev_ctx, x, y, InverseFunctor(), &out, axis);
+    }
+  });
+  double us = MedianUS([&] {
+    funcs::CPUBroadcastCompute<Functor, float>(
+        *dev_ctx, x, y, Functor(), &out, axis);
+  });
+  LOG(INFO) << "[" << x.dims() << "] op [" << y.dims()
+            << "]: ElementwiseCompute " << ref_us
+            << " us, CPUBroadcastCompute " << us << " us, speedup "
+            << ref_us / us;
+}
+
+}  // namespace
+
+TEST(CPUBroadcastBenchmark, add) {
+  using Add = funcs::AddFunctor<float>;
+  using InverseAdd = funcs::InverseAddFunctor<float>;
+  RunBenchmark<Add, InverseAdd>({8, 64, 28, 28}, {64, 1, 1}, {8, 64, 28, 28});
+  RunBenchmark<Add, InverseAdd>({64, 1, 1}, {8, 64, 28, 28}, {8, 64, 28, 28});
+  RunBenchmark<Add, InverseAdd>({256, 1024}, {1024}, {256, 1024});
+  RunBenchmark<Add, InverseAdd>({256, 1}, {1, 1024}, {256, 1024});
+  RunBenchmark<Add, InverseAdd>({8, 64, 28, 28}, {64}, {8, 64, 28, 28}, 1);
+  RunBenchmark<Add, InverseAdd>(
+      {4, 1, 6, 1, 8}, {5, 1, 7, 1}, {4, 5, 6, 7, 8});
+}
+
+TEST(CPUBroadcastBenchmark, subtract_divide) {
+  using Sub = funcs::SubtractFunctor<float>;
+  using InverseSub = funcs::InverseSubtractFunctor<float>;
+  using Div = funcs::DivideFunctor<float>;
+  using InverseDiv = funcs::InverseDivideFunctor<float>;
+  RunBenchmark<Sub, InverseSub>({512}, {128, 512}, {128, 512});
+  RunBenchmark<Sub, InverseSub>({16, 32, 1}, {16, 1, 64}, {16, 32, 64});
+  RunBenchmark<Div, InverseDiv>({32, 1}, {8, 32, 256}, {8, 32, 256});
+  RunBenchmark<Div, InverseDiv>({8, 32, 256}, {1}, {8, 32, 256});
+}
+
+}  // namespace tests
+}  // namespace phi
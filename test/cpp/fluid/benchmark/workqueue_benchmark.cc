@@ -0,0 +1,171 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmark of the host scheduling of PirInterpreter on a transformer-shaped
+// program of CPU kernels, with the default and the NUMA-aware
+// (continuation-style) workqueue. It is built but not run by ctest, run it
+// on an otherwise idle multi-socket machine.
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/new_executor/interpretercore.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/pir/include/core/builder.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+
+PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(matmul, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(softmax, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(relu, CPU, ALL_LAYOUT);
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+constexpr int kNumLayers = 12;
+constexpr int kNumHeads = 8;
+constexpr int64_t kSeqLen = 32;
+constexpr int64_t kHidden = 64;
+constexpr int kNumSteps = 200;
+constexpr int kNumWarmupSteps = 10;
+const char kOutName[] = "benchmark_out";
+
+class TransformerProgramBuilder {
+ public:
+  explicit TransformerProgramBuilder(pir::Program* program)
+      : builder_(pir::IrContext::Instance(), program->block()) {}
+
+  void Build() {
+    weight_ = Full({kHidden, kHidden}, 0.01);
+    pir::Value x = Full({kSeqLen, kHidden}, 1.0);
+    for (int layer = 0; layer < kNumLayers; ++layer) {
+      x = AddLayer(x);
+    }
+    builder_.Build<pir::ShadowOutputOp>(x, kOutName);
+  }
+
+ private:
+  pir::Value Full(const std::vector<int64_t>& shape, double value) {
+    return builder_
+        .Build<paddle::dialect::FullOp>(
+            shape, value, phi::DataType::FLOAT32, phi::CPUPlace())
+        .out();
+  }
+
+  pir::Value Linear(pir::Value x) {
+    return builder_.Build<paddle::dialect::MatmulOp>(x, weight_).out();
+  }
+
+  pir::Value Add(pir::Value x, pir::Value y) {
+    return builder_.Build<paddle::dialect::AddOp>(x, y).out();
+  }
+
+  pir::Value AddLayer(pir::Value input) {
+    pir::Value q = Linear(input);
+    pir::Value k = Linear(input);
+    pir::Value v = Linear(input);
+    // The heads are independent, so they run in parallel on the host.
+    std::vector<pir::Value> heads;
+    for (int head = 0; head < kNumHeads; ++head) {
+      pir::Value qk = builder_
+                          .Build<paddle::dialect::MatmulOp>(
+                              q, k, /*transpose_x=*/false, /*transpose_y=*/true)
+                          .out();
+      pir::Value softmax =
+          builder_.Build<paddle::dialect::SoftmaxOp>(qk, -1).out();
+      heads.push_back(
+          builder_.Build<paddle::dialect::MatmulOp>(softmax, v).out());
+    }
+    while (heads.size() > 1) {
+      std::vector<pir::Value> sums;
+      for (size_t i = 0; i + 1 < heads.size(); i += 2) {
+        sums.push_back(Add(heads[i], heads[i + 1]));
+      }
+      if (heads.size() % 2 == 1) sums.push_back(heads.back());
+      heads.swap(sums);
+    }
+    pir::Value residual = Add(Linear(heads.front()), input);
+    pir::Value ffn = builder_.Build<paddle::dialect::ReluOp>(Linear(residual))
+                         .out();
+    return Add(Linear(ffn), residual);
+  }
+
+  pir::Builder builder_;
+  pir::Value weight_;
+};
+
+void RunBenchmark(bool numa_aware) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Program program(ctx);
+  TransformerProgramBuilder(&program).Build();
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+
+  interpreter::ExecutionConfig execution_config;
+  execution_config.host_numa_aware_scheduling = numa_aware;
+  Scope scope;
+  InterpreterCore core(phi::CPUPlace(),
+                       {},
+                       kernel_program->block(),
+                       &scope,
+                       execution_config);
+  core.SetSkipGcVars({kOutName});
+  // The first run also builds the instructions.
+  for (int i = 0; i < kNumWarmupSteps; ++i) {
+    core.Run({});
+  }
+
+  std::vector<double> latencies;
+  double total_us = 0;
+  for (int i = 0; i < kNumSteps; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    core.Run({});
+    auto end = std::chrono::steady_clock::now();
+    latencies.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count());
+    total_us += latencies.back();
+  }
+  std::sort(latencies.begin(), latencies.end());
+  size_t p99_idx = std::min(static_cast<size_t>(latencies.size() * 0.99),
+                            latencies.size() - 1);
+  const size_t num_ops = kernel_program->block()->size();
+  double ops_per_sec =
+      static_cast<double>(num_ops) * kNumSteps / total_us * 1e6;
+  LOG(INFO) << (numa_aware ? "numa-aware" : "default")
+            << " PirInterpreter: " << num_ops << " ops/step, " << ops_per_sec
+            << " ops/sec, p50 step latency " << latencies[latencies.size() / 2]
+            << " us, p99 step latency " << latencies[p99_idx] << " us";
+}
+
+}  // namespace
+
+TEST(WorkQueueBenchmark, TransformerProgramDefault) { RunBenchmark(false); }
+
+TEST(WorkQueueBenchmark, TransformerProgramNumaAware) { RunBenchmark(true); }
+
+}  // namespace framework
+}  // namespace paddle
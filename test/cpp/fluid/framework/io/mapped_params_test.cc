@@ -0,0 +1,100 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/mapped_params.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <fstream>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+void FillTensor(const std::vector<int64_t>& dims,
+                float start,
+                phi::DenseTensor* tensor) {
+  tensor->Resize(common::make_ddim(dims));
+  float* data = tensor->mutable_data<float>(phi::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = start + static_cast<float>(i);
+  }
+}
+
+void ExpectEqual(const phi::DenseTensor& a, const phi::DenseTensor& b) {
+  ASSERT_EQ(a.dims(), b.dims());
+  ASSERT_EQ(a.dtype(), b.dtype());
+  for (int64_t i = 0; i < a.numel(); ++i) {
+    EXPECT_EQ(a.data<float>()[i], b.data<float>()[i]);
+  }
+}
+
+}  // namespace
+
+TEST(MappedParams, convert_and_load) {
+  phi::DenseTensor weight, bias, scalar;
+  FillTensor({3, 5}, 0.f, &weight);
+  FillTensor({7}, 100.f, &bias);
+  FillTensor({}, 42.f, &scalar);
+
+  const std::string params_file = "mapped_params_test.pdiparams";
+  const std::string mapped_file = "mapped_params_test.mapped";
+  {
+    std::ofstream fout(params_file, std::ios::binary);
+    for (auto* tensor : {&weight, &bias, &scalar}) {
+      SerializeToStream(fout, *tensor);
+    }
+  }
+  ConvertToMappedParams(params_file, mapped_file);
+  EXPECT_FALSE(IsMappedParamsFile(params_file));
+  ASSERT_TRUE(IsMappedParamsFile(mapped_file));
+
+  phi::DenseTensor out_weight, out_bias, out_scalar;
+  LoadMappedParams(
+      mapped_file, {&out_weight, &out_bias, &out_scalar}, phi::CPUPlace());
+  ExpectEqual(weight, out_weight);
+  ExpectEqual(bias, out_bias);
+  ExpectEqual(scalar, out_scalar);
+  for (auto* tensor : {&out_weight, &out_bias, &out_scalar}) {
+    EXPECT_EQ(
+        reinterpret_cast<uintptr_t>(tensor->data()) % kMappedParamsAlignment,
+        0UL);
+  }
+
+  // The mapping is private, writing a loaded tensor leaves the file intact.
+  out_weight.data<float>()[0] = -1.f;
+  phi::DenseTensor reloaded_weight, reloaded_bias, reloaded_scalar;
+  LoadMappedParams(mapped_file,
+                   {&reloaded_weight, &reloaded_bias, &reloaded_scalar},
+                   phi::CPUPlace());
+  ExpectEqual(weight, reloaded_weight);
+}
+
+TEST(MappedParams, tensor_num_mismatch) {
+  phi::DenseTensor weight;
+  FillTensor({4, 4}, 0.f, &weight);
+  const std::string mapped_file = "mapped_params_mismatch_test.mapped";
+  SaveMappedParams({&weight}, mapped_file);
+
+  phi::DenseTensor out_a, out_b;
+  EXPECT_THROW(LoadMappedParams(mapped_file, {&out_a, &out_b}, phi::CPUPlace()),
+               common::enforce::EnforceNotMet);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -203,3 +203,42 @@ TEST(WorkQueue, TestWorkQueueGroup) {
   queue_group.reset();
   waiter_thread.join();
 }
+
+TEST(WorkQueueUtils, TestGetNumaNodeCpus) {
+  auto nodes = paddle::framework::GetNumaNodeCpus();
+  EXPECT_GE(nodes.size(), 1u);
+  for (const auto& cpus : nodes) {
+    EXPECT_FALSE(cpus.empty());
+  }
+}
+
+TEST(WorkQueue, TestNumaAwareWorkQueue) {
+  using paddle::framework::CreateMultiThreadedWorkQueue;
+  using paddle::framework::EventsWaiter;
+  using paddle::framework::WorkQueueOptions;
+  std::atomic<unsigned> counter{0};
+  constexpr unsigned kExternalLoopNum = 100;
+  constexpr unsigned kInternalLoopNum = 100;
+  EventsWaiter events_waiter;
+  WorkQueueOptions options(/*name*/ "NumaAwareWorkQueueForTesting",
+                           /*num_threads*/ 8,
+                           /*allow_spinning*/ true,
+                           /*always_spinning*/ false,
+                           /*track_task*/ true,
+                           /*detached*/ true,
+                           &events_waiter);
+  options.numa_aware = true;
+  auto work_queue = CreateMultiThreadedWorkQueue(options);
+  EXPECT_EQ(work_queue->NumThreads(), 8u);
+  // Tasks spawned from workers go to the local queue and may be stolen.
+  auto* queue = work_queue.get();
+  for (unsigned i = 0; i < kExternalLoopNum; ++i) {
+    work_queue->AddTask([queue, &counter]() {
+      for (unsigned j = 0; j < kInternalLoopNum; ++j) {
+        queue->AddTask([&counter]() { ++counter; });
+      }
+    });
+  }
+  events_waiter.WaitEvent();
+  EXPECT_EQ(counter.load(), kExternalLoopNum * kInternalLoopNum);
+}
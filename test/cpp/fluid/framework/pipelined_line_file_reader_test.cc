@@ -0,0 +1,272 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/pipelined_line_file_reader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>  // NOLINT
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/text_format.h"
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/data_feed.h"
+#include "paddle/fluid/framework/data_feed_factory.h"
+
+COMMON_DECLARE_int32(data_feed_parse_thread_num);
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+void WriteFile(const std::string& path, const std::string& content) {
+  std::ofstream ofs(path, std::ios::binary);
+  ofs << content;
+}
+
+// Lines of 0 to max_length - 1 characters, each one unique.
+std::vector<std::string> MakeLines(size_t num, size_t max_length) {
+  std::mt19937 rng(2024);
+  std::vector<std::string> lines;
+  for (size_t i = 0; i < num; ++i) {
+    std::string line = std::to_string(i) + " ";
+    line.append(rng() % max_length, 'a' + i % 26);
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+std::string JoinLines(const std::vector<std::string>& lines) {
+  std::string content;
+  for (auto& line : lines) {
+    content += line;
+    content += '\n';
+  }
+  return content;
+}
+
+// Reads path with reader and returns the sorted lines passed to the LineFunc.
+std::vector<std::string> ReadLines(PipelinedLineFileReader* reader,
+                                   const std::string& path,
+                                   int* line_num) {
+  std::mutex mutex;
+  std::vector<std::string> lines;
+  FILE* fp = fopen(path.c_str(), "r");
+  *line_num = reader->read_file(
+      fp,
+      [&](int thread_id, const std::string& line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        lines.push_back(line);
+        return true;
+      },
+      0);
+  fclose(fp);
+  std::sort(lines.begin(), lines.end());
+  return lines;
+}
+
+}  // namespace
+
+TEST(PipelinedLineFileReader, LinesSpanBlockBoundary) {
+  const std::string path = "pipelined_line_file_reader_boundary.txt";
+  // About 10MB, so that lines span the boundaries of the default 4MB blocks.
+  std::vector<std::string> expected = MakeLines(40000, 500);
+  std::string content = JoinLines(expected);
+  ASSERT_GT(content.size(), 2 * PipelinedLineFileReader::DEFAULT_BLOCK_SIZE);
+  WriteFile(path, content);
+  std::sort(expected.begin(), expected.end());
+
+  // A block of 7 bytes is shorter than most lines.
+  for (size_t block_size : {PipelinedLineFileReader::DEFAULT_BLOCK_SIZE,
+                            static_cast<size_t>(4093),
+                            static_cast<size_t>(7)}) {
+    PipelinedLineFileReader reader(4, block_size);
+    int line_num = 0;
+    EXPECT_EQ(ReadLines(&reader, path, &line_num), expected);
+    EXPECT_EQ(line_num, static_cast<int>(expected.size()));
+    EXPECT_EQ(reader.file_size(), content.size());
+    EXPECT_FALSE(reader.is_error());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(PipelinedLineFileReader, LastLineWithoutNewline) {
+  const std::string path = "pipelined_line_file_reader_last_line.txt";
+  for (size_t block_size : {PipelinedLineFileReader::DEFAULT_BLOCK_SIZE,
+                            static_cast<size_t>(3)}) {
+    PipelinedLineFileReader reader(2, block_size);
+    int line_num = 0;
+    WriteFile(path, "first\nsecond\nlast");
+    EXPECT_EQ(ReadLines(&reader, path, &line_num),
+              (std::vector<std::string>{"first", "last", "second"}));
+    EXPECT_EQ(line_num, 3);
+
+    WriteFile(path, "only");
+    EXPECT_EQ(ReadLines(&reader, path, &line_num),
+              std::vector<std::string>{"only"});
+    EXPECT_EQ(line_num, 1);
+
+    WriteFile(path, "");
+    EXPECT_TRUE(ReadLines(&reader, path, &line_num).empty());
+    EXPECT_EQ(line_num, 0);
+  }
+  std::remove(path.c_str());
+}
+
+// More than 10 bad lines stop the reading, and the retry with the returned
+// line num as skip_lines parses each remaining line once, as
+// SlotRecordInMemoryDataFeed::LoadIntoMemoryByPipeline does.
+TEST(PipelinedLineFileReader, RetrySkipsDispatchedLines) {
+  const std::string path = "pipelined_line_file_reader_retry.txt";
+  std::vector<std::string> lines = MakeLines(5000, 50);
+  for (int i = 0; i < 12; ++i) {
+    lines[i * 3] = "bad " + std::to_string(i);
+  }
+  WriteFile(path, JoinLines(lines));
+
+  PipelinedLineFileReader reader(3, 64);
+  std::mutex mutex;
+  std::map<std::string, int> parse_count;
+  int line_num = 0;
+  int tries = 0;
+  do {
+    ++tries;
+    FILE* fp = fopen(path.c_str(), "r");
+    line_num = reader.read_file(
+        fp,
+        [&](int thread_id, const std::string& line) {
+          std::lock_guard<std::mutex> lock(mutex);
+          ++parse_count[line];
+          return line.compare(0, 4, "bad ") != 0;
+        },
+        line_num);
+    fclose(fp);
+  } while (reader.is_error() && tries < 10);
+
+  EXPECT_EQ(tries, 2);
+  EXPECT_FALSE(reader.is_error());
+  EXPECT_EQ(line_num, static_cast<int>(lines.size()));
+  ASSERT_EQ(parse_count.size(), lines.size());
+  for (auto& item : parse_count) {
+    EXPECT_EQ(item.second, 1) << item.first;
+  }
+  std::remove(path.c_str());
+}
+
+namespace {
+
+std::string RecordToString(const Record& record) {
+  std::ostringstream os;
+  for (auto& item : record.uint64_feasigns_) {
+    os << item.slot() << ":" << item.sign().uint64_feasign_ << " ";
+  }
+  os << "| ";
+  for (auto& item : record.float_feasigns_) {
+    os << item.slot() << ":" << item.sign().float_feasign_ << " ";
+  }
+  return os.str();
+}
+
+// Loads path with MultiSlotInMemoryDataFeed, returns the sorted records as
+// strings and the feasign num.
+std::vector<std::string> LoadRecords(const DataFeedDesc& desc,
+                                     const std::string& path,
+                                     int parse_thread_num,
+                                     uint64_t* fea_num) {
+  FLAGS_data_feed_parse_thread_num = parse_thread_num;
+  std::mutex file_mutex;
+  std::mutex fea_num_mutex;
+  size_t file_idx = 0;
+  *fea_num = 0;
+  auto channel = MakeChannel<Record>();
+  auto feed = DataFeedFactory::CreateDataFeed("MultiSlotInMemoryDataFeed");
+  feed->Init(desc);
+  feed->SetFileListMutex(&file_mutex);
+  feed->SetFileListIndex(&file_idx);
+  feed->SetFeaNumMutex(&fea_num_mutex);
+  feed->SetFeaNum(fea_num);
+  feed->SetInputChannel(channel.get());
+  feed->SetFileList({path});
+  feed->LoadIntoMemory();
+  FLAGS_data_feed_parse_thread_num = 0;
+
+  channel->Close();
+  std::vector<Record> records;
+  channel->ReadAll(records);
+  std::vector<std::string> result;
+  for (auto& record : records) {
+    result.push_back(RecordToString(record));
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+}  // namespace
+
+TEST(PipelinedLineFileReader, SameRecordsAsSerialLoader) {
+  DataFeedDesc desc;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+      "name: \"MultiSlotInMemoryDataFeed\"\n"
+      "batch_size: 2\n"
+      "multi_slot_desc {\n"
+      "  slots { name: \"uint64_sparse\" type: \"uint64\" is_used: true }\n"
+      "  slots { name: \"float_sparse\" type: \"float\" is_used: true }\n"
+      "  slots { name: \"not_used\" type: \"uint64\" is_used: false }\n"
+      "  slots { name: \"uint64_dense\" type: \"uint64\" is_dense: true\n"
+      "          is_used: true }\n"
+      "}",
+      &desc));
+
+  // More than one 4MB block, and the last line has no newline.
+  const std::string path = "pipelined_line_file_reader_records.txt";
+  std::mt19937 rng(2024);
+  std::ostringstream os;
+  for (int i = 0; i < 60000; ++i) {
+    if (i > 0) {
+      os << "\n";
+    }
+    int num = 1 + rng() % 8;
+    os << num;
+    for (int k = 0; k < num; ++k) {
+      os << " " << rng();
+    }
+    num = 1 + rng() % 4;
+    os << " " << num;
+    for (int k = 0; k < num; ++k) {
+      os << " " << static_cast<float>(rng() % 10000) / 100;
+    }
+    os << " 2 " << rng() << " " << i << " 1 " << i;
+  }
+  WriteFile(path, os.str());
+  ASSERT_GT(os.str().size(), PipelinedLineFileReader::DEFAULT_BLOCK_SIZE);
+
+  uint64_t serial_fea_num = 0;
+  uint64_t pipelined_fea_num = 0;
+  auto serial = LoadRecords(desc, path, 0, &serial_fea_num);
+  auto pipelined = LoadRecords(desc, path, 4, &pipelined_fea_num);
+  EXPECT_EQ(serial.size(), 60000u);
+  EXPECT_EQ(serial, pipelined);
+  EXPECT_EQ(serial_fea_num, pipelined_fea_num);
+  std::remove(path.c_str());
+}
+
+}  // namespace framework
+}  // namespace paddle
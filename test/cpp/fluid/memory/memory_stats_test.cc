@@ -40,6 +40,22 @@ TEST(stat_allocator_test, host_memory_stat_test) {
   EXPECT_EQ(HostMemoryStatPeakValue("Allocated", 0), max_alloc_size);
 }
 
+TEST(stat_allocator_test, thread_alloc_free_bytes_test) {
+  const auto* bytes = CurrentThreadAllocFreeBytes(phi::CPUPlace());
+  int64_t allocated = bytes->allocated;
+  int64_t freed = bytes->freed;
+  int64_t alloc_size = 0;
+  {
+    AllocationPtr allocation = Alloc(phi::CPUPlace(), 4096);
+    alloc_size = static_cast<int64_t>(allocation->size());
+    EXPECT_EQ(bytes->allocated - allocated, alloc_size);
+    EXPECT_EQ(bytes->freed - freed, 0);
+  }
+  // The free is counted apart, the allocation stays counted.
+  EXPECT_EQ(bytes->allocated - allocated, alloc_size);
+  EXPECT_EQ(bytes->freed - freed, alloc_size);
+}
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 TEST(stat_allocator_test, device_memory_stat_test) {
   std::vector<int64_t> alloc_sizes{
@@ -0,0 +1,178 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/api/profiler/host_event_stream.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/api/profiler/common_event.h"
+#include "paddle/phi/api/profiler/host_event_recorder.h"
+
+using phi::CommonEvent;
+using phi::EventRole;
+using phi::HostEventRecorder;
+using phi::HostEventStreamer;
+using phi::HostEventStreamOptions;
+using phi::TracerEventType;
+
+namespace {
+
+std::string ReadFile(const std::string &path) {
+  std::ifstream ifs(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(ifs),
+                     std::istreambuf_iterator<char>());
+}
+
+template <typename T>
+T ReadValue(const std::string &data, size_t *offset) {
+  T value;
+  std::memcpy(&value, data.data() + *offset, sizeof(T));
+  *offset += sizeof(T);
+  return value;
+}
+
+// Returns the number of events of each name in a BinaryChunkStreamSink file.
+std::map<std::string, size_t> CountBinaryEvents(const std::string &path) {
+  std::string data = ReadFile(path);
+  std::map<std::string, size_t> counts;
+  EXPECT_EQ(data.compare(0, 8, phi::BinaryChunkStreamSink::kMagic), 0);
+  size_t offset = 8 + sizeof(uint64_t);
+  while (offset < data.size()) {
+    uint32_t kind = ReadValue<uint32_t>(data, &offset);
+    uint32_t num = ReadValue<uint32_t>(data, &offset);
+    ReadValue<uint64_t>(data, &offset);  // thread_id
+    if (kind == phi::BinaryChunkStreamSink::kThreadName) {
+      offset += num;
+      continue;
+    }
+    for (uint32_t i = 0; i < num; ++i) {
+      uint64_t start_ns = ReadValue<uint64_t>(data, &offset);
+      uint64_t end_ns = ReadValue<uint64_t>(data, &offset);
+      EXPECT_LE(start_ns, end_ns);
+      ReadValue<uint32_t>(data, &offset);  // type
+      uint32_t name_length = ReadValue<uint32_t>(data, &offset);
+      ++counts[data.substr(offset, name_length)];
+      offset += name_length;
+    }
+  }
+  EXPECT_EQ(offset, data.size());
+  return counts;
+}
+
+}  // namespace
+
+TEST(HostEventStreamTest, RingBufferDropsWhenFull) {
+  phi::HostEventRingBuffer ring(3);
+  EXPECT_EQ(ring.capacity(), 4u);
+  for (uint64_t i = 0; i < 6; ++i) {
+    ring.Push("event", 5, i, i + 1, TracerEventType::UserDefined);
+  }
+  EXPECT_EQ(ring.dropped(), 2u);
+
+  phi::StreamedHostEvent events[8];
+  EXPECT_EQ(ring.Pop(events, 3), 3u);
+  EXPECT_EQ(events[0].start_ns, 0u);
+  EXPECT_EQ(events[2].start_ns, 2u);
+  EXPECT_STREQ(events[2].name, "event");
+  EXPECT_TRUE(ring.Push("next", 4, 6, 7, TracerEventType::UserDefined));
+  EXPECT_EQ(ring.Pop(events, 8), 2u);
+  EXPECT_EQ(events[0].start_ns, 3u);
+  EXPECT_EQ(events[1].start_ns, 6u);
+  EXPECT_EQ(ring.Pop(events, 8), 0u);
+
+  std::string long_name(200, 'a');
+  ring.Push(long_name.c_str(),
+            long_name.size(),
+            0,
+            0,
+            TracerEventType::UserDefined);
+  EXPECT_EQ(ring.Pop(events, 8), 1u);
+  EXPECT_EQ(events[0].name_length, phi::StreamedHostEvent::kMaxNameLength);
+  EXPECT_EQ(std::strlen(events[0].name),
+            phi::StreamedHostEvent::kMaxNameLength);
+}
+
+TEST(HostEventStreamTest, StreamBinaryChunks) {
+  const std::string path = "test_host_event_stream.bin";
+  HostEventStreamOptions options;
+  options.drain_interval_ms = 1;
+  HostEventStreamer::GetInstance().Start(
+      phi::CreateHostEventStreamSink(path, "binary"), options);
+
+  constexpr int kNumThreads = 4;
+  constexpr int kNumEvents = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([] {
+      for (int i = 0; i < kNumEvents; ++i) {
+        HostEventRecorder<CommonEvent>::GetInstance().RecordEvent(
+            "stream_event",
+            i,
+            i + 1,
+            EventRole::kOrdinary,
+            TracerEventType::UserDefined);
+        HostEventRecorder<CommonEvent>::GetInstance().RecordEvent(
+            std::string("stream_string_event"),
+            i,
+            i + 1,
+            EventRole::kOrdinary,
+            TracerEventType::UserDefined);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  uint64_t dropped = HostEventStreamer::GetInstance().Stop();
+  EXPECT_FALSE(HostEventStreamer::IsStreaming());
+
+  auto counts = CountBinaryEvents(path);
+  EXPECT_EQ(counts["stream_event"] + counts["stream_string_event"] + dropped,
+            2u * kNumThreads * kNumEvents);
+
+  // The streamed events are not kept by the recorder.
+  auto host_events =
+      HostEventRecorder<CommonEvent>::GetInstance().GatherEvents();
+  for (const auto &thr_sec : host_events.thr_sections) {
+    EXPECT_TRUE(thr_sec.events.empty());
+  }
+}
+
+TEST(HostEventStreamTest, StreamChromeTrace) {
+  const std::string path = "test_host_event_stream.json";
+  HostEventStreamOptions options;
+  HostEventStreamer::GetInstance().Start(
+      phi::CreateHostEventStreamSink(path, "json"), options);
+  HostEventRecorder<CommonEvent>::GetInstance().RecordEvent(
+      "quoted\"event",
+      1000,
+      3500,
+      EventRole::kOrdinary,
+      TracerEventType::Operator);
+  EXPECT_EQ(HostEventStreamer::GetInstance().Stop(), 0u);
+
+  std::string trace = ReadFile(path);
+  EXPECT_EQ(trace.front(), '[');
+  EXPECT_EQ(trace.substr(trace.size() - 3), "\n]\n");
+  EXPECT_NE(trace.find("\"name\":\"quoted\\\"event\""), std::string::npos);
+  EXPECT_NE(trace.find("\"cat\":\"Operator\""), std::string::npos);
+  EXPECT_NE(trace.find("\"ts\":1.000,\"dur\":2.500"), std::string::npos);
+}
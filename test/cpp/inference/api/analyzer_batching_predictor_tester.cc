@@ -0,0 +1,184 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "test/cpp/inference/api/tester_helper.h"
+
+namespace paddle_infer {
+namespace services {
+
+namespace {
+
+const std::vector<int> kInputShape = {1, 3, 224, 224};
+
+Config GetConfig() {
+  Config config;
+  config.SetModel(FLAGS_infer_model + "/model", FLAGS_infer_model + "/params");
+  config.DisableGpu();
+  config.SetCpuMathLibraryNumThreads(FLAGS_cpu_num_threads);
+#ifdef PADDLE_WITH_DNNL
+  config.EnableMKLDNN();
+#endif
+  return config;
+}
+
+PaddleTensor MakeInput(uint32_t seed) {
+  PaddleTensor tensor;
+  tensor.name = "data";
+  tensor.shape = kInputShape;
+  tensor.dtype = DataType::FLOAT32;
+  size_t numel = 1;
+  for (int dim : kInputShape) {
+    numel *= dim;
+  }
+  tensor.data.Resize(numel * sizeof(float));
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(0.f, 1.f);
+  float *data = static_cast<float *>(tensor.data.data());
+  for (size_t i = 0; i < numel; ++i) {
+    data[i] = dist(rng);
+  }
+  return tensor;
+}
+
+// The latency below which the given fraction of the samples fall, as the
+// upper bound of the histogram bucket.
+uint64_t Percentile(const std::vector<uint64_t> &hist, double fraction) {
+  uint64_t total = 0;
+  for (auto count : hist) {
+    total += count;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < hist.size(); ++i) {
+    seen += hist[i];
+    if (seen >= fraction * total) {
+      return 1ULL << i;
+    }
+  }
+  return 1ULL << hist.size();
+}
+
+}  // namespace
+
+TEST(BatchingPredictor, same_result_as_predictor) {
+  auto predictor = CreatePredictor(GetConfig());
+  constexpr int kClients = 4;
+  std::vector<PaddleTensor> inputs;
+  std::vector<std::vector<float>> expected(kClients);
+  for (int i = 0; i < kClients; ++i) {
+    inputs.emplace_back(MakeInput(i));
+    auto input = predictor->GetInputHandle("data");
+    input->Reshape(kInputShape);
+    input->CopyFromCpu(static_cast<float *>(inputs[i].data.data()));
+    ASSERT_TRUE(predictor->Run());
+    auto output = predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+    int numel = 1;
+    for (int dim : output->shape()) {
+      numel *= dim;
+    }
+    expected[i].resize(numel);
+    output->CopyToCpu(expected[i].data());
+  }
+
+  BatchingConfig batching_config;
+  batching_config.max_batch_size = kClients;
+  // Long enough for all the clients to join one batch.
+  batching_config.max_wait_us = 100000;
+  BatchingPredictor batching_predictor(GetConfig(), batching_config);
+  std::vector<std::vector<PaddleTensor>> outputs(kClients);
+  std::vector<std::thread> clients;
+  for (int i = 0; i < kClients; ++i) {
+    clients.emplace_back([&, i] {
+      ASSERT_TRUE(batching_predictor.Run({inputs[i]}, &outputs[i]));
+    });
+  }
+  for (auto &client : clients) {
+    client.join();
+  }
+
+  for (int i = 0; i < kClients; ++i) {
+    ASSERT_EQ(outputs[i].size(), 1UL);
+    ASSERT_EQ(outputs[i][0].shape[0], 1);
+    ASSERT_EQ(outputs[i][0].data.length(), expected[i].size() * sizeof(float));
+    const float *data = static_cast<const float *>(outputs[i][0].data.data());
+    for (size_t j = 0; j < expected[i].size(); ++j) {
+      EXPECT_NEAR(data[j], expected[i][j], 1e-4);
+    }
+  }
+  auto stats = batching_predictor.GetStats();
+  EXPECT_EQ(stats.num_requests, static_cast<uint64_t>(kClients));
+  EXPECT_LT(stats.num_batches, static_cast<uint64_t>(kClients));
+}
+
+// Load generator: concurrent clients send single image requests, compare the
+// throughput and latencies without (max_batch_size 1) and with batching.
+TEST(BatchingPredictor, load_generator) {
+  constexpr int kClients = 16;
+  const int requests_per_client = FLAGS_iterations > 0 ? FLAGS_iterations : 8;
+  auto input = MakeInput(2024);
+
+  for (int max_batch_size : {1, 8}) {
+    BatchingConfig batching_config;
+    batching_config.max_batch_size = max_batch_size;
+    batching_config.max_wait_us = 2000;
+    batching_config.num_workers = 2;
+    BatchingPredictor batching_predictor(GetConfig(), batching_config);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (int i = 0; i < kClients; ++i) {
+      clients.emplace_back([&] {
+        std::vector<PaddleTensor> outputs;
+        for (int j = 0; j < requests_per_client; ++j) {
+          ASSERT_TRUE(batching_predictor.Run({input}, &outputs));
+        }
+      });
+    }
+    for (auto &client : clients) {
+      client.join();
+    }
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    auto stats = batching_predictor.GetStats();
+    ASSERT_EQ(stats.num_requests,
+              static_cast<uint64_t>(kClients * requests_per_client));
+    LOG(INFO) << "max_batch_size " << max_batch_size << ": "
+              << stats.num_requests / seconds << " requests/sec, "
+              << static_cast<double>(stats.num_requests) / stats.num_batches
+              << " requests/batch, queue latency p50 <= "
+              << Percentile(stats.queue_latency_us_hist, 0.5)
+              << "us p99 <= " << Percentile(stats.queue_latency_us_hist, 0.99)
+              << "us, exec latency p50 <= "
+              << Percentile(stats.exec_latency_us_hist, 0.5)
+              << "us p99 <= " << Percentile(stats.exec_latency_us_hist, 0.99)
+              << "us";
+  }
+}
+
+}  // namespace services
+}  // namespace paddle_infer
@@ -0,0 +1,104 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "test/cpp/inference/api/tester_helper.h"
+
+namespace paddle_infer {
+
+namespace {
+
+const std::vector<int> kInputShape = {1, 3, 224, 224};
+
+// The resident memory of this process in kB, anonymous and file backed.
+std::pair<int64_t, int64_t> GetRss() {
+  std::ifstream fin("/proc/self/status");
+  std::string key;
+  int64_t rss_anon = -1, rss_file = -1;
+  while (fin >> key) {
+    if (key == "RssAnon:") {
+      fin >> rss_anon;
+    } else if (key == "RssFile:") {
+      fin >> rss_file;
+    } else {
+      fin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      continue;
+    }
+    fin >> key;  // unit
+  }
+  return {rss_anon, rss_file};
+}
+
+std::vector<float> RunModel(const std::string &params_file,
+                            const std::string &label) {
+  auto rss_before = GetRss();
+  auto start = std::chrono::steady_clock::now();
+  Config config;
+  config.SetModel(FLAGS_infer_model + "/model", params_file);
+  config.DisableGpu();
+  config.SetCpuMathLibraryNumThreads(FLAGS_cpu_num_threads);
+  auto predictor = CreatePredictor(config);
+  double load_ms = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  auto rss_after = GetRss();
+  LOG(INFO) << label << ": load " << load_ms << "ms, RssAnon +"
+            << rss_after.first - rss_before.first << "kB, RssFile +"
+            << rss_after.second - rss_before.second << "kB";
+
+  auto input = predictor->GetInputHandle(predictor->GetInputNames()[0]);
+  input->Reshape(kInputShape);
+  std::vector<float> input_data(1 * 3 * 224 * 224);
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    input_data[i] = static_cast<float>(i % 255) / 255.f;
+  }
+  input->CopyFromCpu(input_data.data());
+  EXPECT_TRUE(predictor->Run());
+  auto output = predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+  int numel = 1;
+  for (int dim : output->shape()) {
+    numel *= dim;
+  }
+  std::vector<float> output_data(numel);
+  output->CopyToCpu(output_data.data());
+  return output_data;
+}
+
+}  // namespace
+
+TEST(MappedParams, same_result_as_combined_params) {
+  const std::string params_file = FLAGS_infer_model + "/params";
+  const std::string mapped_params_file = "resnet50_mapped.pdiparams";
+  ConvertToMappedParams(params_file, mapped_params_file);
+
+  auto expected = RunModel(params_file, "combined params");
+  auto actual = RunModel(mapped_params_file, "mapped params");
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_FLOAT_EQ(actual[i], expected[i]);
+  }
+}
+
+}  // namespace paddle_infer
@@ -0,0 +1,94 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/kernels/funcs/cpu_broadcast.h"
+#include "paddle/phi/kernels/funcs/elementwise_base.h"
+#include "paddle/phi/kernels/funcs/elementwise_functor.h"
+
+namespace phi {
+namespace tests {
+
+void FillTensor(const phi::CPUContext& dev_ctx,
+                const std::vector<int64_t>& dims,
+                float start,
+                phi::DenseTensor* tensor) {
+  tensor->Resize(common::make_ddim(dims));
+  float* data = dev_ctx.Alloc<float>(tensor);
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = start + static_cast<float>(i % 97);
+  }
+}
+
+// Compares with ElementwiseCompute, the broadcast used before. The times of
+// both are compared by test/cpp/fluid/benchmark/cpu_broadcast_benchmark.cc.
+template <typename Functor, typename InverseFunctor>
+void TestBroadcast(const std::vector<int64_t>& x_dims,
+                   const std::vector<int64_t>& y_dims,
+                   const std::vector<int64_t>& out_dims,
+                   int axis = -1) {
+  auto* dev_ctx =
+      phi::DeviceContextPool::Instance().GetByPlace(phi::CPUPlace());
+  phi::DenseTensor x, y, expected, actual;
+  FillTensor(*dev_ctx, x_dims, 1.f, &x);
+  FillTensor(*dev_ctx, y_dims, 3.f, &y);
+  expected.Resize(common::make_ddim(out_dims));
+  actual.Resize(common::make_ddim(out_dims));
+
+  if (x_dims.size() >= y_dims.size()) {
+    funcs::ElementwiseCompute<Functor, float>(
+        *dev_ctx, x, y, Functor(), &expected, axis);
+  } else {
+    funcs::ElementwiseCompute<InverseFunctor, float>(
+        *dev_ctx, x, y, InverseFunctor(), &expected, axis);
+  }
+  funcs::CPUBroadcastCompute<Functor, float>(
+      *dev_ctx, x, y, Functor(), &actual, axis);
+  ASSERT_EQ(actual.dims(), expected.dims());
+  for (int64_t i = 0; i < expected.numel(); ++i) {
+    ASSERT_FLOAT_EQ(actual.data<float>()[i], expected.data<float>()[i])
+        << "at " << i << " of " << actual.dims();
+  }
+}
+
+TEST(CPUBroadcast, add) {
+  using Add = funcs::AddFunctor<float>;
+  using InverseAdd = funcs::InverseAddFunctor<float>;
+  TestBroadcast<Add, InverseAdd>({8, 64, 28, 28}, {64, 1, 1}, {8, 64, 28, 28});
+  TestBroadcast<Add, InverseAdd>({64, 1, 1}, {8, 64, 28, 28}, {8, 64, 28, 28});
+  TestBroadcast<Add, InverseAdd>({256, 1024}, {1024}, {256, 1024});
+  TestBroadcast<Add, InverseAdd>({256, 1}, {1, 1024}, {256, 1024});
+  TestBroadcast<Add, InverseAdd>({8, 64, 28, 28}, {64}, {8, 64, 28, 28}, 1);
+  TestBroadcast<Add, InverseAdd>({2, 3, 4}, {3, 4, 1}, {2, 3, 4}, 1);
+  TestBroadcast<Add, InverseAdd>(
+      {4, 1, 6, 1, 8}, {5, 1, 7, 1}, {4, 5, 6, 7, 8});
+  TestBroadcast<Add, InverseAdd>({}, {16, 16}, {16, 16});
+}
+
+TEST(CPUBroadcast, subtract_divide) {
+  using Sub = funcs::SubtractFunctor<float>;
+  using InverseSub = funcs::InverseSubtractFunctor<float>;
+  using Div = funcs::DivideFunctor<float>;
+  using InverseDiv = funcs::InverseDivideFunctor<float>;
+  TestBroadcast<Sub, InverseSub>({512}, {128, 512}, {128, 512});
+  TestBroadcast<Sub, InverseSub>({16, 32, 1}, {16, 1, 64}, {16, 32, 64});
+  TestBroadcast<Div, InverseDiv>({32, 1}, {8, 32, 256}, {8, 32, 256});
+  TestBroadcast<Div, InverseDiv>({8, 32, 256}, {1}, {8, 32, 256});
+}
+
+}  // namespace tests
+}  // namespace phi
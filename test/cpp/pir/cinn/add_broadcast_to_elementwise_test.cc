@@ -15,6 +15,7 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 #include <memory>
+#include <sstream>
 
 #include "paddle/cinn/hlir/dialect/operator/ir/cinn_op.h"
 #include "paddle/cinn/hlir/dialect/operator/ir/manual_op.h"
@@ -249,3 +250,64 @@ TEST(PatternRewrite, broadcast_elementwise_sub_both) {
           "Expected SubtractOp but found different operation type: " +
           std::string(it->name())));
 }
+
+// num_group_ops group ops, every two of them share an input defined outside.
+void BuildProgramManyGroups(pir::Builder &builder,  // NOLINT
+                            int num_group_ops) {
+  pir::Block *block = builder.block();
+  pir::Value x;
+  for (int i = 0; i < num_group_ops; ++i) {
+    builder.SetInsertionPointToBlockEnd(block);
+    if (i % 2 == 0) {
+      x = builder
+              .Build<paddle::dialect::FullOp>(std::vector<int64_t>{16},
+                                              1.5,
+                                              phi::DataType::FLOAT32,
+                                              phi::CPUPlace())
+              .out();
+    }
+    auto group_op = builder.Build<cinn::dialect::GroupOp>(
+        CreateDenseTensorTypes(common::make_ddim({4, 16})));
+    builder.SetInsertionPointToBlockEnd(group_op.block());
+    auto relu_op = builder.Build<paddle::dialect::ReluOp>(x);
+    auto full_op =
+        builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{4, 1},
+                                               2.0,
+                                               phi::DataType::FLOAT32,
+                                               phi::CPUPlace());
+    auto add_op = builder.Build<paddle::dialect::AddOp>(relu_op.out(),
+                                                        full_op.out());
+    builder.Build<pir::YieldOp>(std::vector<pir::Value>{add_op.out()});
+  }
+}
+
+TEST(PatternRewrite, broadcast_elementwise_parallel) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  ctx->GetOrRegisterDialect<cinn::dialect::OperatorDialect>();
+
+  const auto RunPass = [&](int num_threads) {
+    pir::Program program(ctx);
+    pir::Builder builder = pir::Builder(ctx, program.block());
+    BuildProgramManyGroups(builder, 32);
+    pir::PassManager pm(ctx);
+    pm.AddPass(cinn::dialect::ir::CreateAddBroadcastToElementwisePass());
+    pm.EnableParallel(num_threads);
+    EXPECT_TRUE(pm.Run(&program));
+
+    size_t num_broadcast_ops = 0;
+    for (auto &op : *program.block()) {
+      if (!op.isa<cinn::dialect::GroupOp>()) continue;
+      for (auto &inner_op : *op.dyn_cast<cinn::dialect::GroupOp>().block()) {
+        if (inner_op.isa<cinn::dialect::BroadcastOp>()) ++num_broadcast_ops;
+      }
+    }
+    EXPECT_EQ(num_broadcast_ops, 32u);
+    std::ostringstream os;
+    program.Print(os);
+    return os.str();
+  };
+
+  EXPECT_EQ(RunPass(1), RunPass(4));
+}
@@ -0,0 +1,150 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/ir/group_schedule/cpu_schedule.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+
+#include "paddle/cinn/auto_schedule/database/tuning_record_database.h"
+#include "paddle/cinn/cinn.h"
+#include "paddle/cinn/ir/utils/ir_nodes_collector.h"
+#include "paddle/cinn/lang/lower.h"
+#include "paddle/common/flags.h"
+
+PD_DECLARE_string(cinn_tuning_record_file);
+
+namespace cinn {
+namespace ir {
+
+namespace {
+
+// The CPU kernel of a group of one elementwise op, merged as
+// OpLowererImpl::LowerX86 does. The CPU kernels of groups of any size are
+// lowered while tuning.
+Expr LowerCpuKernel(const std::string& output_name) {
+  Placeholder<float> a("A", {Expr(64), Expr(1024)});
+  Tensor b = Compute(
+      {Expr(64), Expr(1024)},
+      [&](Var i, Var j) { return a(i, j) + Expr(1.f); },
+      output_name);
+  ast_gen_ius::TensorGroup tensor_group({a, b});
+  auto func = lang::LowerToAst("fn_" + output_name,
+                               {a, b},
+                               &tensor_group,
+                               cinn::common::DefaultHostTarget());
+  ModuleExpr mod_expr({func->body});
+  IRSchedule ir_sch(
+      mod_expr, -1, false, cinn::utils::ErrorMessageLevel::kGeneral, true);
+  ir_sch.MergeExprs();
+  return ir_sch.GetModule().GetExprs().at(0);
+}
+
+bool HasVectorizedLoop(const Expr& expr) {
+  return !ir_utils::CollectIRNodesWithoutTensor(expr, [](const Expr* x) {
+            return x->As<For>() && x->As<For>()->is_vectorized();
+          }).empty();
+}
+
+std::string MakeTaskKey(const std::string& group_fingerprint) {
+  return auto_schedule::TuningRecordDatabase::MakeTaskKey(
+      cinn::common::DefaultHostTarget(), group_fingerprint);
+}
+
+// Tunes the kernel of output_name with a vectorize factor of 4, and commits
+// the trace as the record of task_key.
+void CommitVectorizeRecord(const std::string& task_key,
+                           const std::string& output_name) {
+  std::unordered_map<std::string, CpuKernelTrace> traces;
+  {
+    CpuScheduleParams params;
+    params.vectorize_factor = 4;
+    CpuScheduleTuningScope scope(params);
+    Expr tuned = ScheduleCpuKernel(
+        task_key, "fn_" + output_name, LowerCpuKernel(output_name));
+    EXPECT_TRUE(HasVectorizedLoop(tuned));
+    traces = scope.traces();
+  }
+  ASSERT_EQ(traces.count(task_key), 1UL);
+  EXPECT_EQ(traces.at(task_key).kernel_name, "fn_" + output_name);
+
+  auto_schedule::proto::TuningRecord record;
+  record.set_task_key(task_key);
+  record.set_execution_cost(1.0);
+  *record.mutable_trace() = traces.at(task_key).trace;
+  ASSERT_TRUE(auto_schedule::TuningRecordDatabase::Global()->Commit(record));
+}
+
+class ScheduleCpuKernelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    record_file_ = FLAGS_cinn_tuning_record_file;
+    // Global() keeps a database per file, so each test has its own file.
+    path_ = std::string("./schedule_cpu_kernel_") +
+            ::testing::UnitTest::GetInstance()->current_test_info()->name() +
+            ".json";
+    std::remove(path_.c_str());
+    FLAGS_cinn_tuning_record_file = path_;
+  }
+
+  void TearDown() override {
+    FLAGS_cinn_tuning_record_file = record_file_;
+    std::remove(path_.c_str());
+  }
+
+  std::string path_;
+
+ private:
+  std::string record_file_;
+};
+
+}  // namespace
+
+TEST_F(ScheduleCpuKernelTest, ReplayCommittedRecord) {
+  const std::string task_key = MakeTaskKey("elementwise");
+  CommitVectorizeRecord(task_key, "B");
+
+  // A new lowering of the group replays the record.
+  Expr kernel = LowerCpuKernel("B");
+  ASSERT_FALSE(HasVectorizedLoop(kernel));
+  Expr scheduled = ScheduleCpuKernel(task_key, "fn_B", kernel);
+  EXPECT_FALSE(scheduled.same_as(kernel));
+  EXPECT_TRUE(HasVectorizedLoop(scheduled));
+
+  // The record is also read back from the file.
+  auto_schedule::TuningRecordDatabase reloaded(path_);
+  ASSERT_TRUE(reloaded.GetBest(task_key).has_value());
+
+  // The kernels of other groups stay unscheduled.
+  Expr other = ScheduleCpuKernel(MakeTaskKey("other"), "fn_B", kernel);
+  EXPECT_TRUE(other.same_as(kernel));
+}
+
+TEST_F(ScheduleCpuKernelTest, StaleRecordFallsBack) {
+  // The record was tuned on a lowering of the group whose block was named B,
+  // the group now lowers to a block named C.
+  const std::string task_key = MakeTaskKey("elementwise");
+  CommitVectorizeRecord(task_key, "B");
+
+  Expr kernel = LowerCpuKernel("C");
+  Expr scheduled = ScheduleCpuKernel(task_key, "fn_C", kernel);
+  EXPECT_TRUE(scheduled.same_as(kernel));
+  EXPECT_FALSE(HasVectorizedLoop(scheduled));
+}
+
+}  // namespace ir
+}  // namespace cinn
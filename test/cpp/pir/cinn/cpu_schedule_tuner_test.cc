@@ -0,0 +1,157 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/cinn/hlir/dialect/operator/ir/op_dialect.h"
+#include "paddle/cinn/ir/group_schedule/cpu_schedule.h"
+#include "paddle/cinn/ir/group_schedule/search/cpu_schedule_tuner.h"
+#include "paddle/cinn/ir/group_schedule/search/measurer.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+
+PD_DECLARE_string(cinn_tuning_record_file);
+PHI_DECLARE_bool(enable_cinn_compile_cache);
+
+namespace {
+
+constexpr int kRepeats = 100;
+
+const std::vector<int64_t> kShape = {64, 1024};
+
+// exp(x) + y, then relu.
+std::shared_ptr<::pir::Program> BuildElementwiseProgram() {
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  auto program = std::make_shared<::pir::Program>(ctx);
+  ::pir::Builder builder = ::pir::Builder(ctx, program->block());
+
+  auto x = builder
+               .Build<paddle::dialect::DataOp>(
+                   "x", kShape, phi::DataType::FLOAT32, phi::CPUPlace())
+               .result(0);
+  auto y = builder
+               .Build<paddle::dialect::DataOp>(
+                   "y", kShape, phi::DataType::FLOAT32, phi::CPUPlace())
+               .result(0);
+  auto exp = builder.Build<paddle::dialect::ExpOp>(x).result(0);
+  auto add = builder.Build<paddle::dialect::AddOp>(exp, y).result(0);
+  auto out = builder.Build<paddle::dialect::ReluOp>(add).result(0);
+  builder.Build<paddle::dialect::FetchOp>(out, "out", 0);
+  return program;
+}
+
+// rmsnorm over the last axis.
+std::shared_ptr<::pir::Program> BuildRMSNormProgram() {
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  auto program = std::make_shared<::pir::Program>(ctx);
+  ::pir::Builder builder = ::pir::Builder(ctx, program->block());
+
+  auto x = builder
+               .Build<paddle::dialect::DataOp>(
+                   "x", kShape, phi::DataType::FLOAT32, phi::CPUPlace())
+               .result(0);
+  auto pow = builder.Build<paddle::dialect::PowOp>(x, 2.0).result(0);
+  auto sum =
+      builder
+          .Build<paddle::dialect::SumOp>(
+              pow, std::vector<int64_t>{-1}, phi::DataType::FLOAT32, true)
+          .result(0);
+  auto num = builder
+                 .Build<paddle::dialect::FullOp>(std::vector<int64_t>({1}),
+                                                 kShape.back(),
+                                                 phi::DataType::FLOAT32,
+                                                 phi::CPUPlace())
+                 .out();
+  auto mean = builder.Build<paddle::dialect::DivideOp>(sum, num).result(0);
+  auto eps = builder
+                 .Build<paddle::dialect::FullOp>(std::vector<int64_t>({1}),
+                                                 1e-6,
+                                                 phi::DataType::FLOAT32,
+                                                 phi::CPUPlace())
+                 .out();
+  auto add = builder.Build<paddle::dialect::AddOp>(mean, eps).result(0);
+  auto rsqrt = builder.Build<paddle::dialect::RsqrtOp>(add).result(0);
+  auto out = builder.Build<paddle::dialect::MultiplyOp>(rsqrt, x).result(0);
+  builder.Build<paddle::dialect::FetchOp>(out, "out", 0);
+  return program;
+}
+
+// The average time of a run of the program on the CPU place, in us.
+double MeasureProgram(
+    ::pir::Program* program,
+    const std::unordered_map<std::string, std::vector<int64_t>>&
+        input_name_and_shape) {
+  cinn::ir::search::Measurer measurer(program, phi::CPUPlace());
+  measurer.Compile();
+  measurer.Run(input_name_and_shape, kRepeats);
+  return measurer.Result().avg_total_execute_time.count();
+}
+
+}  // namespace
+
+/**
+ * The offline tuning driver of the CPU schedules. It tunes the standard
+ * groups on the local cpu, commits the records to
+ * FLAGS_cinn_tuning_record_file, and reports the time of each program before
+ * and after the tuning.
+ */
+TEST(CpuScheduleTuner, TuneStandardGroups) {
+  FLAGS_enable_cinn_compile_cache = false;
+  std::string record_file = FLAGS_cinn_tuning_record_file;
+  if (record_file.empty()) {
+    record_file = "./cpu_schedule_tuning_records.json";
+  }
+
+  auto elementwise = BuildElementwiseProgram();
+  auto rms_norm = BuildRMSNormProgram();
+  std::vector<cinn::ir::search::CpuTuningTask> tasks{
+      {elementwise.get(), {{"x", kShape}, {"y", kShape}}},
+      {rms_norm.get(), {{"x", kShape}}}};
+
+  // The baseline runs without the records of a previous tuning. The CPU
+  // kernels of such shapes are only lowered while tuning, so it runs in a
+  // scope that leaves them unscheduled.
+  FLAGS_cinn_tuning_record_file = "";
+  std::vector<double> untuned_costs;
+  {
+    cinn::ir::CpuScheduleTuningScope scope{cinn::ir::CpuScheduleParams()};
+    for (const auto& task : tasks) {
+      untuned_costs.push_back(
+          MeasureProgram(task.program, task.input_name_and_shape));
+    }
+  }
+  FLAGS_cinn_tuning_record_file = record_file;
+
+  const int num_committed = cinn::ir::search::TuneCpuSchedules(tasks);
+  LOG(INFO) << "Committed " << num_committed << " records to "
+            << FLAGS_cinn_tuning_record_file;
+
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    const double tuned_cost =
+        MeasureProgram(tasks[i].program, tasks[i].input_name_and_shape);
+    LOG(INFO) << "Program " << i << ": " << untuned_costs[i] << " us before, "
+              << tuned_cost << " us after the tuning";
+  }
+}
@@ -0,0 +1,315 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/hlir/framework/pir/persistent_compilation_cache.h"
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+#include "paddle/cinn/cinn.h"
+#include "paddle/cinn/hlir/dialect/operator/ir/cinn_op.h"
+#include "paddle/cinn/hlir/dialect/operator/ir/op_dialect.h"
+#include "paddle/cinn/hlir/framework/pir/op_lowering_group.h"
+#include "paddle/cinn/hlir/framework/pir/utils.h"
+#include "paddle/cinn/lang/lower.h"
+#include "paddle/cinn/runtime/cinn_runtime.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+
+PD_DECLARE_string(cinn_compilation_cache_dir);
+
+namespace cinn::hlir::framework::pir {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+using ProgramInfo =
+    std::tuple<std::shared_ptr<::pir::Program>, OpLoweringGroupPtr>;
+
+// A group of exp and reduce_sum over axis of a full op of the given shape.
+ProgramInfo BuildGroup(const std::vector<int64_t>& shape, int64_t axis) {
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<cinn::dialect::OperatorDialect>();
+  auto program = std::make_shared<::pir::Program>(ctx);
+  ::pir::Builder builder = ::pir::Builder(ctx, program->block());
+
+  auto x = builder
+               .Build<paddle::dialect::FullOp>(
+                   shape, 1.0, phi::DataType::FLOAT32, phi::CPUPlace())
+               .result(0);
+  auto exp = builder.Build<paddle::dialect::ExpOp>(x).result(0);
+  auto sum = builder
+                 .Build<cinn::dialect::ReduceSumOp>(
+                     exp, std::vector<int64_t>{axis}, true)
+                 .result(0);
+
+  const auto ops =
+      std::vector<::pir::Operation*>({exp.defining_op(), sum.defining_op()});
+  auto group = std::make_shared<OpLoweringGroup>(
+      ops, CompatibleInfo::GroupOpsName(ops));
+  group->mut_output_values().push_back(sum);
+  return {program, group};
+}
+
+std::string Fingerprint(const std::vector<int64_t>& shape, int64_t axis) {
+  auto [program, group] = BuildGroup(shape, axis);
+  return FusionInfo(*group).Fingerprint();
+}
+
+// Computes the fingerprint in a child process, which creates other types
+// first so that the storages of the group's types and attributes are at
+// other addresses than in this process.
+std::string FingerprintInChildProcess(const std::vector<int64_t>& shape,
+                                      int64_t axis) {
+  int fds[2];
+  if (pipe(fds) != 0) return "";
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    for (int64_t i = 1; i <= 16; ++i) {
+      BuildGroup({i, i + 1, 3}, 2);
+    }
+    const std::string fingerprint = Fingerprint(shape, axis);
+    size_t written = 0;
+    while (written < fingerprint.size()) {
+      ssize_t ret = write(
+          fds[1], fingerprint.data() + written, fingerprint.size() - written);
+      if (ret <= 0) _exit(1);
+      written += ret;
+    }
+    close(fds[1]);
+    _exit(0);
+  }
+  close(fds[1]);
+  std::string fingerprint;
+  char buffer[4096];
+  for (ssize_t ret; (ret = read(fds[0], buffer, sizeof(buffer))) > 0;) {
+    fingerprint.append(buffer, ret);
+  }
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  return fingerprint;
+}
+
+// Compiles a kernel B = A + 1 over 16 floats as the kernel of a group.
+std::shared_ptr<CompilationResult> CompileAddOne(const Target& target,
+                                                 const std::string& fn_name) {
+  Placeholder<float> a("A", {Expr(16)});
+  ir::Tensor b = Compute(
+      {Expr(16)}, [&](Var i) { return a(i) + Expr(1.f); }, "B");
+  ast_gen_ius::TensorGroup tensor_group({a, b});
+  auto func = lang::LowerToAst(fn_name, {a, b}, &tensor_group, target);
+  ir::Module::Builder builder(fn_name + "_module", target);
+  builder.AddFunction(func);
+
+  auto backend_resource = std::make_shared<BackendResource>(
+      target,
+      fn_name,
+      fn_name + "_infer_shape",
+      std::map<int, CINNKernelInfo::SymbolArgBindInfo>{
+          {2, CINNKernelInfo::ArgDimIdx{0, 1}},
+          {3, CINNKernelInfo::ArgValueIdx{1, 0}}},
+      std::vector<int64_t>{64, 128});
+  backend_resource->GetBackendCompiler()->Build(builder.Build());
+  backend_resource->GetBackendCompiler()->EndCompile();
+  auto result = std::make_shared<CompilationResult>(target);
+  result->SetBackendResource(backend_resource);
+  return result;
+}
+
+std::vector<float> RunAddOne(const CompilationResult& result) {
+  auto* a = cinn_buffer_t::new_(cinn_x86_device, cinn_float32_t(), {16});
+  auto* b = cinn_buffer_t::new_(cinn_x86_device, cinn_float32_t(), {16});
+  cinn_buffer_malloc(nullptr, a);
+  cinn_buffer_malloc(nullptr, b);
+  for (int i = 0; i < 16; ++i) {
+    reinterpret_cast<float*>(a->memory)[i] = static_cast<float>(i);
+  }
+  cinn_pod_value_t args[] = {cinn_pod_value_t(a), cinn_pod_value_t(b)};
+  auto fn = reinterpret_cast<void (*)(void*, int32_t)>(
+      result.GetBackendResource()->GetHostFuncPtr());
+  fn(args, 2);
+  auto* data = reinterpret_cast<float*>(b->memory);
+  std::vector<float> out(data, data + 16);
+  cinn_buffer_free(nullptr, a);
+  cinn_buffer_free(nullptr, b);
+  cinn_buffer_t::delete_(a);
+  cinn_buffer_t::delete_(b);
+  return out;
+}
+
+class PersistentCompilationCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = fs::temp_directory_path() /
+           ("cinn_persistent_cache_test_" + std::to_string(getpid()) + "_" +
+            std::to_string(
+                std::chrono::steady_clock::now().time_since_epoch().count()));
+    old_dir_ = FLAGS_cinn_compilation_cache_dir;
+    FLAGS_cinn_compilation_cache_dir = dir_.string();
+  }
+
+  void TearDown() override {
+    FLAGS_cinn_compilation_cache_dir = old_dir_;
+    fs::remove_all(dir_);
+  }
+
+  std::vector<fs::path> EntryFiles() const {
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(dir_)) {
+      if (entry.path().extension() == ".cinn") {
+        files.push_back(entry.path());
+      }
+    }
+    return files;
+  }
+
+  fs::path dir_;
+  std::string old_dir_;
+};
+
+}  // namespace
+
+// Runs first, before the other tests create the types of the same shape.
+TEST(FusionInfo, FingerprintStableAcrossProcesses) {
+  const std::string child = FingerprintInChildProcess({37, 129}, 1);
+  const std::string parent = Fingerprint({37, 129}, 1);
+  ASSERT_FALSE(parent.empty());
+  EXPECT_EQ(parent, child);
+  // Two programs of the same group in one process.
+  EXPECT_EQ(parent, Fingerprint({37, 129}, 1));
+}
+
+TEST(FusionInfo, FingerprintDiffersOnShapeAndAttribute) {
+  const std::string fingerprint = Fingerprint({16, 32}, 1);
+  EXPECT_NE(fingerprint, Fingerprint({16, 64}, 1));
+  EXPECT_NE(fingerprint, Fingerprint({32, 16}, 1));
+  EXPECT_NE(fingerprint, Fingerprint({16, 32}, 0));
+  EXPECT_EQ(fingerprint, Fingerprint({16, 32}, 1));
+}
+
+TEST_F(PersistentCompilationCacheTest, SaveThenLoad) {
+  const Target target = common::DefaultHostTarget();
+  ASSERT_TRUE(PersistentCacheEntry::IsEnabled(target));
+  auto [program, group] = BuildGroup({16}, 0);
+  const FusionInfo fusion_info(*group);
+
+  auto compiled = CompileAddOne(target, "fn_persistent_cache_add_one");
+  const std::vector<float> expected = RunAddOne(*compiled);
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_EQ(expected[i], i + 1.f);
+  }
+  {
+    PersistentCacheEntry entry(target, fusion_info);
+    EXPECT_EQ(entry.Load(), nullptr);
+    entry.Save(*compiled);
+  }
+  ASSERT_EQ(EntryFiles().size(), 1u);
+
+  PersistentCacheEntry entry(target, fusion_info);
+  auto loaded = entry.Load();
+  ASSERT_NE(loaded, nullptr);
+  const auto& resource = loaded->GetBackendResource();
+  const auto& compiled_resource = compiled->GetBackendResource();
+  EXPECT_EQ(resource->GetHostFuncName(), compiled_resource->GetHostFuncName());
+  EXPECT_EQ(resource->GetInferFuncName(),
+            compiled_resource->GetInferFuncName());
+  EXPECT_EQ(resource->GetSymbolArgsMap().size(), 2u);
+  EXPECT_TRUE(std::holds_alternative<CINNKernelInfo::ArgDimIdx>(
+      resource->GetSymbolArgsMap().at(2)));
+  EXPECT_TRUE(std::holds_alternative<CINNKernelInfo::ArgValueIdx>(
+      resource->GetSymbolArgsMap().at(3)));
+  EXPECT_EQ(resource->GetTempSpaceSizes(),
+            compiled_resource->GetTempSpaceSizes());
+  EXPECT_EQ(RunAddOne(*loaded), expected);
+}
+
+TEST_F(PersistentCompilationCacheTest, DamagedEntryIsRecompiled) {
+  const Target target = common::DefaultHostTarget();
+  auto [program, group] = BuildGroup({16}, 0);
+  const FusionInfo fusion_info(*group);
+  auto compiled = CompileAddOne(target, "fn_persistent_cache_damaged");
+  const std::vector<float> expected = RunAddOne(*compiled);
+  PersistentCacheEntry(target, fusion_info).Save(*compiled);
+  ASSERT_EQ(EntryFiles().size(), 1u);
+  const fs::path path = EntryFiles()[0];
+  const auto size = fs::file_size(path);
+
+  // Truncated in the middle of the object code.
+  fs::resize_file(path, size - 16);
+  EXPECT_EQ(PersistentCacheEntry(target, fusion_info).Load(), nullptr);
+  // Truncated in the header.
+  fs::resize_file(path, 12);
+  EXPECT_EQ(PersistentCacheEntry(target, fusion_info).Load(), nullptr);
+  // Corrupted bytes in the object code, the size is unchanged.
+  {
+    PersistentCacheEntry(target, fusion_info).Save(*compiled);
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(size - 64));
+    file.write("\xde\xad\xbe\xef", 4);
+  }
+  ASSERT_EQ(fs::file_size(path), size);
+  EXPECT_EQ(PersistentCacheEntry(target, fusion_info).Load(), nullptr);
+  // A corrupted magic.
+  {
+    std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+    fout << "NOTCINN!" << std::string(size, '\0');
+  }
+  EXPECT_EQ(PersistentCacheEntry(target, fusion_info).Load(), nullptr);
+
+  // A miss is compiled and saved again, as PirCompiler does.
+  {
+    PersistentCacheEntry entry(target, fusion_info);
+    auto result = entry.Load();
+    ASSERT_EQ(result, nullptr);
+    result = CompileAddOne(target, "fn_persistent_cache_damaged");
+    EXPECT_EQ(RunAddOne(*result), expected);
+    entry.Save(*result);
+  }
+  auto loaded = PersistentCacheEntry(target, fusion_info).Load();
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(RunAddOne(*loaded), expected);
+}
+
+TEST_F(PersistentCompilationCacheTest, InvalidObjectIsNotLoaded) {
+  // The object code of an entry with a valid checksum may still be rejected
+  // by the jit linker, which must not abort the process.
+  BackendResource resource(common::DefaultHostTarget(),
+                           "fn_persistent_cache_invalid",
+                           "fn_persistent_cache_invalid_infer_shape",
+                           {},
+                           {});
+  EXPECT_FALSE(resource.GetBackendCompiler()->LoadHostObject(
+      std::string(256, '\x7f')));
+}
+
+}  // namespace cinn::hlir::framework::pir
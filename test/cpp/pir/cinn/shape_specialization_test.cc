@@ -0,0 +1,168 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/hlir/framework/pir/shape_specialization.h"
+#include "paddle/common/flags.h"
+
+PD_DECLARE_int64(cinn_shape_specialize_threshold);
+PD_DECLARE_int64(cinn_shape_specialize_max_kernels);
+
+namespace cinn::hlir::framework::pir {
+
+namespace {
+
+class ShapeSpecializationCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    threshold_ = FLAGS_cinn_shape_specialize_threshold;
+    max_kernels_ = FLAGS_cinn_shape_specialize_max_kernels;
+  }
+
+  void TearDown() override {
+    FLAGS_cinn_shape_specialize_threshold = threshold_;
+    FLAGS_cinn_shape_specialize_max_kernels = max_kernels_;
+  }
+
+  // A cache of a group with one temporary space, whose static kernels are
+  // named after their symbol args. The symbol args for which compile_fails
+  // returns true fail to compile.
+  std::shared_ptr<ShapeSpecializationCache> CreateCache(
+      const std::function<bool(const std::vector<int64_t>&)>& compile_fails =
+          [](const std::vector<int64_t>&) { return false; }) {
+    return ShapeSpecializationCache::Create(
+        common::DefaultHostTarget(),
+        "fn_generic",
+        1,
+        [this, compile_fails](const std::vector<int64_t>& symbol_args) {
+          ++num_compiles_;
+          if (compile_fails(symbol_args)) {
+            throw std::runtime_error("compile failed");
+          }
+          CINNKernelInfo kernel_info;
+          kernel_info.fn_name = "fn_static";
+          for (int64_t arg : symbol_args) {
+            kernel_info.fn_name += "_" + std::to_string(arg);
+          }
+          kernel_info.temp_space_sizes = {symbol_args[0] * 4};
+          return kernel_info;
+        });
+  }
+
+  std::atomic<int> num_compiles_{0};
+
+ private:
+  int64_t threshold_;
+  int64_t max_kernels_;
+};
+
+}  // namespace
+
+TEST_F(ShapeSpecializationCacheTest, CompileAfterThreshold) {
+  FLAGS_cinn_shape_specialize_threshold = 3;
+  FLAGS_cinn_shape_specialize_max_kernels = 8;
+  auto cache = CreateCache();
+
+  EXPECT_EQ(cache->Lookup({16, 8}), nullptr);
+  EXPECT_EQ(cache->Lookup({16, 8}), nullptr);
+  cache->WaitForCompiles();
+  EXPECT_EQ(num_compiles_, 0);
+
+  // The third run submits the compile, and the run itself keeps the dynamic
+  // shape kernel.
+  EXPECT_EQ(cache->Lookup({16, 8}), nullptr);
+  cache->WaitForCompiles();
+  EXPECT_EQ(num_compiles_, 1);
+
+  const CINNKernelInfo* kernel_info = cache->Lookup({16, 8});
+  ASSERT_NE(kernel_info, nullptr);
+  EXPECT_EQ(kernel_info->fn_name, "fn_static_16_8");
+  EXPECT_EQ(kernel_info->temp_space_sizes, std::vector<int64_t>{64});
+  EXPECT_EQ(cache->Lookup({16, 8}), kernel_info);
+
+  // Other symbol args keep the dynamic shape kernel.
+  EXPECT_EQ(cache->Lookup({16, 9}), nullptr);
+  cache->WaitForCompiles();
+  EXPECT_EQ(num_compiles_, 1);
+}
+
+TEST_F(ShapeSpecializationCacheTest, MaxKernels) {
+  FLAGS_cinn_shape_specialize_threshold = 1;
+  FLAGS_cinn_shape_specialize_max_kernels = 2;
+  auto cache = CreateCache();
+
+  for (int64_t arg = 1; arg <= 4; ++arg) {
+    for (int run = 0; run < 3; ++run) {
+      cache->Lookup({arg});
+      cache->WaitForCompiles();
+    }
+  }
+  EXPECT_EQ(num_compiles_, 2);
+  EXPECT_NE(cache->Lookup({1}), nullptr);
+  EXPECT_NE(cache->Lookup({2}), nullptr);
+  EXPECT_EQ(cache->Lookup({3}), nullptr);
+  EXPECT_EQ(cache->Lookup({4}), nullptr);
+}
+
+TEST_F(ShapeSpecializationCacheTest, FallbackToDynamicShapeKernel) {
+  FLAGS_cinn_shape_specialize_threshold = 1;
+  FLAGS_cinn_shape_specialize_max_kernels = 8;
+  auto cache = CreateCache([](const std::vector<int64_t>& symbol_args) {
+    return symbol_args[0] < 0;
+  });
+
+  // A failed compile is not retried, the runs keep the dynamic shape kernel.
+  for (int run = 0; run < 3; ++run) {
+    EXPECT_EQ(cache->Lookup({-1}), nullptr);
+    cache->WaitForCompiles();
+  }
+  EXPECT_EQ(num_compiles_, 1);
+
+  // The other symbol args are still specialized.
+  cache->Lookup({2});
+  cache->WaitForCompiles();
+  EXPECT_NE(cache->Lookup({2}), nullptr);
+  EXPECT_EQ(num_compiles_, 2);
+}
+
+TEST_F(ShapeSpecializationCacheTest, FallbackOnTempSpaceMismatch) {
+  FLAGS_cinn_shape_specialize_threshold = 1;
+  FLAGS_cinn_shape_specialize_max_kernels = 8;
+  // The instruction allocates the temporary spaces of the dynamic shape
+  // kernel, a static kernel with other temporary spaces is not used.
+  auto cache = ShapeSpecializationCache::Create(
+      common::DefaultHostTarget(),
+      "fn_generic",
+      2,
+      [](const std::vector<int64_t>& symbol_args) {
+        CINNKernelInfo kernel_info;
+        kernel_info.fn_name = "fn_static";
+        kernel_info.temp_space_sizes = {symbol_args[0]};
+        return kernel_info;
+      });
+  cache->Lookup({8});
+  cache->WaitForCompiles();
+  EXPECT_EQ(cache->Lookup({8}), nullptr);
+}
+
+}  // namespace cinn::hlir::framework::pir
@@ -0,0 +1,81 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "paddle/cinn/auto_schedule/database/tuning_record_database.h"
+#include "paddle/cinn/common/target.h"
+
+namespace cinn {
+namespace auto_schedule {
+
+namespace {
+
+proto::TuningRecord MakeRecord(const std::string& task_key,
+                               double execution_cost,
+                               int vectorize_factor) {
+  proto::TuningRecord record;
+  record.set_task_key(task_key);
+  record.set_execution_cost(execution_cost);
+  auto* step = record.mutable_trace()->add_steps();
+  step->set_type("Vectorize");
+  auto* attr = step->add_attrs();
+  attr->set_name("factor");
+  attr->set_dtype(ir::proto::ScheduleDesc_Attr_DataType_INT);
+  attr->set_i(vectorize_factor);
+  return record;
+}
+
+}  // namespace
+
+TEST(TuningRecordDatabase, CommitAndReload) {
+  const std::string path = "./tuning_record_database_test.json";
+  std::remove(path.c_str());
+  const std::string key_a =
+      TuningRecordDatabase::MakeTaskKey(common::DefaultHostTarget(), "a");
+  const std::string key_b =
+      TuningRecordDatabase::MakeTaskKey(common::DefaultHostTarget(), "b");
+  ASSERT_NE(key_a, key_b);
+
+  {
+    TuningRecordDatabase database(path);
+    EXPECT_FALSE(database.GetBest(key_a).has_value());
+    EXPECT_TRUE(database.Commit(MakeRecord(key_a, 10.0, 4)));
+    // A slower record of the same task is dropped.
+    EXPECT_FALSE(database.Commit(MakeRecord(key_a, 12.0, 8)));
+    EXPECT_TRUE(database.Commit(MakeRecord(key_a, 8.0, 16)));
+    EXPECT_TRUE(database.Commit(MakeRecord(key_b, 5.0, 2)));
+
+    auto best_a = database.GetBest(key_a);
+    ASSERT_TRUE(best_a.has_value());
+    EXPECT_DOUBLE_EQ(best_a->execution_cost(), 8.0);
+  }
+
+  TuningRecordDatabase reloaded(path);
+  auto best_a = reloaded.GetBest(key_a);
+  ASSERT_TRUE(best_a.has_value());
+  EXPECT_DOUBLE_EQ(best_a->execution_cost(), 8.0);
+  ASSERT_EQ(best_a->trace().steps_size(), 1);
+  EXPECT_EQ(best_a->trace().steps(0).attrs(0).i(), 16);
+  auto best_b = reloaded.GetBest(key_b);
+  ASSERT_TRUE(best_b.has_value());
+  EXPECT_DOUBLE_EQ(best_b->execution_cost(), 5.0);
+  std::remove(path.c_str());
+}
+
+}  // namespace auto_schedule
+}  // namespace cinn
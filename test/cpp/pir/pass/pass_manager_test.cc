@@ -13,12 +13,18 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include "glog/logging.h"
 
 // NOTE(zhangbo9674): File pd_op.h is generated by op_gen.py, see details in
 // paddle/fluid/pir/dialect/CMakeLists.txt.
 #include "paddle/common/errors.h"
 #include "paddle/fluid/pir/dialect/operator/interface/op_yaml_info.h"
+#include "paddle/fluid/pir/dialect/operator/ir/control_flow_op.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
 #include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
@@ -32,6 +38,8 @@
 #include "paddle/pir/include/core/ir_context.h"
 #include "paddle/pir/include/core/op_base.h"
 #include "paddle/pir/include/core/operation.h"
+#include "paddle/pir/include/dialect/control_flow/ir/cf_dialect.h"
+#include "paddle/pir/include/dialect/control_flow/ir/cf_op.h"
 #include "paddle/pir/include/pass/pass.h"
 #include "paddle/pir/include/pass/pass_manager.h"
 #include "test/cpp/pir/tools/macros_utils.h"
@@ -312,3 +320,169 @@ TEST(pass_manager, PassManager) {
       true,
       common::errors::InvalidArgument("Program not run. Expected run."));
 }
+
+// Replaces the relu ops in the regions of the if ops with tanh ops.
+class ReluToTanhPass : public pir::Pass {
+ public:
+  ReluToTanhPass() : pir::Pass("relu_to_tanh_pass", 1) {}
+
+  void Run(pir::Operation *op) override {
+    int64_t num_rewrites = 0;
+    for (size_t i = 0; i < op->num_regions(); ++i) {
+      for (auto &block : op->region(i)) {
+        std::vector<pir::Operation *> relu_ops;
+        for (auto &inner_op : block) {
+          if (inner_op.isa<paddle::dialect::ReluOp>()) {
+            relu_ops.push_back(&inner_op);
+          }
+        }
+        for (auto *relu_op : relu_ops) {
+          pir::Builder builder(pir::IrContext::Instance(), &block);
+          builder.set_insertion_point(relu_op);
+          auto tanh_op = builder.Build<paddle::dialect::TanhOp>(
+              relu_op->operand_source(0));
+          relu_op->result(0).ReplaceAllUsesWith(tanh_op.out());
+          relu_op->Erase();
+          ++num_rewrites;
+        }
+      }
+    }
+    AddStatistics(num_rewrites);
+  }
+
+  bool CanApplyOn(pir::Operation *op) const override {
+    return op->isa<paddle::dialect::IfOp>();
+  }
+
+  bool IsRegionLocal() const override { return true; }
+};
+
+// num_if_ops if ops with num_relu_ops relu ops in the true branch, every two
+// of them share an input.
+void BuildIfProgram(pir::Program *program, int num_if_ops, int num_relu_ops) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  pir::Builder builder = pir::Builder(ctx, program->block());
+  pir::Value x;
+  for (int i = 0; i < num_if_ops; ++i) {
+    builder.SetInsertionPointToBlockEnd(program->block());
+    if (i % 2 == 0) {
+      x = builder
+              .Build<paddle::dialect::FullOp>(
+                  std::vector<int64_t>{4, 16}, 1.5, phi::DataType::FLOAT32)
+              .out();
+    }
+    auto cond = builder.Build<paddle::dialect::FullOp>(
+        std::vector<int64_t>{1}, true, phi::DataType::BOOL);
+    auto if_op = builder.Build<paddle::dialect::IfOp>(
+        cond.out(), std::vector<pir::Type>{x.type()});
+
+    builder.SetInsertionPointToStart(&if_op.true_block());
+    pir::Value out = x;
+    for (int j = 0; j < num_relu_ops; ++j) {
+      out = builder.Build<paddle::dialect::ReluOp>(out).out();
+    }
+    builder.Build<pir::YieldOp>(std::vector<pir::Value>{out});
+    builder.SetInsertionPointToStart(&if_op.false_block());
+    builder.Build<pir::YieldOp>(std::vector<pir::Value>{x});
+  }
+}
+
+std::string PrintProgram(const pir::Program &program) {
+  std::ostringstream os;
+  program.Print(os);
+  return os.str();
+}
+
+TEST(pass_manager, ParallelRegionLocalPass) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::ControlFlowDialect>();
+
+  pir::Program serial_program(ctx);
+  BuildIfProgram(&serial_program, 16, 4);
+  pir::PassManager serial_pm(ctx);
+  serial_pm.AddPass(std::make_unique<ReluToTanhPass>());
+  EXPECT_TRUE(serial_pm.Run(&serial_program));
+
+  pir::Program parallel_program(ctx);
+  BuildIfProgram(&parallel_program, 16, 4);
+  pir::PassManager parallel_pm(ctx);
+  parallel_pm.AddPass(std::make_unique<ReluToTanhPass>());
+  parallel_pm.EnableParallel(4);
+  parallel_pm.EnablePrintStatistics();
+  EXPECT_EQ(parallel_pm.num_threads(), 4);
+  EXPECT_TRUE(parallel_pm.Run(&parallel_program));
+
+  std::string serial_str = PrintProgram(serial_program);
+  EXPECT_EQ(serial_str.find("pd_op.relu"), std::string::npos);
+  EXPECT_EQ(serial_str, PrintProgram(parallel_program));
+}
+
+// Counts the operations it runs on by name.
+class CountRunsPass : public pir::Pass {
+ public:
+  CountRunsPass() : pir::Pass("count_runs_pass", 1) {}
+
+  void Run(pir::Operation *op) override {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ++runs_[op->name()];
+  }
+
+  bool IsRegionLocal() const override { return true; }
+
+  std::map<std::string, int> runs() const { return runs_; }
+
+ private:
+  std::mutex mutex_;
+  std::map<std::string, int> runs_;
+};
+
+TEST(pass_manager, ParallelRunReplacesTopLevelRun) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::ControlFlowDialect>();
+
+  const auto CountRuns = [&](int num_threads) {
+    pir::Program program(ctx);
+    BuildIfProgram(&program, 8, 2);
+    auto pass = std::make_unique<CountRunsPass>();
+    auto *pass_ptr = pass.get();
+    pir::PassManager pm(ctx);
+    pm.AddPass(std::move(pass));
+    pm.EnableParallel(num_threads);
+    EXPECT_TRUE(pm.Run(&program));
+    return pass_ptr->runs();
+  };
+
+  auto serial_runs = CountRuns(1);
+  EXPECT_EQ(serial_runs["builtin.module"], 1);
+  EXPECT_EQ(serial_runs["pd_op.if"], 8);
+
+  auto parallel_runs = CountRuns(4);
+  EXPECT_EQ(parallel_runs.count("builtin.module"), 0u);
+  EXPECT_EQ(parallel_runs["pd_op.if"], 8);
+}
+
+TEST(pass_manager, ParallelRegionLocalPassBenchmark) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::ControlFlowDialect>();
+
+  const auto RunPipeline = [&](int num_threads) {
+    pir::Program program(ctx);
+    BuildIfProgram(&program, 2048, 32);
+    pir::PassManager pm(ctx);
+    pm.AddPass(std::make_unique<ReluToTanhPass>());
+    pm.EnableParallel(num_threads);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(pm.Run(&program));
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+  };
+  double serial_ms = RunPipeline(1);
+  double parallel_ms = RunPipeline(0);
+  LOG(INFO) << "Pass pipeline on 2048 if ops with 32 ops each, serial: "
+            << serial_ms << " ms, parallel on "
+            << std::thread::hardware_concurrency() << " threads: "
+            << parallel_ms << " ms.";
+}
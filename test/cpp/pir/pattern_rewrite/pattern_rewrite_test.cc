@@ -431,6 +431,141 @@ TEST(pattern_rewrite, Patterns) {
   EXPECT_EQ(program.block()->size(), 17u);
 }
 
+void BuildTransposeChain(pir::Builder &builder) {  // NOLINT
+  paddle::dialect::FullOp full_op =
+      builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{4, 3, 16, 16},
+                                             1.5,
+                                             phi::DataType::FLOAT32,
+                                             phi::CPUPlace());
+  pir::Value out = full_op.out();
+  for (int i = 0; i < 4; ++i) {
+    std::vector<int> perm = i % 2 == 0 ? std::vector<int>{0, 2, 3, 1}
+                                       : std::vector<int>{0, 3, 1, 2};
+    out = builder.Build<paddle::dialect::TransposeOp>(out, perm).out();
+  }
+  builder.Build<paddle::dialect::FetchOp>(out, "out", 0);
+}
+
+TEST(pattern_rewrite, IncrementalWorklist) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+
+  pir::RewritePatternSet ps(ctx);
+  ps.Add<RedundantTransposeFusePattern>(ctx);
+  pir::FrozenRewritePatternSet patterns(std::move(ps));
+
+  auto RunPatterns = [&](bool use_incremental_worklist,
+                         pir::PatternStatisticsMap *statistics) {
+    pir::Program program(ctx);
+    pir::Builder builder = pir::Builder(ctx, program.block());
+    BuildTransposeChain(builder);
+    EXPECT_EQ(program.block()->size(), 6u);
+
+    pir::GreedyRewriteConfig config;
+    config.use_top_down_traversal = true;
+    config.use_incremental_worklist = use_incremental_worklist;
+    config.pattern_statistics = statistics;
+    auto [converged, num_rewrites] =
+        pir::ApplyPatternsGreedily(program.module_op(), patterns, config);
+    EXPECT_TRUE(converged);
+    EXPECT_EQ(num_rewrites, 3);
+    // The first transpose and the new ones except the last are left unused.
+    EXPECT_EQ(program.block()->size(), 6u);
+    auto *fetch_op = &program.block()->back();
+    auto *transpose_op = pir::GetDefiningOpForInput(fetch_op, 0);
+    EXPECT_TRUE(pir::GetDefiningOpForInput(transpose_op, 0)
+                    ->isa<paddle::dialect::FullOp>());
+  };
+
+  RunPatterns(false, nullptr);
+
+  pir::PatternStatisticsMap statistics;
+  RunPatterns(true, &statistics);
+  ASSERT_EQ(statistics.size(), 1u);
+  const auto &pattern_statistics = statistics.begin()->second;
+  EXPECT_EQ(pattern_statistics.num_rewrites, 3);
+  // The first transpose and the new ones are tried but do not match.
+  EXPECT_GT(pattern_statistics.num_tries, pattern_statistics.num_rewrites);
+}
+
+// A pass of the given opt level, with either the transpose pattern or a
+// pattern matching nothing.
+class GroupedTestPass : public pir::PatternRewritePass {
+ public:
+  GroupedTestPass(uint8_t opt_level,
+                  bool fuse_transpose,
+                  bool use_incremental_worklist = false)
+      : pir::PatternRewritePass("grouped_test_pass", opt_level),
+        fuse_transpose_(fuse_transpose),
+        use_incremental_worklist_(use_incremental_worklist) {}
+
+  pir::RewritePatternSet InitializePatterns(pir::IrContext *context) override {
+    pir::RewritePatternSet ps(context);
+    if (fuse_transpose_) {
+      ps.Add<RedundantTransposeFusePattern>(context);
+    } else {
+      ps.Add<TestPatternRewrite>(context);
+    }
+    return ps;
+  }
+
+  pir::GreedyRewriteConfig InitializeConfig() override {
+    pir::GreedyRewriteConfig config =
+        pir::PatternRewritePass::InitializeConfig();
+    config.use_incremental_worklist = use_incremental_worklist_;
+    return config;
+  }
+
+ private:
+  bool fuse_transpose_;
+  bool use_incremental_worklist_;
+};
+
+TEST(pattern_rewrite, PatternRewritePassGroup) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  ctx->GetOrRegisterDialect<TestDialect>();
+
+  // The transpose pass of opt level 1 is applied only from opt level 1.
+  for (uint8_t opt_level : {0, 1}) {
+    pir::Program program(ctx);
+    pir::Builder builder = pir::Builder(ctx, program.block());
+    BuildTransposeChain(builder);
+
+    std::vector<std::unique_ptr<pir::PatternRewritePass>> passes;
+    passes.push_back(std::make_unique<GroupedTestPass>(0, false));
+    passes.push_back(std::make_unique<GroupedTestPass>(1, true));
+    pir::PassManager pm(ctx, opt_level);
+    pm.AddPass(std::make_unique<pir::PatternRewritePassGroup>(
+        "test_pass_group", std::move(passes)));
+    pm.AddPass(pir::CreateDeadCodeEliminationPass());
+    EXPECT_TRUE(pm.Run(&program));
+    // full, the transposes and fetch.
+    EXPECT_EQ(program.block()->size(), opt_level == 0 ? 6u : 3u);
+  }
+}
+
+TEST(pattern_rewrite, PatternRewritePassGroupWithDifferentConfigs) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  ctx->GetOrRegisterDialect<TestDialect>();
+
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+  BuildTransposeChain(builder);
+
+  std::vector<std::unique_ptr<pir::PatternRewritePass>> passes;
+  passes.push_back(std::make_unique<GroupedTestPass>(1, false, false));
+  passes.push_back(std::make_unique<GroupedTestPass>(1, true, true));
+  pir::PassManager pm(ctx);
+  pm.AddPass(std::make_unique<pir::PatternRewritePassGroup>(
+      "test_pass_group", std::move(passes)));
+  EXPECT_THROW(pm.Run(&program), common::enforce::EnforceNotMet);
+}
+
 void BuildConstantFoldingProgram(pir::Program *program,
                                  pir::IrContext *ctx,
                                  paddle::framework::Scope *scope) {
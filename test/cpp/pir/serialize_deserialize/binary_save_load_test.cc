@@ -0,0 +1,170 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/pir/dialect/operator/ir/control_flow_op.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/ir_binary_deserialize.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/ir_binary_serialize.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/ir_serialize.h"
+#include "paddle/pir/include/core/builtin_dialect.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/program.h"
+#include "paddle/pir/include/dialect/control_flow/ir/cf_dialect.h"
+#include "paddle/pir/include/dialect/control_flow/ir/cf_op.h"
+
+namespace {
+
+pir::IrContext* InitContext() {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  ctx->GetOrRegisterDialect<pir::ControlFlowDialect>();
+  return ctx;
+}
+
+// A chain of num_layers x (parameter, add, relu) and an if op.
+void BuildProgram(pir::IrContext* ctx, pir::Program* program, int num_layers) {
+  pir::Builder builder = pir::Builder(ctx, program->block());
+  pir::Value x =
+      builder
+          .Build<paddle::dialect::FullOp>(std::vector<int64_t>{64, 64}, 1.5)
+          .out();
+  for (int i = 0; i < num_layers; ++i) {
+    auto parameter = builder.Build<pir::ParameterOp>(
+        "weight_" + std::to_string(i), x.type());
+    parameter->set_attribute("stop_gradient",
+                             pir::ArrayAttribute::get(
+                                 ctx, {pir::BoolAttribute::get(ctx, false)}));
+    auto add = builder.Build<paddle::dialect::AddOp>(x, parameter.result(0));
+    x = builder.Build<paddle::dialect::ReluOp>(add.out()).out();
+  }
+
+  auto cond = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{1}, true, phi::DataType::BOOL);
+  auto if_op = builder.Build<paddle::dialect::IfOp>(
+      cond.out(), std::vector<pir::Type>{x.type()});
+  builder.SetInsertionPointToStart(&if_op.true_block());
+  auto relu = builder.Build<paddle::dialect::ReluOp>(x);
+  builder.Build<pir::YieldOp>(std::vector<pir::Value>{relu.out()});
+  builder.SetInsertionPointToStart(&if_op.false_block());
+  builder.Build<pir::YieldOp>(std::vector<pir::Value>{x});
+}
+
+std::string PrintProgram(const pir::Program& program) {
+  std::ostringstream os;
+  program.Print(os);
+  return os.str();
+}
+
+}  // namespace
+
+TEST(BinarySaveLoadTest, round_trip) {
+  pir::IrContext* ctx = InitContext();
+  pir::Program program(ctx);
+  BuildProgram(ctx, &program, 4);
+
+  pir::WriteModuleBinary(
+      program, "./binary_round_trip.pir", /*pir_version*/ 0, true, true);
+  pir::Program new_program(ctx);
+  bool trainable = pir::ReadModule(
+      "./binary_round_trip.pir", &new_program, /*pir_version*/ 0);
+
+  EXPECT_TRUE(trainable);
+  EXPECT_EQ(PrintProgram(program), PrintProgram(new_program));
+  auto it = new_program.block()->begin();
+  pir::Operation& parameter = *(++it);
+  ASSERT_TRUE(parameter.isa<pir::ParameterOp>());
+  EXPECT_EQ(parameter.attribute<pir::StrAttribute>("parameter_name").AsString(),
+            "weight_0");
+  EXPECT_FALSE(parameter.attribute<pir::ArrayAttribute>("stop_gradient")
+                   .at(0)
+                   .dyn_cast<pir::BoolAttribute>()
+                   .data());
+  EXPECT_TRUE(parameter.attribute<pir::ArrayAttribute>("persistable")
+                  .at(0)
+                  .dyn_cast<pir::BoolAttribute>()
+                  .data());
+}
+
+// The patches apply to the expanded json, which should be the same as the
+// json written by ProgramWriter.
+TEST(BinarySaveLoadTest, expand_to_json) {
+  pir::IrContext* ctx = InitContext();
+  for (bool trainable : {true, false}) {
+    pir::Program program(ctx);
+    BuildProgram(ctx, &program, 4);
+
+    pir::BinaryProgramWriter binary_writer(/*pir_version*/ 0, trainable);
+    std::string binary = binary_writer.GetProgramBinary(&program);
+    pir::ProgramWriter json_writer(/*pir_version*/ 0, trainable);
+    Json program_json = json_writer.GetProgramJson(&program);
+
+    pir::BinaryProgramReader reader(binary.data(), binary.size());
+    EXPECT_EQ(reader.trainable(), trainable);
+    EXPECT_EQ(reader.file_version(), 0UL);
+    EXPECT_EQ(reader.GetProgramJson(), program_json);
+  }
+}
+
+TEST(BinarySaveLoadTest, invalid_file) {
+  std::string data = "PIRBIN";
+  EXPECT_FALSE(pir::BinaryProgramReader::IsBinaryProgram(data.data(),
+                                                          data.size()));
+
+  pir::IrContext* ctx = InitContext();
+  pir::Program program(ctx);
+  BuildProgram(ctx, &program, 1);
+  pir::BinaryProgramWriter writer(/*pir_version*/ 0, true);
+  std::string binary = writer.GetProgramBinary(&program);
+  pir::BinaryProgramReader reader(binary.data(), binary.size() - 1);
+  pir::Program new_program(ctx);
+  EXPECT_ANY_THROW(reader.RecoverProgram(&new_program));
+}
+
+TEST(BinarySaveLoadTest, benchmark) {
+  pir::IrContext* ctx = InitContext();
+  pir::Program program(ctx);
+  BuildProgram(ctx, &program, 10000);
+
+  pir::WriteModule(program, "./benchmark.json", 0, true, false, true);
+  pir::WriteModuleBinary(program, "./benchmark.pir", 0, true, true);
+
+  const auto Load = [&](const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    pir::Program new_program(ctx);
+    pir::ReadModule(path, &new_program, /*pir_version*/ 0);
+    auto end = std::chrono::steady_clock::now();
+    EXPECT_EQ(new_program.block()->size(), program.block()->size());
+    return std::chrono::duration<double, std::milli>(end - start).count();
+  };
+  double json_ms = Load("./benchmark.json");
+  double binary_ms = Load("./benchmark.pir");
+
+  LOG(INFO) << "Program of " << program.num_ops() << " ops, json: "
+            << std::filesystem::file_size("./benchmark.json") << " bytes, "
+            << json_ms << " ms; binary: "
+            << std::filesystem::file_size("./benchmark.pir") << " bytes, "
+            << binary_ms << " ms.";
+  EXPECT_LT(std::filesystem::file_size("./benchmark.pir"),
+            std::filesystem::file_size("./benchmark.json"));
+}
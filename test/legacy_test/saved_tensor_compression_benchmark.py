@@ -0,0 +1,155 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Peak memory and step time of FLAGS_eager_saved_tensor_compression.
+
+Each model and policy is trained on CPU in a fresh process, since the peak of
+the host memory stat can't be reset, e.g.
+
+    python saved_tensor_compression_benchmark.py --batch-size 64 --steps 20
+
+It prints the peak host memory allocated, the mean step time and the loss of
+the last step, which should stay close to the one without compression.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import time
+
+import numpy as np
+
+POLICIES = ["", "bf16", "int8"]
+
+
+def build_model(name):
+    import paddle
+
+    nn = paddle.nn
+    if name == "mlp":
+        return nn.Sequential(
+            *[m for _ in range(8) for m in (nn.Linear(1024, 1024), nn.ReLU())],
+            nn.Linear(1024, 10),
+        )
+    if name == "mlp_dropout":
+        return nn.Sequential(
+            *[
+                m
+                for _ in range(8)
+                for m in (nn.Linear(1024, 1024), nn.ReLU(), nn.Dropout(0.1))
+            ],
+            nn.Linear(1024, 10),
+        )
+    if name == "cnn":
+        return nn.Sequential(
+            nn.Conv2D(3, 64, 3, padding=1),
+            nn.ReLU(),
+            nn.Conv2D(64, 64, 3, padding=1),
+            nn.ReLU(),
+            nn.MaxPool2D(2),
+            nn.Conv2D(64, 128, 3, padding=1),
+            nn.ReLU(),
+            nn.Conv2D(128, 128, 3, padding=1),
+            nn.ReLU(),
+            nn.AdaptiveAvgPool2D(1),
+            nn.Flatten(),
+            nn.Linear(128, 10),
+        )
+    raise ValueError(f"Unknown model {name}")
+
+
+def run(args):
+    import paddle
+    from paddle.base import core
+
+    paddle.device.set_device("cpu")
+    paddle.seed(2024)
+    model = build_model(args.model)
+    optimizer = paddle.optimizer.SGD(
+        learning_rate=0.01, parameters=model.parameters()
+    )
+    rng = np.random.RandomState(0)
+    if args.model == "cnn":
+        shape = [args.batch_size, 3, 32, 32]
+    else:
+        shape = [args.batch_size, 1024]
+
+    times = []
+    for _ in range(args.steps):
+        x = paddle.to_tensor(rng.randn(*shape).astype("float32"))
+        label = paddle.to_tensor(rng.randint(0, 10, [args.batch_size, 1]))
+        start = time.perf_counter()
+        loss = paddle.nn.functional.cross_entropy(model(x), label)
+        loss.backward()
+        optimizer.step()
+        optimizer.clear_grad()
+        times.append(time.perf_counter() - start)
+    print(
+        json.dumps(
+            {
+                "peak_mb": core.host_memory_stat_peak_value("Allocated", 0)
+                / (1 << 20),
+                "step_ms": float(np.mean(times[args.warmup :])) * 1e3,
+                "loss": float(loss),
+            }
+        )
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument(
+        "--models", nargs="+", default=["mlp", "mlp_dropout", "cnn"]
+    )
+    parser.add_argument("--batch-size", type=int, default=64)
+    parser.add_argument("--steps", type=int, default=20)
+    parser.add_argument("--warmup", type=int, default=5)
+    # Runs one model in this process, used by the child processes.
+    parser.add_argument("--model", default=None, help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.model:
+        run(args)
+        return
+
+    print(
+        f"{'model':>12} {'policy':>8} {'peak(MB)':>10} {'step(ms)':>10} "
+        f"{'loss':>10}"
+    )
+    for model in args.models:
+        for policy in POLICIES:
+            env = dict(os.environ)
+            env["FLAGS_eager_saved_tensor_compression"] = policy
+            output = subprocess.check_output(
+                [
+                    sys.executable,
+                    __file__,
+                    f"--model={model}",
+                    f"--batch-size={args.batch_size}",
+                    f"--steps={args.steps}",
+                    f"--warmup={args.warmup}",
+                ],
+                env=env,
+            )
+            result = json.loads(output.decode().strip().splitlines()[-1])
+            print(
+                f"{model:>12} {policy or 'none':>8} "
+                f"{result['peak_mb']:>10.1f} {result['step_ms']:>10.2f} "
+                f"{result['loss']:>10.4f}"
+            )
+
+
+if __name__ == "__main__":
+    main()